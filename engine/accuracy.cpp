@@ -0,0 +1,147 @@
+/**
+ * @file accuracy.cpp
+ * @brief Implementation of the force accuracy sampling monitor
+ */
+
+#include "accuracy.h"
+#include "entity.h"
+#include "tree.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Exact softened acceleration on one body by direct summation
+ * @tparam Kernel Softening policy (softening.h)
+ * @param target Body to evaluate
+ * @param bodies All gravitating bodies
+ * @param kernel Prepared kernel
+ * @param G Gravitational constant
+ * @param worldWidth Periodic domain width
+ * @param worldHeight Periodic domain height
+ * @return Acceleration using the same kernel and minimum image as the tree
+ */
+template <typename Kernel>
+static Vec2 directAcceleration(const Body* target, const std::vector<Body*>& bodies,
+                               const Kernel& kernel, float G, float worldWidth, float worldHeight) {
+    double ax = 0, ay = 0;
+    for (const Body* other : bodies) {
+        if (other == target) continue;
+        Vec2 dr = minimumImage(other->pos - target->pos, worldWidth, worldHeight);
+        float f, phi;
+        kernel.apply(dr.lengthSquared(), G * other->mass, f, phi);
+        ax += dr.x * f;
+        ay += dr.y * f;
+    }
+    return Vec2((float)ax, (float)ay);
+}
+
+ForceAccuracyMonitor::ForceAccuracyMonitor(uint32_t seed)
+    : rng(seed), stepsUntilCheck(0), errorHead(0), errorCount(0) {
+    setConfig(ForceAccuracyConfig());
+}
+
+void ForceAccuracyMonitor::setConfig(const ForceAccuracyConfig& newConfig) {
+    config = newConfig;
+    config.interval = std::max(config.interval, 1);
+    config.samples = std::max(config.samples, 1);
+    config.window = std::max(config.window, 1);
+    errors.assign(config.window * config.samples, 0.0f);
+    errorHead = 0;
+    errorCount = 0;
+    stepsUntilCheck = config.interval;
+    updateStats();
+}
+
+void ForceAccuracyMonitor::reset(uint32_t seed) {
+    rng.seed(seed);
+    stats = ForceAccuracyStats();
+    setConfig(config);
+}
+
+void ForceAccuracyMonitor::saveState(CheckpointWriter& out) const {
+    out.put(config);
+    out.put(stats);
+    out.putRng(rng);
+    out.put(stepsUntilCheck);
+    out.putVector(errors);
+    out.put(errorHead);
+    out.put(errorCount);
+}
+
+void ForceAccuracyMonitor::loadState(CheckpointReader& in) {
+    in.get(config);
+    in.get(stats);
+    in.getRng(rng);
+    in.get(stepsUntilCheck);
+    in.getVector(errors);
+    in.get(errorHead);
+    in.get(errorCount);
+    if (errorHead < 0 || errorCount < 0 || (size_t)errorHead > errors.size() ||
+        (size_t)errorCount > errors.size()) {
+        in.fail();
+    }
+}
+
+void ForceAccuracyMonitor::update(const std::vector<Body*>& bodies, const QuadTree& tree, float& theta,
+                                  float eps, float G, float worldWidth, float worldHeight,
+                                  SofteningKernel softening) {
+    if (!config.enabled || bodies.size() < 2) return;
+    if (--stepsUntilCheck > 0) return;
+    stepsUntilCheck = config.interval;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int s = 0; s < config.samples; s++) {
+        const Body* body = bodies[rng() % bodies.size()];
+        Vec2 exact, approx;
+        withSoftening(softening, eps, [&](const auto& kernel) {
+            exact = directAcceleration(body, bodies, kernel, G, worldWidth, worldHeight);
+            approx = tree.calculateForce(body->pos, body->mass, theta, kernel, G).acc;
+        });
+        float exactMag = exact.length();
+        if (exactMag <= 0) continue;
+
+        errors[errorHead] = (approx - exact).length() / exactMag;
+        errorHead = (errorHead + 1) % (int)errors.size();
+        errorCount = std::min(errorCount + 1, (int)errors.size());
+    }
+
+    stats.checks++;
+    updateStats();
+
+    // Steer theta toward the target error (small multiplicative steps with a dead band)
+    if (config.adaptiveTheta && stats.samplesInWindow > 0) {
+        if (stats.rmsError > config.targetError * 1.1f) {
+            theta *= 0.95f;
+        } else if (stats.rmsError < config.targetError * 0.7f) {
+            theta *= 1.03f;
+        }
+        theta = std::min(std::max(theta, config.minTheta), config.maxTheta);
+    }
+
+    stats.costSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ForceAccuracyMonitor::updateStats() {
+    stats.samplesInWindow = errorCount;
+    if (errorCount == 0) {
+        stats.meanError = stats.rmsError = stats.p95Error = stats.maxError = 0;
+        return;
+    }
+
+    double sum = 0, sumSq = 0;
+    float maxError = 0;
+    for (int i = 0; i < errorCount; i++) {
+        sum += errors[i];
+        sumSq += (double)errors[i] * errors[i];
+        maxError = std::max(maxError, errors[i]);
+    }
+    stats.meanError = (float)(sum / errorCount);
+    stats.rmsError = (float)std::sqrt(sumSq / errorCount);
+    stats.maxError = maxError;
+
+    scratch.assign(errors.begin(), errors.begin() + errorCount);
+    size_t k = (size_t)(0.95 * (errorCount - 1));
+    std::nth_element(scratch.begin(), scratch.begin() + k, scratch.end());
+    stats.p95Error = scratch[k];
+}
@@ -0,0 +1,154 @@
+/**
+ * @file accuracy.h
+ * @brief Runtime sampling monitor for Barnes-Hut force accuracy
+ *
+ * Every `interval` steps the monitor picks a few random gravitating bodies,
+ * computes their exact direct-sum acceleration and compares it with the
+ * tree result. Relative errors are kept in a rolling window from which
+ * mean, RMS, 95th percentile and maximum are reported.
+ *
+ * With the default settings (8 bodies every 30 steps) the direct sums cost
+ * about 8N/30 pair interactions per step, well under 1% of the two tree
+ * walks per step. The monitor uses its own RNG stream, so enabling it does
+ * not change the simulation unless adaptive theta is switched on.
+ *
+ * Optionally the monitor steers the opening angle: theta shrinks when the
+ * windowed RMS error exceeds the target and grows when the error is well
+ * below it, holding the target accuracy at the lowest cost.
+ */
+
+#pragma once
+#include "checkpoint.h"
+#include "softening.h"
+#include "tree.h"
+#include "vecn.h"
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+struct Body;
+
+/**
+ * @struct ForceAccuracyConfig
+ * @brief Sampling and control parameters for ForceAccuracyMonitor
+ */
+struct ForceAccuracyConfig {
+    bool enabled;         ///< Run the monitor at all
+    int interval;         ///< Steps between checks (K)
+    int samples;          ///< Bodies sampled per check
+    int window;           ///< Checks kept in the rolling window
+    bool adaptiveTheta;   ///< Adjust theta toward targetError
+    float targetError;    ///< Target windowed RMS relative error
+    float minTheta;       ///< Lower bound for adaptive theta
+    float maxTheta;       ///< Upper bound for adaptive theta
+
+    /**
+     * @brief Default constructor - passive monitoring, 8 bodies every 30 steps
+     */
+    ForceAccuracyConfig()
+        : enabled(true), interval(30), samples(8), window(32), adaptiveTheta(false),
+          targetError(0.01f), minTheta(0.2f), maxTheta(1.2f) {}
+};
+
+/**
+ * @struct ForceAccuracyStats
+ * @brief Error statistics over the rolling window
+ *
+ * Errors are |a_tree - a_direct| / |a_direct| per sampled body.
+ */
+struct ForceAccuracyStats {
+    float meanError;      ///< Mean relative error
+    float rmsError;       ///< Root-mean-square relative error
+    float p95Error;       ///< 95th percentile relative error
+    float maxError;       ///< Largest relative error in the window
+    int samplesInWindow;  ///< Number of errors currently in the window
+    int checks;           ///< Total checks since reset
+    double costSeconds;   ///< Wall time spent in the monitor since reset
+
+    /**
+     * @brief Default constructor - no samples yet
+     */
+    ForceAccuracyStats()
+        : meanError(0), rmsError(0), p95Error(0), maxError(0), samplesInWindow(0),
+          checks(0), costSeconds(0) {}
+};
+
+/**
+ * @class ForceAccuracyMonitor
+ * @brief Samples tree force error against direct summation
+ */
+class ForceAccuracyMonitor {
+public:
+    /**
+     * @brief Construct a monitor
+     * @param seed Seed for the monitor's own sampling RNG
+     */
+    explicit ForceAccuracyMonitor(uint32_t seed);
+
+    /**
+     * @brief Set sampling and control parameters (clears the window)
+     * @param config New configuration
+     */
+    void setConfig(const ForceAccuracyConfig& config);
+
+    /**
+     * @brief Get current configuration
+     * @return Active configuration
+     */
+    const ForceAccuracyConfig& getConfig() const { return config; }
+
+    /**
+     * @brief Clear statistics and reseed the sampling RNG
+     * @param seed New seed
+     */
+    void reset(uint32_t seed);
+
+    /**
+     * @brief Advance one step; on check steps, sample errors and maybe adjust theta
+     * @param bodies Gravitating bodies the tree was built from
+     * @param tree Tree built from bodies at their current positions
+     * @param theta Opening angle (adjusted in place when adaptiveTheta is set)
+     * @param eps Softening length
+     * @param G Gravitational constant
+     * @param worldWidth Periodic domain width
+     * @param worldHeight Periodic domain height
+     * @param softening Kernel the tree forces use
+     */
+    void update(const std::vector<Body*>& bodies, const QuadTree& tree, float& theta,
+                float eps, float G, float worldWidth, float worldHeight,
+                SofteningKernel softening = SofteningKernel::PLUMMER);
+
+    /**
+     * @brief Get error statistics over the rolling window
+     * @return Latest statistics
+     */
+    const ForceAccuracyStats& getStats() const { return stats; }
+
+    /**
+     * @brief Append the full monitor state (config, RNG, window) to a checkpoint
+     * @param out Checkpoint writer
+     */
+    void saveState(CheckpointWriter& out) const;
+
+    /**
+     * @brief Restore state written by saveState
+     * @param in Checkpoint reader (failure is reported through in.good())
+     */
+    void loadState(CheckpointReader& in);
+
+private:
+    ForceAccuracyConfig config;   ///< Active configuration
+    ForceAccuracyStats stats;     ///< Cached statistics (recomputed after each check)
+    std::mt19937 rng;             ///< Sampling RNG (independent of gameplay RNG)
+    int stepsUntilCheck;          ///< Countdown to the next check
+    std::vector<float> errors;    ///< Ring buffer of relative errors (window * samples)
+    int errorHead;                ///< Next write position in errors
+    int errorCount;               ///< Valid entries in errors
+    std::vector<float> scratch;   ///< Scratch copy for percentile selection
+
+    /**
+     * @brief Recompute stats from the ring buffer
+     */
+    void updateStats();
+};
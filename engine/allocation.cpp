@@ -0,0 +1,174 @@
+/**
+ * @file allocation.cpp
+ * @brief Tagged heap accounting: counters and global operator new/delete hooks
+ */
+
+#include "allocation.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+/**
+ * @struct TagCounters
+ * @brief Live counters of one tag (one cache line each, so tags do not false-share)
+ */
+struct alignas(64) TagCounters {
+    std::atomic<int64_t> current;       ///< Live bytes
+    std::atomic<int64_t> peak;          ///< Highest live bytes
+    std::atomic<uint64_t> allocations;  ///< Blocks allocated
+    std::atomic<uint64_t> frees;        ///< Blocks freed
+};
+
+/// Counters indexed by MemoryTag (zero-initialised before any constructor runs)
+static TagCounters counters[kMemoryTagCount];
+
+/// Tag charged for allocations on this thread
+static thread_local MemoryTag threadTag = MemoryTag::UNTAGGED;
+
+const char* memoryTagName(MemoryTag tag) {
+    switch (tag) {
+        case MemoryTag::UNTAGGED: return "untagged";
+        case MemoryTag::ENTITIES: return "entities";
+        case MemoryTag::PARTICLES: return "particles";
+        case MemoryTag::QUADTREE: return "quadtree";
+        case MemoryTag::COLLISION: return "collision";
+        case MemoryTag::ENGINE: return "engine";
+    }
+    return "unknown";
+}
+
+MemoryTagStats getMemoryStats(MemoryTag tag) {
+    const TagCounters& c = counters[static_cast<int>(tag)];
+    MemoryTagStats stats;
+    stats.currentBytes = c.current.load(std::memory_order_relaxed);
+    stats.peakBytes = c.peak.load(std::memory_order_relaxed);
+    stats.allocations = c.allocations.load(std::memory_order_relaxed);
+    stats.frees = c.frees.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void resetMemoryPeaks() {
+    for (TagCounters& c : counters) {
+        c.peak.store(c.current.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
+
+MemoryTag currentMemoryTag() {
+    return threadTag;
+}
+
+MemoryTag setMemoryTag(MemoryTag tag) {
+    MemoryTag previous = threadTag;
+    threadTag = tag;
+    return previous;
+}
+
+#ifdef NBODY_NO_MEMORY_TRACKING
+
+bool memoryTrackingEnabled() {
+    return false;
+}
+
+#else
+
+bool memoryTrackingEnabled() {
+    return true;
+}
+
+/// Marks live tracked blocks (cleared on free, so a double free is not counted twice)
+static constexpr uint32_t kHeaderMagic = 0x4e424d54;
+
+/**
+ * @struct BlockHeader
+ * @brief Prefix of every tracked block; 16 bytes keeps the payload max_align_t aligned
+ */
+struct alignas(16) BlockHeader {
+    uint64_t size;   ///< Payload bytes
+    uint32_t tag;    ///< MemoryTag the block is charged to
+    uint32_t magic;  ///< kHeaderMagic
+};
+static_assert(sizeof(BlockHeader) == 16, "block header must stay 16 bytes");
+
+/**
+ * @brief Allocate a tracked block
+ * @param size Payload bytes
+ * @return Payload pointer, or nullptr when malloc fails
+ */
+static void* trackedAllocate(std::size_t size) {
+    BlockHeader* header = static_cast<BlockHeader*>(std::malloc(sizeof(BlockHeader) + size));
+    if (!header) return nullptr;
+    int tag = static_cast<int>(threadTag);
+    header->size = size;
+    header->tag = (uint32_t)tag;
+    header->magic = kHeaderMagic;
+
+    TagCounters& c = counters[tag];
+    c.allocations.fetch_add(1, std::memory_order_relaxed);
+    int64_t now = c.current.fetch_add((int64_t)size, std::memory_order_relaxed) + (int64_t)size;
+    int64_t peak = c.peak.load(std::memory_order_relaxed);
+    while (now > peak && !c.peak.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {
+    }
+    return header + 1;
+}
+
+/**
+ * @brief Free a tracked block and charge it back to its tag
+ * @param ptr Payload pointer (may be null)
+ */
+static void trackedFree(void* ptr) {
+    if (!ptr) return;
+    BlockHeader* header = static_cast<BlockHeader*>(ptr) - 1;
+    if (header->magic == kHeaderMagic && header->tag < (uint32_t)kMemoryTagCount) {
+        TagCounters& c = counters[header->tag];
+        c.frees.fetch_add(1, std::memory_order_relaxed);
+        c.current.fetch_sub((int64_t)header->size, std::memory_order_relaxed);
+    }
+    header->magic = 0;
+    std::free(header);
+}
+
+void* operator new(std::size_t size) {
+    void* ptr = trackedAllocate(size);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](std::size_t size) {
+    void* ptr = trackedAllocate(size);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return trackedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return trackedAllocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    trackedFree(ptr);
+}
+
+#endif
@@ -0,0 +1,119 @@
+/**
+ * @file allocation.h
+ * @brief Tagged heap accounting by subsystem
+ *
+ * Global operator new/delete are replaced (allocation.cpp) by versions
+ * that prefix every block with a 16-byte header recording its size and
+ * the tag that was current on the allocating thread. Frees are charged
+ * back to the tag stored in the header, so a block allocated while
+ * building the tree and freed during cleanup still balances.
+ *
+ * The current tag is thread-local and set with MemoryScope; WorkerPool
+ * passes the caller's tag to its workers for the duration of a job.
+ * Allocations outside any scope count as UNTAGGED.
+ *
+ * Counters are process-wide (shared by every engine in the process) and
+ * updated with relaxed atomics: one fetch_add per allocation or free plus
+ * a compare-exchange when the peak grows. Build with
+ * -DNBODY_NO_MEMORY_TRACKING to keep the default allocator; the stats
+ * then stay zero and memoryTrackingEnabled() returns false.
+ *
+ * Over-aligned allocations (alignas > 16) bypass the hooks.
+ */
+
+#pragma once
+#include <cstdint>
+
+/**
+ * @enum MemoryTag
+ * @brief Subsystem a heap block is charged to
+ */
+enum class MemoryTag : uint8_t {
+    UNTAGGED = 0,   ///< Outside any scope (runner, standard library, ...)
+    ENTITIES = 1,   ///< Ship, asteroid, bullet and black hole stores
+    PARTICLES = 2,  ///< Explosion particle store
+    QUADTREE = 3,   ///< Barnes-Hut tree nodes
+    COLLISION = 4,  ///< Broadphase grid and collision pair buffers
+    ENGINE = 5      ///< Other per-step scratch (gravity lists, diagnostics, balancing)
+};
+
+/// Number of MemoryTag values
+constexpr int kMemoryTagCount = 6;
+
+/**
+ * @brief Get a tag's display name
+ * @param tag Tag
+ * @return Static lowercase name
+ */
+const char* memoryTagName(MemoryTag tag);
+
+/**
+ * @struct MemoryTagStats
+ * @brief Heap counters of one tag
+ */
+struct MemoryTagStats {
+    int64_t currentBytes;  ///< Live bytes (payload, headers excluded)
+    int64_t peakBytes;     ///< Highest currentBytes since start or resetMemoryPeaks()
+    uint64_t allocations;  ///< Blocks allocated
+    uint64_t frees;        ///< Blocks freed
+
+    /**
+     * @brief Default constructor - zero counters
+     */
+    MemoryTagStats() : currentBytes(0), peakBytes(0), allocations(0), frees(0) {}
+};
+
+/**
+ * @brief Whether the allocation hooks are compiled in
+ * @return False when built with NBODY_NO_MEMORY_TRACKING
+ */
+bool memoryTrackingEnabled();
+
+/**
+ * @brief Get one tag's counters
+ * @param tag Tag
+ * @return Snapshot of the counters
+ */
+MemoryTagStats getMemoryStats(MemoryTag tag);
+
+/**
+ * @brief Restart peak tracking from the current usage of every tag
+ */
+void resetMemoryPeaks();
+
+/**
+ * @brief Get the calling thread's current tag
+ * @return Tag new allocations are charged to
+ */
+MemoryTag currentMemoryTag();
+
+/**
+ * @brief Set the calling thread's current tag
+ * @param tag New tag
+ * @return Previous tag
+ */
+MemoryTag setMemoryTag(MemoryTag tag);
+
+/**
+ * @class MemoryScope
+ * @brief Charges allocations on this thread to a tag until destroyed
+ */
+class MemoryScope {
+public:
+    /**
+     * @brief Enter a scope
+     * @param tag Tag for allocations inside the scope
+     */
+    explicit MemoryScope(MemoryTag tag) : previous(setMemoryTag(tag)) {}
+
+    /**
+     * @brief Restore the enclosing tag
+     */
+    ~MemoryScope() { setMemoryTag(previous); }
+
+    MemoryScope(const MemoryScope&) = delete;
+    MemoryScope& operator=(const MemoryScope&) = delete;
+
+private:
+    MemoryTag previous;  ///< Tag to restore
+};
@@ -19,7 +19,9 @@
 
 #include "engine.h"
 #include <emscripten/emscripten.h>
+#include <algorithm>
 #include <cstring>
+#include <vector>
 
 // C API for WASM
 extern "C" {
@@ -43,11 +45,68 @@ void* engine_create(float width, float height, uint32_t seed) {
     return new GameEngine(width, height, seed);
 }
 
+/**
+ * @brief Create an engine whose world is populated on first use
+ * @param width World width in pixels
+ * @param height World height in pixels
+ * @param seed Random seed for reproducible spawning
+ * @return Opaque handle to engine instance (void*)
+ *
+ * Skips the initial reset(): the world stays empty until engine_reset,
+ * engine_set_mode, engine_load_state or the first engine_step. Use this
+ * when the caller configures the game (or restores a saved state) before
+ * stepping, so set-up work is done once.
+ */
+EMSCRIPTEN_KEEPALIVE
+void* engine_create_deferred(float width, float height, uint32_t seed) {
+    return new GameEngine(width, height, seed, true);
+}
+
 EMSCRIPTEN_KEEPALIVE
 void engine_destroy(void* handle) {
     delete static_cast<GameEngine*>(handle);
 }
 
+/// Last state produced by engine_save_state (the WebAssembly build is single-threaded)
+static std::vector<uint8_t> savedState;
+
+/**
+ * @brief Serialise the full engine state (see checkpoint.h)
+ * @param handle Engine handle
+ * @return State size in bytes; read it from engine_get_saved_state()
+ *
+ * The bytes stay valid until the next engine_save_state call.
+ */
+EMSCRIPTEN_KEEPALIVE
+int engine_save_state(void* handle) {
+    GameEngine* engine = static_cast<GameEngine*>(handle);
+    engine->saveState(savedState);
+    return (int)savedState.size();
+}
+
+/**
+ * @brief Get the bytes written by the last engine_save_state
+ * @return Pointer into WASM memory
+ */
+EMSCRIPTEN_KEEPALIVE
+const uint8_t* engine_get_saved_state() {
+    return savedState.data();
+}
+
+/**
+ * @brief Restore a state written by engine_save_state
+ * @param handle Engine handle (same world size as the saved engine)
+ * @param data State bytes in WASM memory
+ * @param size Byte count
+ * @return 1 on success; 0 if the state is from another build or world
+ *   size (engine untouched) or malformed (engine reset)
+ */
+EMSCRIPTEN_KEEPALIVE
+int engine_load_state(void* handle, const uint8_t* data, int size) {
+    GameEngine* engine = static_cast<GameEngine*>(handle);
+    return engine->loadState(data, size > 0 ? (size_t)size : 0) ? 1 : 0;
+}
+
 // Configuration
 EMSCRIPTEN_KEEPALIVE
 void engine_set_mode(void* handle, int mode) {
@@ -82,6 +141,19 @@ void engine_set_blackholes_enabled(void* handle, int enabled) {
     engine->setBlackHolesEnabled(enabled != 0);
 }
 
+/**
+ * @brief Select the gravitational softening kernel
+ * @param handle Engine handle
+ * @param kernel SofteningKernel (0 = plummer, 1 = spline, 2 = none; others ignored)
+ */
+EMSCRIPTEN_KEEPALIVE
+void engine_set_softening(void* handle, int kernel) {
+    GameEngine* engine = static_cast<GameEngine*>(handle);
+    if (kernel >= 0 && kernel < static_cast<int>(SofteningKernel::COUNT)) {
+        engine->setSofteningKernel(static_cast<SofteningKernel>(kernel));
+    }
+}
+
 EMSCRIPTEN_KEEPALIVE
 void engine_set_ship_mass(void* handle, float mass) {
     GameEngine* engine = static_cast<GameEngine*>(handle);
@@ -191,6 +263,28 @@ void engine_get_asteroid_data(void* handle, int index, float* outData) {
     outData[5] = asteroid.active ? 1.0f : 0.0f;
 }
 
+/**
+ * @brief Get an asteroid's polygon outline
+ * @param handle Engine handle
+ * @param index Asteroid index
+ * @param outData Output buffer of at least 1 + 2 * kMaxAsteroidVertices floats:
+ *   [0] vertex count, then x0, y0, x1, y1, ... in unit-radius local coordinates
+ *   (scale by radius and rotate by rotation to draw)
+ */
+EMSCRIPTEN_KEEPALIVE
+void engine_get_asteroid_shape(void* handle, int index, float* outData) {
+    GameEngine* engine = static_cast<GameEngine*>(handle);
+    const auto& asteroids = engine->getAsteroids();
+    if (index < 0 || index >= (int)asteroids.size()) return;
+
+    const AsteroidShape& shape = asteroids[index].shape;
+    outData[0] = shape.count;
+    for (int i = 0; i < shape.count; i++) {
+        outData[1 + 2 * i] = shape.x[i];
+        outData[2 + 2 * i] = shape.y[i];
+    }
+}
+
 EMSCRIPTEN_KEEPALIVE
 int engine_get_bullet_count(void* handle) {
     GameEngine* engine = static_cast<GameEngine*>(handle);
@@ -241,11 +335,281 @@ void engine_get_particle_data(void* handle, int index, float* outData) {
     const auto& particles = engine->getParticles();
     if (index < 0 || index >= (int)particles.size()) return;
 
-    const Particle& particle = particles[index];
-    outData[0] = particle.pos.x;
-    outData[1] = particle.pos.y;
-    outData[2] = particle.lifetime / particle.maxLifetime;  // Alpha
-    outData[3] = (float)particle.playerId;  // Player ID for color
+    // x, y, alpha (remaining lifetime fraction), player id for color
+    particles.getRenderData(index, 1, outData);
+}
+
+/**
+ * @brief Get render data for all particles in one call
+ * @param handle Engine handle
+ * @param outData Output buffer of 4 floats per particle: [0] x, [1] y, [2] alpha, [3] player id
+ * @param maxCount Capacity of outData in particles
+ * @return Number of particles written
+ */
+EMSCRIPTEN_KEEPALIVE
+int engine_get_particles(void* handle, float* outData, int maxCount) {
+    GameEngine* engine = static_cast<GameEngine*>(handle);
+    const auto& particles = engine->getParticles();
+    int count = std::min(maxCount, (int)particles.size());
+    if (count <= 0) return 0;
+    particles.getRenderData(0, count, outData);
+    return count;
+}
+
+/**
+ * @brief Select the particle storage tier
+ * @param handle Engine handle
+ * @param enabled Nonzero for the compact 16-bit tier, zero for full records
+ */
+EMSCRIPTEN_KEEPALIVE
+void engine_set_compact_storage(void* handle, int enabled) {
+    GameEngine* engine = static_cast<GameEngine*>(handle);
+    engine->setCompactStorage(enabled != 0);
+}
+
+/**
+ * @brief Get conservation diagnostics from the last step
+ * @param handle Engine handle
+ * @param outData Output buffer of 9 floats:
+ *   [0] kinetic, [1] mutual potential, [2] external potential, [3] total energy,
+ *   [4] momentum x, [5] momentum y, [6] angular momentum, [7] relative energy drift,
+ *   [8] body count
+ */
+EMSCRIPTEN_KEEPALIVE
+void engine_get_diagnostics(void* handle, float* outData) {
+    GameEngine* engine = static_cast<GameEngine*>(handle);
+    const EnergyDiagnostics& diag = engine->getDiagnostics();
+    outData[0] = (float)diag.kinetic;
+    outData[1] = (float)diag.potential;
+    outData[2] = (float)diag.external;
+    outData[3] = (float)diag.total;
+    outData[4] = (float)diag.momentumX;
+    outData[5] = (float)diag.momentumY;
+    outData[6] = (float)diag.angularMomentum;
+    outData[7] = (float)diag.drift;
+    outData[8] = (float)diag.bodyCount;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void engine_reset_diagnostics_baseline(void* handle) {
+    GameEngine* engine = static_cast<GameEngine*>(handle);
+    engine->resetDiagnosticsBaseline();
+}
+
+/**
+ * @brief Configure the force accuracy monitor
+ * @param handle Engine handle
+ * @param interval Steps between checks (0 disables the monitor)
+ * @param samples Bodies sampled per check
+ * @param adaptiveTheta Non-zero to steer theta toward targetError
+ * @param targetError Target RMS relative force error
+ */
+EMSCRIPTEN_KEEPALIVE
+void engine_set_force_monitor(void* handle, int interval, int samples, int adaptiveTheta, float targetError) {
+    GameEngine* engine = static_cast<GameEngine*>(handle);
+    ForceAccuracyConfig config;
+    config.enabled = interval > 0;
+    config.interval = interval;
+    config.samples = samples;
+    config.adaptiveTheta = adaptiveTheta != 0;
+    config.targetError = targetError;
+    engine->setForceAccuracyConfig(config);
+}
+
+/**
+ * @brief Get force accuracy statistics
+ * @param handle Engine handle
+ * @param outData Output buffer of 6 floats:
+ *   [0] mean, [1] RMS, [2] p95, [3] max relative error, [4] current theta, [5] checks
+ */
+EMSCRIPTEN_KEEPALIVE
+void engine_get_force_accuracy(void* handle, float* outData) {
+    GameEngine* engine = static_cast<GameEngine*>(handle);
+    const ForceAccuracyStats& stats = engine->getForceAccuracy();
+    outData[0] = stats.meanError;
+    outData[1] = stats.rmsError;
+    outData[2] = stats.p95Error;
+    outData[3] = stats.maxError;
+    outData[4] = engine->getPhysicsConfig().theta;
+    outData[5] = (float)stats.checks;
+}
+
+/**
+ * @brief Configure radial profiles about the potential centre
+ * @param handle Engine handle
+ * @param bins Radial bins (0 disables profiling)
+ * @param maxRadius Outer edge of the last bin (0 = half the shorter world side)
+ * @param interval Steps between updates (1 = every step)
+ */
+EMSCRIPTEN_KEEPALIVE
+void engine_set_profiles(void* handle, int bins, float maxRadius, int interval) {
+    GameEngine* engine = static_cast<GameEngine*>(handle);
+    ProfileConfig config;
+    config.enabled = bins > 0;
+    config.bins = bins;
+    config.maxRadius = maxRadius;
+    config.interval = interval;
+    engine->setProfileConfig(config);
+}
+
+/**
+ * @brief Get the bin count of the latest radial profile
+ * @param handle Engine handle
+ * @return Bins (0 before the first profiled step)
+ */
+EMSCRIPTEN_KEEPALIVE
+int engine_get_profile_bins(void* handle) {
+    GameEngine* engine = static_cast<GameEngine*>(handle);
+    return engine->getProfiler().getBins();
+}
+
+/**
+ * @brief Get the latest radial profile without copying
+ * @param handle Engine handle
+ * @return Pointer into WASM memory to 6 * bins floats, column-major:
+ *   radius, count, surface density, rotation, dispersion, circular speed
+ *   (see ProfileColumn); overwritten in place by later updates, null
+ *   before the first profiled step
+ */
+EMSCRIPTEN_KEEPALIVE
+const float* engine_get_profile(void* handle) {
+    GameEngine* engine = static_cast<GameEngine*>(handle);
+    return engine->getProfiler().getData();
+}
+
+/**
+ * @brief Get phase timings of the last step
+ * @param handle Engine handle
+ * @param outData Output buffer of 8 floats (milliseconds unless noted):
+ *   [0] entities, [1] gravity, [2] analysis, [3] collisions, [4] cleanup,
+ *   [5] total, [6] force imbalance (max/mean task time), [7] force tasks
+ */
+EMSCRIPTEN_KEEPALIVE
+void engine_get_step_profile(void* handle, float* outData) {
+    GameEngine* engine = static_cast<GameEngine*>(handle);
+    const StepProfile& profile = engine->getStepProfile();
+    outData[0] = (float)(profile.entitySeconds * 1000.0);
+    outData[1] = (float)(profile.gravitySeconds * 1000.0);
+    outData[2] = (float)(profile.analysisSeconds * 1000.0);
+    outData[3] = (float)(profile.collisionSeconds * 1000.0);
+    outData[4] = (float)(profile.cleanupSeconds * 1000.0);
+    outData[5] = (float)(profile.totalSeconds * 1000.0);
+    outData[6] = (float)profile.forceImbalance;
+    outData[7] = (float)profile.forceTasks;
+}
+
+/**
+ * @brief Configure step-latency windows and outlier detection (clears the histograms)
+ * @param handle Engine handle
+ * @param window Steps per snapshot window
+ * @param outlierFactor Outlier threshold as a multiple of the median step time
+ * @param minOutlierMs Steps faster than this are never outliers
+ */
+EMSCRIPTEN_KEEPALIVE
+void engine_set_latency_config(void* handle, int window, float outlierFactor, float minOutlierMs) {
+    GameEngine* engine = static_cast<GameEngine*>(handle);
+    LatencyConfig config;
+    config.window = window;
+    config.outlierFactor = outlierFactor;
+    config.minOutlierMs = minOutlierMs;
+    engine->setLatencyConfig(config);
+}
+
+/**
+ * @brief Get step-latency percentiles
+ * @param handle Engine handle
+ * @param scope 0 = current window, 1 = last completed window, 2 = since reset
+ * @param outData Output buffer of 13 floats (milliseconds unless noted):
+ *   [0] steps, [1] mean, [2] p50, [3] p90, [4] p99, [5] p99.9, [6] max,
+ *   [7] outliers, [8..12] outliers dominated by entities, gravity,
+ *   analysis, collisions, cleanup
+ */
+EMSCRIPTEN_KEEPALIVE
+void engine_get_latency(void* handle, int scope, float* outData) {
+    GameEngine* engine = static_cast<GameEngine*>(handle);
+    LatencySummary summary = engine->getLatency().getSummary(static_cast<LatencyScope>(std::min(2, std::max(0, scope))));
+    outData[0] = (float)summary.steps;
+    outData[1] = (float)summary.meanMs;
+    outData[2] = (float)summary.p50Ms;
+    outData[3] = (float)summary.p90Ms;
+    outData[4] = (float)summary.p99Ms;
+    outData[5] = (float)summary.p999Ms;
+    outData[6] = (float)summary.maxMs;
+    outData[7] = (float)summary.outliers;
+    for (int i = 0; i < kStepPhaseCount; i++) {
+        outData[8 + i] = (float)summary.phaseOutliers[i];
+    }
+}
+
+/**
+ * @brief Get the most recent outlier steps
+ * @param handle Engine handle
+ * @param outData Output buffer of 5 floats per outlier, newest first:
+ *   [0] step, [1] total ms, [2] dominant phase (StepPhase), [3] phase ms, [4] median ms
+ * @param maxCount Capacity of outData in outliers
+ * @return Number of outliers written
+ */
+EMSCRIPTEN_KEEPALIVE
+int engine_get_latency_outliers(void* handle, float* outData, int maxCount) {
+    GameEngine* engine = static_cast<GameEngine*>(handle);
+    const LatencyTracker& latency = engine->getLatency();
+    int count = std::min(maxCount, latency.getOutlierCount());
+    for (int i = 0; i < count; i++) {
+        const LatencyOutlier& outlier = latency.getOutlier(i);
+        outData[i * 5 + 0] = (float)outlier.step;
+        outData[i * 5 + 1] = outlier.totalMs;
+        outData[i * 5 + 2] = (float)static_cast<int>(outlier.phase);
+        outData[i * 5 + 3] = outlier.phaseMs;
+        outData[i * 5 + 4] = outlier.medianMs;
+    }
+    return count;
+}
+
+/**
+ * @brief Get heap usage per allocation tag (process-wide)
+ * @param handle Engine handle
+ * @param outData Output buffer of 32 floats: for each tag in MemoryTag order
+ *   (untagged, entities, particles, quadtree, collision, engine) five values
+ *   [current bytes, peak bytes, allocations, frees, steps over budget],
+ *   then [30] over-budget tag mask (bit per tag), [31] tracking enabled
+ */
+EMSCRIPTEN_KEEPALIVE
+void engine_get_memory_stats(void* handle, float* outData) {
+    GameEngine* engine = static_cast<GameEngine*>(handle);
+    for (int i = 0; i < kMemoryTagCount; i++) {
+        MemoryTag tag = static_cast<MemoryTag>(i);
+        MemoryTagStats stats = getMemoryStats(tag);
+        outData[i * 5 + 0] = (float)stats.currentBytes;
+        outData[i * 5 + 1] = (float)stats.peakBytes;
+        outData[i * 5 + 2] = (float)stats.allocations;
+        outData[i * 5 + 3] = (float)stats.frees;
+        outData[i * 5 + 4] = (float)engine->getOverBudgetSteps(tag);
+    }
+    outData[30] = (float)engine->getMemoryPressure();
+    outData[31] = memoryTrackingEnabled() ? 1.0f : 0.0f;
+}
+
+/**
+ * @brief Set a hard heap budget for one allocation tag
+ * @param handle Engine handle
+ * @param tag MemoryTag index (1 = entities ... 5 = engine)
+ * @param bytes Budget in bytes (0 = unlimited)
+ */
+EMSCRIPTEN_KEEPALIVE
+void engine_set_memory_budget(void* handle, int tag, double bytes) {
+    GameEngine* engine = static_cast<GameEngine*>(handle);
+    if (tag < 0 || tag >= kMemoryTagCount) return;
+    engine->setMemoryBudget(static_cast<MemoryTag>(tag), (int64_t)bytes);
+}
+
+/**
+ * @brief Restart peak tracking from current usage (all tags)
+ * @param handle Engine handle (unused; the counters are process-wide)
+ */
+EMSCRIPTEN_KEEPALIVE
+void engine_reset_memory_peaks(void* handle) {
+    (void)handle;
+    resetMemoryPeaks();
 }
 
 EMSCRIPTEN_KEEPALIVE
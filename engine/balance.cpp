@@ -0,0 +1,60 @@
+/**
+ * @file balance.cpp
+ * @brief Cost-weighted Morton partitioning
+ */
+
+#include "balance.h"
+#include "morton.h"
+#include <algorithm>
+
+ForceBalancer::ForceBalancer() : bounds(2, 0), taskSeconds(1, 0.0) {}
+
+void ForceBalancer::partition(const std::vector<Body*>& bodies, float worldWidth, float worldHeight,
+                              int numTasks) {
+    size_t n = bodies.size();
+    numTasks = std::max(1, numTasks);
+
+    keyed.resize(n);
+    double measuredCost = 0;
+    int measured = 0;
+    for (size_t i = 0; i < n; i++) {
+        keyed[i] = std::make_pair(mortonKey(bodies[i]->pos, worldWidth, worldHeight), (int)i);
+        if (bodies[i]->cost > 0) {
+            measuredCost += bodies[i]->cost;
+            measured++;
+        }
+    }
+    std::sort(keyed.begin(), keyed.end());
+
+    order.resize(n);
+    for (size_t k = 0; k < n; k++) order[k] = keyed[k].second;
+
+    // New bodies (spawned since the last force pass) get the mean weight
+    float fallback = measured > 0 ? (float)(measuredCost / measured) : 1.0f;
+    double total = 0;
+    for (size_t i = 0; i < n; i++) {
+        total += bodies[i]->cost > 0 ? bodies[i]->cost : fallback;
+    }
+
+    // Cut where the prefix weight crosses t/numTasks of the total
+    bounds.assign(numTasks + 1, n);
+    bounds[0] = 0;
+    double cumulative = 0;
+    int next = 1;
+    for (size_t k = 0; k < n && next < numTasks; k++) {
+        while (next < numTasks && cumulative >= total * next / numTasks) bounds[next++] = k;
+        float cost = bodies[order[k]]->cost;
+        cumulative += cost > 0 ? cost : fallback;
+    }
+
+    taskSeconds.assign(numTasks, 0.0);
+}
+
+double ForceBalancer::imbalance() const {
+    double maxSeconds = 0, sum = 0;
+    for (double s : taskSeconds) {
+        maxSeconds = std::max(maxSeconds, s);
+        sum += s;
+    }
+    return sum > 0 ? maxSeconds * taskSeconds.size() / sum : 1.0;
+}
@@ -0,0 +1,87 @@
+/**
+ * @file balance.h
+ * @brief Cost-weighted partitioning of per-body force work across threads
+ *
+ * Tree walks are far from uniform: a body next to a black hole or inside a
+ * dense fragment cluster opens many more nodes than one in empty space.
+ * Splitting the body list into equal counts therefore leaves some threads
+ * idle while others finish their share.
+ *
+ * ForceBalancer orders bodies along the Morton curve (so each task walks a
+ * compact region and reuses the same tree nodes) and cuts the curve into
+ * contiguous ranges of equal total weight. The weight of a body is the
+ * number of interactions its walk evaluated in the previous step
+ * (Body::cost); bodies without a measurement yet use the mean.
+ */
+
+#pragma once
+#include "entity.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * @class ForceBalancer
+ * @brief Splits a body list into cost-balanced contiguous Morton ranges
+ *
+ * partition() runs on the calling thread; during the parallel loop each
+ * task only reads its range and writes its own timing slot.
+ */
+class ForceBalancer {
+public:
+    /**
+     * @brief Construct an empty balancer
+     */
+    ForceBalancer();
+
+    /**
+     * @brief Order bodies by Morton key and split them into weighted ranges
+     * @param bodies Bodies to partition
+     * @param worldWidth Domain width
+     * @param worldHeight Domain height
+     * @param numTasks Number of ranges (typically the thread count)
+     */
+    void partition(const std::vector<Body*>& bodies, float worldWidth, float worldHeight, int numTasks);
+
+    /**
+     * @brief Number of ranges from the last partition
+     * @return Task count
+     */
+    int getTaskCount() const { return (int)taskSeconds.size(); }
+
+    /**
+     * @brief Body indices in Morton order
+     * @return Indices into the partitioned body list
+     */
+    const std::vector<int>& getOrder() const { return order; }
+
+    /**
+     * @brief Positions in getOrder() covered by one task
+     * @param task Task index
+     * @param outBegin Output: first position
+     * @param outEnd Output: one past the last position
+     */
+    void taskRange(int task, size_t& outBegin, size_t& outEnd) const {
+        outBegin = bounds[task];
+        outEnd = bounds[task + 1];
+    }
+
+    /**
+     * @brief Record how long a task took (each task writes only its own slot)
+     * @param task Task index
+     * @param seconds Wall time of the task
+     */
+    void recordTaskTime(int task, double seconds) { taskSeconds[task] = seconds; }
+
+    /**
+     * @brief Load imbalance of the last parallel loop
+     * @return Slowest task time / mean task time (1.0 = perfectly balanced)
+     */
+    double imbalance() const;
+
+private:
+    std::vector<std::pair<uint32_t, int>> keyed;  ///< (Morton key, body index) sort scratch
+    std::vector<int> order;                       ///< Body indices in Morton order
+    std::vector<size_t> bounds;                   ///< Task t covers order[bounds[t] .. bounds[t+1])
+    std::vector<double> taskSeconds;              ///< Measured wall time per task
+};
@@ -0,0 +1,466 @@
+/**
+ * @file bench.cpp
+ * @brief Performance regression gate for GameEngine::step
+ *
+ * Builds with `make native` into `nbody-bench`. Runs a fixed set of cases
+ * (pinned seeds, sizes and configs, listed in kCases) through
+ * GameEngine::step, several repetitions each, and either writes the
+ * samples as a baseline or compares them against one:
+ *
+ *     nbody-bench --write-baseline bench/baseline.txt
+ *     nbody-bench --baseline bench/baseline.txt     (exit 1 on regression)
+ *
+ * Every repetition builds a fresh engine, runs a few untimed warm-up steps
+ * and then times each step. A repetition contributes one sample of mean
+ * ms/step, p99 step latency and mean time per StepProfile phase.
+ *
+ * Cases with dims 3 step an NBodySystem<3> (octree) instead of the game;
+ * their gravity phase is the force pass and entities the kicks and drift.
+ *
+ * A metric regresses when both hold:
+ * - the median is more than --threshold percent above the baseline median
+ * - a one-sided Mann-Whitney U test says the current samples are larger,
+ *   p < --alpha
+ * A single slow run therefore fails neither test alone. The per-phase
+ * medians are printed next to each case so a regression can be traced to
+ * gravity, collisions and so on.
+ *
+ * Baseline format (text, `#` comments):
+ *
+ *     threads 1
+ *     sample CASE REP MS_PER_STEP P99_MS ENTITY GRAVITY ANALYSIS COLLISION CLEANUP
+ *
+ * Baselines are machine-specific: regenerate them on the machine that
+ * runs the gate, with the same --threads.
+ */
+
+#include "bot.h"
+#include "engine.h"
+#include "nbodysystem.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * @struct BenchCase
+ * @brief One pinned benchmark configuration
+ */
+struct BenchCase {
+    const char* name;       ///< Case name (baseline key)
+    bool game;              ///< Normal game with a hunter bot instead of a scenario
+    ScenarioKind scenario;  ///< Scenario for non-game cases
+    int bodies;             ///< Scenario body count
+    int level;              ///< Potential level
+    bool collisions;        ///< Collision handling
+    int monitorInterval;    ///< Force accuracy check interval (0 = off)
+    int steps;              ///< Timed steps per repetition
+    int dims;               ///< 2 = GameEngine, 3 = NBodySystem<3> in a cube of the world width
+};
+
+/// The fixed benchmark set (changing a case invalidates its baseline samples)
+static const BenchCase kCases[] = {
+    {"game", true, ScenarioKind::UNIFORM, 0, 0, true, 0, 2000, 2},
+    {"uniform-2k", false, ScenarioKind::UNIFORM, 2000, 0, false, 0, 60, 2},
+    {"plummer-2k", false, ScenarioKind::PLUMMER, 2000, 1, false, 5, 60, 2},
+    {"disc-2k", false, ScenarioKind::ROTATING_DISC, 2000, 0, true, 0, 60, 2},
+    {"bh-cluster-1k", false, ScenarioKind::BLACK_HOLE_CLUSTER, 1000, 0, false, 0, 60, 2},
+    {"plummer3d-2k", false, ScenarioKind::PLUMMER, 2000, 0, false, 0, 30, 3},
+};
+
+/// Untimed steps before each repetition
+static const int kWarmupSteps = 3;
+
+/// Metrics per sample: ms/step, p99, then the StepProfile phases
+static const int kMetrics = 7;
+
+/// Metric names (baseline column order)
+static const char* const kMetricNames[kMetrics] = {
+    "ms/step", "p99", "entities", "gravity", "analysis", "collisions", "cleanup",
+};
+
+/**
+ * @struct BenchSample
+ * @brief Result of one repetition (all values in milliseconds)
+ */
+struct BenchSample {
+    double values[kMetrics];  ///< Indexed like kMetricNames
+};
+
+/// Samples per case name
+using SampleTable = std::map<std::string, std::vector<BenchSample>>;
+
+/**
+ * @struct BenchOptions
+ * @brief Command line options
+ */
+struct BenchOptions {
+    const char* baseline;       ///< Baseline to compare against (null = none)
+    const char* writeBaseline;  ///< Baseline to write (null = none)
+    const char* only;           ///< Run a single case (null = all)
+    int reps;                   ///< Repetitions per case
+    int threads;                ///< Worker threads (pinned; stored in the baseline)
+    double threshold;           ///< Allowed median slowdown (percent)
+    double alpha;               ///< Significance level
+
+    /**
+     * @brief Default options
+     */
+    BenchOptions()
+        : baseline(nullptr), writeBaseline(nullptr), only(nullptr), reps(7), threads(1), threshold(15.0),
+          alpha(0.01) {}
+};
+
+/**
+ * @brief Build a sample from per-step latencies and phase totals
+ * @param latencies Step times in ms (sorted in place)
+ * @param total Sum of step times in ms
+ * @param phases Summed phase times in ms, StepProfile order
+ * @param steps Timed steps
+ * @return Sample
+ */
+static BenchSample makeSample(std::vector<double>& latencies, double total, const double* phases, int steps) {
+    BenchSample sample;
+    std::sort(latencies.begin(), latencies.end());
+    sample.values[0] = total / steps;
+    sample.values[1] = latencies[std::min(latencies.size() - 1, (size_t)(0.99 * latencies.size()))];
+    for (int k = 0; k < 5; k++) sample.values[2 + k] = phases[k] / steps;
+    return sample;
+}
+
+/**
+ * @brief Run one repetition of a 3D case
+ * @param c Case (dims 3)
+ * @param threads Worker threads
+ * @return Timings (gravity = force pass, entities = the rest of the step)
+ */
+static BenchSample runSpatialRepetition(const BenchCase& c, int threads) {
+    const float side = 1600.0f;
+    SystemParams physics;
+    ScenarioParams params;
+    params.kind = c.scenario;
+    params.count = c.bodies;
+    params.seed = 1;
+    std::vector<ScenarioBody3D> bodies;
+    generateScenario3D(params, side, physics.G, bodies);
+
+    NBodySystem<3> system(splat<3>(side), physics);
+    system.setThreadCount(threads);
+    for (const ScenarioBody3D& b : bodies) system.addBody(b.pos, b.vel, b.mass);
+
+    std::vector<double> latencies;
+    double phases[5] = {};
+    double total = 0;
+    for (int i = 0; i < kWarmupSteps + c.steps; i++) {
+        auto start = std::chrono::steady_clock::now();
+        system.step();
+        double ms = 1000.0 * std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (i < kWarmupSteps) continue;
+
+        double gravity = 1000.0 * system.getStats().gravitySeconds;
+        latencies.push_back(ms);
+        total += ms;
+        phases[0] += ms - gravity;
+        phases[1] += gravity;
+    }
+    return makeSample(latencies, total, phases, c.steps);
+}
+
+/**
+ * @brief Run one repetition of a case
+ * @param c Case
+ * @param threads Worker threads
+ * @return Timings
+ */
+static BenchSample runRepetition(const BenchCase& c, int threads) {
+    if (c.dims == 3) return runSpatialRepetition(c, threads);
+
+    const float width = 1600.0f, height = 1200.0f;
+    const uint32_t seed = 1;
+    GameEngine engine(width, height, seed);
+    engine.setThreadCount(threads);
+    engine.setLevel(c.level);
+    engine.setCollisionsEnabled(c.collisions);
+    ForceAccuracyConfig monitor;
+    monitor.enabled = c.monitorInterval > 0;
+    monitor.interval = std::max(c.monitorInterval, 1);
+    engine.setForceAccuracyConfig(monitor);
+
+    if (!c.game) {
+        ScenarioParams params;
+        params.kind = c.scenario;
+        params.count = c.bodies;
+        params.seed = seed;
+        params.level = c.level;
+        Scenario scenario;
+        generateScenario(params, width, height, engine.getPhysicsConfig().G, scenario);
+        engine.setBlackHolesEnabled(false);
+        engine.loadScenario(scenario);
+    }
+
+    Bot bot(BotStrategy::HUNTER, 0);
+    std::vector<double> latencies;
+    double phases[5] = {};
+    double total = 0;
+    for (int i = 0; i < kWarmupSteps + c.steps; i++) {
+        if (c.game) engine.setInput(0, bot.decide(engine));
+        auto start = std::chrono::steady_clock::now();
+        engine.step();
+        double ms = 1000.0 * std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (i < kWarmupSteps) continue;
+
+        const StepProfile& p = engine.getStepProfile();
+        latencies.push_back(ms);
+        total += ms;
+        phases[0] += 1000.0 * p.entitySeconds;
+        phases[1] += 1000.0 * p.gravitySeconds;
+        phases[2] += 1000.0 * p.analysisSeconds;
+        phases[3] += 1000.0 * p.collisionSeconds;
+        phases[4] += 1000.0 * p.cleanupSeconds;
+    }
+
+    return makeSample(latencies, total, phases, c.steps);
+}
+
+/**
+ * @brief Median of one metric over samples
+ * @param samples Samples
+ * @param metric Metric index
+ * @return Median (0 if empty)
+ */
+static double median(const std::vector<BenchSample>& samples, int metric) {
+    std::vector<double> v;
+    for (const BenchSample& s : samples) v.push_back(s.values[metric]);
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    size_t n = v.size();
+    return n % 2 ? v[n / 2] : 0.5 * (v[n / 2 - 1] + v[n / 2]);
+}
+
+/**
+ * @brief One-sided Mann-Whitney U test that current values tend to exceed baseline values
+ * @param current Current samples
+ * @param baseline Baseline samples
+ * @param metric Metric index
+ * @return p-value (normal approximation with tie and continuity correction)
+ */
+static double mannWhitneyGreater(const std::vector<BenchSample>& current, const std::vector<BenchSample>& baseline,
+                                 int metric) {
+    size_t n1 = current.size(), n2 = baseline.size();
+    if (n1 == 0 || n2 == 0) return 1.0;
+
+    // Ranks over the pooled samples (average rank for ties)
+    std::vector<std::pair<double, int>> pooled;
+    for (const BenchSample& s : current) pooled.push_back({s.values[metric], 0});
+    for (const BenchSample& s : baseline) pooled.push_back({s.values[metric], 1});
+    std::sort(pooled.begin(), pooled.end());
+    size_t n = pooled.size();
+    double rankSum = 0, tieTerm = 0;
+    for (size_t i = 0; i < n;) {
+        size_t j = i;
+        while (j < n && pooled[j].first == pooled[i].first) j++;
+        double rank = 0.5 * (i + 1 + j);
+        for (size_t k = i; k < j; k++) {
+            if (pooled[k].second == 0) rankSum += rank;
+        }
+        double t = (double)(j - i);
+        tieTerm += t * t * t - t;
+        i = j;
+    }
+
+    double u = rankSum - n1 * (n1 + 1) / 2.0;
+    double mean = n1 * n2 / 2.0;
+    double variance = n1 * n2 / 12.0 * ((n + 1) - tieTerm / (n * (n - 1.0)));
+    if (variance <= 0) return u > mean ? 0.0 : 1.0;
+    double z = (u - mean - 0.5) / std::sqrt(variance);
+    return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+
+/**
+ * @brief Read a baseline file
+ * @param path Baseline path
+ * @param threads Output thread count recorded in the baseline
+ * @param table Output samples
+ * @return False on a read or syntax error (reported on stderr)
+ */
+static bool readBaseline(const char* path, int& threads, SampleTable& table) {
+    std::ifstream in(path);
+    if (!in) {
+        std::fprintf(stderr, "cannot open baseline %s\n", path);
+        return false;
+    }
+    std::string line;
+    int lineNo = 0;
+    threads = 0;
+    while (std::getline(in, line)) {
+        lineNo++;
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        std::string key;
+        if (!(fields >> key)) continue;
+
+        bool ok = true;
+        if (key == "threads") {
+            ok = static_cast<bool>(fields >> threads);
+        } else if (key == "sample") {
+            std::string name;
+            int rep;
+            BenchSample sample;
+            ok = static_cast<bool>(fields >> name >> rep);
+            for (int m = 0; ok && m < kMetrics; m++) ok = static_cast<bool>(fields >> sample.values[m]);
+            if (ok) table[name].push_back(sample);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            std::fprintf(stderr, "%s:%d: invalid line '%s'\n", path, lineNo, line.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Write a baseline file
+ * @param path Baseline path
+ * @param threads Thread count the samples were taken with
+ * @param table Samples
+ * @return False on I/O error
+ */
+static bool writeBaseline(const char* path, int threads, const SampleTable& table) {
+    FILE* out = std::fopen(path, "w");
+    if (!out) return false;
+    std::fprintf(out, "# nbody-bench baseline (regenerate with nbody-bench --write-baseline)\n");
+    std::fprintf(out, "threads %d\n", threads);
+    std::fprintf(out, "# sample case rep ms_per_step p99_ms entities gravity analysis collisions cleanup\n");
+    for (const BenchCase& c : kCases) {
+        auto it = table.find(c.name);
+        if (it == table.end()) continue;
+        for (size_t r = 0; r < it->second.size(); r++) {
+            std::fprintf(out, "sample %s %zu", c.name, r);
+            for (int m = 0; m < kMetrics; m++) std::fprintf(out, " %.5f", it->second[r].values[m]);
+            std::fprintf(out, "\n");
+        }
+    }
+    return std::fclose(out) == 0;
+}
+
+/**
+ * @brief Print usage text
+ */
+static void printUsage() {
+    std::fprintf(stderr,
+        "Usage: nbody-bench [options]\n"
+        "  --baseline FILE        Compare against a baseline; exit 1 on regression\n"
+        "  --write-baseline FILE  Record a new baseline\n"
+        "  --only CASE            Run one case\n"
+        "  --reps N               Repetitions per case (default 7)\n"
+        "  --threads N            Worker threads (default 1; must match the baseline)\n"
+        "  --threshold PCT        Allowed median slowdown in percent (default 15)\n"
+        "  --alpha P              Significance level of the U test (default 0.01)\n"
+        "  --list                 List the cases\n");
+}
+
+int main(int argc, char** argv) {
+    BenchOptions opts;
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--baseline") == 0 && hasValue) opts.baseline = argv[++i];
+        else if (std::strcmp(arg, "--write-baseline") == 0 && hasValue) opts.writeBaseline = argv[++i];
+        else if (std::strcmp(arg, "--only") == 0 && hasValue) opts.only = argv[++i];
+        else if (std::strcmp(arg, "--reps") == 0 && hasValue) opts.reps = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(arg, "--threads") == 0 && hasValue) opts.threads = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(arg, "--threshold") == 0 && hasValue) opts.threshold = std::atof(argv[++i]);
+        else if (std::strcmp(arg, "--alpha") == 0 && hasValue) opts.alpha = std::atof(argv[++i]);
+        else if (std::strcmp(arg, "--list") == 0) {
+            for (const BenchCase& c : kCases) {
+                std::printf("%-14s %s bodies=%d level=%d collisions=%d steps=%d\n", c.name,
+                            c.game ? "game" : scenarioKindName(c.scenario), c.bodies, c.level, c.collisions, c.steps);
+            }
+            return 0;
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    SampleTable baseline;
+    if (opts.baseline) {
+        int baselineThreads = 0;
+        if (!readBaseline(opts.baseline, baselineThreads, baseline)) return 2;
+        if (baselineThreads != opts.threads) {
+            std::fprintf(stderr, "baseline was taken with %d threads, running with %d\n", baselineThreads,
+                         opts.threads);
+            return 2;
+        }
+    }
+
+    // Repetitions are interleaved across cases so slow drift in machine
+    // load spreads over every case instead of landing on one
+    SampleTable current;
+    for (int r = 0; r < opts.reps; r++) {
+        for (const BenchCase& c : kCases) {
+            if (opts.only && std::strcmp(opts.only, c.name) != 0) continue;
+            current[c.name].push_back(runRepetition(c, opts.threads));
+        }
+    }
+    if (current.empty()) {
+        std::fprintf(stderr, "unknown case '%s' (see --list)\n", opts.only);
+        return 2;
+    }
+
+    bool regression = false;
+    for (const BenchCase& c : kCases) {
+        if (!current.count(c.name)) continue;
+        const std::vector<BenchSample>& samples = current[c.name];
+        auto base = baseline.find(c.name);
+        if (!opts.baseline || base == baseline.end()) {
+            std::printf("%-14s ms/step=%.3f p99=%.3f%s\n", c.name, median(samples, 0), median(samples, 1),
+                        opts.baseline ? "  (no baseline samples)" : "");
+            continue;
+        }
+
+        // Gated metrics: mean step time and tail latency
+        for (int m = 0; m < 2; m++) {
+            double before = median(base->second, m), after = median(samples, m);
+            double change = before > 0 ? 100.0 * (after / before - 1.0) : 0.0;
+            double p = mannWhitneyGreater(samples, base->second, m);
+            bool failed = change > opts.threshold && p < opts.alpha;
+            regression = regression || failed;
+            std::printf("%-14s %-8s %9.3f -> %9.3f ms %+7.1f%%  p=%.3f  %s\n", m == 0 ? c.name : "",
+                        kMetricNames[m], before, after, change, p, failed ? "REGRESSION" : "ok");
+        }
+        std::printf("%-14s phases  ", "");
+        for (int m = 2; m < kMetrics; m++) {
+            double before = median(base->second, m), after = median(samples, m);
+            std::printf(" %s %.3f->%.3f", kMetricNames[m], before, after);
+            if (before > 0.001) std::printf(" (%+.0f%%)", 100.0 * (after / before - 1.0));
+        }
+        std::printf("\n");
+    }
+    if (opts.writeBaseline) {
+        // Keep baseline samples of cases that were not rerun
+        SampleTable merged;
+        int mergedThreads = 0;
+        if (std::ifstream(opts.writeBaseline) && (!readBaseline(opts.writeBaseline, mergedThreads, merged) ||
+                                                  mergedThreads != opts.threads)) {
+            merged.clear();
+        }
+        for (const auto& entry : current) merged[entry.first] = entry.second;
+        if (!writeBaseline(opts.writeBaseline, opts.threads, merged)) {
+            std::fprintf(stderr, "cannot write baseline %s\n", opts.writeBaseline);
+            return 2;
+        }
+        std::printf("wrote %s\n", opts.writeBaseline);
+    }
+    if (opts.baseline) std::printf("%s\n", regression ? "FAIL: performance regression" : "PASS");
+    return regression ? 1 : 0;
+}
@@ -0,0 +1,120 @@
+/**
+ * @file bot.cpp
+ * @brief Ship controller heuristics
+ */
+
+#include "bot.h"
+#include <cmath>
+#include <cstring>
+
+/// Black holes closer than this make the hunter flee
+static constexpr float kFleeDistance = 250.0f;
+
+/// Hunter brakes above this speed
+static constexpr float kMaxHuntSpeed = 150.0f;
+
+/// Aim tolerance (radians) for firing and for stopping rotation
+static constexpr float kAimTolerance = 0.15f;
+
+bool parseBotStrategy(const char* name, BotStrategy& outStrategy) {
+    if (std::strcmp(name, "idle") == 0) outStrategy = BotStrategy::IDLE;
+    else if (std::strcmp(name, "spin") == 0) outStrategy = BotStrategy::SPIN;
+    else if (std::strcmp(name, "hunter") == 0) outStrategy = BotStrategy::HUNTER;
+    else return false;
+    return true;
+}
+
+const char* botStrategyName(BotStrategy strategy) {
+    switch (strategy) {
+        case BotStrategy::IDLE: return "idle";
+        case BotStrategy::SPIN: return "spin";
+        case BotStrategy::HUNTER: return "hunter";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Signed angle from one heading to another, wrapped to [-pi, pi]
+ * @param from Current heading
+ * @param to Desired heading
+ * @return Rotation needed (positive = clockwise in screen coordinates)
+ */
+static float angleDelta(float from, float to) {
+    float d = std::fmod(to - from, 6.28318531f);
+    if (d > 3.14159265f) d -= 6.28318531f;
+    if (d < -3.14159265f) d += 6.28318531f;
+    return d;
+}
+
+/**
+ * @brief Set rotate inputs to turn towards a heading
+ * @param input Input to modify
+ * @param delta Signed angle to the target heading
+ */
+static void steer(InputState& input, float delta) {
+    input.left = delta < -kAimTolerance;
+    input.right = delta > kAimTolerance;
+}
+
+Bot::Bot(BotStrategy strategy, int playerId) : strategy(strategy), playerId(playerId) {}
+
+InputState Bot::decide(const GameEngine& engine) const {
+    InputState input;
+    const std::vector<Ship>& ships = engine.getShips();
+    if (playerId >= (int)ships.size() || !ships[playerId].active) return input;
+    const Ship& ship = ships[playerId];
+
+    if (strategy == BotStrategy::IDLE) return input;
+    if (strategy == BotStrategy::SPIN) {
+        input.right = true;
+        input.shoot = true;
+        return input;
+    }
+
+    float width = engine.getWorldWidth();
+    float height = engine.getWorldHeight();
+
+    // Flee the nearest close black hole: turn away and thrust
+    float nearestHole2 = kFleeDistance * kFleeDistance;
+    Vec2 holeDir;
+    bool fleeing = false;
+    for (const BlackHole& bh : engine.getBlackHoles()) {
+        if (!bh.active) continue;
+        Vec2 d = minimumImage(bh.pos - ship.pos, width, height);
+        float d2 = d.lengthSquared();
+        if (d2 < nearestHole2) {
+            nearestHole2 = d2;
+            holeDir = d;
+            fleeing = true;
+        }
+    }
+    if (fleeing) {
+        float away = std::atan2(-holeDir.y, -holeDir.x);
+        float delta = angleDelta(ship.angle, away);
+        steer(input, delta);
+        input.thrust = std::fabs(delta) < 1.0f;
+        return input;
+    }
+
+    // Otherwise aim at the nearest asteroid and fire when lined up
+    float nearest2 = 1e30f;
+    Vec2 target;
+    bool found = false;
+    for (const Asteroid& a : engine.getAsteroids()) {
+        if (!a.active) continue;
+        Vec2 d = minimumImage(a.pos - ship.pos, width, height);
+        float d2 = d.lengthSquared();
+        if (d2 < nearest2) {
+            nearest2 = d2;
+            target = d;
+            found = true;
+        }
+    }
+    if (found) {
+        float delta = angleDelta(ship.angle, std::atan2(target.y, target.x));
+        steer(input, delta);
+        input.shoot = std::fabs(delta) < kAimTolerance;
+    }
+    input.brake = ship.vel.lengthSquared() > kMaxHuntSpeed * kMaxHuntSpeed;
+    return input;
+}
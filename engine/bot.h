@@ -0,0 +1,62 @@
+/**
+ * @file bot.h
+ * @brief Scripted and heuristic ship controllers for headless games
+ *
+ * Used by the native sweep tool to play many games without a human. Bots
+ * only read the public engine state and produce an InputState per frame,
+ * exactly like the browser input layer, so a bot game exercises the same
+ * code paths as a real one.
+ */
+
+#pragma once
+#include "engine.h"
+
+/**
+ * @enum BotStrategy
+ * @brief How a bot chooses its inputs
+ */
+enum class BotStrategy {
+    IDLE,    ///< No input (pure physics survival baseline)
+    SPIN,    ///< Scripted: rotate and fire continuously
+    HUNTER   ///< Aim at the nearest asteroid, flee black holes, cap speed
+};
+
+/**
+ * @brief Parse a strategy name ("idle", "spin", "hunter")
+ * @param name Strategy name
+ * @param outStrategy Output strategy
+ * @return False if the name is unknown
+ */
+bool parseBotStrategy(const char* name, BotStrategy& outStrategy);
+
+/**
+ * @brief Name of a strategy
+ * @param strategy Strategy
+ * @return Lower-case name
+ */
+const char* botStrategyName(BotStrategy strategy);
+
+/**
+ * @class Bot
+ * @brief Produces per-frame inputs for one ship
+ */
+class Bot {
+public:
+    /**
+     * @brief Create a bot
+     * @param strategy Control strategy
+     * @param playerId Ship the bot controls (0 or 1)
+     */
+    Bot(BotStrategy strategy, int playerId);
+
+    /**
+     * @brief Choose inputs for the next frame
+     * @param engine Game state (read only)
+     * @return Input for this bot's ship
+     */
+    InputState decide(const GameEngine& engine) const;
+
+private:
+    BotStrategy strategy;  ///< Control strategy
+    int playerId;          ///< Controlled ship index
+};
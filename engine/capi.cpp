@@ -0,0 +1,366 @@
+/**
+ * @file capi.cpp
+ * @brief Implementation of the C ABI in nbody.h (libnbody.so)
+ *
+ * Each handle owns a GameEngine plus scratch reused across calls (snapshot
+ * columns, saved state), so repeated snapshots and checkpoints do not
+ * allocate once warmed up. C++ exceptions never cross the ABI: every
+ * entry point catches them and reports NBODY_ERROR_INTERNAL.
+ */
+
+#include "nbody.h"
+#include "engine.h"
+#include "scenario.h"
+#include "snapshot.h"
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <vector>
+
+static_assert(sizeof(Vec2) == 2 * sizeof(float), "position columns are copied as float pairs");
+static_assert(NBODY_SHIP == static_cast<int>(EntityType::SHIP) &&
+              NBODY_ASTEROID == static_cast<int>(EntityType::ASTEROID) &&
+              NBODY_BULLET == static_cast<int>(EntityType::BULLET) &&
+              NBODY_BLACK_HOLE == static_cast<int>(EntityType::BLACK_HOLE),
+              "nbody_body_type must match EntityType");
+
+/**
+ * @struct nbody_engine
+ * @brief Engine behind a C handle
+ */
+struct nbody_engine {
+    GameEngine engine;             ///< Simulation
+    SnapshotData snapshot;         ///< Snapshot scratch (capacity reused)
+    std::vector<uint8_t> state;    ///< Saved-state scratch (capacity reused)
+
+    /**
+     * @brief Construct with a generated world
+     * @param width World width
+     * @param height World height
+     * @param seed Random seed
+     */
+    nbody_engine(float width, float height, uint32_t seed) : engine(width, height, seed) {}
+};
+
+/// Message of the last failure on this thread
+static thread_local std::string lastError;
+
+/**
+ * @brief Record a failure
+ * @param status Status to return
+ * @param message Description
+ * @return status
+ */
+static int fail(int status, const std::string& message) {
+    lastError = message;
+    return status;
+}
+
+/**
+ * @brief Run an entry point body, turning exceptions into NBODY_ERROR_INTERNAL
+ * @param engine Handle (checked for null)
+ * @param body Callable returning a status or size
+ * @return Result of body, or a negative status
+ */
+template <typename Handle, typename Body>
+static auto guarded(Handle* engine, Body&& body) -> decltype(body()) {
+    if (!engine) return fail(NBODY_ERROR_ARGUMENT, "null engine handle");
+    try {
+        return body();
+    } catch (const std::exception& e) {
+        return fail(NBODY_ERROR_INTERNAL, e.what());
+    } catch (...) {
+        return fail(NBODY_ERROR_INTERNAL, "unknown exception");
+    }
+}
+
+extern "C" {
+
+int nbody_abi_version(void) {
+    return NBODY_ABI_VERSION;
+}
+
+const char* nbody_last_error(void) {
+    return lastError.c_str();
+}
+
+nbody_engine* nbody_create(float width, float height, uint32_t seed) {
+    if (!(width > 0) || !(height > 0)) {
+        fail(NBODY_ERROR_ARGUMENT, "world size must be positive");
+        return nullptr;
+    }
+    try {
+        return new nbody_engine(width, height, seed);
+    } catch (const std::exception& e) {
+        fail(NBODY_ERROR_INTERNAL, e.what());
+        return nullptr;
+    }
+}
+
+void nbody_destroy(nbody_engine* engine) {
+    delete engine;
+}
+
+int nbody_set_level(nbody_engine* engine, int level) {
+    return guarded(engine, [&] {
+        if (level < 0 || level > 4) return fail(NBODY_ERROR_ARGUMENT, "level must be 0-4");
+        engine->engine.setLevel(level);
+        return (int)NBODY_OK;
+    });
+}
+
+int nbody_set_mode(nbody_engine* engine, int mode) {
+    return guarded(engine, [&] {
+        if (mode < 0 || mode > 2) return fail(NBODY_ERROR_ARGUMENT, "mode must be 0-2");
+        engine->engine.setMode(static_cast<GameMode>(mode));
+        return (int)NBODY_OK;
+    });
+}
+
+int nbody_set_threads(nbody_engine* engine, int threads) {
+    return guarded(engine, [&] {
+        if (threads < 1) return fail(NBODY_ERROR_ARGUMENT, "threads must be >= 1");
+        engine->engine.setThreadCount(threads);
+        return (int)NBODY_OK;
+    });
+}
+
+int nbody_set_collisions(nbody_engine* engine, int enabled) {
+    return guarded(engine, [&] {
+        engine->engine.setCollisionsEnabled(enabled != 0);
+        return (int)NBODY_OK;
+    });
+}
+
+int nbody_set_black_hole_spawning(nbody_engine* engine, int enabled) {
+    return guarded(engine, [&] {
+        engine->engine.setBlackHolesEnabled(enabled != 0);
+        return (int)NBODY_OK;
+    });
+}
+
+int nbody_set_softening(nbody_engine* engine, int kernel) {
+    return guarded(engine, [&] {
+        if (kernel < 0 || kernel >= static_cast<int>(SofteningKernel::COUNT)) {
+            return fail(NBODY_ERROR_ARGUMENT, "kernel must be 0-2");
+        }
+        engine->engine.setSofteningKernel(static_cast<SofteningKernel>(kernel));
+        return (int)NBODY_OK;
+    });
+}
+
+int nbody_reset(nbody_engine* engine) {
+    return guarded(engine, [&] {
+        engine->engine.reset();
+        return (int)NBODY_OK;
+    });
+}
+
+int nbody_load_scenario(nbody_engine* engine, const char* kind, int count, uint32_t seed) {
+    return guarded(engine, [&] {
+        ScenarioParams params;
+        if (!kind || !parseScenarioKind(kind, params.kind)) {
+            return fail(NBODY_ERROR_ARGUMENT, std::string("unknown scenario '") + (kind ? kind : "") + "'");
+        }
+        if (count < 1) return fail(NBODY_ERROR_ARGUMENT, "count must be >= 1");
+        params.count = count;
+        params.seed = seed;
+        params.level = engine->engine.getLevel();
+
+        GameEngine& game = engine->engine;
+        Scenario scenario;
+        generateScenario(params, game.getWorldWidth(), game.getWorldHeight(), game.getPhysicsConfig().G, scenario);
+        game.setBlackHolesEnabled(false);
+        game.loadScenario(scenario);
+        return (int)NBODY_OK;
+    });
+}
+
+int nbody_load_bodies(nbody_engine* engine, const nbody_columns* bodies, size_t count, int level) {
+    return guarded(engine, [&] {
+        if (!bodies || (count > 0 && (!bodies->pos || !bodies->vel || !bodies->mass || !bodies->type ||
+                                      !bodies->radius))) {
+            return fail(NBODY_ERROR_ARGUMENT, "every column is required");
+        }
+        if (level < 0 || level > 4) return fail(NBODY_ERROR_ARGUMENT, "level must be 0-4");
+        GameEngine& game = engine->engine;
+        SnapshotView view;
+        view.count = count;
+        view.time = game.getTime();
+        view.worldWidth = game.getWorldWidth();
+        view.worldHeight = game.getWorldHeight();
+        view.level = level;
+        view.pos = reinterpret_cast<const Vec2*>(bodies->pos);
+        view.vel = reinterpret_cast<const Vec2*>(bodies->vel);
+        view.mass = bodies->mass;
+        view.type = bodies->type;
+        view.radius = bodies->radius;
+        game.loadSnapshot(view);
+        return (int)NBODY_OK;
+    });
+}
+
+/**
+ * @brief Add the profile of the step just taken to call totals
+ * @param game Engine
+ * @param sum Totals
+ */
+static void addStepStats(const GameEngine& game, nbody_step_stats& sum) {
+    const StepProfile& p = game.getStepProfile();
+    sum.steps++;
+    sum.total_seconds += p.totalSeconds;
+    sum.max_step_seconds = std::max(sum.max_step_seconds, p.totalSeconds);
+    sum.entity_seconds += p.entitySeconds;
+    sum.gravity_seconds += p.gravitySeconds;
+    sum.analysis_seconds += p.analysisSeconds;
+    sum.collision_seconds += p.collisionSeconds;
+    sum.cleanup_seconds += p.cleanupSeconds;
+    sum.interactions += p.interactions;
+}
+
+int nbody_step(nbody_engine* engine, int64_t steps, nbody_step_stats* stats) {
+    return guarded(engine, [&] {
+        if (steps < 0) return fail(NBODY_ERROR_ARGUMENT, "steps must be >= 0");
+        nbody_step_stats sum;
+        std::memset(&sum, 0, sizeof(sum));
+        GameEngine& game = engine->engine;
+        for (int64_t i = 0; i < steps; i++) {
+            game.step();
+            addStepStats(game, sum);
+        }
+        if (stats) *stats = sum;
+        return (int)NBODY_OK;
+    });
+}
+
+int nbody_set_adaptive_dt(nbody_engine* engine, int enabled, float eta) {
+    return guarded(engine, [&] {
+        if (!(eta > 0)) return fail(NBODY_ERROR_ARGUMENT, "eta must be positive");
+        TimestepConfig config;
+        config.enabled = enabled != 0;
+        config.eta = eta;
+        engine->engine.setTimestepConfig(config);
+        return (int)NBODY_OK;
+    });
+}
+
+int nbody_set_kepler_drift(nbody_engine* engine, int enabled, float dominance) {
+    return guarded(engine, [&] {
+        if (!(dominance > 0)) return fail(NBODY_ERROR_ARGUMENT, "dominance must be positive");
+        KeplerConfig config;
+        config.enabled = enabled != 0;
+        config.dominance = dominance;
+        engine->engine.setKeplerConfig(config);
+        return (int)NBODY_OK;
+    });
+}
+
+int nbody_set_compact_storage(nbody_engine* engine, int enabled) {
+    return guarded(engine, [&] {
+        engine->engine.setCompactStorage(enabled != 0);
+        return (int)NBODY_OK;
+    });
+}
+
+int nbody_set_profiles(nbody_engine* engine, int bins, float max_radius, int interval) {
+    return guarded(engine, [&] {
+        if (bins < 0 || bins > RadialProfiler::kMaxBins) return fail(NBODY_ERROR_ARGUMENT, "bins out of range");
+        if (!(max_radius >= 0) || interval < 1) return fail(NBODY_ERROR_ARGUMENT, "bad radius or interval");
+        ProfileConfig config;
+        config.enabled = bins > 0;
+        config.bins = std::max(bins, 1);
+        config.maxRadius = max_radius;
+        config.interval = interval;
+        engine->engine.setProfileConfig(config);
+        return (int)NBODY_OK;
+    });
+}
+
+int64_t nbody_get_profile(const nbody_engine* engine, float* out, size_t capacity) {
+    return guarded(engine, [&]() -> int64_t {
+        if (!out && capacity > 0) return fail(NBODY_ERROR_ARGUMENT, "null output");
+        const RadialProfiler& profiler = engine->engine.getProfiler();
+        size_t needed = (size_t)kProfileColumns * profiler.getBins();
+        if (needed > 0 && needed <= capacity) std::memcpy(out, profiler.getData(), needed * sizeof(float));
+        return (int64_t)needed;
+    });
+}
+
+int nbody_advance(nbody_engine* engine, double duration, nbody_step_stats* stats) {
+    return guarded(engine, [&] {
+        if (!(duration >= 0)) return fail(NBODY_ERROR_ARGUMENT, "duration must be >= 0");
+        nbody_step_stats sum;
+        std::memset(&sum, 0, sizeof(sum));
+        GameEngine& game = engine->engine;
+        double target = game.getTime() + duration;
+        int64_t before = game.getTimestepStats().steps;
+        bool reached = false;
+        while (!reached) {
+            reached = game.stepToward(target);
+            if (game.getTimestepStats().steps != before + sum.steps) addStepStats(game, sum);
+        }
+        if (stats) *stats = sum;
+        return (int)NBODY_OK;
+    });
+}
+
+double nbody_get_time(const nbody_engine* engine) {
+    return engine ? engine->engine.getTime() : 0.0;
+}
+
+int nbody_get_diagnostics(const nbody_engine* engine, nbody_diagnostics* out) {
+    return guarded(engine, [&] {
+        if (!out) return fail(NBODY_ERROR_ARGUMENT, "null output");
+        const EnergyDiagnostics& d = engine->engine.getDiagnostics();
+        out->kinetic = d.kinetic;
+        out->potential = d.potential;
+        out->external = d.external;
+        out->total = d.total;
+        out->momentum_x = d.momentumX;
+        out->momentum_y = d.momentumY;
+        out->angular_momentum = d.angularMomentum;
+        out->drift = d.drift;
+        out->body_count = d.bodyCount;
+        return (int)NBODY_OK;
+    });
+}
+
+int64_t nbody_snapshot(nbody_engine* engine, const nbody_columns* out, size_t capacity) {
+    return guarded(engine, [&]() -> int64_t {
+        if (!out) return fail(NBODY_ERROR_ARGUMENT, "null columns");
+        SnapshotData& s = engine->snapshot;
+        engine->engine.captureSnapshot(s);
+        size_t n = s.pos.size();
+        if (n <= capacity && n > 0) {
+            if (out->pos) std::memcpy(out->pos, s.pos.data(), n * sizeof(Vec2));
+            if (out->vel) std::memcpy(out->vel, s.vel.data(), n * sizeof(Vec2));
+            if (out->mass) std::memcpy(out->mass, s.mass.data(), n * sizeof(float));
+            if (out->type) std::memcpy(out->type, s.type.data(), n * sizeof(uint8_t));
+            if (out->radius) std::memcpy(out->radius, s.radius.data(), n * sizeof(float));
+        }
+        return (int64_t)n;
+    });
+}
+
+int64_t nbody_save_state(nbody_engine* engine, void* buffer, size_t capacity) {
+    return guarded(engine, [&]() -> int64_t {
+        if (!buffer && capacity > 0) return fail(NBODY_ERROR_ARGUMENT, "null buffer");
+        engine->engine.saveState(engine->state);
+        size_t n = engine->state.size();
+        if (n <= capacity) std::memcpy(buffer, engine->state.data(), n);
+        return (int64_t)n;
+    });
+}
+
+int nbody_load_state(nbody_engine* engine, const void* data, size_t size) {
+    return guarded(engine, [&] {
+        if (!data) return fail(NBODY_ERROR_ARGUMENT, "null state");
+        if (!engine->engine.loadState(static_cast<const uint8_t*>(data), size)) {
+            return fail(NBODY_ERROR_STATE, "state is from another build or world size, or malformed");
+        }
+        return (int)NBODY_OK;
+    });
+}
+
+} // extern "C"
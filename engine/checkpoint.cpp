@@ -0,0 +1,161 @@
+/**
+ * @file checkpoint.cpp
+ * @brief Atomic background checkpoint files (native build)
+ */
+
+#include "checkpoint.h"
+#include <chrono>
+#include <cstdio>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Seconds elapsed since a start time
+ * @param start Start time point
+ * @return Elapsed wall-clock seconds
+ */
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief 64-bit FNV-1a hash
+ * @param data Bytes
+ * @param size Byte count
+ * @return Hash
+ */
+static uint64_t fnv1a(const uint8_t* data, size_t size) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/**
+ * @brief Write a checkpoint to PATH.tmp, flush it to disk and rename it over PATH
+ * @param path Checkpoint path
+ * @param step Step counter
+ * @param state Engine state
+ * @return False on I/O error (the previous checkpoint is left intact)
+ */
+static bool writeCheckpointFile(const std::string& path, uint64_t step, const std::vector<uint8_t>& state) {
+    CheckpointHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kCheckpointMagic, sizeof(header.magic));
+    header.version = kCheckpointVersion;
+    header.step = step;
+    header.payloadBytes = state.size();
+    header.checksum = fnv1a(state.data(), state.size());
+
+    std::string temp = path + ".tmp";
+    FILE* file = std::fopen(temp.c_str(), "wb");
+    if (!file) return false;
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(state.data(), 1, state.size(), file) == state.size() &&
+              std::fflush(file) == 0 && ::fsync(fileno(file)) == 0;
+    ok = std::fclose(file) == 0 && ok;
+    ok = ok && std::rename(temp.c_str(), path.c_str()) == 0;
+    if (!ok) std::remove(temp.c_str());
+    return ok;
+}
+
+bool readCheckpoint(const std::string& path, uint64_t& step, std::vector<uint8_t>& state, std::string& error) {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        error = "cannot open " + path;
+        return false;
+    }
+    CheckpointHeader header;
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1 &&
+              std::memcmp(header.magic, kCheckpointMagic, sizeof(header.magic)) == 0 &&
+              header.version == kCheckpointVersion;
+    // The payload must fill the rest of the file exactly; a corrupt header
+    // must not turn into a huge allocation
+    struct stat info;
+    ok = ok && ::fstat(fileno(file), &info) == 0 && (uint64_t)info.st_size >= sizeof(header) &&
+         header.payloadBytes == (uint64_t)info.st_size - sizeof(header);
+    if (ok) {
+        state.resize((size_t)header.payloadBytes);
+        ok = std::fread(state.data(), 1, state.size(), file) == state.size() &&
+             fnv1a(state.data(), state.size()) == header.checksum;
+    }
+    std::fclose(file);
+    if (!ok) {
+        error = path + ": not a valid version " + std::to_string(kCheckpointVersion) + " checkpoint";
+        return false;
+    }
+    step = header.step;
+    return true;
+}
+
+Checkpointer::Checkpointer(const std::string& path)
+    : path(path), pendingStep(0), hasPending(false), stopping(false) {
+    writer = std::thread(&Checkpointer::writerLoop, this);
+}
+
+Checkpointer::~Checkpointer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    writer.join();
+}
+
+void Checkpointer::submit(uint64_t step, std::vector<uint8_t>& state) {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (hasPending) {
+            auto start = std::chrono::steady_clock::now();
+            changed.wait(lock, [&] { return !hasPending; });
+            stats.waitSeconds += secondsSince(start);
+        }
+        pending.swap(state);
+        pendingStep = step;
+        hasPending = true;
+    }
+    changed.notify_all();
+}
+
+void Checkpointer::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&] { return !hasPending; });
+}
+
+CheckpointStats Checkpointer::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void Checkpointer::writerLoop() {
+    for (;;) {
+        uint64_t step;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&] { return hasPending || stopping; });
+            if (!hasPending) return;
+            step = pendingStep;
+        }
+
+        // pending belongs to this thread until hasPending is cleared
+        auto start = std::chrono::steady_clock::now();
+        bool ok = writeCheckpointFile(path, step, pending);
+        double seconds = secondsSince(start);
+        if (!ok) std::fprintf(stderr, "cannot write checkpoint %s\n", path.c_str());
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            hasPending = false;
+            stats.writeSeconds += seconds;
+            if (ok) {
+                stats.written++;
+                stats.lastStep = step;
+                stats.lastBytes = sizeof(CheckpointHeader) + pending.size();
+            } else {
+                stats.failed = true;
+            }
+        }
+        changed.notify_all();
+    }
+}
@@ -0,0 +1,301 @@
+/**
+ * @file checkpoint.h
+ * @brief Full-state checkpoints for restartable runs
+ *
+ * A checkpoint holds everything that influences future steps: every
+ * entity (all fields), the gameplay, collision and force-monitor random
+ * streams, physics and difficulty configuration (including an adapted
+ * theta), inputs, wave, time and id counter. Restoring it into an engine
+ * created with the same world size continues the run bit for bit.
+ *
+ * State is serialised by GameEngine::saveState into memory with the
+ * CheckpointWriter / CheckpointReader helpers below (all builds). Entity
+ * structs are copied as raw bytes, so checkpoints are only portable
+ * between builds with the same layout; the state begins with the struct
+ * sizes and loading rejects a mismatch.
+ *
+ * File layout (native build, checkpoint.cpp):
+ *
+ *     CheckpointHeader (40 bytes), then payloadBytes of engine state
+ *
+ * Files are written to PATH.tmp, flushed to disk and renamed over PATH,
+ * so PATH always holds the last complete checkpoint.
+ */
+
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/// File magic (8 bytes including the terminator)
+constexpr char kCheckpointMagic[8] = "NBCKPT1";
+
+/// Current checkpoint format version
+constexpr uint32_t kCheckpointVersion = 1;
+
+/**
+ * @struct CheckpointHeader
+ * @brief Fixed 40-byte file header
+ */
+struct CheckpointHeader {
+    char magic[8];          ///< kCheckpointMagic
+    uint32_t version;       ///< kCheckpointVersion
+    uint32_t reserved;      ///< Zero
+    uint64_t step;          ///< Caller's step counter at the checkpoint
+    uint64_t payloadBytes;  ///< Engine state size
+    uint64_t checksum;      ///< FNV-1a of the engine state
+};
+static_assert(sizeof(CheckpointHeader) == 40, "checkpoint header must stay 40 bytes");
+
+/**
+ * @class CheckpointWriter
+ * @brief Appends state to a byte buffer
+ */
+class CheckpointWriter {
+public:
+    /**
+     * @brief Construct a writer appending to a buffer
+     * @param out Output bytes
+     */
+    explicit CheckpointWriter(std::vector<uint8_t>& out) : out(out) {}
+
+    /**
+     * @brief Append raw bytes
+     * @param data Bytes
+     * @param size Byte count
+     */
+    void putBytes(const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        out.insert(out.end(), bytes, bytes + size);
+    }
+
+    /**
+     * @brief Append a trivially copyable value
+     * @param value Value
+     */
+    template <typename T>
+    void put(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "checkpointed values must be trivially copyable");
+        putBytes(&value, sizeof(T));
+    }
+
+    /**
+     * @brief Append a vector of trivially copyable values (length-prefixed)
+     * @param values Values
+     */
+    template <typename T>
+    void putVector(const std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable<T>::value, "checkpointed values must be trivially copyable");
+        put((uint64_t)values.size());
+        putBytes(values.data(), values.size() * sizeof(T));
+    }
+
+    /**
+     * @brief Append a random engine's full state
+     * @param rng Engine
+     */
+    void putRng(const std::mt19937& rng) {
+        std::ostringstream text;
+        text << rng;
+        std::string state = text.str();
+        put((uint64_t)state.size());
+        putBytes(state.data(), state.size());
+    }
+
+private:
+    std::vector<uint8_t>& out;  ///< Output bytes
+};
+
+/**
+ * @class CheckpointReader
+ * @brief Reads state written by CheckpointWriter
+ *
+ * Reads past the end or malformed values set a sticky failure flag and
+ * leave the output untouched; check good() once after reading.
+ */
+class CheckpointReader {
+public:
+    /**
+     * @brief Construct a reader over a byte range
+     * @param data State bytes
+     * @param size Byte count
+     */
+    CheckpointReader(const uint8_t* data, size_t size) : cursor(data), end(data + size), ok(true) {}
+
+    /**
+     * @brief Read raw bytes
+     * @param data Output bytes
+     * @param size Byte count
+     */
+    void getBytes(void* data, size_t size) {
+        if (!ok || (size_t)(end - cursor) < size) {
+            ok = false;
+            return;
+        }
+        std::memcpy(data, cursor, size);
+        cursor += size;
+    }
+
+    /**
+     * @brief Read a trivially copyable value
+     * @param value Output value
+     */
+    template <typename T>
+    void get(T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "checkpointed values must be trivially copyable");
+        getBytes(&value, sizeof(T));
+    }
+
+    /**
+     * @brief Read a length-prefixed vector
+     * @param values Output values (resized)
+     */
+    template <typename T>
+    void getVector(std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable<T>::value, "checkpointed values must be trivially copyable");
+        uint64_t count = 0;
+        get(count);
+        if (!ok || count > (uint64_t)(end - cursor) / sizeof(T)) {
+            ok = false;
+            return;
+        }
+        values.resize((size_t)count);
+        getBytes(values.data(), values.size() * sizeof(T));
+    }
+
+    /**
+     * @brief Read a random engine's full state
+     * @param rng Output engine
+     */
+    void getRng(std::mt19937& rng) {
+        uint64_t length = 0;
+        get(length);
+        if (!ok || length > (uint64_t)(end - cursor)) {
+            ok = false;
+            return;
+        }
+        std::istringstream text(std::string(reinterpret_cast<const char*>(cursor), (size_t)length));
+        cursor += length;
+        std::mt19937 restored;
+        text >> restored;
+        if (text.fail()) ok = false;
+        else rng = restored;
+    }
+
+    /**
+     * @brief Mark the input as invalid (for semantic checks after reading)
+     */
+    void fail() { ok = false; }
+
+    /**
+     * @brief Whether every read so far succeeded
+     * @return False after any failed read
+     */
+    bool good() const { return ok; }
+
+    /**
+     * @brief Whether the whole input was consumed
+     * @return True at the end of the input
+     */
+    bool atEnd() const { return cursor == end; }
+
+private:
+    const uint8_t* cursor;  ///< Next byte
+    const uint8_t* end;     ///< End of input
+    bool ok;                ///< No read has failed
+};
+
+/**
+ * @brief Read and verify a checkpoint file (native build)
+ * @param path File path
+ * @param step Output step counter stored with the checkpoint
+ * @param state Output engine state
+ * @param error Output reason on failure
+ * @return False if the file is missing, truncated or fails its checksum
+ */
+bool readCheckpoint(const std::string& path, uint64_t& step, std::vector<uint8_t>& state, std::string& error);
+
+/**
+ * @struct CheckpointStats
+ * @brief Background checkpoint writer counters
+ */
+struct CheckpointStats {
+    int written;          ///< Checkpoints completed
+    uint64_t lastStep;    ///< Step of the last completed checkpoint
+    uint64_t lastBytes;   ///< Size of the last completed checkpoint
+    double writeSeconds;  ///< Writer time (write, flush, rename)
+    double waitSeconds;   ///< Caller time spent waiting for the previous write
+    bool failed;          ///< A write failed (see the stderr message)
+
+    /**
+     * @brief Default constructor - zero counters
+     */
+    CheckpointStats() : written(0), lastStep(0), lastBytes(0), writeSeconds(0), waitSeconds(0), failed(false) {}
+};
+
+/**
+ * @class Checkpointer
+ * @brief Writes checkpoints atomically on a background thread (native build)
+ *
+ * The caller serialises the engine into a buffer and hands it over with
+ * submit(); the buffer is swapped, not copied, and the caller continues
+ * stepping while the writer thread writes, flushes and renames the file.
+ * A submit while the previous write is still running waits for it.
+ */
+class Checkpointer {
+public:
+    /**
+     * @brief Start the writer thread
+     * @param path Checkpoint path (written via PATH.tmp)
+     */
+    explicit Checkpointer(const std::string& path);
+
+    /**
+     * @brief Finish the pending write and stop the thread
+     */
+    ~Checkpointer();
+
+    Checkpointer(const Checkpointer&) = delete;
+    Checkpointer& operator=(const Checkpointer&) = delete;
+
+    /**
+     * @brief Queue a checkpoint
+     * @param step Caller's step counter
+     * @param state Engine state (swapped with a spare buffer; contents unspecified on return)
+     */
+    void submit(uint64_t step, std::vector<uint8_t>& state);
+
+    /**
+     * @brief Wait until no write is pending
+     */
+    void flush();
+
+    /**
+     * @brief Get writer counters
+     * @return Statistics
+     */
+    CheckpointStats getStats() const;
+
+private:
+    std::string path;                  ///< Checkpoint path
+    std::thread writer;                ///< Background writer thread
+    mutable std::mutex mutex;          ///< Guards the pending slot and stats
+    std::condition_variable changed;   ///< Signalled on every state change
+    std::vector<uint8_t> pending;      ///< State waiting to be written
+    uint64_t pendingStep;              ///< Step of the pending state
+    bool hasPending;                   ///< A state is queued or being written
+    bool stopping;                     ///< Writer should exit once idle
+    CheckpointStats stats;             ///< Counters
+
+    /**
+     * @brief Writer thread main loop
+     */
+    void writerLoop();
+};
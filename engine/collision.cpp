@@ -14,6 +14,7 @@
  */
 
 #include "collision.h"
+#include "allocation.h"
 #include <cmath>
 #include <algorithm>
 
@@ -27,7 +28,8 @@
  * @param worldHeight Height of periodic domain
  */
 CollisionDetector::CollisionDetector(float worldWidth, float worldHeight)
-    : worldWidth(worldWidth), worldHeight(worldHeight) {}
+    : worldWidth(worldWidth), worldHeight(worldHeight), workerPool(nullptr),
+      gridWidth(1), gridHeight(1), cellWidth(worldWidth), cellHeight(worldHeight) {}
 
 /**
  * @brief Get nearest periodic image of a position relative to reference
@@ -61,6 +63,109 @@ bool CollisionDetector::checkCollision(Body* a, Body* b, float radiusA, float ra
     return dist2 < minDist * minDist;
 }
 
+bool CollisionDetector::checkAsteroidShapes(const Asteroid& a, const Asteroid& b) const {
+    Vec2 offset = minimumImage(b.pos - a.pos, worldWidth, worldHeight);
+    return polygonsOverlap(a.shape, a.rotation, a.radius, b.shape, b.rotation, b.radius, offset);
+}
+
+bool CollisionDetector::checkCircleAsteroid(const Body& body, float radius, const Asteroid& asteroid) const {
+    Vec2 offset = body.pos - asteroid.pos;
+    if (body.wraps) {
+        offset = minimumImage(offset, worldWidth, worldHeight);
+    }
+    return circlePolygonOverlap(asteroid.shape, asteroid.rotation, asteroid.radius, offset, radius);
+}
+
+void CollisionDetector::releaseScratch() {
+    std::vector<int>().swap(cellStart);
+    std::vector<int>().swap(cellItems);
+    std::vector<int>().swap(asteroidCell);
+    std::vector<int>().swap(cellCursor);
+    std::vector<std::vector<CollisionPair>>().swap(taskPairs);
+}
+
+void CollisionDetector::buildGrid(std::vector<Asteroid>& asteroids, float maxOtherRadius) {
+    // Cells must be at least as wide as the largest possible contact distance
+    float maxRadius = 0;
+    for (const auto& asteroid : asteroids) {
+        if (asteroid.active) maxRadius = std::max(maxRadius, asteroid.radius);
+    }
+    float minCell = std::max(2.0f * maxRadius, maxRadius + maxOtherRadius);
+    minCell = std::max(minCell, 1.0f);
+
+    gridWidth = std::max(1, std::min(1024, (int)(worldWidth / minCell)));
+    gridHeight = std::max(1, std::min(1024, (int)(worldHeight / minCell)));
+    cellWidth = worldWidth / gridWidth;
+    cellHeight = worldHeight / gridHeight;
+    int numCells = gridWidth * gridHeight;
+
+    // Counting sort of asteroid indices by cell (stable, so ascending within a cell)
+    cellStart.assign(numCells + 1, 0);
+    asteroidCell.resize(asteroids.size());
+    for (size_t i = 0; i < asteroids.size(); i++) {
+        if (!asteroids[i].active) {
+            asteroidCell[i] = -1;
+            continue;
+        }
+        int cell = cellOf(asteroids[i].pos);
+        asteroidCell[i] = cell;
+        cellStart[cell + 1]++;
+    }
+    for (int c = 0; c < numCells; c++) {
+        cellStart[c + 1] += cellStart[c];
+    }
+    cellItems.resize(cellStart[numCells]);
+    cellCursor.assign(cellStart.begin(), cellStart.end() - 1);
+    for (size_t i = 0; i < asteroids.size(); i++) {
+        if (asteroidCell[i] >= 0) {
+            cellItems[cellCursor[asteroidCell[i]]++] = (int)i;
+        }
+    }
+}
+
+int CollisionDetector::cellOf(const Vec2& pos) const {
+    int cx = (int)(pos.x / cellWidth);
+    int cy = (int)(pos.y / cellHeight);
+    cx = std::min(std::max(cx, 0), gridWidth - 1);
+    cy = std::min(std::max(cy, 0), gridHeight - 1);
+    return cy * gridWidth + cx;
+}
+
+int CollisionDetector::neighbourCells(int cell, int* outCells) const {
+    int cx = cell % gridWidth;
+    int cy = cell / gridWidth;
+    int count = 0;
+    for (int dy = -1; dy <= 1; dy++) {
+        int ny = (cy + dy + gridHeight) % gridHeight;
+        for (int dx = -1; dx <= 1; dx++) {
+            int nx = (cx + dx + gridWidth) % gridWidth;
+            outCells[count++] = ny * gridWidth + nx;
+        }
+    }
+    // Grids narrower than 3 cells wrap onto themselves; drop repeats
+    std::sort(outCells, outCells + count);
+    return (int)(std::unique(outCells, outCells + count) - outCells);
+}
+
+int CollisionDetector::taskCount(int items) {
+    // Below this size the hand-off costs more than the narrowphase itself
+    const int minItemsPerTask = 64;
+    int tasks = 1;
+    if (workerPool) {
+        tasks = std::min(workerPool->getThreadCount(), std::max(1, items / minItemsPerTask));
+    }
+    if ((int)taskPairs.size() < tasks) {
+        taskPairs.resize(tasks);
+    }
+    return tasks;
+}
+
+void CollisionDetector::mergeTaskPairs(int numTasks, std::vector<CollisionPair>& outCollisions) {
+    for (int t = 0; t < numTasks; t++) {
+        outCollisions.insert(outCollisions.end(), taskPairs[t].begin(), taskPairs[t].end());
+    }
+}
+
 void CollisionDetector::detectCollisions(
     std::vector<Ship>& ships,
     std::vector<Asteroid>& asteroids,
@@ -76,8 +181,9 @@ void CollisionDetector::detectCollisions(
         for (auto& asteroid : asteroids) {
             if (!asteroid.active) continue;
             float dist;
-            if (checkCollision(&ship, &asteroid, ship.radius, asteroid.radius, dist)) {
-                outCollisions.push_back({&ship, &asteroid, dist});
+            if (checkCollision(&ship, &asteroid, ship.radius, asteroid.radius, dist) &&
+                checkCircleAsteroid(ship, ship.radius, asteroid)) {
+                outCollisions.push_back({&ship, &asteroid, dist, CollisionKind::SHIP_ASTEROID});
             }
         }
     }
@@ -89,35 +195,85 @@ void CollisionDetector::detectCollisions(
             if (!ships[j].active) continue;
             float dist;
             if (checkCollision(&ships[i], &ships[j], ships[i].radius, ships[j].radius, dist)) {
-                outCollisions.push_back({&ships[i], &ships[j], dist});
+                outCollisions.push_back({&ships[i], &ships[j], dist, CollisionKind::SHIP_SHIP});
             }
         }
     }
 
-    // Asteroid-Asteroid collisions
-    for (size_t i = 0; i < asteroids.size(); i++) {
-        if (!asteroids[i].active) continue;
-        for (size_t j = i + 1; j < asteroids.size(); j++) {
-            if (!asteroids[j].active) continue;
-            float dist;
-            if (checkCollision(&asteroids[i], &asteroids[j],
-                             asteroids[i].radius, asteroids[j].radius, dist)) {
-                outCollisions.push_back({&asteroids[i], &asteroids[j], dist});
+    float maxBulletRadius = 0;
+    for (const auto& bullet : bullets) {
+        maxBulletRadius = std::max(maxBulletRadius, bullet.radius);
+    }
+    buildGrid(asteroids, maxBulletRadius);
+
+    // Asteroid-Asteroid collisions: each pair is found once, from the cell of its lower index
+    int numCells = gridWidth * gridHeight;
+    int numTasks = taskCount((int)asteroids.size());
+    auto asteroidTask = [&](int task) {
+        std::vector<CollisionPair>& out = taskPairs[task];
+        out.clear();
+        int cellBegin, cellEnd;
+        taskRange(numCells, numTasks, task, cellBegin, cellEnd);
+        int neighbours[9];
+        for (int cell = cellBegin; cell < cellEnd; cell++) {
+            int numNeighbours = neighbourCells(cell, neighbours);
+            for (int k = cellStart[cell]; k < cellStart[cell + 1]; k++) {
+                int i = cellItems[k];
+                for (int n = 0; n < numNeighbours; n++) {
+                    int other = neighbours[n];
+                    for (int m = cellStart[other]; m < cellStart[other + 1]; m++) {
+                        int j = cellItems[m];
+                        if (j <= i) continue;
+                        float dist;
+                        if (checkCollision(&asteroids[i], &asteroids[j],
+                                           asteroids[i].radius, asteroids[j].radius, dist) &&
+                            checkAsteroidShapes(asteroids[i], asteroids[j])) {
+                            out.push_back({&asteroids[i], &asteroids[j], dist,
+                                           CollisionKind::ASTEROID_ASTEROID});
+                        }
+                    }
+                }
             }
         }
+    };
+    if (workerPool) {
+        workerPool->run(numTasks, asteroidTask);
+    } else {
+        asteroidTask(0);
     }
+    mergeTaskPairs(numTasks, outCollisions);
 
     // Bullet-Asteroid collisions
-    for (auto& bullet : bullets) {
-        if (!bullet.active) continue;
-        for (auto& asteroid : asteroids) {
-            if (!asteroid.active) continue;
-            float dist;
-            if (checkCollision(&bullet, &asteroid, bullet.radius, asteroid.radius, dist)) {
-                outCollisions.push_back({&bullet, &asteroid, dist});
+    numTasks = taskCount((int)bullets.size());
+    auto bulletTask = [&](int task) {
+        std::vector<CollisionPair>& out = taskPairs[task];
+        out.clear();
+        int begin, end;
+        taskRange((int)bullets.size(), numTasks, task, begin, end);
+        int neighbours[9];
+        for (int b = begin; b < end; b++) {
+            Bullet& bullet = bullets[b];
+            if (!bullet.active) continue;
+            int numNeighbours = neighbourCells(cellOf(bullet.pos), neighbours);
+            for (int n = 0; n < numNeighbours; n++) {
+                int other = neighbours[n];
+                for (int m = cellStart[other]; m < cellStart[other + 1]; m++) {
+                    Asteroid& asteroid = asteroids[cellItems[m]];
+                    float dist;
+                    if (checkCollision(&bullet, &asteroid, bullet.radius, asteroid.radius, dist) &&
+                        checkCircleAsteroid(bullet, bullet.radius, asteroid)) {
+                        out.push_back({&bullet, &asteroid, dist, CollisionKind::BULLET_ASTEROID});
+                    }
+                }
             }
         }
+    };
+    if (workerPool) {
+        workerPool->run(numTasks, bulletTask);
+    } else {
+        bulletTask(0);
     }
+    mergeTaskPairs(numTasks, outCollisions);
 
     // Black hole accretion
     for (auto& bh : blackHoles) {
@@ -132,7 +288,7 @@ void CollisionDetector::detectCollisions(
             }
             float dist = dr.length();
             if (dist < bh.accretionRadius) {
-                outCollisions.push_back({&ship, &bh, dist});
+                outCollisions.push_back({&ship, &bh, dist, CollisionKind::ACCRETION});
             }
         }
 
@@ -145,7 +301,7 @@ void CollisionDetector::detectCollisions(
             }
             float dist = dr.length();
             if (dist < bh.accretionRadius) {
-                outCollisions.push_back({&asteroid, &bh, dist});
+                outCollisions.push_back({&asteroid, &bh, dist, CollisionKind::ACCRETION});
             }
         }
 
@@ -158,7 +314,7 @@ void CollisionDetector::detectCollisions(
             }
             float dist = dr.length();
             if (dist < bh.accretionRadius) {
-                outCollisions.push_back({&bullet, &bh, dist});
+                outCollisions.push_back({&bullet, &bh, dist, CollisionKind::ACCRETION});
             }
         }
     }
@@ -174,9 +330,9 @@ void CollisionDetector::detectCollisions(
  * @param worldHeight Height of simulation domain
  */
 CollisionHandler::CollisionHandler(float worldWidth, float worldHeight)
-    : worldWidth(worldWidth), worldHeight(worldHeight) {}
+    : worldWidth(worldWidth), worldHeight(worldHeight), rng(0), particlesEnabled(true) {}
 
-void CollisionHandler::handleShipAsteroid(Ship* ship, Asteroid* asteroid, std::vector<Particle>& particles) {
+void CollisionHandler::handleShipAsteroid(Ship* ship, Asteroid* asteroid, ParticlePool& particles) {
     // Calculate collision point (between ship and asteroid centers)
     Vec2 dr = minimumImage(asteroid->pos - ship->pos, worldWidth, worldHeight);
     float dist = dr.length();
@@ -334,7 +490,7 @@ void CollisionHandler::mergeBulletIntoAsteroid(Bullet* bullet, Asteroid* asteroi
     bullet->active = false;
 }
 
-void CollisionHandler::handleBulletAsteroid(Bullet* bullet, Asteroid* asteroid, std::vector<Particle>& particles, std::vector<Asteroid>& asteroids, int& nextId) {
+void CollisionHandler::handleBulletAsteroid(Bullet* bullet, Asteroid* asteroid, ParticlePool& particles, std::vector<Asteroid>& asteroids, int& nextId) {
     // Destroy bullet
     bullet->active = false;
 
@@ -345,7 +501,7 @@ void CollisionHandler::handleBulletAsteroid(Bullet* bullet, Asteroid* asteroid,
             Asteroid newAst;
 
             // Fragments fly in opposite directions
-            float baseAngle = (rand() % 360) * 3.14159f / 180.0f;
+            float baseAngle = (rng() % 360) * 3.14159f / 180.0f;
             float angle = baseAngle + i * 3.14159f;  // 180 degrees apart
 
             // Position offset - make them clearly separated
@@ -355,7 +511,7 @@ void CollisionHandler::handleBulletAsteroid(Bullet* bullet, Asteroid* asteroid,
             newPos = wrapPosition(newPos, worldWidth, worldHeight);
 
             // Velocity - fragments fly apart at high speed
-            float speed = 100.0f + (rand() % 100);  // Much faster separation
+            float speed = 100.0f + (rng() % 100);  // Much faster separation
             Vec2 separationVel(std::cos(angle) * speed, std::sin(angle) * speed);
             Vec2 newVel = asteroid->vel * 0.3f + separationVel;  // Less parent velocity, more separation
 
@@ -377,7 +533,7 @@ void CollisionHandler::handleBulletAsteroid(Bullet* bullet, Asteroid* asteroid,
     asteroid->active = false;
 }
 
-void CollisionHandler::handleBlackHoleAccretion(Body* body, BlackHole* blackHole, std::vector<Particle>& particles,
+void CollisionHandler::handleBlackHoleAccretion(Body* body, BlackHole* blackHole, ParticlePool& particles,
                                                 std::vector<Asteroid>& asteroids, int& nextId, float distance) {
     // Save original position before any modifications
     Vec2 accretionPos = body->pos;
@@ -418,7 +574,7 @@ void CollisionHandler::handleBlackHoleAccretion(Body* body, BlackHole* blackHole
             newPos = wrapPosition(newPos, worldWidth, worldHeight);
 
             // Velocity - fragment escapes away from black hole at high speed
-            float escapeSpeed = 150.0f + (rand() % 100);
+            float escapeSpeed = 150.0f + (rng() % 100);
             Vec2 escapeVel = awayDir * escapeSpeed;
             Vec2 newVel = asteroid->vel * 0.3f + escapeVel;
 
@@ -443,16 +599,17 @@ void CollisionHandler::handleBlackHoleAccretion(Body* body, BlackHole* blackHole
     }
 }
 
-void CollisionHandler::createExplosion(Vec2 pos, int count, std::vector<Particle>& particles, float speedMin, float speedMax, float lifetimeMultiplier, int playerId) {
+void CollisionHandler::createExplosion(Vec2 pos, int count, ParticlePool& particles, float speedMin, float speedMax, float lifetimeMultiplier, int playerId) {
+    MemoryScope scope(MemoryTag::PARTICLES);
     for (int i = 0; i < count; i++) {
         Particle p;
-        float angle = (rand() % 360) * 3.14159f / 180.0f;
+        float angle = (rng() % 360) * 3.14159f / 180.0f;
         float speedRange = speedMax - speedMin;
-        float speed = speedMin + (rand() % (int)(speedRange + 1));
+        float speed = speedMin + (rng() % (int)(speedRange + 1));
         Vec2 vel(std::cos(angle) * speed, std::sin(angle) * speed);
         p.init(pos, vel, playerId);
         p.maxLifetime *= lifetimeMultiplier;
         p.lifetime = p.maxLifetime;
-        particles.push_back(p);
+        if (particlesEnabled) particles.add(p);
     }
 }
@@ -9,31 +9,64 @@
  */
 
 #pragma once
+#include "checkpoint.h"
 #include "entity.h"
-#include "quadtree.h"
+#include "particles.h"
+#include "tree.h"
+#include "parallel.h"
+#include <random>
 #include <vector>
 
+/**
+ * @enum CollisionKind
+ * @brief Type pair of a detected collision, used to bucket and dispatch responses
+ *
+ * Values are ordered by the sequence in which batches are resolved each frame.
+ * COUNT is the number of kinds and sizes the dispatch table.
+ */
+enum class CollisionKind {
+    SHIP_ASTEROID,      ///< a = Ship, b = Asteroid
+    SHIP_SHIP,          ///< a = Ship, b = Ship
+    ASTEROID_ASTEROID,  ///< a = Asteroid, b = Asteroid
+    BULLET_ASTEROID,    ///< a = Bullet, b = Asteroid
+    ACCRETION,          ///< a = any body, b = BlackHole
+    COUNT
+};
+
 /**
  * @struct CollisionPair
  * @brief Records a detected collision between two bodies
  *
  * Used by CollisionDetector to pass collision information to
- * CollisionHandler for response processing.
+ * CollisionHandler for response processing. Pairs are always emitted in
+ * the orientation documented on CollisionKind, so responders never need
+ * to check which side is which.
  */
 struct CollisionPair {
-    Body* a;           ///< First colliding body
-    Body* b;           ///< Second colliding body
-    float distance;    ///< Distance between centers (should be < sum of radii)
+    Body* a;             ///< First colliding body
+    Body* b;             ///< Second colliding body
+    float distance;      ///< Distance between centers (should be < sum of radii)
+    CollisionKind kind;  ///< Type pair (fixes the roles of a and b)
 };
 
 /**
  * @class CollisionDetector
  * @brief Detects collisions between all entity types
  *
- * Uses brute-force O(N²) collision detection with periodic boundary
- * condition support via minimum image convention. Checks all pairs of
- * entities that can meaningfully collide (e.g., ships with asteroids,
- * bullets with asteroids, but not bullets with bullets).
+ * Asteroid contacts are tested in two stages: the circle test on the
+ * asteroid's radius rejects almost all pairs cheaply, and the polygon
+ * narrowphase (polygon.h) runs only for overlapping circles.
+ *
+ * Asteroid-asteroid and bullet-asteroid tests use a periodic uniform grid
+ * broadphase: asteroids are binned into cells at least one collision
+ * diameter wide, and only the 3x3 neighbourhood of a cell is tested. The
+ * rare pair types (ships, black holes) stay brute force. Periodic boundaries
+ * are handled via minimum image convention.
+ *
+ * With a WorkerPool attached, grid cells and bullets are split into
+ * contiguous ranges, one per task. Each task writes to its own pair buffer
+ * and the buffers are concatenated in task order, so the output is identical
+ * to a serial run for any thread count.
  */
 class CollisionDetector {
 public:
@@ -58,6 +91,8 @@ public:
      * - Bullet vs Asteroid
      * - Asteroid vs Asteroid
      * - All entities vs Black Hole accretion radius
+     *
+     * Each pair is tagged with its CollisionKind and oriented accordingly.
      */
     void detectCollisions(
         std::vector<Ship>& ships,
@@ -67,8 +102,67 @@ public:
         std::vector<CollisionPair>& outCollisions
     );
 
+    /**
+     * @brief Attach a worker pool for parallel narrowphase
+     * @param pool Pool to run tasks on (nullptr = serial)
+     */
+    void setWorkerPool(WorkerPool* pool) { workerPool = pool; }
+
+    /**
+     * @brief Free the broadphase grid and pair buffers (regrown on the next call)
+     */
+    void releaseScratch();
+
 private:
     float worldWidth, worldHeight;  ///< Domain size for periodic boundaries
+    WorkerPool* workerPool;         ///< Optional pool for parallel detection (not owned)
+
+    // Broadphase grid in compressed-row form (rebuilt every frame, storage reused)
+    int gridWidth, gridHeight;          ///< Number of cells along each axis
+    float cellWidth, cellHeight;        ///< Cell dimensions (>= largest collision diameter)
+    std::vector<int> cellStart;         ///< Offset of each cell's first entry in cellItems (size cells+1)
+    std::vector<int> cellItems;         ///< Asteroid indices ordered by cell, ascending within a cell
+    std::vector<int> asteroidCell;      ///< Cell index of each asteroid (-1 if inactive)
+    std::vector<int> cellCursor;        ///< Fill position per cell during binning
+    std::vector<std::vector<CollisionPair>> taskPairs;  ///< Per-task output buffers
+
+    /**
+     * @brief Bin active asteroids into the broadphase grid
+     * @param asteroids Asteroids to bin
+     * @param maxOtherRadius Largest radius of any body tested against asteroids
+     */
+    void buildGrid(std::vector<Asteroid>& asteroids, float maxOtherRadius);
+
+    /**
+     * @brief Get cell index containing a position
+     * @param pos Position in world coordinates
+     * @return Cell index in [0, gridWidth * gridHeight)
+     */
+    int cellOf(const Vec2& pos) const;
+
+    /**
+     * @brief List the distinct cells in the periodic 3x3 neighbourhood of a cell
+     * @param cell Centre cell index
+     * @param outCells Output array of at least 9 entries, sorted ascending
+     * @return Number of distinct neighbour cells (fewer than 9 on tiny grids)
+     */
+    int neighbourCells(int cell, int* outCells) const;
+
+    /**
+     * @brief Number of tasks to split a loop of the given size into
+     * @param items Number of loop items
+     * @return 1 when serial or too small to be worth splitting
+     *
+     * Also grows taskPairs so every task has a buffer.
+     */
+    int taskCount(int items);
+
+    /**
+     * @brief Concatenate per-task buffers into the output in task order
+     * @param numTasks Number of tasks used
+     * @param outCollisions Output vector to append to
+     */
+    void mergeTaskPairs(int numTasks, std::vector<CollisionPair>& outCollisions);
 
     /**
      * @brief Check if two bodies collide using minimum image distance
@@ -81,6 +175,23 @@ private:
      */
     bool checkCollision(Body* a, Body* b, float radiusA, float radiusB, float& outDistance);
 
+    /**
+     * @brief Polygon narrowphase for two asteroids whose circles overlap
+     * @param a First asteroid
+     * @param b Second asteroid
+     * @return True if the asteroid outlines overlap
+     */
+    bool checkAsteroidShapes(const Asteroid& a, const Asteroid& b) const;
+
+    /**
+     * @brief Polygon narrowphase for a circular body against an asteroid
+     * @param body Ship or bullet
+     * @param radius Collision radius of the body
+     * @param asteroid Asteroid whose circle overlaps the body
+     * @return True if the body's circle touches the asteroid outline
+     */
+    bool checkCircleAsteroid(const Body& body, float radius, const Asteroid& asteroid) const;
+
     /**
      * @brief Get nearest periodic image of a position
      * @param pos Position to adjust
@@ -115,6 +226,33 @@ public:
      */
     CollisionHandler(float worldWidth, float worldHeight);
 
+    /**
+     * @brief Reseed the handler's random stream (fragment and particle scatter)
+     * @param seed Stream seed; the engine derives it from the game seed
+     */
+    void setSeed(uint32_t seed) { rng.seed(seed); }
+
+    /**
+     * @brief Append the handler's random stream to a checkpoint
+     * @param out Checkpoint writer
+     */
+    void saveState(CheckpointWriter& out) const { out.putRng(rng); }
+
+    /**
+     * @brief Restore the random stream written by saveState
+     * @param in Checkpoint reader
+     */
+    void loadState(CheckpointReader& in) { in.getRng(rng); }
+
+    /**
+     * @brief Enable or suppress explosion particles
+     * @param enabled False to stop emitting (memory budget degradation)
+     *
+     * Suppressed explosions still draw their random numbers, so fragments
+     * and everything else in the run are unchanged.
+     */
+    void setParticlesEnabled(bool enabled) { particlesEnabled = enabled; }
+
     /**
      * @brief Handle ship colliding with asteroid
      * @param ship Ship that was hit
@@ -125,7 +263,7 @@ public:
      * respawns ship at center if lives remain, creates death explosion
      * if no lives remain. Explosion particles match ship color.
      */
-    void handleShipAsteroid(Ship* ship, Asteroid* asteroid, std::vector<Particle>& particles);
+    void handleShipAsteroid(Ship* ship, Asteroid* asteroid, ParticlePool& particles);
 
     /**
      * @brief Handle two ships colliding
@@ -161,7 +299,7 @@ public:
      * - Small (2): Destroyed completely
      * Bullet is consumed. Awards score to bullet owner.
      */
-    void handleBulletAsteroid(Bullet* bullet, Asteroid* asteroid, std::vector<Particle>& particles, std::vector<Asteroid>& asteroids, int& nextId);
+    void handleBulletAsteroid(Bullet* bullet, Asteroid* asteroid, ParticlePool& particles, std::vector<Asteroid>& asteroids, int& nextId);
 
     /**
      * @brief Handle black hole accreting an object
@@ -180,11 +318,13 @@ public:
      * Asteroids are "nibbled" by splitting them in half. One fragment is
      * immediately consumed, the other escapes away from the black hole.
      */
-    void handleBlackHoleAccretion(Body* body, BlackHole* blackHole, std::vector<Particle>& particles,
+    void handleBlackHoleAccretion(Body* body, BlackHole* blackHole, ParticlePool& particles,
                                   std::vector<Asteroid>& asteroids, int& nextId, float distance);
 
 private:
     float worldWidth, worldHeight;  ///< Domain size for respawn calculations
+    std::mt19937 rng;               ///< Per-game random stream (no shared global state between engines)
+    bool particlesEnabled;          ///< Explosions emit particles
 
     /**
      * @brief Merge two asteroids into one
@@ -220,5 +360,5 @@ private:
      * and directions. Used for ship deaths, asteroid destruction,
      * and black hole accretion effects.
      */
-    void createExplosion(Vec2 pos, int count, std::vector<Particle>& particles, float speedMin = 50.0f, float speedMax = 150.0f, float lifetimeMultiplier = 1.0f, int playerId = -1);
+    void createExplosion(Vec2 pos, int count, ParticlePool& particles, float speedMin = 50.0f, float speedMax = 150.0f, float lifetimeMultiplier = 1.0f, int playerId = -1);
 };
@@ -0,0 +1,87 @@
+/**
+ * @file diagnostics.cpp
+ * @brief Parallel reduction of conservation diagnostics
+ */
+
+#include "diagnostics.h"
+#include "entity.h"
+#include "potential.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @struct DiagnosticSums
+ * @brief Partial sums for one reduction task
+ */
+struct DiagnosticSums {
+    double kinetic = 0;
+    double potential = 0;
+    double external = 0;
+    double momentumX = 0;
+    double momentumY = 0;
+    double angularMomentum = 0;
+};
+
+void computeDiagnostics(const std::vector<Body*>& bodies, const std::vector<float>& treePotential,
+                        const IExternalPotential* external, const Vec2& centre,
+                        WorkerPool* pool, EnergyDiagnostics& diag) {
+    // Small enough sets are reduced serially; hand-off would dominate
+    const int minBodiesPerTask = 1024;
+    int count = (int)bodies.size();
+    int numTasks = 1;
+    if (pool) {
+        numTasks = std::min(pool->getThreadCount(), std::max(1, count / minBodiesPerTask));
+    }
+
+    std::vector<DiagnosticSums> partial(numTasks);
+    auto reduceTask = [&](int task) {
+        int begin, end;
+        taskRange(count, numTasks, task, begin, end);
+        DiagnosticSums sums;
+        for (int i = begin; i < end; i++) {
+            const Body* body = bodies[i];
+            double m = body->mass;
+            double vx = body->vel.x, vy = body->vel.y;
+            double rx = body->pos.x - centre.x, ry = body->pos.y - centre.y;
+            sums.kinetic += 0.5 * m * (vx * vx + vy * vy);
+            sums.potential += 0.5 * m * treePotential[i];  // each pair counted twice
+            if (external) sums.external += m * external->potentialAt(body->pos);
+            sums.momentumX += m * vx;
+            sums.momentumY += m * vy;
+            sums.angularMomentum += m * (rx * vy - ry * vx);
+        }
+        partial[task] = sums;
+    };
+    if (pool) {
+        pool->run(numTasks, reduceTask);
+    } else {
+        reduceTask(0);
+    }
+
+    // Combine in task order for thread-count independent totals
+    DiagnosticSums sums;
+    for (const auto& p : partial) {
+        sums.kinetic += p.kinetic;
+        sums.potential += p.potential;
+        sums.external += p.external;
+        sums.momentumX += p.momentumX;
+        sums.momentumY += p.momentumY;
+        sums.angularMomentum += p.angularMomentum;
+    }
+
+    diag.kinetic = sums.kinetic;
+    diag.potential = sums.potential;
+    diag.external = sums.external;
+    diag.total = sums.kinetic + sums.potential + sums.external;
+    diag.momentumX = sums.momentumX;
+    diag.momentumY = sums.momentumY;
+    diag.angularMomentum = sums.angularMomentum;
+    diag.bodyCount = count;
+
+    if (!diag.hasBaseline) {
+        diag.baselineTotal = diag.total;
+        diag.hasBaseline = true;
+    }
+    double scale = std::fabs(diag.baselineTotal);
+    diag.drift = scale > 0 ? (diag.total - diag.baselineTotal) / scale : 0.0;
+}
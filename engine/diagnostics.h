@@ -0,0 +1,63 @@
+/**
+ * @file diagnostics.h
+ * @brief Conservation diagnostics: energy, linear and angular momentum
+ *
+ * The mutual gravitational potential of every body comes for free from the
+ * Barnes-Hut walk of the closing half-kick (see QuadTree::calculateForce).
+ * Kinetic energy, momenta and the external potential energy are reduced in
+ * parallel over the same body list. Per-task partial sums are combined in
+ * task order, so the totals do not depend on the thread count.
+ *
+ * Drift is measured against a baseline captured on the first step after a
+ * reset (or on request). Gameplay events such as thrust, collisions,
+ * spawning and accretion inject or remove energy, so drift is only a
+ * measure of integration error in closed runs.
+ */
+
+#pragma once
+#include "vecn.h"
+#include "parallel.h"
+#include "potential.h"
+#include <vector>
+
+struct Body;
+
+/**
+ * @struct EnergyDiagnostics
+ * @brief Per-step conservation totals for all gravitating bodies
+ *
+ * Accumulated in double precision; particles are not included.
+ */
+struct EnergyDiagnostics {
+    double kinetic;          ///< Σ ½ m v²
+    double potential;        ///< Mutual gravitational energy ½ Σ m φ (tree approximation)
+    double external;         ///< Σ m Φ_ext(x) from the active IExternalPotential
+    double total;            ///< kinetic + potential + external
+    double momentumX;        ///< Σ m v_x
+    double momentumY;        ///< Σ m v_y
+    double angularMomentum;  ///< Σ m (r × v) about the potential centre (raw, unwrapped positions)
+    double baselineTotal;    ///< Total energy when the baseline was taken
+    double drift;            ///< Relative drift (total - baseline) / |baseline|
+    int bodyCount;           ///< Number of bodies included
+    bool hasBaseline;        ///< True once a baseline has been captured
+
+    /**
+     * @brief Default constructor - all totals zero, no baseline
+     */
+    EnergyDiagnostics()
+        : kinetic(0), potential(0), external(0), total(0), momentumX(0), momentumY(0),
+          angularMomentum(0), baselineTotal(0), drift(0), bodyCount(0), hasBaseline(false) {}
+};
+
+/**
+ * @brief Reduce conservation totals over a set of bodies
+ * @param bodies Gravitating bodies (velocities at the end of the step)
+ * @param treePotential Per-body tree potential φ_i, same order as bodies
+ * @param external External potential (nullptr for none)
+ * @param centre Reference point for angular momentum
+ * @param pool Worker pool for the reduction (nullptr = serial)
+ * @param diag Diagnostics to update; baseline is captured if not yet set
+ */
+void computeDiagnostics(const std::vector<Body*>& bodies, const std::vector<float>& treePotential,
+                        const IExternalPotential* external, const Vec2& centre,
+                        WorkerPool* pool, EnergyDiagnostics& diag);
@@ -0,0 +1,364 @@
+/**
+ * @file domain.cpp
+ * @brief Morton-range domain decomposition with locally essential trees
+ */
+
+#include "domain.h"
+#include "morton.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+/// Key buckets for cost histograms (top 16 bits of the 32-bit key)
+static constexpr int kCostBuckets = 1 << 16;
+
+/// One past the largest Morton key
+static constexpr uint64_t kKeyEnd = 1ULL << 32;
+
+/**
+ * @struct PackedBody
+ * @brief Body plus its measured cost, as sent during migration
+ */
+struct PackedBody {
+    Body body;   ///< Body state
+    float cost;  ///< Interactions at its last force evaluation
+};
+
+/**
+ * @struct PseudoBody
+ * @brief Exported tree node or body: a point mass
+ */
+struct PseudoBody {
+    float x, y;  ///< Centre of mass
+    float mass;  ///< Total mass
+};
+
+/**
+ * @struct DomainBox
+ * @brief Axis-aligned bounds of a rank's bodies
+ */
+struct DomainBox {
+    float minX, minY, maxX, maxY;  ///< Bounds (empty if minX > maxX)
+};
+
+/**
+ * @brief Append a trivially copyable array to a message
+ * @param buffer Message buffer
+ * @param items Items to append
+ */
+template <typename T>
+static void appendItems(MessageBuffer& buffer, const std::vector<T>& items) {
+    size_t offset = buffer.size();
+    buffer.resize(offset + items.size() * sizeof(T));
+    if (!items.empty()) std::memcpy(buffer.data() + offset, items.data(), items.size() * sizeof(T));
+}
+
+/**
+ * @brief Decode a message holding an array of T
+ * @param buffer Message buffer
+ * @param out Output items
+ */
+template <typename T>
+static void readItems(const MessageBuffer& buffer, std::vector<T>& out) {
+    out.resize(buffer.size() / sizeof(T));
+    if (!out.empty()) std::memcpy(out.data(), buffer.data(), out.size() * sizeof(T));
+}
+
+/**
+ * @brief Seconds elapsed since a start time
+ * @param start Start time
+ * @return Elapsed seconds
+ */
+static double elapsedSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Squared minimum-image distance from a point to a box
+ * @param p Point
+ * @param box Box
+ * @param worldWidth Domain width
+ * @param worldHeight Domain height
+ * @return Squared distance (0 if inside)
+ */
+static float boxDistanceSquared(const Vec2& p, const DomainBox& box, float worldWidth, float worldHeight) {
+    Vec2 centre((box.minX + box.maxX) * 0.5f, (box.minY + box.maxY) * 0.5f);
+    Vec2 d = minimumImage(p - centre, worldWidth, worldHeight);
+    float dx = std::max(std::fabs(d.x) - (box.maxX - box.minX) * 0.5f, 0.0f);
+    float dy = std::max(std::fabs(d.y) - (box.maxY - box.minY) * 0.5f, 0.0f);
+    return dx * dx + dy * dy;
+}
+
+/**
+ * @brief Collect the part of a tree a remote domain needs
+ * @param node Subtree root
+ * @param box Remote domain bounds
+ * @param theta Opening angle
+ * @param worldWidth Domain width
+ * @param worldHeight Domain height
+ * @param out Output pseudo-bodies
+ *
+ * A node is sent whole when it passes the opening criterion against the
+ * nearest point of the box, which implies it passes for every body there.
+ */
+static void exportEssential(const QuadTreeNode* node, const DomainBox& box, float theta,
+                            float worldWidth, float worldHeight, std::vector<PseudoBody>& out) {
+    if (node->totalMass == 0) return;
+
+    if (node->isLeaf) {
+        if (node->body) out.push_back({node->body->pos.x, node->body->pos.y, node->body->mass});
+        return;
+    }
+
+    float s = node->halfSize * 2.0f;
+    float d2 = boxDistanceSquared(node->centerOfMass, box, worldWidth, worldHeight);
+    if (s * s < theta * theta * d2) {
+        out.push_back({node->centerOfMass.x, node->centerOfMass.y, node->totalMass});
+        return;
+    }
+    for (int i = 0; i < QuadTreeNode::kChildren; i++) {
+        if (node->children[i]) exportEssential(node->children[i].get(), box, theta, worldWidth, worldHeight, out);
+    }
+}
+
+DomainSimulation::DomainSimulation(ITransport& transport, const DomainParams& params)
+    : transport(transport), params(params), tree(Vec2(params.worldWidth, params.worldHeight)),
+      stepCount(0), forcesValid(false) {}
+
+void DomainSimulation::initialize(const std::vector<Body>& allBodies) {
+    // Unit cost per body until forces have been measured; every rank sees
+    // the same bodies, so the splitters agree without communication
+    std::vector<double> histogram(kCostBuckets, 0.0);
+    for (const Body& b : allBodies) {
+        histogram[mortonKey(b.pos, params.worldWidth, params.worldHeight) >> 16] += 1.0;
+    }
+    computeSplitters(histogram);
+
+    bodies.clear();
+    int me = transport.rank();
+    for (const Body& b : allBodies) {
+        if (ownerOf(mortonKey(b.pos, params.worldWidth, params.worldHeight)) == me) bodies.push_back(b);
+    }
+    cost.assign(bodies.size(), 1.0f);
+    stepCount = 0;
+    forcesValid = false;
+}
+
+void DomainSimulation::computeSplitters(const std::vector<double>& histogram) {
+    int numRanks = transport.size();
+    double total = 0;
+    for (double c : histogram) total += c;
+
+    splitters.assign(numRanks + 1, kKeyEnd);
+    splitters[0] = 0;
+    double cumulative = 0;
+    int next = 1;
+    for (int bucket = 0; bucket < kCostBuckets && next < numRanks; bucket++) {
+        // Splitter k goes at the first bucket boundary where the prefix
+        // cost reaches k/P of the total
+        while (next < numRanks && cumulative >= total * next / numRanks) {
+            splitters[next++] = (uint64_t)bucket << 16;
+        }
+        cumulative += histogram[bucket];
+    }
+}
+
+int DomainSimulation::ownerOf(uint32_t key) const {
+    auto it = std::upper_bound(splitters.begin(), splitters.end(), (uint64_t)key);
+    return std::min((int)(it - splitters.begin()) - 1, transport.size() - 1);
+}
+
+void DomainSimulation::migrate() {
+    int numRanks = transport.size();
+    int me = transport.rank();
+    std::vector<std::vector<PackedBody>> leaving(numRanks);
+
+    size_t kept = 0;
+    for (size_t i = 0; i < bodies.size(); i++) {
+        int owner = ownerOf(mortonKey(bodies[i].pos, params.worldWidth, params.worldHeight));
+        if (owner == me) {
+            bodies[kept] = bodies[i];
+            cost[kept] = cost[i];
+            kept++;
+        } else {
+            leaving[owner].push_back({bodies[i], cost[i]});
+        }
+    }
+    bodies.resize(kept);
+    cost.resize(kept);
+
+    std::vector<MessageBuffer> outgoing(numRanks), incoming;
+    for (int r = 0; r < numRanks; r++) appendItems(outgoing[r], leaving[r]);
+    transport.exchange(outgoing, incoming);
+
+    // Append arrivals in rank order so the layout is deterministic
+    std::vector<PackedBody> arrived;
+    for (int r = 0; r < numRanks; r++) {
+        if (r == me) continue;
+        readItems(incoming[r], arrived);
+        for (const PackedBody& p : arrived) {
+            bodies.push_back(p.body);
+            cost.push_back(p.cost);
+        }
+    }
+    forcesValid = false;
+}
+
+void DomainSimulation::rebalance() {
+    std::vector<float> local(kCostBuckets, 0.0f);
+    for (size_t i = 0; i < bodies.size(); i++) {
+        local[mortonKey(bodies[i].pos, params.worldWidth, params.worldHeight) >> 16] += std::max(cost[i], 1.0f);
+    }
+
+    MessageBuffer mine;
+    appendItems(mine, local);
+    std::vector<MessageBuffer> all;
+    transport.allGather(mine, all);
+
+    // Sum in rank order: identical floating-point result on every rank
+    std::vector<double> histogram(kCostBuckets, 0.0);
+    std::vector<float> remote;
+    for (const MessageBuffer& buffer : all) {
+        readItems(buffer, remote);
+        for (int b = 0; b < kCostBuckets; b++) histogram[b] += remote[b];
+    }
+    computeSplitters(histogram);
+    migrate();
+}
+
+void DomainSimulation::computeForces() {
+    int numRanks = transport.size();
+    int me = transport.rank();
+
+    // Local tree first: it is both exported and extended for local forces
+    auto buildStart = std::chrono::steady_clock::now();
+    treeBodies.clear();
+    for (Body& b : bodies) treeBodies.push_back(&b);
+    tree.build(treeBodies);
+    stats.forceSeconds += elapsedSince(buildStart);
+
+    auto exchangeStart = std::chrono::steady_clock::now();
+    DomainBox myBox = {1e30f, 1e30f, -1e30f, -1e30f};
+    for (const Body& b : bodies) {
+        myBox.minX = std::min(myBox.minX, b.pos.x);
+        myBox.minY = std::min(myBox.minY, b.pos.y);
+        myBox.maxX = std::max(myBox.maxX, b.pos.x);
+        myBox.maxY = std::max(myBox.maxY, b.pos.y);
+    }
+    MessageBuffer boxMessage;
+    appendItems(boxMessage, std::vector<DomainBox>(1, myBox));
+    std::vector<MessageBuffer> boxMessages;
+    transport.allGather(boxMessage, boxMessages);
+
+    std::vector<MessageBuffer> outgoing(numRanks), incoming;
+    std::vector<PseudoBody> essential;
+    std::vector<DomainBox> remoteBox;
+    for (int r = 0; r < numRanks; r++) {
+        if (r == me) continue;
+        readItems(boxMessages[r], remoteBox);
+        if (remoteBox.empty() || remoteBox[0].minX > remoteBox[0].maxX) continue;
+        essential.clear();
+        exportEssential(tree.getRoot(), remoteBox[0], params.theta,
+                        params.worldWidth, params.worldHeight, essential);
+        appendItems(outgoing[r], essential);
+    }
+    transport.exchange(outgoing, incoming);
+
+    imported.clear();
+    for (int r = 0; r < numRanks; r++) {
+        if (r == me) continue;
+        readItems(incoming[r], essential);
+        for (const PseudoBody& p : essential) {
+            Body ghost;
+            ghost.pos = Vec2(p.x, p.y);
+            ghost.mass = p.mass;
+            ghost.id = -1;
+            imported.push_back(ghost);
+        }
+    }
+    stats.exchangeSeconds += elapsedSince(exchangeStart);
+
+    auto forceStart = std::chrono::steady_clock::now();
+    if (!imported.empty()) {
+        for (Body& ghost : imported) treeBodies.push_back(&ghost);
+        tree.build(treeBodies);
+    }
+
+    long long interactions = 0;
+    for (size_t i = 0; i < bodies.size(); i++) {
+        ForceResult force = tree.calculateForce(bodies[i].pos, bodies[i].mass,
+                                                params.theta, params.epsilon, params.G);
+        bodies[i].acc = force.acc;
+        cost[i] = (float)force.interactions;
+        interactions += force.interactions;
+    }
+    stats.forceSeconds += elapsedSince(forceStart);
+    stats.importedBodies = (int)imported.size();
+    stats.interactions = interactions;
+    forcesValid = true;
+}
+
+void DomainSimulation::step() {
+    auto stepStart = std::chrono::steady_clock::now();
+    stats = DomainStepStats();
+    float halfDt = params.dt * 0.5f;
+
+    if (!forcesValid) computeForces();
+
+    for (Body& b : bodies) {
+        b.vel += b.acc * halfDt;
+        b.pos = wrapPosition(b.pos + b.vel * params.dt, params.worldWidth, params.worldHeight);
+    }
+
+    auto exchangeStart = std::chrono::steady_clock::now();
+    stepCount++;
+    if (params.rebalanceInterval > 0 && stepCount % params.rebalanceInterval == 0) {
+        rebalance();
+    } else {
+        migrate();
+    }
+    stats.exchangeSeconds += elapsedSince(exchangeStart);
+
+    computeForces();
+    for (Body& b : bodies) b.vel += b.acc * halfDt;
+
+    stats.localBodies = (int)bodies.size();
+    stats.stepSeconds = elapsedSince(stepStart);
+}
+
+void DomainSimulation::gatherStats(std::vector<DomainStepStats>& out) {
+    MessageBuffer mine;
+    appendItems(mine, std::vector<DomainStepStats>(1, stats));
+    std::vector<MessageBuffer> all;
+    transport.allGather(mine, all);
+
+    out.resize(all.size());
+    std::vector<DomainStepStats> one;
+    for (size_t r = 0; r < all.size(); r++) {
+        readItems(all[r], one);
+        out[r] = one.empty() ? DomainStepStats() : one[0];
+    }
+}
+
+void DomainSimulation::globalTotals(double& outKinetic, Vec2& outMomentum) {
+    double local[3] = {0, 0, 0};
+    for (const Body& b : bodies) {
+        local[0] += 0.5 * b.mass * ((double)b.vel.x * b.vel.x + (double)b.vel.y * b.vel.y);
+        local[1] += (double)b.mass * b.vel.x;
+        local[2] += (double)b.mass * b.vel.y;
+    }
+    MessageBuffer mine;
+    appendItems(mine, std::vector<double>(local, local + 3));
+    std::vector<MessageBuffer> all;
+    transport.allGather(mine, all);
+
+    double total[3] = {0, 0, 0};
+    std::vector<double> remote;
+    for (const MessageBuffer& buffer : all) {
+        readItems(buffer, remote);
+        for (int k = 0; k < 3 && k < (int)remote.size(); k++) total[k] += remote[k];
+    }
+    outKinetic = total[0];
+    outMomentum = Vec2((float)total[1], (float)total[2]);
+}
@@ -0,0 +1,167 @@
+/**
+ * @file domain.h
+ * @brief Distributed N-body simulation over spatial domains in several processes
+ *
+ * For offline research runs too large for one process. The periodic world
+ * is cut into contiguous ranges of Morton keys, one per rank, balanced by
+ * the measured cost (tree interactions) of the bodies inside. Each rank
+ * integrates only its own bodies with the same kick-drift-kick leapfrog
+ * and softened Barnes-Hut gravity as GameEngine (gameplay, collisions and
+ * external potentials are not part of research runs).
+ *
+ * Forces use locally essential trees: every rank walks its own tree
+ * against each remote domain's bounding box and sends the remote rank the
+ * coarsest set of nodes that pass the opening criterion for *every* point
+ * in that box, plus the individual bodies of cells that do not. The
+ * receiver inserts these pseudo-bodies into its local tree, so all of the
+ * remote mass is represented at sufficient accuracy.
+ *
+ * After each drift, bodies that left a domain migrate to their new owner.
+ * Every rebalanceInterval steps the ranks exchange per-key-bucket cost
+ * histograms and recompute the key splitters. Every rank computes the same
+ * splitters from the same data, so no coordinator is needed.
+ *
+ * Native build only; see transport.h.
+ */
+
+#pragma once
+#include "entity.h"
+#include "transport.h"
+#include "tree.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @struct DomainParams
+ * @brief Physics and decomposition parameters for a distributed run
+ */
+struct DomainParams {
+    float worldWidth;       ///< Periodic domain width
+    float worldHeight;      ///< Periodic domain height
+    float G;                ///< Gravitational constant
+    float epsilon;          ///< Softening length
+    float theta;            ///< Barnes-Hut opening angle
+    float dt;               ///< Fixed timestep
+    int rebalanceInterval;  ///< Steps between cost-based repartitioning
+
+    /**
+     * @brief Default constructor matching PhysicsConfig defaults
+     */
+    DomainParams()
+        : worldWidth(1600.0f), worldHeight(1200.0f), G(100.0f), epsilon(5.0f), theta(0.5f),
+          dt(1.0f / 120.0f), rebalanceInterval(10) {}
+};
+
+/**
+ * @struct DomainStepStats
+ * @brief Timing and work counters for the last step on one rank
+ */
+struct DomainStepStats {
+    double stepSeconds;      ///< Wall time of the whole step
+    double forceSeconds;     ///< Tree build and force evaluation
+    double exchangeSeconds;  ///< Ghost export, migration and rebalance communication
+    int localBodies;         ///< Bodies owned after the step
+    int importedBodies;      ///< Pseudo-bodies received from other ranks
+    long long interactions;  ///< Tree interactions evaluated for local bodies
+
+    /**
+     * @brief Default constructor - zero counters
+     */
+    DomainStepStats()
+        : stepSeconds(0), forceSeconds(0), exchangeSeconds(0), localBodies(0),
+          importedBodies(0), interactions(0) {}
+};
+
+/**
+ * @class DomainSimulation
+ * @brief One rank's share of a distributed N-body run
+ *
+ * All public methods except accessors are collective: every rank must call
+ * them in the same order.
+ */
+class DomainSimulation {
+public:
+    /**
+     * @brief Create a rank's simulation
+     * @param transport Connection to the other ranks
+     * @param params Physics and decomposition parameters
+     */
+    DomainSimulation(ITransport& transport, const DomainParams& params);
+
+    /**
+     * @brief Decompose the initial conditions and keep this rank's bodies
+     * @param allBodies Full body set (identical on every rank)
+     */
+    void initialize(const std::vector<Body>& allBodies);
+
+    /**
+     * @brief Advance all domains by one leapfrog step
+     */
+    void step();
+
+    /**
+     * @brief Get bodies currently owned by this rank
+     * @return Local bodies
+     */
+    const std::vector<Body>& getBodies() const { return bodies; }
+
+    /**
+     * @brief Get this rank's counters for the last step
+     * @return Step statistics
+     */
+    const DomainStepStats& getStats() const { return stats; }
+
+    /**
+     * @brief Gather every rank's step statistics
+     * @param out Output statistics indexed by rank
+     */
+    void gatherStats(std::vector<DomainStepStats>& out);
+
+    /**
+     * @brief Global kinetic energy and momentum
+     * @param outKinetic Output: Σ ½ m v² over all ranks
+     * @param outMomentum Output: Σ m v over all ranks
+     */
+    void globalTotals(double& outKinetic, Vec2& outMomentum);
+
+private:
+    ITransport& transport;             ///< Message transport
+    DomainParams params;               ///< Physics parameters
+    std::vector<Body> bodies;          ///< Bodies owned by this rank
+    std::vector<float> cost;           ///< Interaction count of each local body at its last force evaluation
+    std::vector<uint64_t> splitters;   ///< Rank r owns keys in [splitters[r], splitters[r+1])
+    std::vector<Body> imported;        ///< Pseudo-bodies from other ranks' locally essential trees
+    std::vector<Body*> treeBodies;     ///< Local and imported bodies for the tree build
+    QuadTree tree;                     ///< Tree over local and imported bodies
+    DomainStepStats stats;             ///< Counters for the last step
+    int stepCount;                     ///< Steps taken
+    bool forcesValid;                  ///< True once accelerations match current positions
+
+    /**
+     * @brief Compute splitters from a per-bucket cost histogram
+     * @param histogram Cost per key bucket (top 16 key bits)
+     */
+    void computeSplitters(const std::vector<double>& histogram);
+
+    /**
+     * @brief Rank owning a Morton key
+     * @param key Morton key
+     * @return Owner rank
+     */
+    int ownerOf(uint32_t key) const;
+
+    /**
+     * @brief Send bodies outside this rank's key range to their owners
+     */
+    void migrate();
+
+    /**
+     * @brief Re-split key ranges by measured cost, then migrate
+     */
+    void rebalance();
+
+    /**
+     * @brief Exchange locally essential trees and evaluate local accelerations
+     */
+    void computeForces();
+};
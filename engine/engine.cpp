@@ -1,18 +1,33 @@
 #include "engine.h"
 #include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstring>
+#include <limits>
 
-GameEngine::GameEngine(float width, float height, uint32_t gameSeed)
+/**
+ * @brief Seconds elapsed since a start time
+ * @param start Start time point
+ * @return Elapsed wall-clock seconds
+ */
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+GameEngine::GameEngine(float width, float height, uint32_t gameSeed, bool deferWorld)
     : worldWidth(width), worldHeight(height), time(0), wave(1),
       seed(gameSeed), rng(gameSeed), mode(GameMode::SOLO),
-      currentLevel(0), nextEntityId(0) {
+      currentLevel(0), nextEntityId(0), collisionsEnabled(true), worldPending(true),
+      accuracyMonitor(gameSeed ^ 0x5bd1e995U), configuredTheta(physics.theta), stepDt(0),
+      stepLimit(std::numeric_limits<double>::infinity()), stepSynced(false),
+      memoryBudgets{}, overBudgetSteps{}, memoryPressure(0) {
 
-    quadtree = std::make_unique<QuadTree>(width, height);
-    collisionDetector = std::make_unique<CollisionDetector>(width, height);
+    MemoryScope scope(MemoryTag::ENGINE);
+    workerPool = std::make_unique<WorkerPool>(1);
     collisionHandler = std::make_unique<CollisionHandler>(width, height);
-    potential = createPotential(0, Vec2(width * 0.5f, height * 0.5f), width);
+    potential = createPotential(0, Vec2(width * 0.5f, height * 0.5f), width, physics.softening);
 
-    reset();
+    if (!deferWorld) reset();
 }
 
 GameEngine::~GameEngine() = default;
@@ -24,7 +39,14 @@ void GameEngine::setMode(GameMode newMode) {
 
 void GameEngine::setLevel(int levelId) {
     currentLevel = levelId;
-    potential = createPotential(levelId, Vec2(worldWidth * 0.5f, worldHeight * 0.5f), worldWidth);
+    potential = createPotential(levelId, Vec2(worldWidth * 0.5f, worldHeight * 0.5f), worldWidth, physics.softening);
+    resetDiagnosticsBaseline();
+}
+
+void GameEngine::setSofteningKernel(SofteningKernel kind) {
+    physics.softening = kind;
+    // The point-mass level softens with the same kernel as body-body gravity
+    potential = createPotential(currentLevel, Vec2(worldWidth * 0.5f, worldHeight * 0.5f), worldWidth, kind);
 }
 
 void GameEngine::setDifficulty(const DifficultyConfig& config) {
@@ -60,6 +82,290 @@ void GameEngine::setAsteroidBaseMass(float mass) {
     }
 }
 
+void GameEngine::setThreadCount(int numThreads) {
+    workerPool->setThreadCount(numThreads);
+}
+
+void GameEngine::loadScenario(const Scenario& scenario) {
+    MemoryScope scope(MemoryTag::ENTITIES);
+    ensureWorld();  // ships are kept
+    setLevel(scenario.level);
+
+    asteroids.clear();
+    bullets.clear();
+    blackHoles.clear();
+    particles.clear();
+    asteroids.reserve(scenario.bodies.size());
+
+    for (const ScenarioBody& body : scenario.bodies) {
+        if (body.blackHole) {
+            BlackHole bh;
+            bh.init(nextEntityId++, body.pos, body.vel, body.mass, difficulty.bhAccRadius);
+            bh.wraps = true;  // stays in the system instead of leaving the screen
+            blackHoles.push_back(bh);
+        } else {
+            Asteroid asteroid;
+            asteroid.init(nextEntityId++, body.pos, body.vel, 5);
+            asteroid.mass = body.mass;
+            asteroids.push_back(asteroid);
+        }
+    }
+    resetDiagnosticsBaseline();
+    timestep.invalidate();
+}
+
+void GameEngine::captureSnapshot(SnapshotData& out) const {
+    out.clear();
+    out.step = (uint64_t)std::lround(time / physics.dt);
+    out.time = time;
+    out.worldWidth = worldWidth;
+    out.worldHeight = worldHeight;
+    out.level = currentLevel;
+
+    uint8_t shipType = static_cast<uint8_t>(EntityType::SHIP);
+    uint8_t asteroidType = static_cast<uint8_t>(EntityType::ASTEROID);
+    uint8_t bulletType = static_cast<uint8_t>(EntityType::BULLET);
+    uint8_t blackHoleType = static_cast<uint8_t>(EntityType::BLACK_HOLE);
+    for (const auto& ship : ships) {
+        if (ship.active) out.add(ship.pos, ship.vel, ship.mass, shipType, ship.radius);
+    }
+    for (const auto& asteroid : asteroids) {
+        if (asteroid.active) out.add(asteroid.pos, asteroid.vel, asteroid.mass, asteroidType, asteroid.radius);
+    }
+    for (const auto& bullet : bullets) {
+        if (bullet.active) out.add(bullet.pos, bullet.vel, bullet.mass, bulletType, bullet.radius);
+    }
+    for (const auto& bh : blackHoles) {
+        if (bh.active) out.add(bh.pos, bh.vel, bh.mass, blackHoleType, bh.accretionRadius);
+    }
+}
+
+/**
+ * @brief Append one body to a trajectory frame
+ * @param out Frame (pre-sized)
+ * @param index Record index (advanced)
+ * @param entity Body
+ */
+template <typename T>
+static void addTrajectoryRecord(TrajectoryFrame& out, size_t& index, const T& entity) {
+    out.id[index] = entity.id;
+    out.px[index] = entity.pos.x;
+    out.py[index] = entity.pos.y;
+    out.vx[index] = entity.vel.x;
+    out.vy[index] = entity.vel.y;
+    index++;
+}
+
+void GameEngine::captureTrajectory(TrajectoryFrame& out) const {
+    out.step = (uint64_t)std::lround(time / physics.dt);
+    out.time = time;
+
+    size_t count = 0;
+    for (const auto& ship : ships) count += ship.active;
+    for (const auto& asteroid : asteroids) count += asteroid.active;
+    for (const auto& bullet : bullets) count += bullet.active;
+    for (const auto& bh : blackHoles) count += bh.active;
+    out.resize(count);
+
+    size_t index = 0;
+    for (const auto& ship : ships) {
+        if (ship.active) addTrajectoryRecord(out, index, ship);
+    }
+    for (const auto& asteroid : asteroids) {
+        if (asteroid.active) addTrajectoryRecord(out, index, asteroid);
+    }
+    for (const auto& bullet : bullets) {
+        if (bullet.active) addTrajectoryRecord(out, index, bullet);
+    }
+    for (const auto& bh : blackHoles) {
+        if (bh.active) addTrajectoryRecord(out, index, bh);
+    }
+}
+
+/**
+ * @brief Asteroid size class whose default radius is nearest a given radius
+ * @param radius Asteroid radius
+ * @return Size class 0-5
+ */
+static int asteroidSizeForRadius(float radius) {
+    static const float classRadius[6] = {40.0f, 25.0f, 15.0f, 10.0f, 6.0f, 3.0f};
+    int best = 0;
+    for (int s = 1; s < 6; s++) {
+        if (std::fabs(classRadius[s] - radius) < std::fabs(classRadius[best] - radius)) best = s;
+    }
+    return best;
+}
+
+bool GameEngine::loadSnapshot(const SnapshotView& view) {
+    // Positions only make sense on the torus they were saved on
+    if (view.worldWidth != worldWidth || view.worldHeight != worldHeight) return false;
+
+    MemoryScope scope(MemoryTag::ENTITIES);
+    ensureWorld();  // snapshot ships are matched to existing ones
+    setLevel(view.level);
+    time = (float)view.time;
+    timestep.invalidate();
+
+    asteroids.clear();
+    bullets.clear();
+    blackHoles.clear();
+    particles.clear();
+
+    // Asteroids dominate large snapshots and their outlines cost a few
+    // trig calls each, so they are initialised in parallel with ids in
+    // file order; the few other entities follow serially
+    std::vector<uint32_t> asteroidRecords;
+    for (size_t i = 0; i < view.count; i++) {
+        if (view.type[i] == static_cast<uint8_t>(EntityType::ASTEROID)) asteroidRecords.push_back((uint32_t)i);
+    }
+    int firstId = nextEntityId;
+    nextEntityId += (int)asteroidRecords.size();
+    asteroids.resize(asteroidRecords.size());
+
+    int numTasks = std::min(workerPool->getThreadCount() * 4, std::max(1, (int)asteroidRecords.size() / 4096));
+    workerPool->run(numTasks, [&](int task) {
+        int begin, end;
+        taskRange((int)asteroidRecords.size(), numTasks, task, begin, end);
+        for (int k = begin; k < end; k++) {
+            uint32_t i = asteroidRecords[k];
+            Asteroid& asteroid = asteroids[k];
+            asteroid.init(firstId + k, view.pos[i], view.vel[i], asteroidSizeForRadius(view.radius[i]));
+            asteroid.mass = view.mass[i];
+            asteroid.radius = view.radius[i];
+        }
+    });
+
+    size_t shipIndex = 0;
+    for (size_t i = 0; i < view.count; i++) {
+        switch (static_cast<EntityType>(view.type[i])) {
+            case EntityType::SHIP:
+                if (shipIndex < ships.size()) {
+                    Ship& ship = ships[shipIndex++];
+                    ship.pos = view.pos[i];
+                    ship.vel = view.vel[i];
+                    ship.mass = view.mass[i];
+                }
+                break;
+            case EntityType::BULLET: {
+                Bullet bullet;
+                bullet.init(nextEntityId++, view.pos[i], view.vel[i], 0);
+                bullet.mass = view.mass[i];
+                bullets.push_back(bullet);
+                break;
+            }
+            case EntityType::BLACK_HOLE: {
+                BlackHole bh;
+                bh.init(nextEntityId++, view.pos[i], view.vel[i], view.mass[i], view.radius[i]);
+                bh.wraps = true;
+                blackHoles.push_back(bh);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Struct sizes recorded at the start of engine state (layout check)
+ */
+static const uint32_t kStateLayout[] = {
+    sizeof(Ship), sizeof(Asteroid), sizeof(Bullet), sizeof(BlackHole), sizeof(Particle),
+    sizeof(PhysicsConfig), sizeof(DifficultyConfig), sizeof(InputState), sizeof(EnergyDiagnostics),
+    sizeof(ForceAccuracyConfig), sizeof(ForceAccuracyStats), sizeof(TimestepConfig), sizeof(TimestepStats),
+    sizeof(KeplerConfig), sizeof(KeplerStats), sizeof(ParticlePool), sizeof(ProfileConfig),
+};
+
+void GameEngine::saveState(std::vector<uint8_t>& out) const {
+    out.clear();
+    CheckpointWriter writer(out);
+    writer.put(kStateLayout);
+    writer.put(worldWidth);
+    writer.put(worldHeight);
+    writer.put(time);
+    writer.put(wave);
+    writer.put(seed);
+    writer.putRng(rng);
+    writer.put(mode);
+    writer.put(currentLevel);
+    writer.put(physics);
+    writer.put(difficulty);
+    writer.put(inputs);
+    writer.put(nextEntityId);
+    writer.put(collisionsEnabled);
+    writer.put(diagnostics);
+    writer.putVector(ships);
+    writer.putVector(asteroids);
+    writer.putVector(bullets);
+    writer.putVector(blackHoles);
+    particles.saveState(writer);
+    collisionHandler->saveState(writer);
+    accuracyMonitor.saveState(writer);
+    timestep.saveState(writer);
+    writer.put(kepler);
+    writer.put(keplerStats);
+    profiler.saveState(writer);
+}
+
+bool GameEngine::loadState(const uint8_t* data, size_t size) {
+    MemoryScope scope(MemoryTag::ENTITIES);
+    CheckpointReader reader(data, size);
+    uint32_t layout[sizeof(kStateLayout) / sizeof(kStateLayout[0])];
+    float width = 0, height = 0;
+    reader.get(layout);
+    reader.get(width);
+    reader.get(height);
+    if (!reader.good() || std::memcmp(layout, kStateLayout, sizeof(layout)) != 0 ||
+        width != worldWidth || height != worldHeight) {
+        return false;
+    }
+
+    int level = 0;
+    reader.get(time);
+    reader.get(wave);
+    reader.get(seed);
+    reader.getRng(rng);
+    reader.get(mode);
+    reader.get(level);
+    reader.get(physics);
+    reader.get(difficulty);
+    reader.get(inputs);
+    reader.get(nextEntityId);
+    reader.get(collisionsEnabled);
+    reader.get(diagnostics);
+    reader.getVector(ships);
+    reader.getVector(asteroids);
+    reader.getVector(bullets);
+    reader.getVector(blackHoles);
+    {
+        MemoryScope particleScope(MemoryTag::PARTICLES);
+        particles.loadState(reader);
+    }
+    collisionHandler->loadState(reader);
+    accuracyMonitor.loadState(reader);
+    timestep.loadState(reader);
+    reader.get(kepler);
+    reader.get(keplerStats);
+    profiler.loadState(reader);
+    if (!reader.good() || !reader.atEnd()) {
+        reset();
+        return false;
+    }
+
+    // Rebuild the potential without touching the restored baseline
+    worldPending = false;
+    currentLevel = level;
+    potential = createPotential(level, Vec2(worldWidth * 0.5f, worldHeight * 0.5f), worldWidth, physics.softening);
+    return true;
+}
+
+void GameEngine::setForceAccuracyConfig(const ForceAccuracyConfig& config) {
+    // Remember the angle adaptation starts from so reset() replays the run
+    if (config.adaptiveTheta && !accuracyMonitor.getConfig().adaptiveTheta) configuredTheta = physics.theta;
+    accuracyMonitor.setConfig(config);
+}
+
 void GameEngine::setInput(int playerId, const InputState& input) {
     if (playerId >= 0 && playerId < 2) {
         inputs[playerId] = input;
@@ -67,10 +373,23 @@ void GameEngine::setInput(int playerId, const InputState& input) {
 }
 
 void GameEngine::reset() {
+    MemoryScope scope(MemoryTag::ENTITIES);
+    worldPending = false;
     time = 0;
     wave = 1;
     nextEntityId = 0;
     rng.seed(seed);
+    collisionHandler->setSeed(seed ^ 0x9e3779b9U);
+    diagnostics = EnergyDiagnostics();
+    accuracyMonitor.reset(seed ^ 0x5bd1e995U);
+    physics.theta = configuredTheta;
+    profiler.reset();
+    timestep.reset();
+    keplerStats = KeplerStats();
+    latency.reset();
+    std::fill(std::begin(overBudgetSteps), std::end(overBudgetSteps), 0);
+    memoryPressure = 0;
+    collisionHandler->setParticlesEnabled(true);
 
     ships.clear();
     asteroids.clear();
@@ -138,6 +457,12 @@ void GameEngine::spawnBlackHole() {
 }
 
 void GameEngine::step() {
+    auto stepStart = std::chrono::steady_clock::now();
+    MemoryScope engineScope(MemoryTag::ENGINE);
+    MemoryTag outerTag = setMemoryTag(MemoryTag::ENTITIES);
+    ensureWorld();
+    stepDt = chooseTimestep();
+
     // Update entity timers
     updateEntities();
 
@@ -148,20 +473,20 @@ void GameEngine::step() {
         const InputState& input = inputs[i];
 
         if (input.left) {
-            ships[i].rotate(-3.0f * physics.dt);
+            ships[i].rotate(-3.0f * stepDt);
         }
         if (input.right) {
-            ships[i].rotate(3.0f * physics.dt);
+            ships[i].rotate(3.0f * stepDt);
         }
         if (input.thrust) {
-            ships[i].thrust(500.0f, physics.dt);
+            ships[i].thrust(500.0f, stepDt);
         }
         if (input.brake) {
             // Apply deceleration (negative thrust)
             float speed = ships[i].vel.length();
             if (speed > 1.0f) {
                 Vec2 decelDirection = ships[i].vel.normalized() * -1.0f;
-                ships[i].vel += decelDirection * (500.0f * physics.dt);
+                ships[i].vel += decelDirection * (500.0f * stepDt);
             } else {
                 // Stop completely if moving slowly
                 ships[i].vel = Vec2(0, 0);
@@ -180,14 +505,26 @@ void GameEngine::step() {
         }
     }
 
+    profile.entitySeconds = secondsSince(stepStart);
+    setMemoryTag(outerTag);
+
     // Apply physics
     applyPhysics();
 
     // Handle collisions
-    handleCollisions();
+    auto collisionStart = std::chrono::steady_clock::now();
+    if (collisionsEnabled) {
+        handleCollisions();
+    }
+    profile.collisionSeconds = secondsSince(collisionStart);
+    auto cleanupStart = std::chrono::steady_clock::now();
+    setMemoryTag(MemoryTag::ENTITIES);
 
-    // Spawn black holes
-    if (difficulty.bhEnabled && randomFloat(0, 1) < difficulty.bhSpawnRate) {
+    // Spawn black holes (paused while entities are over their memory budget); the
+    // rate is per fixed step, so a longer adaptive step spawns proportionally more often
+    bool entityPressure = memoryPressure & (1u << static_cast<int>(MemoryTag::ENTITIES));
+    float spawnChance = difficulty.bhSpawnRate * (stepDt / physics.dt);
+    if (difficulty.bhEnabled && randomFloat(0, 1) < spawnChance && !entityPressure) {
         spawnBlackHole();
     }
 
@@ -196,28 +533,83 @@ void GameEngine::step() {
 
     // Check wave progression
     checkWaveComplete();
+    setMemoryTag(outerTag);
+    enforceMemoryBudgets();
+    profile.cleanupSeconds = secondsSince(cleanupStart);
+
+    time += stepDt;
+    profile.totalSeconds = secondsSince(stepStart);
+
+    const double phaseSeconds[kStepPhaseCount] = {
+        profile.entitySeconds, profile.gravitySeconds, profile.analysisSeconds,
+        profile.collisionSeconds, profile.cleanupSeconds
+    };
+    latency.record(profile.totalSeconds, phaseSeconds);
+}
 
-    time += physics.dt;
+bool GameEngine::stepToward(double target) {
+    ensureWorld();
+    double remaining = target - (double)time;
+    if (remaining <= 1e-4 * physics.dt) {
+        // Already there up to the rounding of the float clock
+        if (remaining > 0) time = (float)target;
+        return true;
+    }
+    stepLimit = remaining;
+    step();
+    stepLimit = std::numeric_limits<double>::infinity();
+    if (stepSynced) time = (float)target;
+    return stepSynced;
+}
+
+int64_t GameEngine::advance(double duration) {
+    ensureWorld();
+    double target = (double)time + duration;
+    int64_t before = timestep.getStats().steps;
+    while (!stepToward(target)) {}
+    return timestep.getStats().steps - before;
+}
+
+float GameEngine::chooseTimestep() {
+    TimestepSample sample;
+    if (timestep.wantsSample()) {
+        // Collision radii only limit the step while collisions are handled
+        float useRadius = collisionsEnabled ? 1.0f : 0.0f;
+        for (const auto& ship : ships) {
+            if (ship.active) sample.add(ship, useRadius * ship.radius);
+        }
+        for (const auto& asteroid : asteroids) {
+            if (asteroid.active) sample.add(asteroid, useRadius * asteroid.radius);
+        }
+        for (const auto& bullet : bullets) {
+            if (bullet.active) sample.add(bullet, useRadius * bullet.radius);
+        }
+        for (const auto& bh : blackHoles) {
+            if (bh.active) sample.add(bh, useRadius * bh.accretionRadius);
+        }
+    }
+    return timestep.select(sample, physics.dt, physics.epsilon, stepLimit, stepSynced);
 }
 
 void GameEngine::updateEntities() {
     for (auto& ship : ships) {
-        if (ship.active) ship.update(physics.dt);
+        if (ship.active) ship.update(stepDt);
     }
     for (auto& asteroid : asteroids) {
-        if (asteroid.active) asteroid.update(physics.dt);
+        if (asteroid.active) asteroid.update(stepDt);
     }
     for (auto& bullet : bullets) {
-        if (bullet.active) bullet.update(physics.dt);
-    }
-    for (auto& particle : particles) {
-        if (particle.active) particle.update(physics.dt);
+        if (bullet.active) bullet.update(stepDt);
     }
+    particles.update(stepDt);
 }
 
 void GameEngine::applyPhysics() {
+    auto gravityStart = std::chrono::steady_clock::now();
+
     // Collect all bodies for N-body gravity
-    std::vector<Body*> bodies;
+    std::vector<Body*>& bodies = gravityBodies;
+    bodies.clear();
     for (auto& ship : ships) {
         if (ship.active) bodies.push_back(&ship);
     }
@@ -232,63 +624,65 @@ void GameEngine::applyPhysics() {
     }
 
     // Build quadtree
+    profile.treeAllocations = 0;
     if (!bodies.empty()) {
+        MemoryScope treeScope(MemoryTag::QUADTREE);
+        if (!quadtree) quadtree = std::make_unique<QuadTree>(Vec2(worldWidth, worldHeight));
         quadtree->build(bodies);
+        profile.treeAllocations += quadtree->getNodeCount();
     }
 
-    // Leapfrog integration (kick-drift-kick / velocity Verlet)
-    // First half-kick: v += a * dt/2
-    for (Body* body : bodies) {
-        Vec2 acc(0, 0);
-
-        // N-body gravity
-        if (!bodies.empty()) {
-            acc += quadtree->calculateAcceleration(body->pos, body->mass,
-                                                   physics.theta, physics.epsilon, physics.G);
-        }
-
-        // External potential
-        if (potential) {
-            acc += potential->accelerationAt(body->pos);
-        }
+    // Leapfrog integration (kick-drift-kick / velocity Verlet); bodies bound to a
+    // dominant black hole drift along their exact orbit about it instead (kepler.h)
+    assignKeplerHosts(bodies);
+    bool keplerActive = !keplerHosts.empty();
 
-        body->acc = acc;
-        body->vel += acc * (physics.dt * 0.5f);
-    }
+    // First half-kick: v += a * dt/2
+    profile.interactions = 0;
+    double openingImbalance = kickBodies(bodies, nullptr);
 
-    // Drift: x += v * dt
-    for (Body* body : bodies) {
-        body->pos += body->vel * physics.dt;
+    // Drift: x += v * dt (Kepler-drifted bodies first, while their hosts are still in place)
+    if (keplerActive) driftKeplerBodies(bodies);
+    for (size_t i = 0; i < bodies.size(); i++) {
+        if (keplerActive && keplerHosts[i] >= 0) continue;
+        Body* body = bodies[i];
+        body->pos += body->vel * stepDt;
 
         // Apply wrapping for entities that wrap
         if (body->wraps) {
             body->pos = wrapPosition(body->pos, worldWidth, worldHeight);
         }
     }
+    if (keplerActive) applyKeplerRecoil(bodies);
 
     // Rebuild quadtree after drift
     if (!bodies.empty()) {
+        MemoryScope treeScope(MemoryTag::QUADTREE);
         quadtree->build(bodies);
+        profile.treeAllocations += quadtree->getNodeCount();
     }
 
-    // Second half-kick: v += a * dt/2
-    for (Body* body : bodies) {
-        Vec2 acc(0, 0);
-
-        // N-body gravity
-        if (!bodies.empty()) {
-            acc += quadtree->calculateAcceleration(body->pos, body->mass,
-                                                   physics.theta, physics.epsilon, physics.G);
-        }
+    // Second half-kick: v += a * dt/2 (also records tree potential for diagnostics)
+    bodyPotential.resize(bodies.size());
+    double closingImbalance = kickBodies(bodies, &bodyPotential);
+    if (keplerActive) correctKeplerPotential(bodies);
+    profile.forceImbalance = std::max(openingImbalance, closingImbalance);
+    profile.forceTasks = forceBalancer.getTaskCount();
+    profile.treeNodes = bodies.empty() ? 0 : quadtree->getNodeCount();
+    profile.gravitySeconds = secondsSince(gravityStart);
 
-        // External potential
-        if (potential) {
-            acc += potential->accelerationAt(body->pos);
-        }
+    auto analysisStart = std::chrono::steady_clock::now();
+    computeDiagnostics(bodies, bodyPotential, potential.get(),
+                       Vec2(worldWidth * 0.5f, worldHeight * 0.5f), workerPool.get(), diagnostics);
+    profiler.update(bodies, potential.get(), Vec2(worldWidth * 0.5f, worldHeight * 0.5f),
+                    0.5f * std::min(worldWidth, worldHeight), physics.G, workerPool.get());
 
-        body->acc = acc;
-        body->vel += acc * (physics.dt * 0.5f);
+    // Sample tree force error (may steer theta for the next step)
+    if (!bodies.empty()) {
+        accuracyMonitor.update(bodies, *quadtree, physics.theta, physics.epsilon, physics.G,
+                               worldWidth, worldHeight, physics.softening);
     }
+    profile.analysisSeconds = secondsSince(analysisStart);
 
     // Remove black holes that went offscreen
     for (auto& bh : blackHoles) {
@@ -298,51 +692,351 @@ void GameEngine::applyPhysics() {
     }
 }
 
+double GameEngine::kickBodies(std::vector<Body*>& bodies, std::vector<float>* outPotential) {
+    // One range per thread, but keep ranges large enough to outweigh the handoff
+    int numTasks = std::min(workerPool->getThreadCount(), std::max(1, (int)bodies.size() / 256));
+    forceBalancer.partition(bodies, worldWidth, worldHeight, numTasks);
+
+    const std::vector<int>& order = forceBalancer.getOrder();
+    float halfDt = stepDt * 0.5f;
+    taskInteractions.assign(forceBalancer.getTaskCount(), 0);
+    // Resolve the kernel once per pass: each policy gets its own inlined tree walk
+    withSoftening(physics.softening, physics.epsilon, [&](const auto& kernel) {
+        workerPool->run(forceBalancer.getTaskCount(), [&](int task) {
+            auto taskStart = std::chrono::steady_clock::now();
+            size_t begin, end;
+            forceBalancer.taskRange(task, begin, end);
+            long long interactions = 0;
+            for (size_t k = begin; k < end; k++) {
+                int i = order[k];
+                Body* body = bodies[i];
+
+                // N-body gravity
+                ForceResult force = quadtree->calculateForce(body->pos, body->mass,
+                                                             physics.theta, kernel, physics.G);
+                Vec2 acc = force.acc;
+
+                // The pull between a Kepler-drifted body and its host is integrated by the drift
+                if (!keplerHosts.empty() && keplerHosts[i] >= 0) {
+                    const Body* host = bodies[keplerHosts[i]];
+                    Vec2 dr = minimumImage(host->pos - body->pos, worldWidth, worldHeight);
+                    float accScale, phi;
+                    kernel.apply(dr.lengthSquared(), physics.G * host->mass, accScale, phi);
+                    acc -= dr * accScale;
+                }
+                body->cost = (float)force.interactions;
+                interactions += force.interactions;
+                if (outPotential) (*outPotential)[i] = force.potential;
+
+                // External potential
+                if (potential) {
+                    acc += potential->accelerationAt(body->pos);
+                }
+
+                body->acc = acc;
+                body->vel += acc * halfDt;
+            }
+            taskInteractions[task] = interactions;
+            forceBalancer.recordTaskTime(task, secondsSince(taskStart));
+        });
+
+        // Hosts feel their Kepler-drifted bodies only through the drift's recoil
+        for (size_t i = 0; i < keplerHosts.size(); i++) {
+            if (keplerHosts[i] < 0) continue;
+            Body* host = bodies[keplerHosts[i]];
+            Vec2 dr = minimumImage(bodies[i]->pos - host->pos, worldWidth, worldHeight);
+            float accScale, phi;
+            kernel.apply(dr.lengthSquared(), physics.G * bodies[i]->mass, accScale, phi);
+            host->acc -= dr * accScale;
+            host->vel -= dr * (accScale * halfDt);
+        }
+    });
+    for (long long count : taskInteractions) profile.interactions += count;
+    return forceBalancer.imbalance();
+}
+
+void GameEngine::assignKeplerHosts(std::vector<Body*>& bodies) {
+    bool wasActive = keplerStats.bodies > 0;
+    keplerHosts.clear();
+    keplerStats.bodies = 0;
+
+    std::vector<int> holes;
+    if (kepler.enabled) {
+        for (size_t i = 0; i < bodies.size(); i++) {
+            if (bodies[i]->type == EntityType::BLACK_HOLE) holes.push_back((int)i);
+        }
+    }
+    if (holes.empty()) {
+        // Stored accelerations include every pull again from here on
+        if (wasActive) {
+            for (Body* body : bodies) body->keplerHost = -1;
+        }
+        return;
+    }
+
+    keplerHosts.assign(bodies.size(), -1);
+    float switchRadius = kepler.switchRadius * physics.epsilon;
+    float switchRadius2 = switchRadius * switchRadius;
+    int numTasks = std::min(workerPool->getThreadCount(), std::max(1, (int)bodies.size() / 1024));
+    withSoftening(physics.softening, physics.epsilon, [&](const auto& kernel) {
+        workerPool->run(numTasks, [&](int task) {
+            int begin, end;
+            taskRange((int)bodies.size(), numTasks, task, begin, end);
+            for (int i = begin; i < end; i++) {
+                Body* body = bodies[i];
+                int best = -1, previous = -1;
+                float bestPull = 0;
+                Vec2 bestDr;
+                bool nearHole = false;
+                // Bound black hole pulling hardest (holes themselves drift linearly)
+                for (int h = 0; h < (int)holes.size() && body->type != EntityType::BLACK_HOLE; h++) {
+                    const Body* hole = bodies[holes[h]];
+                    if (hole->id == body->keplerHost) previous = holes[h];
+                    Vec2 dr = minimumImage(hole->pos - body->pos, worldWidth, worldHeight);
+                    float r2 = dr.lengthSquared();
+                    nearHole = nearHole || r2 < switchRadius2;
+                    if (r2 <= 0) continue;
+                    float pull = physics.G * hole->mass / r2;
+                    float energy = 0.5f * (body->vel - hole->vel).lengthSquared() -
+                                   physics.G * (hole->mass + body->mass) / std::sqrt(r2);
+                    if (energy < 0 && pull > bestPull) {
+                        best = holes[h];
+                        bestPull = pull;
+                        bestDr = dr;
+                    }
+                }
+                if (nearHole) {
+                    // Deep in a well the body keeps last step's choice (see kepler.h)
+                    best = previous;
+                } else if (best >= 0) {
+                    // Everything else acting on the body; its stored acceleration
+                    // already lacks the host's pull if it drifted about it last step
+                    Vec2 rest = body->acc;
+                    if (body->keplerHost != bodies[best]->id) {
+                        float accScale, phi;
+                        kernel.apply(bestDr.lengthSquared(), physics.G * bodies[best]->mass, accScale, phi);
+                        rest -= bestDr * accScale;
+                    }
+                    if (bestPull < kepler.dominance * rest.length()) best = -1;
+                }
+                keplerHosts[i] = best;
+                body->keplerHost = best >= 0 ? bodies[best]->id : -1;
+            }
+        });
+    });
+
+    for (int host : keplerHosts) keplerStats.bodies += host >= 0 ? 1 : 0;
+    if (keplerStats.bodies == 0) keplerHosts.clear();
+}
+
+void GameEngine::driftKeplerBodies(std::vector<Body*>& bodies) {
+    int numTasks = std::min(workerPool->getThreadCount(), std::max(1, keplerStats.bodies / 256));
+    taskKeplerCounts.assign(numTasks * 3, 0);
+    keplerShift.assign(bodies.size(), Vec2(0, 0));
+    keplerKick.assign(bodies.size(), Vec2(0, 0));
+    workerPool->run(numTasks, [&](int task) {
+        int begin, end;
+        taskRange((int)bodies.size(), numTasks, task, begin, end);
+        int64_t* counts = &taskKeplerCounts[task * 3];
+        for (int i = begin; i < end; i++) {
+            if (keplerHosts[i] < 0) continue;
+            Body* body = bodies[i];
+            const Body* host = bodies[keplerHosts[i]];
+            Vec2 r0 = minimumImage(body->pos - host->pos, worldWidth, worldHeight);
+            Vec2 v0 = body->vel - host->vel;
+            Vec2 r = r0, v = v0;
+            int iterations = 0;
+            float total = host->mass + body->mass;
+            if (keplerDrift(r, v, physics.G * total, stepDt, iterations)) {
+                // Two-body motion: the pair's centre of mass drifts linearly and
+                // the host takes the body's share of the orbital displacement
+                float share = body->mass / total;
+                Vec2 shift = (r - r0 - v0 * stepDt) * -share;
+                Vec2 kick = (v - v0) * -share;
+                body->pos = host->pos + host->vel * stepDt + shift + r;
+                body->vel = host->vel + kick + v;
+                keplerShift[i] = shift;
+                keplerKick[i] = kick;
+            } else {
+                body->pos += body->vel * stepDt;
+                counts[1]++;
+            }
+            counts[0]++;
+            counts[2] += iterations;
+            if (body->wraps) {
+                body->pos = wrapPosition(body->pos, worldWidth, worldHeight);
+            }
+        }
+    });
+    for (int task = 0; task < numTasks; task++) {
+        keplerStats.drifts += taskKeplerCounts[task * 3];
+        keplerStats.fallbacks += taskKeplerCounts[task * 3 + 1];
+        keplerStats.iterations += taskKeplerCounts[task * 3 + 2];
+    }
+
+    // Sum each host's recoil in body order (members and hosts are distinct slots)
+    for (size_t i = 0; i < bodies.size(); i++) {
+        int h = keplerHosts[i];
+        if (h < 0) continue;
+        keplerShift[h] += keplerShift[i];
+        keplerKick[h] += keplerKick[i];
+    }
+}
+
+void GameEngine::applyKeplerRecoil(std::vector<Body*>& bodies) {
+    for (size_t i = 0; i < bodies.size(); i++) {
+        Body* body = bodies[i];
+        if (body->type != EntityType::BLACK_HOLE) continue;
+        body->pos += keplerShift[i];
+        body->vel += keplerKick[i];
+        if (body->wraps) {
+            body->pos = wrapPosition(body->pos, worldWidth, worldHeight);
+        }
+    }
+}
+
+void GameEngine::correctKeplerPotential(std::vector<Body*>& bodies) {
+    withSoftening(physics.softening, physics.epsilon, [&](const auto& kernel) {
+        for (size_t i = 0; i < bodies.size(); i++) {
+            int h = keplerHosts[i];
+            if (h < 0) continue;
+            Vec2 dr = minimumImage(bodies[h]->pos - bodies[i]->pos, worldWidth, worldHeight);
+            float r2 = dr.lengthSquared();
+            if (r2 <= 0) continue;
+            float invR = 1.0f / std::sqrt(r2);
+            float accScale, phi;
+            // The tree gave the body -phi(G M) and the host -phi(G m) per unit mass
+            kernel.apply(r2, physics.G * bodies[h]->mass, accScale, phi);
+            bodyPotential[i] += phi - physics.G * bodies[h]->mass * invR;
+            kernel.apply(r2, physics.G * bodies[i]->mass, accScale, phi);
+            bodyPotential[h] += phi - physics.G * bodies[i]->mass * invR;
+        }
+    });
+}
+
+const GameEngine::CollisionResolver GameEngine::collisionResolvers[static_cast<int>(CollisionKind::COUNT)] = {
+    &GameEngine::resolveShipAsteroid,      // SHIP_ASTEROID
+    &GameEngine::resolveShipShip,          // SHIP_SHIP
+    &GameEngine::resolveAsteroidAsteroid,  // ASTEROID_ASTEROID
+    &GameEngine::resolveBulletAsteroid,    // BULLET_ASTEROID
+    &GameEngine::resolveAccretion,         // ACCRETION
+};
+
+/**
+ * @brief Order pairs by (a id, b id) so batch resolution is independent of detection order
+ */
+static bool pairIdLess(const CollisionPair& x, const CollisionPair& y) {
+    if (x.a->id != y.a->id) return x.a->id < y.a->id;
+    return x.b->id < y.b->id;
+}
+
 void GameEngine::handleCollisions() {
-    std::vector<CollisionPair> collisions;
+    MemoryTag outerTag = setMemoryTag(MemoryTag::COLLISION);
+    if (!collisionDetector) {
+        collisionDetector = std::make_unique<CollisionDetector>(worldWidth, worldHeight);
+        collisionDetector->setWorkerPool(workerPool.get());
+    }
     collisionDetector->detectCollisions(ships, asteroids, bullets, blackHoles, collisions);
 
+    // Bucket by type pair
+    for (auto& batch : collisionBatches) {
+        batch.clear();
+    }
     for (const auto& collision : collisions) {
-        Body* a = collision.a;
-        Body* b = collision.b;
-
-        if (!a->active || !b->active) continue;
-
-        // Determine collision type
-        if (a->type == EntityType::SHIP && b->type == EntityType::ASTEROID) {
-            collisionHandler->handleShipAsteroid(static_cast<Ship*>(a),
-                                                static_cast<Asteroid*>(b), particles);
-        } else if (a->type == EntityType::ASTEROID && b->type == EntityType::SHIP) {
-            collisionHandler->handleShipAsteroid(static_cast<Ship*>(b),
-                                                static_cast<Asteroid*>(a), particles);
-        } else if (a->type == EntityType::SHIP && b->type == EntityType::SHIP) {
-            collisionHandler->handleShipShip(static_cast<Ship*>(a), static_cast<Ship*>(b));
-        } else if (a->type == EntityType::ASTEROID && b->type == EntityType::ASTEROID) {
-            collisionHandler->handleAsteroidAsteroid(static_cast<Asteroid*>(a),
-                                                     static_cast<Asteroid*>(b));
-        } else if (a->type == EntityType::BULLET && b->type == EntityType::ASTEROID) {
-            Bullet* bullet = static_cast<Bullet*>(a);
-            Asteroid* asteroid = static_cast<Asteroid*>(b);
-            collisionHandler->handleBulletAsteroid(bullet, asteroid, particles, asteroids, nextEntityId);
-
-            // Award points
-            if (bullet->playerId >= 0 && bullet->playerId < (int)ships.size()) {
-                ships[bullet->playerId].score += 10;
-            }
-        } else if (a->type == EntityType::ASTEROID && b->type == EntityType::BULLET) {
-            Bullet* bullet = static_cast<Bullet*>(b);
-            Asteroid* asteroid = static_cast<Asteroid*>(a);
-            collisionHandler->handleBulletAsteroid(bullet, asteroid, particles, asteroids, nextEntityId);
-
-            // Award points
-            if (bullet->playerId >= 0 && bullet->playerId < (int)ships.size()) {
-                ships[bullet->playerId].score += 10;
+        collisionBatches[static_cast<int>(collision.kind)].push_back(collision);
+    }
+
+    // Resolve each bucket as a batch, in CollisionKind order (explosions tag their own particles)
+    setMemoryTag(MemoryTag::ENTITIES);
+    spawnedAsteroids.clear();
+    frameStartLives.clear();
+    for (const auto& ship : ships) frameStartLives.push_back(ship.lives);
+    for (int kind = 0; kind < static_cast<int>(CollisionKind::COUNT); kind++) {
+        if (!collisionBatches[kind].empty()) {
+            (this->*collisionResolvers[kind])(collisionBatches[kind]);
+        }
+    }
+
+    // Fragments join the world only after every pair has been handled
+    asteroids.insert(asteroids.end(), spawnedAsteroids.begin(), spawnedAsteroids.end());
+    setMemoryTag(outerTag);
+}
+
+void GameEngine::resolveShipAsteroid(std::vector<CollisionPair>& batch) {
+    std::sort(batch.begin(), batch.end(), pairIdLess);
+    for (const auto& collision : batch) {
+        if (!collision.a->active || !collision.b->active) continue;
+        // A hit earlier in the batch already granted respawn invulnerability
+        if (static_cast<Ship*>(collision.a)->invulnerable) continue;
+        collisionHandler->handleShipAsteroid(static_cast<Ship*>(collision.a),
+                                             static_cast<Asteroid*>(collision.b), particles);
+    }
+}
+
+void GameEngine::resolveShipShip(std::vector<CollisionPair>& batch) {
+    std::sort(batch.begin(), batch.end(), pairIdLess);
+    for (const auto& collision : batch) {
+        if (!collision.a->active || !collision.b->active) continue;
+        collisionHandler->handleShipShip(static_cast<Ship*>(collision.a),
+                                         static_cast<Ship*>(collision.b));
+    }
+}
+
+void GameEngine::resolveAsteroidAsteroid(std::vector<CollisionPair>& batch) {
+    std::sort(batch.begin(), batch.end(), pairIdLess);
+    for (const auto& collision : batch) {
+        if (!collision.a->active || !collision.b->active) continue;
+        collisionHandler->handleAsteroidAsteroid(static_cast<Asteroid*>(collision.a),
+                                                 static_cast<Asteroid*>(collision.b));
+    }
+}
+
+void GameEngine::resolveBulletAsteroid(std::vector<CollisionPair>& batch) {
+    // Group by asteroid so the lowest-id bullet claims each asteroid
+    std::sort(batch.begin(), batch.end(), [](const CollisionPair& x, const CollisionPair& y) {
+        if (x.b->id != y.b->id) return x.b->id < y.b->id;
+        return x.a->id < y.a->id;
+    });
+
+    for (const auto& collision : batch) {
+        if (!collision.a->active || !collision.b->active) continue;
+
+        Bullet* bullet = static_cast<Bullet*>(collision.a);
+        Asteroid* asteroid = static_cast<Asteroid*>(collision.b);
+        collisionHandler->handleBulletAsteroid(bullet, asteroid, particles, spawnedAsteroids, nextEntityId);
+
+        // Award points
+        if (bullet->playerId >= 0 && bullet->playerId < (int)ships.size()) {
+            ships[bullet->playerId].score += 10;
+        }
+    }
+}
+
+void GameEngine::resolveAccretion(std::vector<CollisionPair>& batch) {
+    // Group by body, nearest black hole first
+    std::sort(batch.begin(), batch.end(), [](const CollisionPair& x, const CollisionPair& y) {
+        if (x.a->id != y.a->id) return x.a->id < y.a->id;
+        if (x.distance != y.distance) return x.distance < y.distance;
+        return x.b->id < y.b->id;
+    });
+
+    int lastBodyId = -1;
+    for (const auto& collision : batch) {
+        if (!collision.a->active || !collision.b->active) continue;
+        // Respawned ships stay active; only the nearest black hole gets them
+        if (collision.a->id == lastBodyId) continue;
+        lastBodyId = collision.a->id;
+        // A ship that already lost a life this frame loses no further one
+        if (collision.a->type == EntityType::SHIP) {
+            const Ship* ship = static_cast<const Ship*>(collision.a);
+            if (ship->playerId >= 0 && ship->playerId < (int)frameStartLives.size() &&
+                ship->lives < frameStartLives[ship->playerId]) {
+                continue;
             }
-        } else if (b->type == EntityType::BLACK_HOLE) {
-            collisionHandler->handleBlackHoleAccretion(a, static_cast<BlackHole*>(b), particles, asteroids, nextEntityId, collision.distance);
-        } else if (a->type == EntityType::BLACK_HOLE) {
-            collisionHandler->handleBlackHoleAccretion(b, static_cast<BlackHole*>(a), particles, asteroids, nextEntityId, collision.distance);
         }
+        collisionHandler->handleBlackHoleAccretion(collision.a, static_cast<BlackHole*>(collision.b),
+                                                   particles, spawnedAsteroids, nextEntityId,
+                                                   collision.distance);
     }
 }
 
@@ -362,10 +1056,34 @@ void GameEngine::cleanupInactive() {
                       [](const BlackHole& bh) { return !bh.active; }),
         blackHoles.end());
 
-    particles.erase(
-        std::remove_if(particles.begin(), particles.end(),
-                      [](const Particle& p) { return !p.active; }),
-        particles.end());
+    particles.removeInactive();
+}
+
+void GameEngine::enforceMemoryBudgets() {
+    memoryPressure = 0;
+    for (int i = 0; i < kMemoryTagCount; i++) {
+        if (memoryBudgets[i] > 0 && getMemoryStats(static_cast<MemoryTag>(i)).currentBytes > memoryBudgets[i]) {
+            memoryPressure |= 1u << i;
+            overBudgetSteps[i]++;
+        }
+    }
+
+    // Particles: stop emitting, and give capacity back once half of it is unused
+    bool particlePressure = memoryPressure & (1u << static_cast<int>(MemoryTag::PARTICLES));
+    collisionHandler->setParticlesEnabled(!particlePressure);
+    if (particlePressure && particles.size() <= particles.capacity() / 2) {
+        MemoryScope scope(MemoryTag::PARTICLES);
+        particles.shrinkToFit();
+    }
+
+    // Collision scratch: free it between steps
+    if (memoryPressure & (1u << static_cast<int>(MemoryTag::COLLISION))) {
+        if (collisionDetector) collisionDetector->releaseScratch();
+        std::vector<CollisionPair>().swap(collisions);
+        for (auto& batch : collisionBatches) {
+            std::vector<CollisionPair>().swap(batch);
+        }
+    }
 }
 
 void GameEngine::checkWaveComplete() {
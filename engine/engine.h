@@ -15,11 +15,23 @@
  */
 
 #pragma once
-#include "vec2.h"
-#include "quadtree.h"
+#include "vecn.h"
+#include "tree.h"
 #include "potential.h"
 #include "entity.h"
 #include "collision.h"
+#include "parallel.h"
+#include "diagnostics.h"
+#include "accuracy.h"
+#include "balance.h"
+#include "latency.h"
+#include "allocation.h"
+#include "scenario.h"
+#include "snapshot.h"
+#include "trajectory.h"
+#include "timestep.h"
+#include "kepler.h"
+#include "profiles.h"
 #include <vector>
 #include <memory>
 #include <random>
@@ -46,12 +58,13 @@ struct PhysicsConfig {
     float G;         ///< Gravitational constant - scales force strength
     float epsilon;   ///< Softening length - prevents singularities in close encounters
     float theta;     ///< Barnes-Hut opening angle - accuracy vs speed tradeoff (typical: 0.5)
+    SofteningKernel softening;  ///< Softening kernel shape (epsilon sets its length)
 
     /**
      * @brief Default constructor with tuned physics parameters
      */
     PhysicsConfig()
-        : dt(1.0f / 120.0f), G(100.0f), epsilon(5.0f), theta(0.5f) {}
+        : dt(1.0f / 120.0f), G(100.0f), epsilon(5.0f), theta(0.5f), softening(SofteningKernel::PLUMMER) {}
 };
 
 /**
@@ -100,6 +113,32 @@ struct InputState {
     InputState() : left(false), right(false), thrust(false), brake(false), shoot(false) {}
 };
 
+/**
+ * @struct StepProfile
+ * @brief Wall-clock timings of the phases of the last step
+ */
+struct StepProfile {
+    double entitySeconds;     ///< Entity timers and input handling
+    double gravitySeconds;    ///< Tree builds, both half-kicks and the drift
+    double analysisSeconds;   ///< Conservation diagnostics, force accuracy sampling and radial profiles
+    double collisionSeconds;  ///< Collision detection and response
+    double cleanupSeconds;    ///< Spawning, cleanup and wave progression
+    double totalSeconds;      ///< Whole step
+    double forceImbalance;    ///< Slowest / mean force task time, worse of the two half-kicks
+    int forceTasks;           ///< Ranges the force loop was split into
+    int treeNodes;            ///< Nodes in the closing tree build
+    int treeAllocations;      ///< Nodes allocated by both tree builds
+    long long interactions;   ///< Body/node interactions over both half-kicks
+
+    /**
+     * @brief Default constructor - zero timings
+     */
+    StepProfile()
+        : entitySeconds(0), gravitySeconds(0), analysisSeconds(0), collisionSeconds(0),
+          cleanupSeconds(0), totalSeconds(0), forceImbalance(1.0), forceTasks(1), treeNodes(0),
+          treeAllocations(0), interactions(0) {}
+};
+
 /**
  * @class GameEngine
  * @brief Main game simulation engine
@@ -124,8 +163,15 @@ public:
      * @param width World width in pixels
      * @param height World height in pixels
      * @param seed Random seed for reproducible asteroid/black hole spawning
+     * @param deferWorld If true, skip the initial reset(): the world stays
+     *                   empty until reset(), setMode(), loadState() or the
+     *                   first step() populates it (saves the set-up work that
+     *                   callers configuring a game would immediately discard)
+     *
+     * The Barnes-Hut tree and the collision detector are created on first
+     * use either way, so a run without collisions never allocates a grid.
      */
-    GameEngine(float width, float height, uint32_t seed);
+    GameEngine(float width, float height, uint32_t seed, bool deferWorld = false);
 
     /**
      * @brief Destructor - cleans up all subsystems
@@ -179,6 +225,95 @@ public:
      */
     void setAsteroidBaseMass(float mass);
 
+    /**
+     * @brief Set number of threads used by parallel subsystems
+     * @param numThreads Total threads including the caller (1 = serial)
+     *
+     * Results are identical for every thread count. Ignored in the
+     * single-threaded WebAssembly build.
+     */
+    void setThreadCount(int numThreads);
+
+    /**
+     * @brief Replace the world contents with generated initial conditions
+     * @param scenario Scenario from generateScenario
+     *
+     * Switches to the scenario's level, removes all asteroids, bullets,
+     * black holes and particles, and loads the scenario bodies as dust
+     * asteroids (size 5) or wrapping black holes. Ships are kept. Black
+     * hole spawning is left as configured; disable it for clean benchmarks.
+     */
+    void loadScenario(const Scenario& scenario);
+
+    /**
+     * @brief Copy the world's bodies into snapshot columns
+     * @param out Output columns (cleared first; capacity is reused)
+     *
+     * Ships, asteroids, bullets and black holes are written in that order;
+     * inactive entities and particles are skipped.
+     */
+    void captureSnapshot(SnapshotData& out) const;
+
+    /**
+     * @brief Copy the ids, positions and velocities of all bodies into a trajectory frame
+     * @param out Output frame (columns resized; capacity is reused)
+     *
+     * Same body order as captureSnapshot. Entity ids make records
+     * traceable across frames when bodies are destroyed or spawned.
+     */
+    void captureTrajectory(TrajectoryFrame& out) const;
+
+    /**
+     * @brief Replace the world contents with snapshot bodies
+     * @param view Snapshot columns (mapped file or SnapshotData)
+     *
+     * Switches to the snapshot's level and time. Ship records update the
+     * existing ships in order; asteroids take the size class nearest
+     * their radius but keep the stored mass and radius; black holes are
+     * loaded wrapping, as in loadScenario.
+     *
+     * @return False (world untouched) if the snapshot was saved for a
+     *         different world size
+     */
+    bool loadSnapshot(const SnapshotView& view);
+
+    /**
+     * @brief Serialise the complete simulation state for a checkpoint
+     * @param out Output bytes (cleared first; capacity is reused)
+     *
+     * Covers entities, RNG streams (gameplay, collision response, force
+     * monitor), configuration, inputs, wave, time and the id counter;
+     * see checkpoint.h. Thread count and scratch buffers are not state.
+     */
+    void saveState(std::vector<uint8_t>& out) const;
+
+    /**
+     * @brief Restore state written by saveState
+     * @param data State bytes
+     * @param size Byte count
+     * @return False if the state is malformed, from an incompatible build
+     *         or for a different world size (the engine is then reset)
+     *
+     * Stepping after a successful load is bit-identical to stepping the
+     * engine the state was saved from.
+     */
+    bool loadState(const uint8_t* data, size_t size);
+
+    /**
+     * @brief Enable or disable collision detection and response
+     * @param enabled False to run pure gravity (e.g. for scenario benchmarks)
+     */
+    void setCollisionsEnabled(bool enabled) { collisionsEnabled = enabled; }
+
+    /**
+     * @brief Select the gravitational softening kernel
+     * @param kind Kernel (the softening length stays PhysicsConfig::epsilon)
+     *
+     * Also softens the point-mass level's central mass. Saved with the
+     * engine state, so a restart keeps the kernel.
+     */
+    void setSofteningKernel(SofteningKernel kind);
+
     /**
      * @brief Set player input for current frame
      * @param playerId Player index (0 or 1)
@@ -187,14 +322,37 @@ public:
     void setInput(int playerId, const InputState& input);
 
     /**
-     * @brief Advance simulation by one fixed timestep
+     * @brief Advance simulation by one timestep
      *
      * Complete simulation step including entity updates, physics,
      * collisions, spawning, and wave management. Should be called
-     * at display refresh rate (typically 60 Hz).
+     * at display refresh rate (typically 60 Hz). The step is
+     * PhysicsConfig::dt unless the adaptive timestep is enabled
+     * (setTimestepConfig).
      */
     void step();
 
+    /**
+     * @brief Take one step without passing a target time
+     * @param target Simulation time to reach (e.g. the next output time)
+     * @return True once time equals target (the step was shortened to land on it, or no step was needed)
+     *
+     * Call repeatedly until it returns true; the state is then
+     * synchronised exactly at target, ready for output or a checkpoint.
+     */
+    bool stepToward(double target);
+
+    /**
+     * @brief Advance the simulation by a span of simulated time
+     * @param duration Seconds of simulated time
+     * @return Steps taken
+     *
+     * With the adaptive timestep this takes as few steps as the criteria
+     * allow; with the fixed one, duration / dt steps (the last shortened
+     * if duration is not a multiple of dt).
+     */
+    int64_t advance(double duration);
+
     /**
      * @brief Reset game to initial state
      *
@@ -203,6 +361,12 @@ public:
      */
     void reset();
 
+    /**
+     * @brief Whether the world is still waiting for its deferred reset
+     * @return True after GameEngine(..., deferWorld = true) until the world is populated
+     */
+    bool isWorldPending() const { return worldPending; }
+
     // Getters for rendering and UI
 
     /**
@@ -231,9 +395,9 @@ public:
 
     /**
      * @brief Get all active particles
-     * @return Vector of explosion particles
+     * @return Explosion particle pool
      */
-    const std::vector<Particle>& getParticles() const { return particles; }
+    const ParticlePool& getParticles() const { return particles; }
 
     /**
      * @brief Get world width
@@ -259,6 +423,12 @@ public:
      */
     int getWave() const { return wave; }
 
+    /**
+     * @brief Get the selected potential level
+     * @return Level (0-4, see setLevel)
+     */
+    int getLevel() const { return currentLevel; }
+
     /**
      * @brief Check if game is over
      * @return True if all players are dead (no lives remaining)
@@ -271,6 +441,148 @@ public:
      */
     const IExternalPotential* getPotential() const { return potential.get(); }
 
+    /**
+     * @brief Get conservation diagnostics from the last step
+     * @return Energy, momentum and angular momentum totals and energy drift
+     */
+    const EnergyDiagnostics& getDiagnostics() const { return diagnostics; }
+
+    /**
+     * @brief Re-baseline energy drift at the next step
+     *
+     * Called automatically by reset() and setLevel().
+     */
+    void resetDiagnosticsBaseline() { diagnostics.hasBaseline = false; }
+
+    /**
+     * @brief Configure the force accuracy monitor
+     * @param config Sampling interval, sample count, window and optional theta control
+     */
+    void setForceAccuracyConfig(const ForceAccuracyConfig& config);
+
+    /**
+     * @brief Get tree force error statistics over the monitor's rolling window
+     * @return Mean, RMS, p95 and max relative error
+     */
+    const ForceAccuracyStats& getForceAccuracy() const { return accuracyMonitor.getStats(); }
+
+    /**
+     * @brief Configure radial profiles about the potential centre (off by default)
+     * @param config Bins, outer radius and update interval (see profiles.h)
+     */
+    void setProfileConfig(const ProfileConfig& config) { profiler.setConfig(config); }
+
+    /**
+     * @brief Get the radial profiler
+     * @return Profiler holding the latest density, rotation and dispersion profile
+     */
+    const RadialProfiler& getProfiler() const { return profiler; }
+
+    /**
+     * @brief Configure the adaptive timestep (off by default, see timestep.h)
+     * @param config Criteria parameters and dt range
+     */
+    void setTimestepConfig(const TimestepConfig& config) { timestep.setConfig(config); }
+
+    /**
+     * @brief Get adaptive timestep statistics since the last reset
+     * @return Steps taken against fixed-dt steps, dt range and limiters
+     */
+    const TimestepStats& getTimestepStats() const { return timestep.getStats(); }
+
+    /**
+     * @brief Configure Kepler drift for bodies bound to a black hole (off by default, see kepler.h)
+     * @param config Enable flag and host dominance threshold
+     */
+    void setKeplerConfig(const KeplerConfig& config) { kepler = config; }
+
+    /**
+     * @brief Get Kepler drift counters since the last reset
+     * @return Bodies drifted last step, drifts, solver fallbacks and iterations
+     */
+    const KeplerStats& getKeplerStats() const { return keplerStats; }
+
+    /**
+     * @brief Get phase timings of the last step
+     * @return Step profile including force load imbalance
+     */
+    const StepProfile& getStepProfile() const { return profile; }
+
+    /**
+     * @brief Configure step-latency windows and outlier detection (clears the histograms)
+     * @param config Window length, outlier factor and floor
+     */
+    void setLatencyConfig(const LatencyConfig& config) { latency.setConfig(config); }
+
+    /**
+     * @brief Get the step-latency tracker
+     * @return Histograms, summaries and the outlier log
+     *
+     * Cleared by reset(); not part of saved state (wall-clock timings).
+     */
+    const LatencyTracker& getLatency() const { return latency; }
+
+    /**
+     * @brief Set a hard heap budget for one subsystem
+     * @param tag Subsystem (see allocation.h)
+     * @param bytes Budget in bytes (0 = unlimited)
+     *
+     * Budgets are checked after every step against the process-wide tag
+     * counters. While a tag is over budget the engine degrades instead of
+     * growing further:
+     * - PARTICLES: explosions stop emitting particles and the particle
+     *   store is shrunk as old particles expire (the simulation is otherwise
+     *   unchanged)
+     * - ENTITIES: black holes stop spawning
+     * - COLLISION: broadphase and pair buffers are freed after each step,
+     *   trading reallocation for footprint
+     * - QUADTREE, ENGINE, UNTAGGED: reported only (the tree is rebuilt every
+     *   step and cannot be shed without changing the physics)
+     */
+    void setMemoryBudget(MemoryTag tag, int64_t bytes) { memoryBudgets[static_cast<int>(tag)] = bytes > 0 ? bytes : 0; }
+
+    /**
+     * @brief Get a subsystem's heap budget
+     * @param tag Subsystem
+     * @return Budget in bytes (0 = unlimited)
+     */
+    int64_t getMemoryBudget(MemoryTag tag) const { return memoryBudgets[static_cast<int>(tag)]; }
+
+    /**
+     * @brief Get the subsystems that were over budget after the last step
+     * @return Bit (1 << tag) set for every tag over its budget
+     */
+    uint32_t getMemoryPressure() const { return memoryPressure; }
+
+    /**
+     * @brief Get how many steps a subsystem ended over budget since reset
+     * @param tag Subsystem
+     * @return Step count
+     */
+    uint64_t getOverBudgetSteps(MemoryTag tag) const { return overBudgetSteps[static_cast<int>(tag)]; }
+
+    /**
+     * @brief Keep cold, non-physics data in 16-bit form (off by default)
+     * @param compact True for the compact storage tier
+     *
+     * Applies to the explosion particle pool (17 instead of 60 bytes per
+     * particle, see particles.h); the particles present are converted.
+     * Nothing the physics reads changes.
+     */
+    void setCompactStorage(bool compact) { particles.setCompact(compact); }
+
+    /**
+     * @brief Check the storage tier
+     * @return True if cold data is stored compactly
+     */
+    bool isCompactStorage() const { return particles.isCompact(); }
+
+    /**
+     * @brief Get physics parameters
+     * @return Active physics configuration (theta may be steered by the accuracy monitor)
+     */
+    const PhysicsConfig& getPhysicsConfig() const { return physics; }
+
 private:
     // World properties
     float worldWidth, worldHeight;  ///< Simulation domain size
@@ -286,9 +598,10 @@ private:
     DifficultyConfig difficulty;    ///< Gameplay balance parameters
 
     // Subsystems
+    std::unique_ptr<WorkerPool> workerPool;             ///< Threads shared by parallel subsystems
     std::unique_ptr<IExternalPotential> potential;      ///< Active gravitational potential
-    std::unique_ptr<QuadTree> quadtree;                 ///< Barnes-Hut tree for N-body gravity
-    std::unique_ptr<CollisionDetector> collisionDetector;  ///< Collision detection system
+    std::unique_ptr<QuadTree> quadtree;                 ///< Barnes-Hut tree for N-body gravity (created on first build)
+    std::unique_ptr<CollisionDetector> collisionDetector;  ///< Collision detection system (created on first detection)
     std::unique_ptr<CollisionHandler> collisionHandler;    ///< Collision response system
 
     // Entity collections
@@ -296,14 +609,59 @@ private:
     std::vector<Asteroid> asteroids;    ///< Active asteroids
     std::vector<Bullet> bullets;        ///< Active bullets
     std::vector<BlackHole> blackHoles;  ///< Active black holes
-    std::vector<Particle> particles;    ///< Active explosion particles
+    ParticlePool particles;             ///< Active explosion particles
 
     InputState inputs[2];  ///< Player inputs (index 0 and 1)
 
+    // Collision scratch buffers (kept as members so capacity is reused every frame)
+    std::vector<CollisionPair> collisions;  ///< Pairs from the detector, in detection order
+    std::vector<CollisionPair> collisionBatches[static_cast<int>(CollisionKind::COUNT)];  ///< Pairs bucketed by kind
+    std::vector<Asteroid> spawnedAsteroids;  ///< Fragments created during response, appended after all batches
+    std::vector<int> frameStartLives;        ///< Ship lives before this frame's response (by player; one life lost per frame)
+
+    /// Response function for one batch of same-kind collision pairs
+    using CollisionResolver = void (GameEngine::*)(std::vector<CollisionPair>& batch);
+
+    /// Dispatch table indexed by CollisionKind (also the batch resolution order)
+    static const CollisionResolver collisionResolvers[static_cast<int>(CollisionKind::COUNT)];
+
     int nextEntityId;  ///< Counter for unique entity IDs
+    bool collisionsEnabled;  ///< If false, handleCollisions is skipped
+    bool worldPending;       ///< Deferred reset() not yet run (see constructor)
+
+    EnergyDiagnostics diagnostics;     ///< Conservation totals from the last step
+    ForceAccuracyMonitor accuracyMonitor;  ///< Samples tree force error against direct summation
+    float configuredTheta;             ///< Opening angle before adaptive theta steered it (restored by reset)
+    RadialProfiler profiler;           ///< Radial profiles about the potential centre
+    TimestepController timestep;       ///< Chooses each step's dt (fixed unless enabled)
+    float stepDt;                      ///< dt of the step in progress
+    double stepLimit;                  ///< Longest step allowed (stepToward target distance, else infinity)
+    bool stepSynced;                   ///< The last step landed exactly on stepLimit
+    KeplerConfig kepler;               ///< Kepler drift settings
+    KeplerStats keplerStats;           ///< Kepler drift counters
+    std::vector<int> keplerHosts;      ///< Host index in gravityBodies per body this step (-1 = linear; empty = none)
+    std::vector<int64_t> taskKeplerCounts;  ///< Drifts, fallbacks and iterations per drift task
+    std::vector<Vec2> keplerShift;     ///< Kepler drift displacement beyond linear, per body (host: summed recoil)
+    std::vector<Vec2> keplerKick;      ///< Kepler drift velocity change share, per body (host: summed recoil)
+    std::vector<Body*> gravityBodies;  ///< Scratch list of gravitating bodies (reused every step)
+    std::vector<float> bodyPotential;  ///< Tree potential per gravity body from the closing half-kick
+    ForceBalancer forceBalancer;       ///< Splits force loops into cost-balanced Morton ranges
+    std::vector<long long> taskInteractions;  ///< Interactions per force task (one writer each)
+    StepProfile profile;               ///< Phase timings of the last step
+    LatencyTracker latency;            ///< Histograms of whole-step times
+    int64_t memoryBudgets[kMemoryTagCount];     ///< Heap budget per tag in bytes (0 = unlimited)
+    uint64_t overBudgetSteps[kMemoryTagCount];  ///< Steps that ended over budget, per tag
+    uint32_t memoryPressure;                    ///< Tags over budget after the last step (bit per tag)
 
     // Game logic methods
 
+    /**
+     * @brief Run the deferred reset() if the world has not been populated yet
+     */
+    void ensureWorld() {
+        if (worldPending) reset();
+    }
+
     /**
      * @brief Spawn asteroids at start of wave
      *
@@ -336,22 +694,120 @@ private:
      */
     void updateEntities();
 
+    /**
+     * @brief Choose the dt of the step about to run
+     * @return Fixed dt, or the adaptive controller's choice from the bodies' state
+     */
+    float chooseTimestep();
+
     /**
      * @brief Apply gravitational forces and integrate motion
      *
      * Uses leapfrog integrator with Barnes-Hut tree for N-body gravity
      * plus acceleration from external potential. Particles skip gravity.
+     * The closing half-kick also records each body's tree potential, from
+     * which the conservation diagnostics are reduced.
      */
     void applyPhysics();
 
+    /**
+     * @brief Evaluate gravity on every body and apply a half-kick
+     * @param bodies Gravitating bodies (tree must be built over them)
+     * @param outPotential Optional per-body tree potential (indexed like bodies)
+     * @return Load imbalance of the parallel loop
+     *
+     * The loop is split into contiguous Morton ranges of equal measured
+     * cost (see ForceBalancer); each body's interaction count is stored
+     * in Body::cost as next step's weight. Every body is written by
+     * exactly one task, so results do not depend on the thread count.
+     */
+    double kickBodies(std::vector<Body*>& bodies, std::vector<float>* outPotential);
+
+    /**
+     * @brief Choose which bodies Kepler-drift about which black hole this step
+     * @param bodies Gravitating bodies (black holes last)
+     *
+     * Fills keplerHosts and Body::keplerHost. A body qualifies when it is
+     * bound to a black hole and that hole's pull exceeds
+     * KeplerConfig::dominance times everything else acting on it (taken
+     * from the acceleration of the previous step); the hole pulling
+     * hardest wins.
+     */
+    void assignKeplerHosts(std::vector<Body*>& bodies);
+
+    /**
+     * @brief Drift the bodies in keplerHosts along their exact orbits about their hosts
+     * @param bodies Gravitating bodies (hosts not yet drifted)
+     *
+     * Each body and its host move as an isolated two-body system
+     * (μ = G (M + m)) whose centre of mass drifts linearly, so momentum is
+     * conserved. The hosts' recoil is collected in keplerShift/keplerKick.
+     */
+    void driftKeplerBodies(std::vector<Body*>& bodies);
+
+    /**
+     * @brief Add the recoil collected by driftKeplerBodies to the hosts
+     * @param bodies Gravitating bodies (hosts already drifted linearly)
+     */
+    void applyKeplerRecoil(std::vector<Body*>& bodies);
+
+    /**
+     * @brief Replace the softened host potential by the Newtonian one in the diagnostics
+     * @param bodies Gravitating bodies
+     *
+     * Kepler-drifted pairs interact through the unsoftened 1/r potential,
+     * so that is the energy the integrator conserves.
+     */
+    void correctKeplerPotential(std::vector<Body*>& bodies);
+
     /**
      * @brief Detect and respond to all collisions
      *
-     * Runs collision detection then processes all collision pairs with
-     * appropriate responses (damage, merging, splitting, scoring).
+     * Runs collision detection, buckets the pairs by CollisionKind and
+     * resolves each bucket as a batch through collisionResolvers. Batches are
+     * sorted by entity id so the outcome does not depend on detection order,
+     * and fragments spawned by splits are held back in spawnedAsteroids until
+     * every batch is done (pairs hold pointers into the asteroid vector).
      */
     void handleCollisions();
 
+    /**
+     * @brief Resolve a batch of ship-asteroid collisions
+     * @param batch Pairs sorted by (ship id, asteroid id)
+     *
+     * A ship hit by several asteroids in one frame loses a single life.
+     */
+    void resolveShipAsteroid(std::vector<CollisionPair>& batch);
+
+    /**
+     * @brief Resolve a batch of ship-ship collisions
+     * @param batch Pairs sorted by (ship id, ship id)
+     */
+    void resolveShipShip(std::vector<CollisionPair>& batch);
+
+    /**
+     * @brief Resolve a batch of asteroid-asteroid collisions
+     * @param batch Pairs sorted by (asteroid id, asteroid id)
+     */
+    void resolveAsteroidAsteroid(std::vector<CollisionPair>& batch);
+
+    /**
+     * @brief Resolve a batch of bullet-asteroid hits and award score
+     * @param batch Pairs sorted by (asteroid id, bullet id)
+     *
+     * When several bullets hit the same asteroid in one frame, the bullet
+     * with the lowest id splits it; the others fly on.
+     */
+    void resolveBulletAsteroid(std::vector<CollisionPair>& batch);
+
+    /**
+     * @brief Resolve a batch of black hole accretions
+     * @param batch Pairs sorted by (body id, distance, black hole id)
+     *
+     * A body inside several accretion radii is taken by the nearest black hole.
+     */
+    void resolveAccretion(std::vector<CollisionPair>& batch);
+
     /**
      * @brief Remove inactive entities
      *
@@ -360,6 +816,11 @@ private:
      */
     void cleanupInactive();
 
+    /**
+     * @brief Compare tag usage with the budgets and apply or lift degradations
+     */
+    void enforceMemoryBudgets();
+
     /**
      * @brief Check if wave is complete and spawn next wave
      *
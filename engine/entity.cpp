@@ -86,9 +86,10 @@ void Ship::update(float dt) {
 Asteroid::Asteroid() {
     type = EntityType::ASTEROID;
     wraps = true;
-    vertices = 8;
+    vertices = 0;
     rotation = 0;
     rotationSpeed = 0;
+    shapeSeed = 0;
 }
 
 void Asteroid::init(int entityId, Vec2 position, Vec2 velocity, int asteroidSize, float baseMass) {
@@ -130,7 +131,11 @@ void Asteroid::init(int entityId, Vec2 position, Vec2 velocity, int asteroidSize
             mass = baseMass * 0.75f;
     }
 
-    rotationSpeed = (rand() % 100 - 50) * 0.01f;
+    // Outline and spin depend only on the id, so every run and client agrees on them
+    shapeSeed = (uint32_t)entityId * 2654435761U;
+    generateAsteroidShape(shapeSeed, shape);
+    vertices = shape.count;
+    rotationSpeed = ((int)((shapeSeed >> 16) % 100) - 50) * 0.01f;
 }
 
 void Asteroid::update(float dt) {
@@ -8,7 +8,8 @@
  */
 
 #pragma once
-#include "vec2.h"
+#include "vecn.h"
+#include "polygon.h"
 #include <vector>
 #include <cstdint>
 
@@ -38,17 +39,19 @@ enum class EntityType {
 struct Body {
     Vec2 pos;           ///< Position in world coordinates
     Vec2 vel;           ///< Velocity vector
-    Vec2 acc;           ///< Acceleration (reset each timestep)
+    Vec2 acc;           ///< Acceleration (reset each timestep; without Kepler-drifted body-host pulls)
     float mass;         ///< Mass for gravitational interactions
     EntityType type;    ///< Entity classification
     bool wraps;         ///< If true, position wraps at periodic boundaries
     bool active;        ///< If false, entity is marked for deletion
     int id;             ///< Unique identifier
+    float cost;         ///< Tree interactions at the last force evaluation (load-balancing weight)
+    int keplerHost;     ///< Id of the black hole this body Kepler-drifts about (-1 = none, see kepler.h)
 
     /**
      * @brief Default constructor - initializes to inactive asteroid
      */
-    Body() : mass(0), type(EntityType::ASTEROID), wraps(true), active(true), id(0) {}
+    Body() : mass(0), type(EntityType::ASTEROID), wraps(true), active(true), id(0), cost(0), keplerHost(-1) {}
 };
 
 /**
@@ -124,13 +127,19 @@ struct Ship : public Body {
  * destroyed completely. Asteroids can merge through collisions, combining
  * their masses and momenta. They participate in N-body gravity and can
  * create dramatic gravitational dynamics.
+ *
+ * Each asteroid owns a jagged polygon outline generated from shapeSeed
+ * (derived from its id), so the outline is reproducible and identical on
+ * every client.
  */
 struct Asteroid : public Body {
     float radius;          ///< Collision and visual radius
     int size;              ///< Size class: 0=large, 1=medium, 2=small
-    int vertices;          ///< Number of vertices for polygon rendering
-    float rotation;        ///< Current rotation angle for visual variety
+    int vertices;          ///< Number of vertices of the outline (shape.count)
+    float rotation;        ///< Current rotation angle (applied to the outline)
     float rotationSpeed;   ///< Angular velocity (radians/second)
+    uint32_t shapeSeed;    ///< Seed the outline was generated from
+    AsteroidShape shape;   ///< Polygon outline used for rendering and narrowphase collision
 
     /**
      * @brief Default constructor
@@ -0,0 +1,82 @@
+/**
+ * @file half.cpp
+ * @brief Batch conversions for the 16-bit storage formats
+ *
+ * The portable binary16 loops compute every case and select with masks
+ * instead of branching, so GCC and Clang vectorise them (SSE2 natively,
+ * wasm SIMD with -msimd128). They give the same bits as the scalar
+ * conversions; the F16C path differs only in NaN payloads.
+ */
+
+#include "half.h"
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+void floatToHalf(const float* in, uint16_t* out, size_t count) {
+    size_t i = 0;
+#if defined(__F16C__)
+    for (; i + 8 <= count; i += 8) {
+        __m128i packed = _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+    }
+#endif
+    const uint32_t magicBits = (uint32_t)((127 - 15) + (23 - 10) + 1) << 23;
+    float magic;
+    std::memcpy(&magic, &magicBits, sizeof(magic));
+    for (; i < count; i++) {
+        uint32_t f;
+        std::memcpy(&f, &in[i], sizeof(f));
+        uint32_t sign = f & 0x80000000u;
+        f ^= sign;
+        // Subnormal result: let the FPU round by adding 0.5
+        float shifted;
+        std::memcpy(&shifted, &f, sizeof(shifted));
+        shifted += magic;
+        uint32_t subnormal;
+        std::memcpy(&subnormal, &shifted, sizeof(subnormal));
+        subnormal -= magicBits;
+        // Normal result: rebias and round the mantissa to 10 bits (ties to even)
+        uint32_t normal = (f + ((uint32_t)(15 - 127) << 23) + 0xfffu + ((f >> 13) & 1u)) >> 13;
+        uint32_t isSubnormal = 0u - (uint32_t)(f < 0x38800000u);
+        uint32_t isOverflow = 0u - (uint32_t)(f >= 0x47800000u);
+        uint32_t isNan = 0u - (uint32_t)(f > 0x7f800000u);
+        uint32_t half = (subnormal & isSubnormal) | (normal & ~isSubnormal);
+        half = (0x7c00u & isOverflow) | (half & ~isOverflow);
+        half |= 0x0200u & isNan;
+        out[i] = (uint16_t)(half | (sign >> 16));
+    }
+}
+
+void halfToFloat(const uint16_t* in, float* out, size_t count) {
+    size_t i = 0;
+#if defined(__F16C__)
+    for (; i + 8 <= count; i += 8) {
+        __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm256_storeu_ps(out + i, _mm256_cvtph_ps(packed));
+    }
+#endif
+    // Scaling by 2^112 rebiases normals and renormalises subnormals exactly
+    const uint32_t scaleBits = (uint32_t)(254 - 15) << 23;
+    float scale;
+    std::memcpy(&scale, &scaleBits, sizeof(scale));
+    for (; i < count; i++) {
+        uint32_t bits = (uint32_t)(in[i] & 0x7fffu) << 13;
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        value *= scale;
+        std::memcpy(&bits, &value, sizeof(bits));
+        bits |= 0x7f800000u & (0u - (uint32_t)((in[i] & 0x7c00u) == 0x7c00u));  // infinity / NaN
+        bits |= (uint32_t)(in[i] & 0x8000u) << 16;
+        std::memcpy(&out[i], &bits, sizeof(bits));
+    }
+}
+
+void floatToUnorm16(const float* in, uint16_t* out, size_t count) {
+    for (size_t i = 0; i < count; i++) out[i] = floatToUnorm16(in[i]);
+}
+
+void unorm16ToFloat(const uint16_t* in, float* out, size_t count) {
+    for (size_t i = 0; i < count; i++) out[i] = unorm16ToFloat(in[i]);
+}
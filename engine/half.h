@@ -0,0 +1,135 @@
+/**
+ * @file half.h
+ * @brief 16-bit storage formats for cold, non-physics data
+ *
+ * Two formats, both converted to and from float at the edges of the code
+ * that stores them:
+ *
+ * - IEEE 754 binary16 ("half"): 11 significant bits, range ±65504. Good for
+ *   values with a wide range and a relative tolerance, such as particle
+ *   velocities (0.05 % error) and lifetimes.
+ * - unorm16: a fraction in [0, 1] in steps of 1/65535. Good for values with
+ *   a known range and an absolute tolerance, such as fade fractions.
+ *
+ * Nothing the physics reads is stored this way; gravitating bodies keep
+ * full floats. The batch conversions work on contiguous arrays, so a pool
+ * is converted a block at a time rather than one value per access; the
+ * binary16 ones and the unorm16 decode compile to SIMD code (F16C on x86
+ * when the compiler targets it, otherwise branch-free vectorised loops).
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @brief Convert a float to binary16, rounding to nearest even
+ * @param value Value (beyond ±65504 becomes ±infinity, NaN stays NaN)
+ * @return binary16 bits
+ */
+inline uint16_t floatToHalf(float value) {
+    uint32_t f;
+    std::memcpy(&f, &value, sizeof(f));
+    uint32_t sign = f & 0x80000000u;
+    f ^= sign;
+    uint32_t half;
+    if (f >= 0x47800000u) {
+        // Too large for binary16 (or already infinite / NaN)
+        half = f > 0x7f800000u ? 0x7e00u : 0x7c00u;
+    } else if (f < 0x38800000u) {
+        // Subnormal or zero in binary16: let the FPU round by adding 0.5
+        const uint32_t magicBits = (uint32_t)((127 - 15) + (23 - 10) + 1) << 23;
+        float magic, shifted;
+        std::memcpy(&magic, &magicBits, sizeof(magic));
+        std::memcpy(&shifted, &f, sizeof(shifted));
+        shifted += magic;
+        std::memcpy(&half, &shifted, sizeof(half));
+        half -= magicBits;
+    } else {
+        // Normal: rebias the exponent and round the mantissa to 10 bits (ties to even)
+        uint32_t odd = (f >> 13) & 1u;
+        f += ((uint32_t)(15 - 127) << 23) + 0xfffu + odd;
+        half = f >> 13;
+    }
+    return (uint16_t)(half | (sign >> 16));
+}
+
+/**
+ * @brief Convert binary16 to float (exact)
+ * @param half binary16 bits
+ * @return Value
+ */
+inline float halfToFloat(uint16_t half) {
+    const uint32_t shiftedExp = 0x7c00u << 13;
+    uint32_t bits = (uint32_t)(half & 0x7fffu) << 13;
+    uint32_t exp = bits & shiftedExp;
+    bits += (uint32_t)(127 - 15) << 23;
+    if (exp == shiftedExp) {
+        bits += (uint32_t)(128 - 16) << 23;  // infinity / NaN
+    } else if (exp == 0) {
+        // Subnormal: renormalise through the FPU
+        const uint32_t magicBits = 113u << 23;
+        float magic, value;
+        bits += 1u << 23;
+        std::memcpy(&magic, &magicBits, sizeof(magic));
+        std::memcpy(&value, &bits, sizeof(value));
+        value -= magic;
+        std::memcpy(&bits, &value, sizeof(bits));
+    }
+    bits |= (uint32_t)(half & 0x8000u) << 16;
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Convert a fraction to unorm16
+ * @param value Fraction (clamped to [0, 1]; NaN becomes 0)
+ * @return Nearest multiple of 1/65535
+ */
+inline uint16_t floatToUnorm16(float value) {
+    float clamped = value > 0.0f ? (value < 1.0f ? value : 1.0f) : 0.0f;
+    return (uint16_t)(clamped * 65535.0f + 0.5f);
+}
+
+/**
+ * @brief Convert unorm16 to a fraction
+ * @param value unorm16 value
+ * @return value / 65535
+ */
+inline float unorm16ToFloat(uint16_t value) {
+    return (float)value * (1.0f / 65535.0f);
+}
+
+/**
+ * @brief Convert an array of floats to binary16
+ * @param in Values
+ * @param out Output bits (may not alias in)
+ * @param count Number of values
+ */
+void floatToHalf(const float* in, uint16_t* out, size_t count);
+
+/**
+ * @brief Convert an array of binary16 values to float
+ * @param in binary16 bits
+ * @param out Output values (may not alias in)
+ * @param count Number of values
+ */
+void halfToFloat(const uint16_t* in, float* out, size_t count);
+
+/**
+ * @brief Convert an array of fractions to unorm16
+ * @param in Fractions (clamped to [0, 1])
+ * @param out Output values
+ * @param count Number of values
+ */
+void floatToUnorm16(const float* in, uint16_t* out, size_t count);
+
+/**
+ * @brief Convert an array of unorm16 values to fractions
+ * @param in unorm16 values
+ * @param out Output fractions
+ * @param count Number of values
+ */
+void unorm16ToFloat(const uint16_t* in, float* out, size_t count);
@@ -0,0 +1,88 @@
+/**
+ * @file kepler.cpp
+ * @brief Universal-variable Kepler solver
+ */
+
+#include "kepler.h"
+#include <cmath>
+
+/**
+ * @brief Stumpff functions c2(ψ) and c3(ψ)
+ * @param psi Argument α χ²
+ * @param c2 Output: (1 - cos √ψ) / ψ
+ * @param c3 Output: (√ψ - sin √ψ) / ψ^(3/2)
+ */
+static void stumpff(double psi, double& c2, double& c3) {
+    if (psi > 1e-4) {
+        double s = std::sqrt(psi);
+        c2 = (1.0 - std::cos(s)) / psi;
+        c3 = (s - std::sin(s)) / (psi * s);
+    } else if (psi < -1e-4) {
+        double s = std::sqrt(-psi);
+        c2 = (std::cosh(s) - 1.0) / -psi;
+        c3 = (std::sinh(s) - s) / (-psi * s);
+    } else {
+        // Series near ψ = 0 (the closed forms cancel catastrophically there)
+        c2 = 0.5 - psi * (1.0 / 24.0 - psi / 720.0);
+        c3 = 1.0 / 6.0 - psi * (1.0 / 120.0 - psi / 5040.0);
+    }
+}
+
+bool keplerDrift(Vec2& pos, Vec2& vel, double mu, double dt, int& outIterations) {
+    outIterations = 0;
+    const double kPi = 3.14159265358979323846;
+    double x0 = pos.x, y0 = pos.y, vx0 = vel.x, vy0 = vel.y;
+    double r0 = std::sqrt(x0 * x0 + y0 * y0);
+    if (!(mu > 0) || !(r0 > 0)) return false;
+    double v2 = vx0 * vx0 + vy0 * vy0;
+    double sqrtMu = std::sqrt(mu);
+    double sigma = (x0 * vx0 + y0 * vy0) / sqrtMu;  // r·v / √μ
+    double alpha = 2.0 / r0 - v2 / mu;              // 1 / semi-major axis
+
+    // Whole periods of a bound orbit change nothing
+    if (alpha > 0) {
+        double period = 2.0 * kPi / (alpha * std::sqrt(alpha * mu));
+        dt = std::fmod(dt, period);
+    }
+
+    // Solve √μ dt = χ³c3 + σχ²c2 + r0 χ(1 - ψc3) for χ (Laguerre-Conway, robust for any orbit)
+    double chi = alpha > 0 ? sqrtMu * dt * alpha : sqrtMu * dt / r0;
+    const int kMaxIterations = 50;
+    const double n = 5.0;
+    double c2 = 0.5, c3 = 1.0 / 6.0, psi = 0, r = r0;
+    bool converged = false;
+    for (int it = 0; it < kMaxIterations; it++) {
+        outIterations = it + 1;
+        psi = chi * chi * alpha;
+        stumpff(psi, c2, c3);
+        double chi2 = chi * chi;
+        double f = chi2 * chi * c3 + sigma * chi2 * c2 + r0 * chi * (1.0 - psi * c3) - sqrtMu * dt;
+        r = chi2 * c2 + sigma * chi * (1.0 - psi * c3) + r0 * (1.0 - psi * c2);  // df/dχ
+        double ddf = sigma * (1.0 - psi * c2) + (1.0 - r0 * alpha) * chi * (1.0 - psi * c3);
+        double root = std::sqrt(std::fabs((n - 1.0) * (n - 1.0) * r * r - n * (n - 1.0) * f * ddf));
+        double denom = r > 0 ? r + root : r - root;
+        if (denom == 0) break;
+        double delta = n * f / denom;
+        chi -= delta;
+        if (std::fabs(delta) <= 1e-12 * (1.0 + std::fabs(chi))) {
+            converged = true;
+            break;
+        }
+    }
+    if (!converged || !std::isfinite(chi)) return false;
+
+    // Final r and Lagrange coefficients at the converged χ
+    psi = chi * chi * alpha;
+    stumpff(psi, c2, c3);
+    double chi2 = chi * chi;
+    r = chi2 * c2 + sigma * chi * (1.0 - psi * c3) + r0 * (1.0 - psi * c2);
+    if (!(r > 0)) return false;
+    double f = 1.0 - chi2 * c2 / r0;
+    double g = dt - chi2 * chi * c3 / sqrtMu;
+    double fDot = sqrtMu / (r * r0) * chi * (psi * c3 - 1.0);
+    double gDot = 1.0 - chi2 * c2 / r;
+
+    pos = Vec2((float)(f * x0 + g * vx0), (float)(f * y0 + g * vy0));
+    vel = Vec2((float)(fDot * x0 + gDot * vx0), (float)(fDot * y0 + gDot * vy0));
+    return true;
+}
@@ -0,0 +1,87 @@
+/**
+ * @file kepler.h
+ * @brief Analytic Kepler drift for bodies bound to a black hole
+ *
+ * A body deep in a black hole's potential well moves on a nearly
+ * Keplerian orbit whose pericentre passages need tiny steps with a plain
+ * kick-drift-kick. With Kepler drift enabled GameEngine splits such a
+ * body's motion the way mixed-variable symplectic (Wisdom-Holman)
+ * integrators do:
+ *
+ *     kick   v += (a - a_pair) dt/2      everything except the body-host pull
+ *     drift  two-body motion of body and host, solved exactly for dt
+ *     kick   v += (a - a_pair) dt/2
+ *
+ * The drift advances the position and velocity relative to the host with
+ * the universal-variable solution (f and g functions, Stumpff c2/c3), so
+ * it is exact for elliptic, parabolic and hyperbolic arcs and for any dt.
+ * It uses μ = G (M_host + m): the pair's centre of mass drifts linearly and
+ * the host recoils by the body's share of the orbital motion, so momentum
+ * is conserved. The host drifts linearly itself and adds up the recoil of
+ * every body bound to it (accurate while the bodies are light next to it).
+ *
+ * A body drifts about a host when it is bound to it and the host's pull
+ * exceeds `dominance` times everything else acting on it; bodies are
+ * reassigned at the start of every step (the choice is fixed for the whole
+ * kick-drift-kick, which keeps the step symmetric). Hosts themselves and
+ * unbound bodies drift linearly as before. The host's force inside the
+ * drift is unsoftened; the kicks remove the softened host force the tree
+ * applied, so a close pass is integrated exactly instead of softened.
+ *
+ * Switching a body between the softened and the exact host potential
+ * changes its energy by the difference of the two, which is large deep in
+ * the well: a body that left Kepler drift near pericentre would keep its
+ * unsoftened speed in the shallow softened well and fly off. So a body only
+ * starts or stops Kepler drift while it is more than `switchRadius`
+ * softening lengths from the host, where the two potentials agree to about
+ * 1 %; closer in it keeps the choice it had.
+ */
+
+#pragma once
+#include "vecn.h"
+#include <cstdint>
+
+/**
+ * @struct KeplerConfig
+ * @brief Parameters of the Kepler drift
+ */
+struct KeplerConfig {
+    bool enabled;     ///< Kepler-drift bound bodies (false = linear drift for all)
+    float dominance;  ///< Host pull / all other acceleration needed to drift about the host
+    float switchRadius;  ///< Bodies closer to a host than this many softening lengths keep their choice
+
+    /**
+     * @brief Default constructor - off; host must dominate tenfold when enabled
+     */
+    KeplerConfig() : enabled(false), dominance(10.0f), switchRadius(8.0f) {}
+};
+
+/**
+ * @struct KeplerStats
+ * @brief Kepler drift counters
+ */
+struct KeplerStats {
+    int bodies;              ///< Bodies Kepler-drifted in the last step
+    int64_t drifts;          ///< Kepler drifts since reset
+    int64_t fallbacks;       ///< Drifts whose solver did not converge (drifted linearly instead)
+    int64_t iterations;      ///< Solver iterations since reset
+
+    /**
+     * @brief Default constructor - nothing drifted yet
+     */
+    KeplerStats() : bodies(0), drifts(0), fallbacks(0), iterations(0) {}
+};
+
+/**
+ * @brief Advance a two-body relative orbit exactly
+ * @param pos Position relative to the host (updated)
+ * @param vel Velocity relative to the host (updated)
+ * @param mu Gravitational parameter G M of the host
+ * @param dt Time to advance
+ * @param outIterations Solver iterations used
+ * @return False (pos and vel untouched) if the solver did not converge
+ *
+ * Works in double precision; elliptic orbits are first reduced modulo
+ * their period, so long steps cost no more than short ones.
+ */
+bool keplerDrift(Vec2& pos, Vec2& vel, double mu, double dt, int& outIterations);
@@ -0,0 +1,167 @@
+/**
+ * @file latency.cpp
+ * @brief Implementation of step-latency histograms and outlier tracking
+ */
+
+#include "latency.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+/// Steps recorded before outliers are reported (first steps run on cold caches)
+static constexpr uint64_t kWarmupSteps = 32;
+
+const char* stepPhaseName(StepPhase phase) {
+    switch (phase) {
+        case StepPhase::ENTITIES: return "entities";
+        case StepPhase::GRAVITY: return "gravity";
+        case StepPhase::ANALYSIS: return "analysis";
+        case StepPhase::COLLISIONS: return "collisions";
+        case StepPhase::CLEANUP: return "cleanup";
+    }
+    return "unknown";
+}
+
+void LatencyHistogram::clear() {
+    std::memset(counts, 0, sizeof(counts));
+    count = 0;
+    sum = 0;
+    maxValue = 0;
+}
+
+int LatencyHistogram::bucketIndex(uint64_t value) {
+    // Values below 2 * kSubBuckets map one to one; above, each octave
+    // [2^k, 2^(k+1)) is split into kSubBuckets equal parts
+    if (value < 2 * kSubBuckets) return (int)value;
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - kSubBucketBits;
+    return shift * kSubBuckets + (int)(value >> shift);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int index) {
+    if (index < 2 * kSubBuckets) return (uint64_t)index;
+    int shift = index / kSubBuckets - 1;
+    uint64_t mantissa = (uint64_t)(index % kSubBuckets + kSubBuckets);
+    return ((mantissa + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t nanoseconds) {
+    uint64_t value = std::min(nanoseconds, kMaxValue);
+    counts[bucketIndex(value)]++;
+    count++;
+    sum += value;
+    maxValue = std::max(maxValue, value);
+}
+
+void LatencyHistogram::add(const LatencyHistogram& other) {
+    for (int i = 0; i < kBuckets; i++) counts[i] += other.counts[i];
+    count += other.count;
+    sum += other.sum;
+    maxValue = std::max(maxValue, other.maxValue);
+}
+
+uint64_t LatencyHistogram::valueAtPercentile(double percentile) const {
+    if (count == 0) return 0;
+    double p = std::min(100.0, std::max(0.0, percentile));
+    uint64_t target = std::max<uint64_t>(1, (uint64_t)std::ceil(p / 100.0 * (double)count));
+    uint64_t seen = 0;
+    for (int i = 0; i < kBuckets; i++) {
+        seen += counts[i];
+        if (seen >= target) return std::min(bucketUpperBound(i), maxValue);
+    }
+    return maxValue;
+}
+
+LatencyTracker::LatencyTracker() {
+    reset();
+}
+
+void LatencyTracker::setConfig(const LatencyConfig& config) {
+    this->config = config;
+    this->config.window = std::max(1, config.window);
+    reset();
+}
+
+void LatencyTracker::reset() {
+    for (LatencyHistogram& histogram : histograms) histogram.clear();
+    std::memset(outlierCounts, 0, sizeof(outlierCounts));
+    outlierHead = 0;
+    outlierCount = 0;
+    steps = 0;
+    windowSteps = 0;
+    thresholdNs = 0;
+    medianNs = 0;
+}
+
+void LatencyTracker::updateThreshold(const LatencyHistogram& histogram) {
+    medianNs = histogram.valueAtPercentile(50.0);
+    uint64_t floorNs = (uint64_t)(config.minOutlierMs * 1e6);
+    thresholdNs = std::max((uint64_t)(medianNs * (double)config.outlierFactor), floorNs);
+}
+
+void LatencyTracker::record(double totalSeconds, const double phaseSeconds[kStepPhaseCount]) {
+    uint64_t ns = (uint64_t)std::max(0.0, totalSeconds * 1e9);
+    LatencyHistogram& current = histograms[(int)LatencyScope::CURRENT];
+    LatencyHistogram& total = histograms[(int)LatencyScope::TOTAL];
+    current.record(ns);
+    total.record(ns);
+    steps++;
+
+    // Until a window completes the threshold follows the running median
+    bool haveWindow = histograms[(int)LatencyScope::WINDOW].getCount() > 0;
+    if (!haveWindow && steps >= kWarmupSteps && steps % kWarmupSteps == 0) updateThreshold(total);
+
+    if (thresholdNs > 0 && ns > thresholdNs) {
+        int dominant = 0;
+        for (int i = 1; i < kStepPhaseCount; i++) {
+            if (phaseSeconds[i] > phaseSeconds[dominant]) dominant = i;
+        }
+        outlierCounts[(int)LatencyScope::CURRENT][dominant]++;
+        outlierCounts[(int)LatencyScope::TOTAL][dominant]++;
+
+        LatencyOutlier& entry = outlierLog[outlierHead];
+        entry.step = steps - 1;
+        entry.totalMs = (float)(totalSeconds * 1000.0);
+        entry.phaseMs = (float)(phaseSeconds[dominant] * 1000.0);
+        entry.medianMs = (float)(medianNs * 1e-6);
+        entry.phase = static_cast<StepPhase>(dominant);
+        outlierHead = (outlierHead + 1) % kOutlierLog;
+        outlierCount = std::min(outlierCount + 1, kOutlierLog);
+    }
+
+    // Roll the window: the completed one becomes the snapshot and the new baseline
+    if (++windowSteps >= config.window) {
+        histograms[(int)LatencyScope::WINDOW] = current;
+        std::memcpy(outlierCounts[(int)LatencyScope::WINDOW], outlierCounts[(int)LatencyScope::CURRENT],
+                    sizeof(outlierCounts[0]));
+        std::memset(outlierCounts[(int)LatencyScope::CURRENT], 0, sizeof(outlierCounts[0]));
+        current.clear();
+        windowSteps = 0;
+        updateThreshold(histograms[(int)LatencyScope::WINDOW]);
+    }
+}
+
+LatencySummary LatencyTracker::getSummary(LatencyScope scope) const {
+    const LatencyHistogram& histogram = getHistogram(scope);
+    LatencySummary summary;
+    summary.steps = histogram.getCount();
+    summary.meanMs = histogram.getMean() * 1e-6;
+    summary.p50Ms = histogram.valueAtPercentile(50.0) * 1e-6;
+    summary.p90Ms = histogram.valueAtPercentile(90.0) * 1e-6;
+    summary.p99Ms = histogram.valueAtPercentile(99.0) * 1e-6;
+    summary.p999Ms = histogram.valueAtPercentile(99.9) * 1e-6;
+    summary.maxMs = histogram.getMax() * 1e-6;
+    for (int i = 0; i < kStepPhaseCount; i++) {
+        summary.phaseOutliers[i] = outlierCounts[(int)scope][i];
+        summary.outliers += outlierCounts[(int)scope][i];
+    }
+    return summary;
+}
+
+const LatencyHistogram& LatencyTracker::getHistogram(LatencyScope scope) const {
+    return histograms[(int)scope];
+}
+
+const LatencyOutlier& LatencyTracker::getOutlier(int index) const {
+    return outlierLog[(outlierHead - 1 - index + 2 * kOutlierLog) % kOutlierLog];
+}
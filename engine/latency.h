@@ -0,0 +1,275 @@
+/**
+ * @file latency.h
+ * @brief Step-latency histograms with windowed snapshots and outlier tagging
+ *
+ * Mean steps per second hides the hitches a player feels (a wave spawn, a
+ * large explosion, a vector regrowing). LatencyTracker keeps an HDR-style
+ * histogram of whole-step durations so tail percentiles are available at
+ * any time without storing samples.
+ *
+ * Buckets are log-linear: 32 linear sub-buckets per power of two of
+ * nanoseconds, so every recorded value is reported within 1/32 (3.1%)
+ * of its true value from 1 ns up to 68 s. A histogram is 1024 counters
+ * (4 KB); recording is a bit scan and an increment.
+ *
+ * Three histograms are kept: the window being filled, the last completed
+ * window (a snapshot, every `window` steps) and everything since reset.
+ *
+ * A step is an outlier when it takes longer than outlierFactor times the
+ * median of the last completed window (the running median before the
+ * first window completes) and at least minOutlierMs. Each outlier is
+ * tagged with the phase that took longest in that step.
+ */
+
+#pragma once
+#include <cstdint>
+
+/// Number of phases a step is split into (see StepPhase)
+constexpr int kStepPhaseCount = 5;
+
+/**
+ * @enum StepPhase
+ * @brief Step phases, in execution order (matches StepProfile)
+ */
+enum class StepPhase {
+    ENTITIES = 0,    ///< Entity timers and input handling
+    GRAVITY = 1,     ///< Tree builds, half-kicks and drift
+    ANALYSIS = 2,    ///< Diagnostics, force accuracy sampling and radial profiles
+    COLLISIONS = 3,  ///< Collision detection and response
+    CLEANUP = 4      ///< Spawning, cleanup and wave progression
+};
+
+/**
+ * @brief Get a phase's display name
+ * @param phase Phase
+ * @return Static lowercase name
+ */
+const char* stepPhaseName(StepPhase phase);
+
+/**
+ * @class LatencyHistogram
+ * @brief Fixed-size log-linear histogram of durations in nanoseconds
+ */
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 5;                        ///< log2 of sub-buckets per octave
+    static constexpr int kSubBuckets = 1 << kSubBucketBits;         ///< Sub-buckets per octave
+    static constexpr int kBuckets = 1024;                           ///< Total counters
+    static constexpr uint64_t kMaxValue = (1ULL << 36) - 1;         ///< Largest distinguishable value (~68 s)
+
+    /**
+     * @brief Default constructor - empty histogram
+     */
+    LatencyHistogram() { clear(); }
+
+    /**
+     * @brief Remove all values
+     */
+    void clear();
+
+    /**
+     * @brief Record one duration
+     * @param nanoseconds Duration (clamped to kMaxValue)
+     */
+    void record(uint64_t nanoseconds);
+
+    /**
+     * @brief Add every value of another histogram
+     * @param other Histogram to merge
+     */
+    void add(const LatencyHistogram& other);
+
+    /**
+     * @brief Get the value at a percentile
+     * @param percentile Percentile in [0, 100]
+     * @return Largest value equivalent to the bucket holding the percentile (0 when empty)
+     */
+    uint64_t valueAtPercentile(double percentile) const;
+
+    /**
+     * @brief Get the number of recorded values
+     * @return Count
+     */
+    uint64_t getCount() const { return count; }
+
+    /**
+     * @brief Get the exact largest recorded value
+     * @return Maximum in nanoseconds (0 when empty)
+     */
+    uint64_t getMax() const { return maxValue; }
+
+    /**
+     * @brief Get the exact mean of recorded values
+     * @return Mean in nanoseconds (0 when empty)
+     */
+    double getMean() const { return count ? (double)sum / count : 0.0; }
+
+    /**
+     * @brief Map a value to its bucket
+     * @param value Value in nanoseconds (at most kMaxValue)
+     * @return Bucket index in [0, kBuckets)
+     */
+    static int bucketIndex(uint64_t value);
+
+    /**
+     * @brief Largest value mapped to a bucket
+     * @param index Bucket index
+     * @return Inclusive upper bound in nanoseconds
+     */
+    static uint64_t bucketUpperBound(int index);
+
+private:
+    uint32_t counts[kBuckets];  ///< Values per bucket
+    uint64_t count;             ///< Total values
+    uint64_t sum;               ///< Sum of values (for the mean)
+    uint64_t maxValue;          ///< Exact maximum
+};
+
+/**
+ * @struct LatencyConfig
+ * @brief Window and outlier parameters for LatencyTracker
+ */
+struct LatencyConfig {
+    int window;           ///< Steps per snapshot window
+    float outlierFactor;  ///< Outlier threshold as a multiple of the median
+    float minOutlierMs;   ///< Steps faster than this are never outliers
+
+    /**
+     * @brief Default constructor - 5 s windows at 120 Hz, outliers above 2x median
+     */
+    LatencyConfig() : window(600), outlierFactor(2.0f), minOutlierMs(1.0f) {}
+};
+
+/**
+ * @enum LatencyScope
+ * @brief Which histogram a summary is taken from
+ */
+enum class LatencyScope {
+    CURRENT = 0,  ///< Window being filled
+    WINDOW = 1,   ///< Last completed window
+    TOTAL = 2     ///< Everything since reset
+};
+
+/**
+ * @struct LatencySummary
+ * @brief Percentiles and outlier counts of one histogram
+ */
+struct LatencySummary {
+    uint64_t steps;                          ///< Steps recorded
+    double meanMs;                           ///< Mean step time
+    double p50Ms;                            ///< Median
+    double p90Ms;                            ///< 90th percentile
+    double p99Ms;                            ///< 99th percentile
+    double p999Ms;                           ///< 99.9th percentile
+    double maxMs;                            ///< Slowest step
+    uint64_t outliers;                       ///< Outlier steps
+    uint64_t phaseOutliers[kStepPhaseCount];  ///< Outliers by dominant phase
+
+    /**
+     * @brief Default constructor - no steps
+     */
+    LatencySummary()
+        : steps(0), meanMs(0), p50Ms(0), p90Ms(0), p99Ms(0), p999Ms(0), maxMs(0), outliers(0),
+          phaseOutliers{} {}
+};
+
+/**
+ * @struct LatencyOutlier
+ * @brief One slow step and the phase that dominated it
+ */
+struct LatencyOutlier {
+    uint64_t step;     ///< Step number since reset (0-based)
+    float totalMs;     ///< Whole step time
+    float phaseMs;     ///< Time of the dominant phase
+    float medianMs;    ///< Median the step was compared against
+    StepPhase phase;   ///< Longest phase of the step
+};
+
+/**
+ * @class LatencyTracker
+ * @brief Records step durations into windowed histograms and logs outliers
+ */
+class LatencyTracker {
+public:
+    static constexpr int kOutlierLog = 32;  ///< Most recent outliers kept
+
+    /**
+     * @brief Default constructor - default configuration, no steps
+     */
+    LatencyTracker();
+
+    /**
+     * @brief Set window and outlier parameters (clears everything)
+     * @param config New configuration
+     */
+    void setConfig(const LatencyConfig& config);
+
+    /**
+     * @brief Get current configuration
+     * @return Active configuration
+     */
+    const LatencyConfig& getConfig() const { return config; }
+
+    /**
+     * @brief Clear histograms, outlier counts and the outlier log
+     */
+    void reset();
+
+    /**
+     * @brief Record one step
+     * @param totalSeconds Whole step time
+     * @param phaseSeconds Time of each phase, indexed by StepPhase
+     */
+    void record(double totalSeconds, const double phaseSeconds[kStepPhaseCount]);
+
+    /**
+     * @brief Summarise one histogram
+     * @param scope Current window, last completed window or total
+     * @return Percentiles, maximum and outlier counts
+     */
+    LatencySummary getSummary(LatencyScope scope) const;
+
+    /**
+     * @brief Get a histogram for custom queries
+     * @param scope Current window, last completed window or total
+     * @return Histogram
+     */
+    const LatencyHistogram& getHistogram(LatencyScope scope) const;
+
+    /**
+     * @brief Get the number of outliers in the log
+     * @return At most kOutlierLog
+     */
+    int getOutlierCount() const { return outlierCount; }
+
+    /**
+     * @brief Get a logged outlier
+     * @param index 0 is the most recent
+     * @return Outlier record
+     */
+    const LatencyOutlier& getOutlier(int index) const;
+
+    /**
+     * @brief Get the number of steps recorded since reset
+     * @return Step count
+     */
+    uint64_t getSteps() const { return steps; }
+
+private:
+    LatencyConfig config;                        ///< Window and outlier parameters
+    LatencyHistogram histograms[3];              ///< Indexed by LatencyScope
+    uint64_t outlierCounts[3][kStepPhaseCount];  ///< Outliers by scope and phase
+    LatencyOutlier outlierLog[kOutlierLog];      ///< Ring of recent outliers
+    int outlierHead;                             ///< Next ring slot
+    int outlierCount;                            ///< Valid ring entries
+    uint64_t steps;                              ///< Steps since reset
+    int windowSteps;                             ///< Steps in the current window
+    uint64_t thresholdNs;                        ///< Current outlier threshold (0 = not yet known)
+    uint64_t medianNs;                           ///< Median the threshold was derived from
+
+    /**
+     * @brief Derive the outlier threshold from a histogram's median
+     * @param histogram Reference histogram
+     */
+    void updateThreshold(const LatencyHistogram& histogram);
+};
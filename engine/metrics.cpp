@@ -0,0 +1,318 @@
+/**
+ * @file metrics.cpp
+ * @brief Prometheus registry, localhost HTTP server and engine metrics (native build)
+ */
+
+#include "metrics.h"
+#include "engine.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/// Phase label values, indexed by StepPhase
+static const char* const kPhaseLabels[kStepPhaseCount] = {
+    "entities", "gravity", "analysis", "collisions", "cleanup"
+};
+
+/// Body type label values, indexed like EngineMetrics::bodies
+static const char* const kBodyLabels[EngineMetrics::kBodyTypes] = {
+    "ship", "asteroid", "bullet", "black_hole", "particle"
+};
+
+/// Latency quantiles published as a summary
+static const double kQuantiles[4] = {0.5, 0.9, 0.99, 0.999};
+
+/**
+ * @brief Prometheus TYPE keyword
+ * @param type Metric type
+ * @return Lowercase type name
+ */
+static const char* typeName(MetricType type) {
+    switch (type) {
+        case MetricType::COUNTER: return "counter";
+        case MetricType::GAUGE: return "gauge";
+        case MetricType::SUMMARY: return "summary";
+    }
+    return "untyped";
+}
+
+void MetricsRegistry::family(const std::string& name, const std::string& help, MetricType type) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const Family& f : families) {
+        if (f.name == name) return;
+    }
+    Family f;
+    f.name = name;
+    f.help = help;
+    f.type = type;
+    families.push_back(std::move(f));
+}
+
+MetricValue* MetricsRegistry::series(const std::string& name, const std::string& labels, const std::string& suffix) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (Family& f : families) {
+        if (f.name != name) continue;
+        Series s;
+        s.labels = labels;
+        s.suffix = suffix;
+        s.value = std::make_unique<MetricValue>();
+        MetricValue* value = s.value.get();
+        f.series.push_back(std::move(s));
+        return value;
+    }
+    return nullptr;
+}
+
+std::string MetricsRegistry::render() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string out;
+    char number[64];
+    for (const Family& f : families) {
+        out += "# HELP " + f.name + " " + f.help + "\n";
+        out += "# TYPE " + f.name + " " + typeName(f.type) + "\n";
+        for (const Series& s : f.series) {
+            out += f.name + s.suffix;
+            if (!s.labels.empty()) out += "{" + s.labels + "}";
+            std::snprintf(number, sizeof(number), " %.12g\n", s.value->get());
+            out += number;
+        }
+    }
+    return out;
+}
+
+MetricsServer::MetricsServer() : listenFd(-1), port(0), registry(nullptr), stopping(false) {}
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+bool MetricsServer::start(int requestedPort, const MetricsRegistry& registry) {
+    stop();
+    listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        std::perror("metrics socket");
+        return false;
+    }
+    int one = 1;
+    ::setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons((uint16_t)requestedPort);
+    socklen_t length = sizeof(addr);
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listenFd, 8) != 0 ||
+        ::getsockname(listenFd, reinterpret_cast<sockaddr*>(&addr), &length) != 0) {
+        std::fprintf(stderr, "metrics: cannot listen on 127.0.0.1:%d: %s\n", requestedPort, std::strerror(errno));
+        ::close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+
+    port = ntohs(addr.sin_port);
+    this->registry = &registry;
+    stopping = false;
+    server = std::thread(&MetricsServer::serveLoop, this);
+    return true;
+}
+
+void MetricsServer::stop() {
+    if (listenFd < 0) return;
+    stopping = true;
+    server.join();
+    ::close(listenFd);
+    listenFd = -1;
+    port = 0;
+}
+
+/**
+ * @brief Send a whole buffer
+ * @param fd Connected socket
+ * @param data Bytes
+ * @param size Byte count
+ */
+static void sendAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t sent = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (sent <= 0) return;
+        data += sent;
+        size -= (size_t)sent;
+    }
+}
+
+void MetricsServer::serveLoop() {
+    pollfd listening = {listenFd, POLLIN, 0};
+    while (!stopping) {
+        // Wake periodically to notice stop()
+        if (::poll(&listening, 1, 200) <= 0) continue;
+        int client = ::accept(listenFd, nullptr, nullptr);
+        if (client < 0) continue;
+
+        // Read the request head; a slow client is dropped after one second
+        timeval timeout = {1, 0};
+        ::setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        std::string request;
+        char buffer[1024];
+        while (request.size() < 8192 && request.find("\r\n\r\n") == std::string::npos) {
+            ssize_t received = ::recv(client, buffer, sizeof(buffer), 0);
+            if (received <= 0) break;
+            request.append(buffer, (size_t)received);
+        }
+
+        std::string status = "200 OK", body;
+        if (request.compare(0, 13, "GET /metrics ") == 0 || request.compare(0, 14, "GET /metrics?") == 0) {
+            body = registry->render();
+        } else if (request.compare(0, 4, "GET ") == 0) {
+            status = "404 Not Found";
+            body = "metrics are served at /metrics\n";
+        } else {
+            status = "405 Method Not Allowed";
+        }
+        std::string response = "HTTP/1.0 " + status + "\r\n"
+                               "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                               "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                               "Connection: close\r\n\r\n" + body;
+        sendAll(client, response.data(), response.size());
+        ::close(client);
+    }
+}
+
+EngineMetrics::EngineMetrics(MetricsRegistry& registry, double refreshSeconds)
+    : refreshSeconds(refreshSeconds), lastRefresh(std::chrono::steady_clock::now()), stepsAtRefresh(0),
+      steps(0) {
+    registry.family("nbody_steps_total", "Engine steps completed", MetricType::COUNTER);
+    stepsTotal = registry.series("nbody_steps_total");
+    registry.family("nbody_steps_per_second", "Step rate over the last refresh interval", MetricType::GAUGE);
+    stepsPerSecond = registry.series("nbody_steps_per_second");
+
+    registry.family("nbody_step_latency_seconds", "Step wall time (quantiles over the last completed window)",
+                    MetricType::SUMMARY);
+    for (int i = 0; i < 4; i++) {
+        char label[32];
+        std::snprintf(label, sizeof(label), "quantile=\"%g\"", kQuantiles[i]);
+        latencyQuantiles[i] = registry.series("nbody_step_latency_seconds", label);
+    }
+    latencySum = registry.series("nbody_step_latency_seconds", "", "_sum");
+    latencyCount = registry.series("nbody_step_latency_seconds", "", "_count");
+    registry.family("nbody_step_latency_max_seconds", "Slowest step in the last completed latency window",
+                    MetricType::GAUGE);
+    latencyMax = registry.series("nbody_step_latency_max_seconds");
+
+    registry.family("nbody_step_outliers_total", "Outlier steps by the phase that dominated them",
+                    MetricType::COUNTER);
+    registry.family("nbody_phase_seconds_total", "Wall time spent in each step phase", MetricType::COUNTER);
+    for (int i = 0; i < kStepPhaseCount; i++) {
+        std::string label = std::string("phase=\"") + kPhaseLabels[i] + "\"";
+        outliers[i] = registry.series("nbody_step_outliers_total", label);
+        phaseSeconds[i] = registry.series("nbody_phase_seconds_total", label);
+    }
+
+    registry.family("nbody_bodies", "Live entities by type", MetricType::GAUGE);
+    registry.family("nbody_entity_storage_bytes", "Bytes reserved by entity arrays", MetricType::GAUGE);
+    for (int i = 0; i < kBodyTypes; i++) {
+        std::string label = std::string("type=\"") + kBodyLabels[i] + "\"";
+        bodies[i] = registry.series("nbody_bodies", label);
+        storageBytes[i] = registry.series("nbody_entity_storage_bytes", label);
+    }
+
+    registry.family("nbody_memory_bytes", "Live heap bytes by allocation tag", MetricType::GAUGE);
+    registry.family("nbody_memory_peak_bytes", "Peak live heap bytes by allocation tag", MetricType::GAUGE);
+    registry.family("nbody_memory_allocations_total", "Heap blocks allocated by tag", MetricType::COUNTER);
+    registry.family("nbody_memory_frees_total", "Heap blocks freed by tag", MetricType::COUNTER);
+    registry.family("nbody_memory_over_budget", "1 while the tag is over its engine budget", MetricType::GAUGE);
+    for (int i = 0; i < kMemoryTagCount; i++) {
+        std::string label = std::string("tag=\"") + memoryTagName(static_cast<MemoryTag>(i)) + "\"";
+        memoryBytes[i] = registry.series("nbody_memory_bytes", label);
+        memoryPeak[i] = registry.series("nbody_memory_peak_bytes", label);
+        memoryAllocs[i] = registry.series("nbody_memory_allocations_total", label);
+        memoryFrees[i] = registry.series("nbody_memory_frees_total", label);
+        memoryOver[i] = registry.series("nbody_memory_over_budget", label);
+    }
+
+    registry.family("nbody_tree_nodes", "Nodes in the last Barnes-Hut tree build", MetricType::GAUGE);
+    treeNodes = registry.series("nbody_tree_nodes");
+    registry.family("nbody_tree_node_allocations_total", "Tree nodes allocated (two builds per step)",
+                    MetricType::COUNTER);
+    treeAllocations = registry.series("nbody_tree_node_allocations_total");
+    registry.family("nbody_force_interactions_per_step", "Body/node interactions in the last step",
+                    MetricType::GAUGE);
+    interactionsPerStep = registry.series("nbody_force_interactions_per_step");
+    registry.family("nbody_force_interactions_total", "Body/node interactions evaluated", MetricType::COUNTER);
+    interactionsTotal = registry.series("nbody_force_interactions_total");
+    registry.family("nbody_force_imbalance", "Slowest / mean force task time in the last step", MetricType::GAUGE);
+    forceImbalance = registry.series("nbody_force_imbalance");
+}
+
+/**
+ * @brief Bytes reserved by an entity vector
+ * @param entities Vector
+ * @return capacity * element size
+ */
+template <typename T>
+static double storageOf(const std::vector<T>& entities) {
+    return (double)(entities.capacity() * sizeof(T));
+}
+
+void EngineMetrics::update(const GameEngine& engine) {
+    const StepProfile& profile = engine.getStepProfile();
+    steps++;
+    stepsTotal->set((double)steps);
+    const double phases[kStepPhaseCount] = {
+        profile.entitySeconds, profile.gravitySeconds, profile.analysisSeconds,
+        profile.collisionSeconds, profile.cleanupSeconds
+    };
+    for (int i = 0; i < kStepPhaseCount; i++) phaseSeconds[i]->add(phases[i]);
+    treeNodes->set(profile.treeNodes);
+    treeAllocations->add(profile.treeAllocations);
+    interactionsPerStep->set((double)profile.interactions);
+    interactionsTotal->add((double)profile.interactions);
+    forceImbalance->set(profile.forceImbalance);
+
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - lastRefresh).count();
+    if (elapsed < refreshSeconds) return;
+
+    // Derived values: a percentile scan and a few size queries
+    stepsPerSecond->set((steps - stepsAtRefresh) / elapsed);
+    lastRefresh = now;
+    stepsAtRefresh = steps;
+
+    const LatencyTracker& latency = engine.getLatency();
+    LatencyScope scope = latency.getHistogram(LatencyScope::WINDOW).getCount() > 0 ? LatencyScope::WINDOW
+                                                                                   : LatencyScope::CURRENT;
+    const LatencyHistogram& window = latency.getHistogram(scope);
+    for (int i = 0; i < 4; i++) latencyQuantiles[i]->set(window.valueAtPercentile(kQuantiles[i] * 100.0) * 1e-9);
+    const LatencyHistogram& all = latency.getHistogram(LatencyScope::TOTAL);
+    latencySum->set(all.getMean() * all.getCount() * 1e-9);
+    latencyCount->set((double)all.getCount());
+    latencyMax->set(window.getMax() * 1e-9);
+    LatencySummary total = latency.getSummary(LatencyScope::TOTAL);
+    for (int i = 0; i < kStepPhaseCount; i++) outliers[i]->set((double)total.phaseOutliers[i]);
+
+    bodies[0]->set((double)engine.getShips().size());
+    bodies[1]->set((double)engine.getAsteroids().size());
+    bodies[2]->set((double)engine.getBullets().size());
+    bodies[3]->set((double)engine.getBlackHoles().size());
+    bodies[4]->set((double)engine.getParticles().size());
+    storageBytes[0]->set(storageOf(engine.getShips()));
+    storageBytes[1]->set(storageOf(engine.getAsteroids()));
+    storageBytes[2]->set(storageOf(engine.getBullets()));
+    storageBytes[3]->set(storageOf(engine.getBlackHoles()));
+    storageBytes[4]->set((double)engine.getParticles().capacityBytes());
+
+    for (int i = 0; i < kMemoryTagCount; i++) {
+        MemoryTagStats stats = getMemoryStats(static_cast<MemoryTag>(i));
+        memoryBytes[i]->set((double)stats.currentBytes);
+        memoryPeak[i]->set((double)stats.peakBytes);
+        memoryAllocs[i]->set((double)stats.allocations);
+        memoryFrees[i]->set((double)stats.frees);
+        memoryOver[i]->set((engine.getMemoryPressure() >> i) & 1u);
+    }
+}
@@ -0,0 +1,250 @@
+/**
+ * @file metrics.h
+ * @brief Live Prometheus metrics for headless runs (native build)
+ *
+ * MetricsRegistry holds metric families whose values are single atomics:
+ * the simulation thread stores into them with relaxed atomics and never
+ * takes a lock, so a scrape can never stall a step. Registration happens
+ * once at setup; the family list is guarded by a mutex that only
+ * registration and scrapes take.
+ *
+ * MetricsServer is a minimal blocking HTTP/1.0 server on 127.0.0.1 that
+ * answers GET /metrics with the registry in Prometheus text format 0.0.4.
+ * It serves one connection at a time on its own thread.
+ *
+ * EngineMetrics registers the engine's standard metrics and publishes
+ * them from a GameEngine after each step:
+ *
+ *     nbody_steps_total                      counter
+ *     nbody_steps_per_second                 gauge (over the last refresh interval)
+ *     nbody_step_latency_seconds{quantile}   summary (last completed latency window)
+ *     nbody_step_latency_max_seconds         gauge
+ *     nbody_step_outliers_total{phase}       counter
+ *     nbody_phase_seconds_total{phase}       counter
+ *     nbody_bodies{type}                     gauge
+ *     nbody_tree_nodes                       gauge
+ *     nbody_tree_node_allocations_total      counter
+ *     nbody_force_interactions_per_step      gauge
+ *     nbody_force_interactions_total         counter
+ *     nbody_force_imbalance                  gauge
+ *     nbody_entity_storage_bytes{type}       gauge (vector capacity)
+ *     nbody_memory_bytes{tag}                gauge (tagged heap, see allocation.h)
+ *     nbody_memory_peak_bytes{tag}           gauge
+ *     nbody_memory_allocations_total{tag}    counter
+ *     nbody_memory_frees_total{tag}          counter
+ *     nbody_memory_over_budget{tag}          gauge (1 while the engine degrades)
+ */
+
+#pragma once
+#include "allocation.h"
+#include "latency.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class GameEngine;
+
+static_assert(std::atomic<double>::is_always_lock_free, "metric values must be lock-free atomics");
+
+/**
+ * @enum MetricType
+ * @brief Prometheus metric family type
+ */
+enum class MetricType {
+    COUNTER,  ///< Monotonic total
+    GAUGE,    ///< Current value
+    SUMMARY   ///< Quantiles plus _sum and _count
+};
+
+/**
+ * @class MetricValue
+ * @brief One time series value, updated lock-free
+ *
+ * Written by a single thread (the simulation), read by the scraper.
+ */
+class MetricValue {
+public:
+    /**
+     * @brief Default constructor - zero
+     */
+    MetricValue() : value(0.0) {}
+
+    /**
+     * @brief Set the value
+     * @param v New value
+     */
+    void set(double v) { value.store(v, std::memory_order_relaxed); }
+
+    /**
+     * @brief Add to the value (single writer, so no read-modify-write race)
+     * @param delta Increment
+     */
+    void add(double delta) { value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed); }
+
+    /**
+     * @brief Read the value
+     * @return Current value
+     */
+    double get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> value;  ///< Current value
+};
+
+/**
+ * @class MetricsRegistry
+ * @brief Named metric families and their series
+ */
+class MetricsRegistry {
+public:
+    /**
+     * @brief Register a family (no-op if the name is already registered)
+     * @param name Family name
+     * @param help One-line description
+     * @param type Counter, gauge or summary
+     */
+    void family(const std::string& name, const std::string& help, MetricType type);
+
+    /**
+     * @brief Register a series in a family
+     * @param name Family name (must be registered)
+     * @param labels Label set without braces, e.g. `phase="gravity"` (may be empty)
+     * @param suffix Name suffix, e.g. "_sum" for summaries (may be empty)
+     * @return Stable pointer to the value (valid for the registry's lifetime)
+     */
+    MetricValue* series(const std::string& name, const std::string& labels = "", const std::string& suffix = "");
+
+    /**
+     * @brief Render every family in Prometheus text format
+     * @return Exposition text
+     */
+    std::string render() const;
+
+private:
+    /// One labelled time series
+    struct Series {
+        std::string labels;                  ///< Label set without braces
+        std::string suffix;                  ///< Appended to the family name
+        std::unique_ptr<MetricValue> value;  ///< Value (heap-allocated so pointers stay valid)
+    };
+
+    /// A named family of series
+    struct Family {
+        std::string name;            ///< Metric name
+        std::string help;            ///< HELP text
+        MetricType type;             ///< TYPE
+        std::vector<Series> series;  ///< Series in registration order
+    };
+
+    mutable std::mutex mutex;       ///< Guards the family list (never the values)
+    std::vector<Family> families;   ///< Families in registration order
+};
+
+/**
+ * @class MetricsServer
+ * @brief Serves a registry over HTTP on localhost
+ */
+class MetricsServer {
+public:
+    /**
+     * @brief Default constructor - not listening
+     */
+    MetricsServer();
+
+    /**
+     * @brief Stop the server
+     */
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    /**
+     * @brief Bind 127.0.0.1:port and start serving
+     * @param port TCP port (0 picks a free port, see getPort)
+     * @param registry Registry to serve (must outlive the server)
+     * @return False if the socket cannot be bound (reason on stderr)
+     */
+    bool start(int port, const MetricsRegistry& registry);
+
+    /**
+     * @brief Stop serving and close the socket
+     */
+    void stop();
+
+    /**
+     * @brief Get the bound port
+     * @return Port, or 0 when not listening
+     */
+    int getPort() const { return port; }
+
+private:
+    int listenFd;                     ///< Listening socket (-1 when stopped)
+    int port;                         ///< Bound port
+    const MetricsRegistry* registry;  ///< Registry being served
+    std::atomic<bool> stopping;       ///< Server thread should exit
+    std::thread server;               ///< Accept loop thread
+
+    /**
+     * @brief Accept loop: answer one request per connection
+     */
+    void serveLoop();
+};
+
+/**
+ * @class EngineMetrics
+ * @brief Standard engine metrics fed from GameEngine after each step
+ *
+ * Per-step counters are updated every step (a few relaxed stores);
+ * steps/s, latency quantiles and storage sizes are refreshed at most
+ * every refreshSeconds.
+ */
+class EngineMetrics {
+public:
+    static constexpr int kBodyTypes = 5;  ///< Ships, asteroids, bullets, black holes, particles
+
+    /**
+     * @brief Register the engine metrics
+     * @param registry Registry to register into
+     * @param refreshSeconds Minimum interval between refreshes of derived values
+     */
+    explicit EngineMetrics(MetricsRegistry& registry, double refreshSeconds = 0.25);
+
+    /**
+     * @brief Publish the step that just finished
+     * @param engine Engine after step()
+     */
+    void update(const GameEngine& engine);
+
+private:
+    double refreshSeconds;                              ///< Minimum refresh interval
+    std::chrono::steady_clock::time_point lastRefresh;  ///< Time of the last refresh
+    uint64_t stepsAtRefresh;                            ///< Step count at the last refresh
+    uint64_t steps;                                     ///< Steps published
+
+    MetricValue* stepsTotal;                     ///< nbody_steps_total
+    MetricValue* stepsPerSecond;                 ///< nbody_steps_per_second
+    MetricValue* latencyQuantiles[4];            ///< nbody_step_latency_seconds{quantile}
+    MetricValue* latencySum;                     ///< nbody_step_latency_seconds_sum
+    MetricValue* latencyCount;                   ///< nbody_step_latency_seconds_count
+    MetricValue* latencyMax;                     ///< nbody_step_latency_max_seconds
+    MetricValue* outliers[kStepPhaseCount];      ///< nbody_step_outliers_total{phase}
+    MetricValue* phaseSeconds[kStepPhaseCount];  ///< nbody_phase_seconds_total{phase}
+    MetricValue* bodies[kBodyTypes];             ///< nbody_bodies{type}
+    MetricValue* treeNodes;                      ///< nbody_tree_nodes
+    MetricValue* treeAllocations;                ///< nbody_tree_node_allocations_total
+    MetricValue* interactionsPerStep;            ///< nbody_force_interactions_per_step
+    MetricValue* interactionsTotal;              ///< nbody_force_interactions_total
+    MetricValue* forceImbalance;                 ///< nbody_force_imbalance
+    MetricValue* storageBytes[kBodyTypes];       ///< nbody_entity_storage_bytes{type}
+    MetricValue* memoryBytes[kMemoryTagCount];   ///< nbody_memory_bytes{tag}
+    MetricValue* memoryPeak[kMemoryTagCount];    ///< nbody_memory_peak_bytes{tag}
+    MetricValue* memoryAllocs[kMemoryTagCount];  ///< nbody_memory_allocations_total{tag}
+    MetricValue* memoryFrees[kMemoryTagCount];   ///< nbody_memory_frees_total{tag}
+    MetricValue* memoryOver[kMemoryTagCount];    ///< nbody_memory_over_budget{tag}
+};
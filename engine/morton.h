@@ -0,0 +1,41 @@
+/**
+ * @file morton.h
+ * @brief Morton (Z-order) keys for spatial ordering of bodies
+ *
+ * Interleaves 16-bit quantized x and y coordinates into a 32-bit key.
+ * Sorting bodies by key lays them out along a space-filling curve, so
+ * contiguous key ranges are compact spatial regions. Used to split work
+ * between threads and between processes.
+ */
+
+#pragma once
+#include "vecn.h"
+#include <algorithm>
+#include <cstdint>
+
+/**
+ * @brief Spread the low 16 bits of v so bit i moves to bit 2i
+ * @param v Value to spread
+ * @return Spread value with zeros in odd bit positions
+ */
+inline uint32_t mortonSpread(uint32_t v) {
+    v &= 0x0000ffffU;
+    v = (v | (v << 8)) & 0x00ff00ffU;
+    v = (v | (v << 4)) & 0x0f0f0f0fU;
+    v = (v | (v << 2)) & 0x33333333U;
+    v = (v | (v << 1)) & 0x55555555U;
+    return v;
+}
+
+/**
+ * @brief Morton key of a position in the periodic domain
+ * @param pos Position (clamped into the domain)
+ * @param worldWidth Domain width
+ * @param worldHeight Domain height
+ * @return 32-bit Z-order key (x in even bits, y in odd bits)
+ */
+inline uint32_t mortonKey(const Vec2& pos, float worldWidth, float worldHeight) {
+    float fx = std::min(std::max(pos.x / worldWidth, 0.0f), 1.0f) * 65535.0f;
+    float fy = std::min(std::max(pos.y / worldHeight, 0.0f), 1.0f) * 65535.0f;
+    return mortonSpread((uint32_t)fx) | (mortonSpread((uint32_t)fy) << 1);
+}
@@ -0,0 +1,344 @@
+/**
+ * @file nbody.h
+ * @brief Stable C ABI of the native engine (libnbody.so)
+ *
+ * Lets tools in any language with a C FFI (Python ctypes/cffi, Julia,
+ * Rust, ...) drive GameEngine at native speed. Every call works on whole
+ * steps or whole columns: nbody_step advances N steps in one call and
+ * nbody_snapshot / nbody_load_bodies move every body through
+ * caller-provided contiguous arrays, so the FFI cost is per call, never
+ * per entity.
+ *
+ * Build with `make lib` (engine/Makefile) into libnbody.so.1, with
+ * libnbody.so linking to it. The library exports only the functions
+ * below.
+ *
+ * Conventions:
+ * - Functions returning int return NBODY_OK (0) or a negative
+ *   nbody_status; nbody_last_error() then describes the failure.
+ * - Functions filling a caller buffer return the size they need and only
+ *   write when it fits (like snprintf): retry with a larger buffer when
+ *   the result exceeds the capacity passed in.
+ * - An engine must not be used from two threads at once; different
+ *   engines are independent. nbody_set_threads parallelises inside a call.
+ * - Columns are laid out as in snapshot files: positions and velocities
+ *   are interleaved x, y float pairs; ships come first, then asteroids,
+ *   bullets and black holes, inactive entities and particles skipped.
+ *
+ * Versioning: NBODY_ABI_VERSION changes whenever a signature or struct in
+ * this header changes incompatibly (new functions keep it). Check
+ * nbody_abi_version() against the value the binding was written for.
+ */
+
+#ifndef NBODY_H
+#define NBODY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(NBODY_BUILD_LIBRARY)
+#define NBODY_API __attribute__((visibility("default")))
+#else
+#define NBODY_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** ABI version of this header */
+#define NBODY_ABI_VERSION 1
+
+/** Opaque engine handle */
+typedef struct nbody_engine nbody_engine;
+
+/**
+ * @enum nbody_status
+ * @brief Result codes (negative values are errors)
+ */
+typedef enum nbody_status {
+    NBODY_OK = 0,               /**< Success */
+    NBODY_ERROR_ARGUMENT = -1,  /**< Null handle, null column or out-of-range value */
+    NBODY_ERROR_STATE = -2,     /**< Saved state from another build or world size, or malformed */
+    NBODY_ERROR_INTERNAL = -3   /**< Exception inside the engine (e.g. out of memory) */
+} nbody_status;
+
+/**
+ * @enum nbody_body_type
+ * @brief Values of the type column (EntityType)
+ */
+typedef enum nbody_body_type {
+    NBODY_SHIP = 0,       /**< Player ship */
+    NBODY_ASTEROID = 1,   /**< Asteroid or scenario dust body */
+    NBODY_BULLET = 2,     /**< Bullet */
+    NBODY_BLACK_HOLE = 3  /**< Black hole (radius column holds the accretion radius) */
+} nbody_body_type;
+
+/**
+ * @struct nbody_columns
+ * @brief Caller-owned body columns, each with room for the same number of bodies
+ *
+ * Any column may be NULL in nbody_snapshot to skip it; nbody_load_bodies
+ * needs all of them (and does not modify them).
+ */
+typedef struct nbody_columns {
+    float* pos;      /**< 2 floats per body: x, y */
+    float* vel;      /**< 2 floats per body: vx, vy */
+    float* mass;     /**< Mass */
+    uint8_t* type;   /**< nbody_body_type */
+    float* radius;   /**< Collision radius */
+} nbody_columns;
+
+/**
+ * @struct nbody_step_stats
+ * @brief Totals over the steps of one nbody_step call
+ */
+typedef struct nbody_step_stats {
+    int64_t steps;              /**< Steps run */
+    double total_seconds;       /**< Whole steps */
+    double max_step_seconds;    /**< Slowest step */
+    double entity_seconds;      /**< Entity timers and input handling */
+    double gravity_seconds;     /**< Tree builds, kicks and drift */
+    double analysis_seconds;    /**< Conservation diagnostics and force accuracy sampling */
+    double collision_seconds;   /**< Collision detection and response */
+    double cleanup_seconds;     /**< Spawning, cleanup and wave progression */
+    int64_t interactions;       /**< Body/node force interactions */
+} nbody_step_stats;
+
+/**
+ * @struct nbody_diagnostics
+ * @brief Conservation totals after the last step
+ */
+typedef struct nbody_diagnostics {
+    double kinetic;           /**< Kinetic energy */
+    double potential;         /**< Mutual gravitational energy (tree approximation) */
+    double external;          /**< Energy in the external potential */
+    double total;             /**< kinetic + potential + external */
+    double momentum_x;        /**< Linear momentum x */
+    double momentum_y;        /**< Linear momentum y */
+    double angular_momentum;  /**< Angular momentum about the potential centre */
+    double drift;             /**< Relative energy drift since the baseline */
+    int64_t body_count;       /**< Bodies included */
+} nbody_diagnostics;
+
+/**
+ * @brief Get the library's ABI version
+ * @return NBODY_ABI_VERSION the library was built with
+ */
+NBODY_API int nbody_abi_version(void);
+
+/**
+ * @brief Describe the last error on the calling thread
+ * @return Message (empty if none); valid until the next failing call on this thread
+ */
+NBODY_API const char* nbody_last_error(void);
+
+/**
+ * @brief Create an engine with a generated game world
+ * @param width World width
+ * @param height World height
+ * @param seed Random seed
+ * @return Handle, or NULL on failure (see nbody_last_error)
+ */
+NBODY_API nbody_engine* nbody_create(float width, float height, uint32_t seed);
+
+/**
+ * @brief Destroy an engine
+ * @param engine Handle (NULL is ignored)
+ */
+NBODY_API void nbody_destroy(nbody_engine* engine);
+
+/**
+ * @brief Set the external potential
+ * @param engine Handle
+ * @param level Level 0-4 (none, point mass, harmonic, logarithmic, NFW)
+ * @return Status
+ */
+NBODY_API int nbody_set_level(nbody_engine* engine, int level);
+
+/**
+ * @brief Set the game mode and regenerate the world
+ * @param engine Handle
+ * @param mode 0 = solo, 1 = co-op, 2 = versus
+ * @return Status
+ */
+NBODY_API int nbody_set_mode(nbody_engine* engine, int mode);
+
+/**
+ * @brief Set threads used inside each call (results do not depend on it)
+ * @param engine Handle
+ * @param threads Threads including the caller (>= 1)
+ * @return Status
+ */
+NBODY_API int nbody_set_threads(nbody_engine* engine, int threads);
+
+/**
+ * @brief Enable or disable collision handling
+ * @param engine Handle
+ * @param enabled Nonzero to enable
+ * @return Status
+ */
+NBODY_API int nbody_set_collisions(nbody_engine* engine, int enabled);
+
+/**
+ * @brief Enable or disable black hole spawning
+ * @param engine Handle
+ * @param enabled Nonzero to enable
+ * @return Status
+ */
+NBODY_API int nbody_set_black_hole_spawning(nbody_engine* engine, int enabled);
+
+/**
+ * @brief Select the gravitational softening kernel (softening length is fixed)
+ * @param engine Handle
+ * @param kernel 0 = Plummer (default), 1 = cubic spline (Newtonian beyond 2.8 eps), 2 = none
+ * @return Status
+ */
+NBODY_API int nbody_set_softening(nbody_engine* engine, int kernel);
+
+/**
+ * @brief Regenerate the game world (wave 1, time 0)
+ * @param engine Handle
+ * @return Status
+ */
+NBODY_API int nbody_reset(nbody_engine* engine);
+
+/**
+ * @brief Replace the world with generated initial conditions
+ * @param engine Handle
+ * @param kind Scenario name (e.g. "plummer", as accepted by nbody-native --scenario)
+ * @param count Number of bodies
+ * @param seed Random seed
+ * @return Status
+ *
+ * Black hole spawning is disabled, as in the native runner.
+ */
+NBODY_API int nbody_load_scenario(nbody_engine* engine, const char* kind, int count, uint32_t seed);
+
+/**
+ * @brief Replace the world's bodies with caller columns
+ * @param engine Handle
+ * @param bodies Columns (all required)
+ * @param count Number of bodies
+ * @param level External potential level
+ * @return Status
+ *
+ * Ships are matched to the existing ships in order; asteroids take the
+ * nearest size class; black holes wrap around the world.
+ */
+NBODY_API int nbody_load_bodies(nbody_engine* engine, const nbody_columns* bodies, size_t count, int level);
+
+/**
+ * @brief Advance the simulation
+ * @param engine Handle
+ * @param steps Number of fixed steps
+ * @param stats Totals over these steps (may be NULL)
+ * @return Status
+ */
+NBODY_API int nbody_step(nbody_engine* engine, int64_t steps, nbody_step_stats* stats);
+
+/**
+ * @brief Enable or disable the adaptive global timestep (off by default)
+ * @param engine Handle
+ * @param enabled Nonzero to choose dt per step from accelerations, speeds and collision radii
+ * @param eta Accuracy parameter (0.025 is the default; smaller is more accurate)
+ * @return Status
+ *
+ * With it enabled, nbody_step takes that many variable steps; use
+ * nbody_advance to cover a span of simulated time and land on its end.
+ */
+NBODY_API int nbody_set_adaptive_dt(nbody_engine* engine, int enabled, float eta);
+
+/**
+ * @brief Advance the simulation by a span of simulated time, ending exactly at its end
+ * @param engine Handle
+ * @param duration Seconds of simulated time (>= 0)
+ * @param stats Totals over the steps taken (may be NULL)
+ * @return Status
+ */
+NBODY_API int nbody_advance(nbody_engine* engine, double duration, nbody_step_stats* stats);
+
+/**
+ * @brief Drift bodies bound to a dominant black hole along exact Kepler orbits (off by default)
+ * @param engine Handle
+ * @param enabled Nonzero to enable
+ * @param dominance Black hole pull / all other acceleration a body needs to qualify (10 is the default)
+ * @return Status
+ */
+NBODY_API int nbody_set_kepler_drift(nbody_engine* engine, int enabled, float dominance);
+
+/**
+ * @brief Store explosion particles in the compact 16-bit tier (off by default)
+ * @param engine Handle
+ * @param enabled Nonzero for 17-byte compact records, zero for full records
+ * @return Status
+ */
+NBODY_API int nbody_set_compact_storage(nbody_engine* engine, int enabled);
+
+/**
+ * @brief Compute radial profiles about the potential centre (off by default)
+ * @param engine Handle
+ * @param bins Radial bins (0 disables, at most 1024)
+ * @param max_radius Outer edge of the last bin (0 = half the shorter world side)
+ * @param interval Steps between updates (1 = every step)
+ * @return Status
+ */
+NBODY_API int nbody_set_profiles(nbody_engine* engine, int bins, float max_radius, int interval);
+
+/**
+ * @brief Copy the latest radial profile
+ * @param engine Handle
+ * @param out Column-major floats: bins radii, then counts, surface densities,
+ *   rotation speeds, velocity dispersions and model circular speeds
+ * @param capacity Floats out has room for
+ * @return Floats needed (6 * bins; 0 before the first profiled step), or a negative status
+ */
+NBODY_API int64_t nbody_get_profile(const nbody_engine* engine, float* out, size_t capacity);
+
+/**
+ * @brief Get simulation time
+ * @param engine Handle
+ * @return Seconds of simulated time (0 for a NULL handle)
+ */
+NBODY_API double nbody_get_time(const nbody_engine* engine);
+
+/**
+ * @brief Get the conservation totals of the last step
+ * @param engine Handle
+ * @param out Output
+ * @return Status
+ */
+NBODY_API int nbody_get_diagnostics(const nbody_engine* engine, nbody_diagnostics* out);
+
+/**
+ * @brief Copy every active body into caller columns
+ * @param engine Handle
+ * @param out Columns (NULL columns are skipped)
+ * @param capacity Bodies each column has room for
+ * @return Number of bodies (written only if <= capacity), or a negative status
+ */
+NBODY_API int64_t nbody_snapshot(nbody_engine* engine, const nbody_columns* out, size_t capacity);
+
+/**
+ * @brief Serialise the full engine state (bit-exact restart, see checkpoint.h)
+ * @param engine Handle
+ * @param buffer Output bytes (may be NULL when capacity is 0)
+ * @param capacity Buffer size
+ * @return State size (written only if <= capacity), or a negative status
+ */
+NBODY_API int64_t nbody_save_state(nbody_engine* engine, void* buffer, size_t capacity);
+
+/**
+ * @brief Restore a state from nbody_save_state
+ * @param engine Handle with the same world size, from the same build
+ * @param data State bytes
+ * @param size Byte count
+ * @return Status (NBODY_ERROR_STATE if incompatible)
+ */
+NBODY_API int nbody_load_state(nbody_engine* engine, const void* data, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NBODY_H */
@@ -0,0 +1,128 @@
+/**
+ * @file nbodysystem.cpp
+ * @brief Implementation of the dimension-generic N-body integrator
+ */
+
+#include "nbodysystem.h"
+#include <algorithm>
+#include <chrono>
+
+template <int D>
+NBodySystem<D>::NBodySystem(const VecN<D>& box, const SystemParams& params)
+    : box(box), params(params), tree(box), workerPool(std::make_unique<WorkerPool>(1)),
+      forcesValid(false) {
+}
+
+template <int D>
+void NBodySystem<D>::addBody(const VecN<D>& pos, const VecN<D>& vel, float mass) {
+    PointBody<D> body;
+    body.pos = wrapPosition(pos, box);
+    body.vel = vel;
+    body.mass = mass;
+    bodies.push_back(body);
+    forcesValid = false;
+}
+
+template <int D>
+void NBodySystem<D>::setThreadCount(int numThreads) {
+    workerPool->setThreadCount(numThreads);
+}
+
+template <int D>
+void NBodySystem<D>::setPotential(std::unique_ptr<ExternalPotential<D>> newPotential) {
+    potential = std::move(newPotential);
+    forcesValid = false;
+}
+
+/**
+ * @brief Rebuild the tree and evaluate every body's acceleration
+ *
+ * Tasks are over-decomposed (several per thread) because tree walks in
+ * dense regions cost far more than in sparse ones; each task writes only
+ * its own bodies and its own interaction counter, so results do not
+ * depend on the thread count.
+ */
+template <int D>
+void NBodySystem<D>::computeForces() {
+    auto start = std::chrono::steady_clock::now();
+
+    treeBodies.clear();
+    for (PointBody<D>& b : bodies) treeBodies.push_back(&b);
+    tree.build(treeBodies);
+
+    int count = (int)bodies.size();
+    int numTasks = std::min(workerPool->getThreadCount() * 4, std::max(1, count / 256));
+    std::vector<long long> taskInteractions(numTasks, 0);
+    withSoftening(params.softening, params.epsilon, [&](const auto& kernel) {
+        workerPool->run(numTasks, [&](int task) {
+            int begin, end;
+            taskRange(count, numTasks, task, begin, end);
+            long long interactions = 0;
+            for (int i = begin; i < end; i++) {
+                PointBody<D>& b = bodies[i];
+                ForceResultN<D> force = tree.calculateForce(b.pos, b.mass, params.theta, kernel, params.G);
+                b.acc = force.acc;
+                if (potential) b.acc += potential->accelerationAt(b.pos);
+                b.potential = force.potential;
+                interactions += force.interactions;
+            }
+            taskInteractions[task] = interactions;
+        });
+    });
+
+    stats.interactions = 0;
+    for (long long n : taskInteractions) stats.interactions += n;
+    stats.treeNodes = tree.getNodeCount();
+    stats.gravitySeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    forcesValid = true;
+}
+
+template <int D>
+void NBodySystem<D>::step() {
+    float halfDt = params.dt * 0.5f;
+
+    if (!forcesValid) computeForces();
+
+    for (PointBody<D>& b : bodies) {
+        b.vel += b.acc * halfDt;
+        b.pos = wrapPosition(b.pos + b.vel * params.dt, box);
+    }
+
+    computeForces();
+    for (PointBody<D>& b : bodies) b.vel += b.acc * halfDt;
+}
+
+template <int D>
+double NBodySystem<D>::kineticEnergy() const {
+    double total = 0;
+    for (const PointBody<D>& b : bodies) {
+        double v2 = 0;
+        for (int d = 0; d < D; d++) v2 += (double)b.vel[d] * b.vel[d];
+        total += 0.5 * b.mass * v2;
+    }
+    return total;
+}
+
+template <int D>
+double NBodySystem<D>::potentialEnergy() const {
+    double pairs = 0, external = 0;
+    for (const PointBody<D>& b : bodies) {
+        pairs += (double)b.mass * b.potential;
+        if (potential) external += (double)b.mass * potential->potentialAt(b.pos);
+    }
+    return 0.5 * pairs + external;
+}
+
+template <int D>
+VecN<D> NBodySystem<D>::momentum() const {
+    double total[D] = {};
+    for (const PointBody<D>& b : bodies) {
+        for (int d = 0; d < D; d++) total[d] += (double)b.mass * b.vel[d];
+    }
+    VecN<D> result;
+    for (int d = 0; d < D; d++) result[d] = (float)total[d];
+    return result;
+}
+
+template class NBodySystem<2>;
+template class NBodySystem<3>;
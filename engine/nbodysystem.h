@@ -0,0 +1,163 @@
+/**
+ * @file nbodysystem.h
+ * @brief Dimension-generic N-body integrator for 2D and 3D research runs
+ *
+ * NBodySystem<D> is the kick-drift-kick leapfrog with softened Barnes-Hut
+ * gravity and an optional external potential, written once over the
+ * dimension. It is instantiated for D = 2 (quadtree) and D = 3 (octree)
+ * over plain point masses in a periodic box. Gameplay (collisions, black
+ * holes, Kepler drift, load balancing) stays in GameEngine, whose 2D kick
+ * loop walks the same tree code over Body.
+ */
+
+#pragma once
+#include "parallel.h"
+#include "potential.h"
+#include "softening.h"
+#include "tree.h"
+#include "vecn.h"
+#include <memory>
+#include <vector>
+
+/**
+ * @struct PointBody
+ * @brief Point mass of an NBodySystem
+ * @tparam D Dimension
+ */
+template <int D>
+struct PointBody {
+    VecN<D> pos;      ///< Position
+    VecN<D> vel;      ///< Velocity
+    VecN<D> acc;      ///< Acceleration at the current positions
+    float mass;       ///< Mass
+    float potential;  ///< Tree potential per unit mass at the last force pass (phi, <= 0)
+
+    /**
+     * @brief Default constructor - massless body at rest at the origin
+     */
+    PointBody() : mass(0), potential(0) {}
+};
+
+/// Barnes-Hut octree over 3D point masses
+using Octree = SpatialTree<3, PointBody<3>>;
+
+/**
+ * @struct SystemParams
+ * @brief Physics parameters of an NBodySystem
+ */
+struct SystemParams {
+    float G;                    ///< Gravitational constant
+    float epsilon;              ///< Softening length
+    float theta;                ///< Barnes-Hut opening angle
+    float dt;                   ///< Fixed timestep
+    SofteningKernel softening;  ///< Softening kernel
+
+    /**
+     * @brief Default constructor matching PhysicsConfig defaults
+     */
+    SystemParams()
+        : G(100.0f), epsilon(5.0f), theta(0.5f), dt(1.0f / 120.0f),
+          softening(SofteningKernel::PLUMMER) {}
+};
+
+/**
+ * @struct SystemStepStats
+ * @brief Timing and work counters for the last force pass
+ */
+struct SystemStepStats {
+    double gravitySeconds;   ///< Tree build and force evaluation
+    long long interactions;  ///< Tree interactions evaluated
+    int treeNodes;           ///< Nodes in the tree
+
+    /**
+     * @brief Default constructor - zero counters
+     */
+    SystemStepStats() : gravitySeconds(0), interactions(0), treeNodes(0) {}
+};
+
+/**
+ * @class NBodySystem
+ * @brief Leapfrog N-body integrator in D dimensions
+ * @tparam D Dimension (2 or 3)
+ */
+template <int D>
+class NBodySystem {
+public:
+    /**
+     * @brief Create an empty system
+     * @param box Size of the periodic domain per axis
+     * @param params Physics parameters
+     */
+    NBodySystem(const VecN<D>& box, const SystemParams& params);
+
+    /**
+     * @brief Add a body (invalidates forces)
+     * @param pos Position
+     * @param vel Velocity
+     * @param mass Mass
+     */
+    void addBody(const VecN<D>& pos, const VecN<D>& vel, float mass);
+
+    /**
+     * @brief Get all bodies
+     * @return Bodies in insertion order
+     */
+    const std::vector<PointBody<D>>& getBodies() const { return bodies; }
+
+    /**
+     * @brief Set the number of threads used for force evaluation
+     * @param numThreads Total threads including the caller (1 = serial)
+     */
+    void setThreadCount(int numThreads);
+
+    /**
+     * @brief Set the external potential (invalidates forces)
+     * @param newPotential Potential, or nullptr for none
+     */
+    void setPotential(std::unique_ptr<ExternalPotential<D>> newPotential);
+
+    /**
+     * @brief Evaluate accelerations and potentials at the current positions
+     */
+    void computeForces();
+
+    /**
+     * @brief Advance one kick-drift-kick leapfrog step
+     */
+    void step();
+
+    /**
+     * @brief Total kinetic energy
+     * @return Σ ½ m v²
+     */
+    double kineticEnergy() const;
+
+    /**
+     * @brief Total potential energy at the last force pass
+     * @return ½ Σ m φ_tree + Σ m Φ_ext
+     */
+    double potentialEnergy() const;
+
+    /**
+     * @brief Total linear momentum
+     * @return Σ m v
+     */
+    VecN<D> momentum() const;
+
+    /**
+     * @brief Get counters for the last force pass
+     * @return Step statistics
+     */
+    const SystemStepStats& getStats() const { return stats; }
+
+private:
+    VecN<D> box;                                      ///< Periodic domain size per axis
+    SystemParams params;                              ///< Physics parameters
+    std::vector<PointBody<D>> bodies;                 ///< Bodies
+    std::vector<PointBody<D>*> treeBodies;            ///< Body pointers for the tree build
+    SpatialTree<D, PointBody<D>> tree;                ///< Barnes-Hut tree (quadtree or octree)
+    std::unique_ptr<ExternalPotential<D>> potential;  ///< External potential (may be null)
+    std::unique_ptr<WorkerPool> workerPool;           ///< Threads for force evaluation
+    SystemStepStats stats;                            ///< Counters for the last force pass
+    bool forcesValid;                                 ///< True once accelerations match current positions
+};
@@ -0,0 +1,118 @@
+/**
+ * @file parallel.cpp
+ * @brief Implementation of the persistent worker pool
+ *
+ * Jobs are handed to sleeping workers through a generation counter; tasks
+ * are claimed with an atomic counter so uneven tasks still keep every
+ * thread busy. In single-threaded builds the pool never starts workers.
+ */
+
+#include "parallel.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool(int numThreads)
+    : job(nullptr), jobTasks(0), jobTag(MemoryTag::UNTAGGED), nextTask(0), activeWorkers(0), generation(0),
+      stopping(false) {
+    setThreadCount(numThreads);
+}
+
+WorkerPool::~WorkerPool() {
+    shutdown();
+}
+
+void WorkerPool::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+    stopping = false;
+}
+
+void WorkerPool::setThreadCount(int numThreads) {
+#ifdef NBODY_SINGLE_THREADED
+    numThreads = 1;
+#endif
+    numThreads = std::max(numThreads, 1);
+    if (numThreads == getThreadCount()) return;
+
+    shutdown();
+    for (int i = 1; i < numThreads; i++) {
+        workers.emplace_back(&WorkerPool::workerLoop, this);
+    }
+}
+
+void WorkerPool::run(int numTasks, const std::function<void(int)>& task) {
+    if (numTasks <= 0) return;
+
+    // Serial fast path: no hand-off cost for single tasks or single threads
+    if (workers.empty() || numTasks == 1) {
+        for (int i = 0; i < numTasks; i++) {
+            task(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &task;
+        jobTasks = numTasks;
+        jobTag = currentMemoryTag();
+        nextTask.store(0, std::memory_order_relaxed);
+        activeWorkers = (int)workers.size();
+        generation++;
+    }
+    wake.notify_all();
+
+    // Caller works too
+    drain();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return activeWorkers == 0; });
+    job = nullptr;
+}
+
+void WorkerPool::drain() {
+    for (;;) {
+        int i = nextTask.fetch_add(1, std::memory_order_relaxed);
+        if (i >= jobTasks) break;
+        (*job)(i);
+    }
+}
+
+void WorkerPool::workerLoop() {
+    unsigned seen = 0;
+    for (;;) {
+        MemoryTag tag;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            tag = jobTag;
+        }
+
+        {
+            MemoryScope scope(tag);
+            drain();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--activeWorkers == 0) {
+            done.notify_one();
+        }
+    }
+}
+
+int hardwareThreads() {
+#ifdef NBODY_SINGLE_THREADED
+    return 1;
+#else
+    unsigned n = std::thread::hardware_concurrency();
+    return n > 0 ? (int)n : 1;
+#endif
+}
@@ -0,0 +1,123 @@
+/**
+ * @file parallel.h
+ * @brief Minimal worker pool for data-parallel loops in the native build
+ *
+ * Provides a persistent pool of worker threads and a parallelFor helper that
+ * splits a loop into numbered tasks. Callers that need reproducible output
+ * give every task its own output buffer and merge the buffers in task order,
+ * so results never depend on how tasks were scheduled onto threads.
+ *
+ * The WebAssembly build is compiled without pthreads; there the pool has no
+ * workers and every loop runs serially on the calling thread.
+ */
+
+#pragma once
+#include "allocation.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define NBODY_SINGLE_THREADED 1
+#endif
+
+/**
+ * @class WorkerPool
+ * @brief Persistent thread pool executing indexed tasks
+ *
+ * Workers sleep on a condition variable between jobs, so a pool can be kept
+ * alive for the whole simulation and reused every step without paying
+ * thread creation cost. The calling thread also executes tasks.
+ */
+class WorkerPool {
+public:
+    /**
+     * @brief Create a pool
+     * @param numThreads Total threads including the caller (1 = serial)
+     */
+    explicit WorkerPool(int numThreads = 1);
+
+    /**
+     * @brief Stop and join all workers
+     */
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * @brief Resize the pool
+     * @param numThreads Total threads including the caller (clamped to >= 1)
+     */
+    void setThreadCount(int numThreads);
+
+    /**
+     * @brief Get total thread count including the caller
+     * @return Number of threads that execute tasks
+     */
+    int getThreadCount() const { return (int)workers.size() + 1; }
+
+    /**
+     * @brief Run task(i) for every i in [0, numTasks) and wait for completion
+     * @param numTasks Number of tasks
+     * @param task Callable invoked once per task index
+     *
+     * Tasks are claimed dynamically, so task index and thread are unrelated.
+     * Workers charge their allocations to the caller's MemoryScope tag.
+     * Must not be called re-entrantly from inside a task.
+     */
+    void run(int numTasks, const std::function<void(int)>& task);
+
+private:
+    std::vector<std::thread> workers;         ///< Worker threads (caller not included)
+    std::mutex mutex;                         ///< Guards job hand-off
+    std::condition_variable wake;             ///< Signals a new job or shutdown
+    std::condition_variable done;             ///< Signals job completion
+    const std::function<void(int)>* job;      ///< Current job (valid while running)
+    int jobTasks;                             ///< Number of tasks in current job
+    MemoryTag jobTag;                         ///< Caller's allocation tag for the current job
+    std::atomic<int> nextTask;                ///< Next unclaimed task index
+    int activeWorkers;                        ///< Workers still inside current job
+    unsigned generation;                      ///< Incremented for every job
+    bool stopping;                            ///< Set when workers should exit
+
+    /**
+     * @brief Worker thread main loop
+     */
+    void workerLoop();
+
+    /**
+     * @brief Claim and execute tasks until none remain
+     */
+    void drain();
+
+    /**
+     * @brief Stop and join all workers
+     */
+    void shutdown();
+};
+
+/**
+ * @brief Number of hardware threads available to the process
+ * @return At least 1 (always 1 in single-threaded builds)
+ */
+int hardwareThreads();
+
+/**
+ * @brief Split [0, count) into contiguous ranges, one per task
+ * @param count Number of items
+ * @param numTasks Number of tasks
+ * @param task Task index
+ * @param begin Output: first item of the task's range
+ * @param end Output: one past the last item
+ *
+ * Ranges are balanced by item count and ordered by task index, so
+ * concatenating per-task output in task order reproduces serial order.
+ */
+inline void taskRange(int count, int numTasks, int task, int& begin, int& end) {
+    begin = (int)((long long)count * task / numTasks);
+    end = (int)((long long)count * (task + 1) / numTasks);
+}
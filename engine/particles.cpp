@@ -0,0 +1,242 @@
+/**
+ * @file particles.cpp
+ * @brief Implementation of the explosion particle pool
+ */
+
+#include "particles.h"
+#include "allocation.h"
+#include "half.h"
+#include <algorithm>
+
+/// Particles converted per batch (stack buffers of this many floats)
+static constexpr size_t kBlock = 256;
+
+/// Shortest stored lifetime, which bounds the fade units per step
+static constexpr float kMinLifetime = 1e-3f;
+
+ParticlePool::ParticlePool() : compact(false) {}
+
+void ParticlePool::setCompact(bool enable) {
+    if (enable == compact) return;
+    MemoryScope scope(MemoryTag::PARTICLES);
+    if (enable) {
+        size_t count = full.size();
+        pos.resize(count);
+        velX.resize(count);
+        velY.resize(count);
+        lifetime.resize(count);
+        fade.resize(count);
+        playerId.resize(count);
+        float vx[kBlock], vy[kBlock], life[kBlock], alpha[kBlock];
+        for (size_t begin = 0; begin < count; begin += kBlock) {
+            size_t n = std::min(kBlock, count - begin);
+            for (size_t i = 0; i < n; i++) {
+                const Particle& p = full[begin + i];
+                pos[begin + i] = p.pos;
+                vx[i] = p.vel.x;
+                vy[i] = p.vel.y;
+                life[i] = std::max(p.maxLifetime, kMinLifetime);
+                alpha[i] = p.active && p.maxLifetime > 0 ? p.lifetime / p.maxLifetime : 0.0f;
+                playerId[begin + i] = (int8_t)p.playerId;
+            }
+            floatToHalf(vx, &velX[begin], n);
+            floatToHalf(vy, &velY[begin], n);
+            floatToHalf(life, &lifetime[begin], n);
+            floatToUnorm16(alpha, &fade[begin], n);
+        }
+        // A live particle keeps at least one unit so it is not lost to rounding
+        for (size_t i = 0; i < count; i++) {
+            if (fade[i] == 0 && full[i].active && full[i].lifetime > 0) fade[i] = 1;
+        }
+    } else {
+        full.resize(pos.size());
+        for (size_t i = 0; i < full.size(); i++) full[i] = get(i);
+    }
+    compact = enable;
+    releaseUnused();
+}
+
+void ParticlePool::add(const Particle& particle) {
+    if (!compact) {
+        full.push_back(particle);
+        return;
+    }
+    pos.push_back(particle.pos);
+    velX.push_back(floatToHalf(particle.vel.x));
+    velY.push_back(floatToHalf(particle.vel.y));
+    lifetime.push_back(floatToHalf(std::max(particle.maxLifetime, kMinLifetime)));
+    uint16_t alpha = 0;
+    if (particle.active && particle.lifetime > 0 && particle.maxLifetime > 0) {
+        alpha = std::max<uint16_t>(floatToUnorm16(particle.lifetime / particle.maxLifetime), 1);
+    }
+    fade.push_back(alpha);
+    playerId.push_back((int8_t)particle.playerId);
+}
+
+Particle ParticlePool::get(size_t index) const {
+    if (!compact) return full[index];
+    Particle p;
+    p.pos = pos[index];
+    p.vel = Vec2(halfToFloat(velX[index]), halfToFloat(velY[index]));
+    p.maxLifetime = halfToFloat(lifetime[index]);
+    p.lifetime = unorm16ToFloat(fade[index]) * p.maxLifetime;
+    p.active = fade[index] > 0;
+    p.playerId = playerId[index];
+    return p;
+}
+
+void ParticlePool::getRenderData(size_t begin, size_t count, float* out) const {
+    if (!compact) {
+        for (size_t i = 0; i < count; i++) {
+            const Particle& p = full[begin + i];
+            float* o = out + i * kRenderFloats;
+            o[0] = p.pos.x;
+            o[1] = p.pos.y;
+            o[2] = p.lifetime / p.maxLifetime;
+            o[3] = (float)p.playerId;
+        }
+        return;
+    }
+    float alpha[kBlock];
+    for (size_t first = 0; first < count; first += kBlock) {
+        size_t n = std::min(kBlock, count - first);
+        unorm16ToFloat(&fade[begin + first], alpha, n);
+        for (size_t i = 0; i < n; i++) {
+            size_t k = begin + first + i;
+            float* o = out + (first + i) * kRenderFloats;
+            o[0] = pos[k].x;
+            o[1] = pos[k].y;
+            o[2] = alpha[i];
+            o[3] = (float)playerId[k];
+        }
+    }
+}
+
+void ParticlePool::update(float dt) {
+    if (!compact) {
+        for (auto& particle : full) {
+            if (particle.active) particle.update(dt);
+        }
+        return;
+    }
+    float vx[kBlock], vy[kBlock], life[kBlock];
+    const float units = dt * 65535.0f;
+    size_t count = pos.size();
+    for (size_t begin = 0; begin < count; begin += kBlock) {
+        size_t n = std::min(kBlock, count - begin);
+        halfToFloat(&velX[begin], vx, n);
+        halfToFloat(&velY[begin], vy, n);
+        halfToFloat(&lifetime[begin], life, n);
+        // Expired particles move too (they are never drawn); this keeps the loop branch-free
+        Vec2* p = &pos[begin];
+        for (size_t i = 0; i < n; i++) {
+            p[i].x += vx[i] * dt;
+            p[i].y += vy[i] * dt;
+        }
+        uint16_t* remaining = &fade[begin];
+        for (size_t i = 0; i < n; i++) {
+            // Fade units this step; at least one so every particle eventually expires
+            int32_t step = (int32_t)(units / life[i] + 0.5f);
+            step = std::min(std::max(step, 1), 65535);
+            remaining[i] = (uint16_t)std::max((int32_t)remaining[i] - step, 0);
+        }
+    }
+}
+
+void ParticlePool::removeInactive() {
+    if (!compact) {
+        full.erase(std::remove_if(full.begin(), full.end(), [](const Particle& p) { return !p.active; }),
+                   full.end());
+        return;
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < pos.size(); i++) {
+        if (fade[i] == 0) continue;
+        pos[kept] = pos[i];
+        velX[kept] = velX[i];
+        velY[kept] = velY[i];
+        lifetime[kept] = lifetime[i];
+        fade[kept] = fade[i];
+        playerId[kept] = playerId[i];
+        kept++;
+    }
+    pos.resize(kept);
+    velX.resize(kept);
+    velY.resize(kept);
+    lifetime.resize(kept);
+    fade.resize(kept);
+    playerId.resize(kept);
+}
+
+void ParticlePool::clear() {
+    full.clear();
+    pos.clear();
+    velX.clear();
+    velY.clear();
+    lifetime.clear();
+    fade.clear();
+    playerId.clear();
+}
+
+size_t ParticlePool::bytesPerParticle() const {
+    if (!compact) return sizeof(Particle);
+    return sizeof(Vec2) + 4 * sizeof(uint16_t) + sizeof(int8_t);
+}
+
+void ParticlePool::shrinkToFit() {
+    full.shrink_to_fit();
+    pos.shrink_to_fit();
+    velX.shrink_to_fit();
+    velY.shrink_to_fit();
+    lifetime.shrink_to_fit();
+    fade.shrink_to_fit();
+    playerId.shrink_to_fit();
+}
+
+void ParticlePool::saveState(CheckpointWriter& out) const {
+    out.put(compact);
+    if (!compact) {
+        out.putVector(full);
+        return;
+    }
+    out.putVector(pos);
+    out.putVector(velX);
+    out.putVector(velY);
+    out.putVector(lifetime);
+    out.putVector(fade);
+    out.putVector(playerId);
+}
+
+void ParticlePool::loadState(CheckpointReader& in) {
+    clear();
+    in.get(compact);
+    if (!compact) {
+        in.getVector(full);
+    } else {
+        in.getVector(pos);
+        in.getVector(velX);
+        in.getVector(velY);
+        in.getVector(lifetime);
+        in.getVector(fade);
+        in.getVector(playerId);
+        size_t count = pos.size();
+        if (velX.size() != count || velY.size() != count || lifetime.size() != count ||
+            fade.size() != count || playerId.size() != count) {
+            in.fail();
+        }
+    }
+    releaseUnused();
+}
+
+void ParticlePool::releaseUnused() {
+    if (compact) {
+        std::vector<Particle>().swap(full);
+    } else {
+        std::vector<Vec2>().swap(pos);
+        std::vector<uint16_t>().swap(velX);
+        std::vector<uint16_t>().swap(velY);
+        std::vector<uint16_t>().swap(lifetime);
+        std::vector<uint16_t>().swap(fade);
+        std::vector<int8_t>().swap(playerId);
+    }
+}
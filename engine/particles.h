@@ -0,0 +1,168 @@
+/**
+ * @file particles.h
+ * @brief Explosion particle pool with an optional compact 16-bit tier
+ *
+ * Particles are purely visual: they move ballistically, fade out and are
+ * never read by the physics. A large explosion adds dozens at once, so the
+ * pool is the biggest cold allocation of a busy game. It stores them
+ * either as full Particle records (the default; 60 bytes, since Particle
+ * is a Body) or, in the compact tier, as columns of
+ *
+ *     position      2 x float    8 bytes  (world coordinates need float)
+ *     velocity      2 x half     4 bytes
+ *     lifetime      half         2 bytes  (initial lifetime, for the fade rate)
+ *     fade          unorm16      2 bytes  (remaining / initial lifetime)
+ *     playerId      int8         1 byte
+ *
+ * that is 17 bytes per particle. The compact tier advances particles a
+ * block at a time: velocities and lifetimes are decoded into stack
+ * buffers with the batch conversions of half.h, positions advanced and the
+ * fade counted down in integer steps of round(65535 dt / lifetime), so a
+ * particle expires within one step of when the full tier expires it.
+ * Velocities are rounded once when the particle is stored (0.05 %, under
+ * a pixel over a particle's life).
+ *
+ * Switching tiers converts the particles in place. Both tiers produce the
+ * same render data (position, fade alpha, player id) through Particle
+ * values or getRenderData().
+ *
+ * The tier stops at particles because nothing else cold is free to round.
+ * A bullet's lifetime decides when a gravitating body leaves the
+ * simulation, and an asteroid's rotation, spin and outline are its
+ * narrowphase collision geometry (polygon.h), so storing any of them in
+ * 16 bits would change trajectories. Bullet::maxLifetime is render-only,
+ * but one float of a 64-byte record saves nothing.
+ */
+
+#pragma once
+#include "checkpoint.h"
+#include "entity.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class ParticlePool
+ * @brief Storage, update and removal of explosion particles
+ */
+class ParticlePool {
+public:
+    /// Floats per particle written by getRenderData (x, y, alpha, playerId)
+    static constexpr int kRenderFloats = 4;
+
+    /**
+     * @brief Construct an empty pool in the full tier
+     */
+    ParticlePool();
+
+    /**
+     * @brief Select the storage tier, converting the stored particles
+     * @param compact True for the 17-byte compact tier, false for full Particle records
+     */
+    void setCompact(bool compact);
+
+    /**
+     * @brief Check the storage tier
+     * @return True if particles are stored compactly
+     */
+    bool isCompact() const { return compact; }
+
+    /**
+     * @brief Number of particles (expired ones stay until removeInactive)
+     * @return Particle count
+     */
+    size_t size() const { return compact ? pos.size() : full.size(); }
+
+    /**
+     * @brief Check for an empty pool
+     * @return True if there are no particles
+     */
+    bool empty() const { return size() == 0; }
+
+    /**
+     * @brief Append a particle
+     * @param particle Particle (converted if the pool is compact)
+     */
+    void add(const Particle& particle);
+
+    /**
+     * @brief Get a particle
+     * @param index Particle index (< size())
+     * @return The particle (decoded in the compact tier)
+     */
+    Particle get(size_t index) const;
+
+    /**
+     * @brief Write render data for a range of particles
+     * @param begin First particle
+     * @param count Number of particles (begin + count <= size())
+     * @param out kRenderFloats floats per particle: x, y, alpha (remaining lifetime fraction), playerId
+     */
+    void getRenderData(size_t begin, size_t count, float* out) const;
+
+    /**
+     * @brief Move every live particle and count down its lifetime
+     * @param dt Time step in seconds
+     */
+    void update(float dt);
+
+    /**
+     * @brief Drop expired particles, keeping the order of the others
+     */
+    void removeInactive();
+
+    /**
+     * @brief Remove all particles (capacity is kept)
+     */
+    void clear();
+
+    /**
+     * @brief Particles the current storage holds without reallocating
+     * @return Capacity in particles
+     */
+    size_t capacity() const { return compact ? pos.capacity() : full.capacity(); }
+
+    /**
+     * @brief Bytes of particle storage per particle in the current tier
+     * @return sizeof(Particle) or the sum of the compact columns
+     */
+    size_t bytesPerParticle() const;
+
+    /**
+     * @brief Heap bytes reserved by the pool
+     * @return capacity() * bytesPerParticle()
+     */
+    size_t capacityBytes() const { return capacity() * bytesPerParticle(); }
+
+    /**
+     * @brief Give unused capacity back to the allocator
+     */
+    void shrinkToFit();
+
+    /**
+     * @brief Append the tier and the particles to a checkpoint
+     * @param out Checkpoint writer
+     */
+    void saveState(CheckpointWriter& out) const;
+
+    /**
+     * @brief Restore state written by saveState
+     * @param in Checkpoint reader (failure is reported through in.good())
+     */
+    void loadState(CheckpointReader& in);
+
+private:
+    bool compact;                   ///< Current tier
+    std::vector<Particle> full;     ///< Full tier records
+    std::vector<Vec2> pos;          ///< Compact: position
+    std::vector<uint16_t> velX;     ///< Compact: velocity x (binary16)
+    std::vector<uint16_t> velY;     ///< Compact: velocity y (binary16)
+    std::vector<uint16_t> lifetime; ///< Compact: initial lifetime (binary16)
+    std::vector<uint16_t> fade;     ///< Compact: remaining lifetime fraction (unorm16, 0 = expired)
+    std::vector<int8_t> playerId;   ///< Compact: colour (-1 white, 0 green, 1 cyan)
+
+    /**
+     * @brief Release every column of the tier not in use
+     */
+    void releaseUnused();
+};
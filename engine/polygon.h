@@ -0,0 +1,85 @@
+/**
+ * @file polygon.h
+ * @brief Asteroid polygon shapes and polygon narrowphase collision tests
+ *
+ * Asteroids are jagged star-shaped polygons. The shape is generated
+ * deterministically from a per-asteroid seed and stored in unit-radius
+ * local coordinates, so the same outline is used for rendering and for
+ * collision regardless of later radius changes. Every vertex lies within
+ * the asteroid's radius, so the circle test remains a conservative
+ * broadphase and the polygon tests below only run for overlapping circles.
+ *
+ * Vertices are kept as structure-of-arrays (separate x and y arrays padded
+ * to a multiple of four) so the per-edge loops compile to SIMD code.
+ */
+
+#pragma once
+#include "vecn.h"
+#include <cstdint>
+
+/// Maximum vertices of an asteroid outline (multiple of 4 for SIMD padding)
+constexpr int kMaxAsteroidVertices = 12;
+
+/**
+ * @struct AsteroidShape
+ * @brief Polygon outline in unit-radius local coordinates
+ *
+ * Vertex i sits at angle 2*pi*i/count with a radial scale in [0.4, 1.0].
+ * Entries past count are padding that generateAsteroidShape fills with
+ * copies of vertex 0: a fixed-width pass over all kMaxAsteroidVertices
+ * (e.g. a SIMD loop) may read them and sees the closing edge followed by
+ * zero-length edges, and checkpointed asteroids hold no stale bytes. The
+ * collision tests and the API read only the first count entries.
+ */
+struct AsteroidShape {
+    alignas(16) float x[kMaxAsteroidVertices];  ///< Vertex x (local, unit radius)
+    alignas(16) float y[kMaxAsteroidVertices];  ///< Vertex y (local, unit radius)
+    int count;                                  ///< Number of vertices in use
+
+    /**
+     * @brief Default constructor - empty shape
+     */
+    AsteroidShape() : x{}, y{}, count(0) {}
+};
+
+/**
+ * @brief Generate an asteroid outline from a seed
+ * @param seed Shape seed (same seed always gives the same outline)
+ * @param outShape Output shape
+ *
+ * Picks 7-11 vertices at evenly spaced angles with a hashed radial
+ * jitter, giving the classic jagged vector-rock look.
+ */
+void generateAsteroidShape(uint32_t seed, AsteroidShape& outShape);
+
+/**
+ * @brief Test whether two asteroid polygons overlap
+ * @param a Shape of first asteroid
+ * @param rotationA Rotation of first asteroid (radians)
+ * @param radiusA Radius (scale) of first asteroid
+ * @param b Shape of second asteroid
+ * @param rotationB Rotation of second asteroid (radians)
+ * @param radiusB Radius (scale) of second asteroid
+ * @param offset Minimum-image offset from A's centre to B's centre
+ * @return True if the outlines intersect or one contains the other
+ *
+ * Outlines are not convex, so the test checks every edge pair for
+ * intersection and falls back to a single point-in-polygon test for
+ * full containment.
+ */
+bool polygonsOverlap(const AsteroidShape& a, float rotationA, float radiusA,
+                     const AsteroidShape& b, float rotationB, float radiusB,
+                     const Vec2& offset);
+
+/**
+ * @brief Test whether a circle overlaps an asteroid polygon
+ * @param shape Asteroid shape
+ * @param rotation Asteroid rotation (radians)
+ * @param radius Asteroid radius (scale)
+ * @param offset Minimum-image offset from the asteroid centre to the circle centre
+ * @param circleRadius Radius of the circle (ship or bullet)
+ * @return True if the circle centre is inside the outline or within
+ *         circleRadius of any edge
+ */
+bool circlePolygonOverlap(const AsteroidShape& shape, float rotation, float radius,
+                          const Vec2& offset, float circleRadius);
@@ -8,6 +8,7 @@
  */
 
 #include "potential.h"
+#include <type_traits>
 
 /**
  * @brief Factory function to create potential by level ID
@@ -22,29 +23,34 @@
  * - Level 3 (Logarithmic): v0=10 with rc=0.1*width provides mild rotation
  * - Level 4 (NFW): rho_s and r_s tuned for realistic dark matter halo effects
  */
-std::unique_ptr<IExternalPotential> createPotential(int levelId, Vec2 worldCenter, float worldWidth) {
+template <int D>
+std::unique_ptr<ExternalPotential<D>> createPotential(int levelId, VecN<D> worldCenter, float worldWidth,
+                                                      SofteningKernel softening) {
     switch (levelId) {
         case 0:
-            return std::make_unique<NoPotential>();
+            return std::make_unique<NoPotential<D>>();
 
         case 1: {
             // Central point mass
             float GM = 50000.0f;
             float eps = 20.0f;
-            return std::make_unique<PointMassPotential>(worldCenter, GM, eps);
+            return withSoftening(softening, eps, [&](const auto& kernel) -> std::unique_ptr<ExternalPotential<D>> {
+                using Kernel = std::decay_t<decltype(kernel)>;
+                return std::make_unique<PointMassPotential<D, Kernel>>(worldCenter, GM, eps);
+            });
         }
 
         case 2: {
             // Harmonic oscillator
             float omega2 = 0.0001f;  // omega^2
-            return std::make_unique<HarmonicPotential>(worldCenter, omega2);
+            return std::make_unique<HarmonicPotential<D>>(worldCenter, omega2);
         }
 
         case 3: {
             // Logarithmic potential
             float v0 = 10.0f;           // Circular velocity
             float rc = worldWidth * 0.1f;  // Core radius
-            return std::make_unique<LogarithmicPotential>(worldCenter, v0, rc);
+            return std::make_unique<LogarithmicPotential<D>>(worldCenter, v0, rc);
         }
 
         case 4: {
@@ -53,10 +59,13 @@ std::unique_ptr<IExternalPotential> createPotential(int levelId, Vec2 worldCente
             float r_s = worldWidth * 0.2f;   // Scale radius
             float G = 50.0f;              // Gravitational constant
             float eps = 10.0f;            // Softening
-            return std::make_unique<NFWPotential>(worldCenter, rho_s, r_s, G, eps);
+            return std::make_unique<NFWPotential<D>>(worldCenter, rho_s, r_s, G, eps);
         }
 
         default:
-            return std::make_unique<NoPotential>();
+            return std::make_unique<NoPotential<D>>();
     }
 }
+
+template std::unique_ptr<ExternalPotential<2>> createPotential<2>(int, VecN<2>, float, SofteningKernel);
+template std::unique_ptr<ExternalPotential<3>> createPotential<3>(int, VecN<3>, float, SofteningKernel);
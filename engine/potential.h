@@ -12,30 +12,47 @@
  * - Harmonic: Oscillatory motion with restoring force
  * - Logarithmic: Flat rotation curves (spiral galaxy-like)
  * - NFW: Dark matter halo profile
+ *
+ * The potentials are templates over the dimension D (default 2, the
+ * game's plane); 3D research runs instantiate them with D = 3. All of
+ * them are spherically symmetric, so the formulas are the same in both.
  */
 
 #pragma once
-#include "vec2.h"
+#include "softening.h"
+#include "vecn.h"
 #include <memory>
 
 /**
- * @class IExternalPotential
+ * @class ExternalPotential
  * @brief Abstract interface for external gravitational potentials
+ * @tparam D Dimension
  *
  * All potential implementations must provide:
  * - Acceleration calculation at any position
+ * - Potential per unit mass (for energy diagnostics)
  * - Human-readable name and description
  */
-class IExternalPotential {
+template <int D = 2>
+class ExternalPotential {
 public:
-    virtual ~IExternalPotential() = default;
+    virtual ~ExternalPotential() = default;
 
     /**
      * @brief Calculate acceleration due to external potential at a position
      * @param pos Position at which to evaluate the potential
      * @return Acceleration vector
      */
-    virtual Vec2 accelerationAt(const Vec2& pos) const = 0;
+    virtual VecN<D> accelerationAt(const VecN<D>& pos) const = 0;
+
+    /**
+     * @brief Calculate potential energy per unit mass at a position
+     * @param pos Position at which to evaluate the potential
+     * @return Potential Φ such that accelerationAt = -∇Φ (up to softening)
+     *
+     * Used for energy diagnostics; not needed for the dynamics.
+     */
+    virtual float potentialAt(const VecN<D>& pos) const = 0;
 
     /**
      * @brief Get the name of this potential
@@ -50,6 +67,9 @@ public:
     virtual const char* getDescription() const = 0;
 };
 
+/// Planar potential interface used by the game
+using IExternalPotential = ExternalPotential<2>;
+
 /**
  * @class NoPotential
  * @brief No external potential - pure N-body dynamics
@@ -57,15 +77,25 @@ public:
  * Returns zero acceleration everywhere. Bodies only experience
  * mutual gravitational attraction from other bodies.
  */
-class NoPotential : public IExternalPotential {
+template <int D = 2>
+class NoPotential : public ExternalPotential<D> {
 public:
     /**
      * @brief Calculate acceleration (always zero)
      * @param pos Position (unused)
      * @return Zero vector
      */
-    Vec2 accelerationAt(const Vec2& pos) const override {
-        return Vec2(0, 0);
+    VecN<D> accelerationAt(const VecN<D>& pos) const override {
+        return VecN<D>();
+    }
+
+    /**
+     * @brief Calculate potential (always zero)
+     * @param pos Position (unused)
+     * @return Zero
+     */
+    float potentialAt(const VecN<D>& pos) const override {
+        return 0;
     }
 
     const char* getName() const override { return "No Potential"; }
@@ -77,15 +107,20 @@ public:
 /**
  * @class PointMassPotential
  * @brief Central point mass creating Keplerian orbits
+ * @tparam D Dimension
+ * @tparam Kernel Softening policy (see softening.h)
  *
  * Models a massive central body (like a star or black hole).
- * Acceleration: a(r) = -GM * r / (r² + ε²)^(3/2)
+ * Acceleration: a(r) = -GM * r / r³ beyond the softening, smoothed at
+ * small r by the same kernel as body-body gravity (Plummer:
+ * a(r) = -GM * r / (r² + ε²)^(3/2)).
  *
  * Softening length ε prevents singularities at r=0.
  * Creates circular, elliptical, parabolic, or hyperbolic orbits
  * depending on velocity and radius.
  */
-class PointMassPotential : public IExternalPotential {
+template <int D = 2, typename Kernel = PlummerSoftening>
+class PointMassPotential : public ExternalPotential<D> {
 public:
     /**
      * @brief Construct point mass potential
@@ -93,30 +128,42 @@ public:
      * @param GM Gravitational parameter (G × mass)
      * @param eps Softening length to prevent singularities
      */
-    PointMassPotential(Vec2 center, float GM, float eps)
-        : center(center), GM(GM), eps(eps) {}
+    PointMassPotential(VecN<D> center, float GM, float eps)
+        : center(center), GM(GM), kernel(eps) {}
 
     /**
      * @brief Calculate acceleration toward central mass
      * @param pos Position at which to calculate acceleration
      * @return Acceleration vector pointing toward center, magnitude ∝ 1/r²
      */
-    Vec2 accelerationAt(const Vec2& pos) const override {
-        Vec2 dr = center - pos;
-        float r2 = dr.lengthSquared();
-        float r3 = std::pow(r2 + eps * eps, 1.5f);
-        return dr * (GM / r3);
+    VecN<D> accelerationAt(const VecN<D>& pos) const override {
+        VecN<D> dr = center - pos;
+        float accScale, phi;
+        kernel.apply(dr.lengthSquared(), GM, accScale, phi);
+        return dr * accScale;
+    }
+
+    /**
+     * @brief Calculate softened Kepler potential
+     * @param pos Position at which to evaluate
+     * @return Φ(r) = -GM / r beyond the softening (Plummer: -GM / sqrt(r² + ε²))
+     */
+    float potentialAt(const VecN<D>& pos) const override {
+        VecN<D> dr = pos - center;
+        float accScale, phi;
+        kernel.apply(dr.lengthSquared(), GM, accScale, phi);
+        return -phi;
     }
 
     const char* getName() const override { return "Point Mass"; }
     const char* getDescription() const override {
-        return "Central gravitational potential: a(r) = -GM * r / (r^2 + eps^2)^1.5";
+        return "Central gravitational potential: a(r) = -GM * r / r^3, softened like body-body gravity";
     }
 
 private:
-    Vec2 center;  ///< Position of central mass
-    float GM;     ///< Gravitational parameter (G × mass)
-    float eps;    ///< Softening length
+    VecN<D> center;  ///< Position of central mass
+    float GM;        ///< Gravitational parameter (G × mass)
+    Kernel kernel;   ///< Softening kernel
 };
 
 /**
@@ -130,14 +177,15 @@ private:
  * with the same angular frequency ω regardless of amplitude.
  * Unique property: orbital period independent of radius.
  */
-class HarmonicPotential : public IExternalPotential {
+template <int D = 2>
+class HarmonicPotential : public ExternalPotential<D> {
 public:
     /**
      * @brief Construct harmonic potential
      * @param center Center of the potential well
      * @param omega2 Square of angular frequency (ω²)
      */
-    HarmonicPotential(Vec2 center, float omega2)
+    HarmonicPotential(VecN<D> center, float omega2)
         : center(center), omega2(omega2) {}
 
     /**
@@ -145,18 +193,28 @@ public:
      * @param pos Position at which to calculate acceleration
      * @return Acceleration proportional to displacement from center
      */
-    Vec2 accelerationAt(const Vec2& pos) const override {
-        Vec2 dr = pos - center;
+    VecN<D> accelerationAt(const VecN<D>& pos) const override {
+        VecN<D> dr = pos - center;
         return dr * (-omega2);
     }
 
+    /**
+     * @brief Calculate harmonic potential
+     * @param pos Position at which to evaluate
+     * @return Φ(r) = ω² r² / 2
+     */
+    float potentialAt(const VecN<D>& pos) const override {
+        VecN<D> dr = pos - center;
+        return 0.5f * omega2 * dr.lengthSquared();
+    }
+
     const char* getName() const override { return "Harmonic Oscillator"; }
     const char* getDescription() const override {
         return "Harmonic potential: a(r) = -omega^2 * r. Creates oscillatory orbits.";
     }
 
 private:
-    Vec2 center;   ///< Center of oscillator
+    VecN<D> center;   ///< Center of oscillator
     float omega2;  ///< Square of angular frequency
 };
 
@@ -172,7 +230,8 @@ private:
  * historically motivating dark matter. Core radius r_c prevents
  * singularity at center.
  */
-class LogarithmicPotential : public IExternalPotential {
+template <int D = 2>
+class LogarithmicPotential : public ExternalPotential<D> {
 public:
     /**
      * @brief Construct logarithmic potential
@@ -180,7 +239,7 @@ public:
      * @param v0 Circular velocity (asymptotic value at large r)
      * @param rc Core radius (softens central behavior)
      */
-    LogarithmicPotential(Vec2 center, float v0, float rc)
+    LogarithmicPotential(VecN<D> center, float v0, float rc)
         : center(center), v0(v0), rc(rc) {}
 
     /**
@@ -188,24 +247,36 @@ public:
      * @param pos Position at which to calculate acceleration
      * @return Acceleration giving v_circular ≈ v₀ at large r
      */
-    Vec2 accelerationAt(const Vec2& pos) const override {
-        Vec2 dr = pos - center;
+    VecN<D> accelerationAt(const VecN<D>& pos) const override {
+        VecN<D> dr = pos - center;
         float r2 = dr.lengthSquared();
         float r = std::sqrt(r2);
-        if (r < 1e-6f) return Vec2(0, 0);
+        if (r < 1e-6f) return VecN<D>();
 
         // a(r) = -v0^2 * r / (r^2 + rc^2)
         float factor = -v0 * v0 / (r2 + rc * rc);
         return dr * factor;
     }
 
+    /**
+     * @brief Calculate logarithmic potential
+     * @param pos Position at which to evaluate
+     * @return Φ(r) = (v₀² / 2) ln(r² + r_c²)
+     *
+     * The factor 1/2 matches the acceleration used by accelerationAt.
+     */
+    float potentialAt(const VecN<D>& pos) const override {
+        VecN<D> dr = pos - center;
+        return 0.5f * v0 * v0 * std::log(dr.lengthSquared() + rc * rc);
+    }
+
     const char* getName() const override { return "Logarithmic"; }
     const char* getDescription() const override {
         return "Logarithmic potential: V(r) = v0^2 * ln(r^2 + rc^2). Flat rotation curve.";
     }
 
 private:
-    Vec2 center;  ///< Center of potential
+    VecN<D> center;  ///< Center of potential
     float v0;     ///< Circular velocity
     float rc;     ///< Core radius
 };
@@ -223,7 +294,8 @@ private:
  *
  * Produces cuspy density profile at small r and ρ ∝ r⁻³ at large r.
  */
-class NFWPotential : public IExternalPotential {
+template <int D = 2>
+class NFWPotential : public ExternalPotential<D> {
 public:
     /**
      * @brief Construct NFW halo potential
@@ -233,7 +305,7 @@ public:
      * @param G Gravitational constant
      * @param eps Softening length
      */
-    NFWPotential(Vec2 center, float rho_s, float r_s, float G, float eps)
+    NFWPotential(VecN<D> center, float rho_s, float r_s, float G, float eps)
         : center(center), rho_s(rho_s), r_s(r_s), G(G), eps(eps) {}
 
     /**
@@ -245,10 +317,10 @@ public:
      * Computes enclosed mass M(<r) analytically, then applies
      * a = -GM(<r)/r² with softening.
      */
-    Vec2 accelerationAt(const Vec2& pos) const override {
-        Vec2 dr = pos - center;
+    VecN<D> accelerationAt(const VecN<D>& pos) const override {
+        VecN<D> dr = pos - center;
         float r = dr.length();
-        if (r < 1e-6f) return Vec2(0, 0);
+        if (r < 1e-6f) return VecN<D>();
 
         // NFW enclosed mass: M(<r) = 4π ρ_s r_s^3 [ln(1+x) - x/(1+x)]
         // where x = r/r_s
@@ -264,13 +336,29 @@ public:
         return dr * factor;
     }
 
+    /**
+     * @brief Calculate NFW potential
+     * @param pos Position at which to evaluate
+     * @return Φ(r) = -4πGρ_s r_s³ ln(1 + r/r_s) / r
+     *
+     * Unsoftened analytic form; it differs from the softened acceleration
+     * only inside ~eps of the centre.
+     */
+    float potentialAt(const VecN<D>& pos) const override {
+        float r = (pos - center).length();
+        float prefactor = -4.0f * 3.14159265f * G * rho_s * r_s * r_s;
+        if (r < 1e-6f) return prefactor;  // limit r -> 0
+        float x = r / r_s;
+        return prefactor * std::log(1.0f + x) / x;
+    }
+
     const char* getName() const override { return "NFW Profile"; }
     const char* getDescription() const override {
         return "Navarro-Frenk-White dark matter halo: ρ(r) ∝ 1/(r(1+r/rs)^2)";
     }
 
 private:
-    Vec2 center;   ///< Center of halo
+    VecN<D> center;   ///< Center of halo
     float rho_s;   ///< Characteristic density
     float r_s;     ///< Scale radius
     float G;       ///< Gravitational constant
@@ -279,9 +367,11 @@ private:
 
 /**
  * @brief Factory function to create potential by level ID
+ * @tparam D Dimension (instantiated for 2 and 3)
  * @param levelId Integer identifying the potential type (0-4)
  * @param worldCenter Center position for the potential
  * @param worldWidth Width of simulation domain (used for scaling)
+ * @param softening Kernel softening the point mass (match PhysicsConfig::softening)
  * @return Unique pointer to created potential
  *
  * Level mapping:
@@ -291,4 +381,6 @@ private:
  * - 3: Logarithmic
  * - 4: NFW Profile
  */
-std::unique_ptr<IExternalPotential> createPotential(int levelId, Vec2 worldCenter, float worldWidth);
+template <int D>
+std::unique_ptr<ExternalPotential<D>> createPotential(int levelId, VecN<D> worldCenter, float worldWidth,
+                                                      SofteningKernel softening = SofteningKernel::PLUMMER);
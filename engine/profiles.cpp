@@ -0,0 +1,163 @@
+/**
+ * @file profiles.cpp
+ * @brief Parallel binned reduction of radial profiles
+ */
+
+#include "profiles.h"
+#include "entity.h"
+#include <algorithm>
+#include <cmath>
+
+/// Sums kept per bin: tracer count, mass, m·v_r, m·v_r², m·v_t, m·v_t², then all mass (black holes too)
+static constexpr int kSums = 7;
+
+RadialProfiler::RadialProfiler() : stepsUntilUpdate(0), updates(0), bins(0) {
+}
+
+void RadialProfiler::setConfig(const ProfileConfig& newConfig) {
+    config = newConfig;
+    config.bins = std::max(1, std::min(config.bins, kMaxBins));
+    config.interval = std::max(config.interval, 1);
+    config.maxRadius = std::max(config.maxRadius, 0.0f);
+    reset();
+}
+
+void RadialProfiler::reset() {
+    stepsUntilUpdate = 0;
+    updates = 0;
+    bins = 0;
+    columns.clear();
+}
+
+bool RadialProfiler::update(const std::vector<Body*>& bodies, const IExternalPotential* external,
+                            const Vec2& centre, float defaultRadius, float G, WorkerPool* pool) {
+    if (!config.enabled) return false;
+    if (stepsUntilUpdate > 0) {
+        stepsUntilUpdate--;
+        return false;
+    }
+    stepsUntilUpdate = config.interval - 1;
+
+    int numBins = config.bins;
+    float rMax = config.maxRadius > 0 ? config.maxRadius : defaultRadius;
+    float invWidth = rMax > 0 ? numBins / rMax : 0.0f;
+
+    // Small enough sets are reduced serially; hand-off would dominate
+    const int minBodiesPerTask = 1024;
+    int count = (int)bodies.size();
+    int numTasks = 1;
+    if (pool) {
+        numTasks = std::min(pool->getThreadCount(), std::max(1, count / minBodiesPerTask));
+    }
+
+    binIndex.resize(count);
+    mass.resize(count);
+    radialVel.resize(count);
+    tangentVel.resize(count);
+    tracer.resize(count);
+    partial.assign((size_t)numTasks * numBins * kSums, 0.0);
+
+    auto reduceTask = [&](int task) {
+        int begin, end;
+        taskRange(count, numTasks, task, begin, end);
+
+        // Gather this task's bodies into columns
+        for (int i = begin; i < end; i++) {
+            const Body* body = bodies[i];
+            Vec2 dr = body->pos - centre;
+            float r = dr.length();
+            float invR = r > 0 ? 1.0f / r : 0.0f;
+            binIndex[i] = r < rMax ? std::min((int)(r * invWidth), numBins - 1) : -1;
+            mass[i] = body->mass;
+            radialVel[i] = (dr.x * body->vel.x + dr.y * body->vel.y) * invR;
+            tangentVel[i] = (dr.x * body->vel.y - dr.y * body->vel.x) * invR;
+            tracer[i] = body->type != EntityType::BLACK_HOLE;
+        }
+
+        // Reduce the columns into this task's bins
+        double* sums = partial.data() + (size_t)task * numBins * kSums;
+        for (int i = begin; i < end; i++) {
+            if (binIndex[i] < 0) continue;
+            double* s = sums + binIndex[i] * kSums;
+            double m = mass[i], vr = radialVel[i], vt = tangentVel[i];
+            s[6] += m;
+            if (!tracer[i]) continue;
+            s[0] += 1;
+            s[1] += m;
+            s[2] += m * vr;
+            s[3] += m * vr * vr;
+            s[4] += m * vt;
+            s[5] += m * vt * vt;
+        }
+    };
+    if (pool) {
+        pool->run(numTasks, reduceTask);
+    } else {
+        reduceTask(0);
+    }
+
+    // Combine in task order for thread-count independent profiles
+    for (int task = 1; task < numTasks; task++) {
+        const double* sums = partial.data() + (size_t)task * numBins * kSums;
+        for (int k = 0; k < numBins * kSums; k++) partial[k] += sums[k];
+    }
+
+    bins = numBins;
+    columns.resize((size_t)kProfileColumns * numBins);
+    float* radius = columns.data() + static_cast<int>(ProfileColumn::RADIUS) * numBins;
+    float* counts = columns.data() + static_cast<int>(ProfileColumn::COUNT) * numBins;
+    float* density = columns.data() + static_cast<int>(ProfileColumn::DENSITY) * numBins;
+    float* rotation = columns.data() + static_cast<int>(ProfileColumn::ROTATION) * numBins;
+    float* dispersion = columns.data() + static_cast<int>(ProfileColumn::DISPERSION) * numBins;
+    float* circular = columns.data() + static_cast<int>(ProfileColumn::CIRCULAR) * numBins;
+
+    const double pi = 3.14159265358979;
+    double width = rMax / numBins;
+    double enclosed = 0;
+    for (int b = 0; b < numBins; b++) {
+        const double* s = partial.data() + b * kSums;
+        double rIn = b * width, rOut = (b + 1) * width, rMid = (b + 0.5) * width;
+        radius[b] = (float)rMid;
+        counts[b] = (float)s[0];
+        density[b] = (float)(s[1] / (pi * (rOut * rOut - rIn * rIn)));
+        if (s[1] > 0) {
+            double meanVr = s[2] / s[1], meanVt = s[4] / s[1];
+            double variance = 0.5 * (s[3] / s[1] - meanVr * meanVr + s[5] / s[1] - meanVt * meanVt);
+            rotation[b] = (float)meanVt;
+            dispersion[b] = (float)std::sqrt(std::max(variance, 0.0));
+        } else {
+            rotation[b] = 0;
+            dispersion[b] = 0;
+        }
+
+        // Monopole of the bodies inside rMid plus the inward external pull (as in scenario.cpp)
+        double v2 = G * (enclosed + 0.5 * s[6]) / rMid;
+        if (external) {
+            Vec2 acc = external->accelerationAt(centre + Vec2((float)rMid, 0));
+            v2 += std::max(0.0, -(double)acc.x * rMid);
+        }
+        circular[b] = (float)std::sqrt(std::max(v2, 0.0));
+        enclosed += s[6];
+    }
+    updates++;
+    return true;
+}
+
+void RadialProfiler::saveState(CheckpointWriter& out) const {
+    out.put(config);
+    out.put(stepsUntilUpdate);
+    out.put(updates);
+    out.put(bins);
+    out.putVector(columns);
+}
+
+void RadialProfiler::loadState(CheckpointReader& in) {
+    in.get(config);
+    in.get(stepsUntilUpdate);
+    in.get(updates);
+    in.get(bins);
+    in.getVector(columns);
+    if (bins < 0 || bins > kMaxBins || columns.size() != (size_t)kProfileColumns * bins) {
+        in.fail();
+    }
+}
@@ -0,0 +1,161 @@
+/**
+ * @file profiles.h
+ * @brief Radial profiles and rotation curves about the potential centre
+ *
+ * The potential levels exist to show galactic dynamics: the flat rotation
+ * curve of the logarithmic potential, the rising-then-falling curve of an
+ * NFW halo. RadialProfiler bins the bodies by distance from the potential
+ * centre in the analysis phase of a step and publishes, per annulus, the
+ * surface density, the measured rotation curve, the velocity dispersion
+ * and the circular speed the model predicts at that radius.
+ *
+ * An update is one pass of a WorkerPool: each task gathers its slice of
+ * the body list into structure-of-arrays columns (bin, mass, radial and
+ * tangential velocity), then reduces those columns into a private set of
+ * bins. The per-task bins are combined in task order, so the profiles do
+ * not depend on the thread count.
+ *
+ * The output is one column-major float array (kProfileColumns columns of
+ * `bins` values, see ProfileColumn) owned by the profiler and overwritten
+ * in place, so the browser and the C ABI read it without copying entities.
+ */
+
+#pragma once
+#include "checkpoint.h"
+#include "parallel.h"
+#include "potential.h"
+#include "vecn.h"
+#include <vector>
+
+struct Body;
+
+/**
+ * @enum ProfileColumn
+ * @brief Columns of the published profile, in storage order
+ */
+enum class ProfileColumn {
+    RADIUS = 0,      ///< Bin centre radius
+    COUNT = 1,       ///< Bodies in the annulus (black holes excluded)
+    DENSITY = 2,     ///< Surface density: mass / annulus area
+    ROTATION = 3,    ///< Mass-weighted mean tangential velocity (counter-clockwise positive)
+    DISPERSION = 4,  ///< One-dimensional velocity dispersion about the mean flow
+    CIRCULAR = 5     ///< Model circular speed: external potential plus enclosed body mass
+};
+
+/// Number of columns in a published profile
+constexpr int kProfileColumns = 6;
+
+/**
+ * @struct ProfileConfig
+ * @brief Binning and cadence of RadialProfiler
+ */
+struct ProfileConfig {
+    bool enabled;     ///< Compute profiles at all
+    int bins;         ///< Radial bins (1 to RadialProfiler::kMaxBins)
+    float maxRadius;  ///< Outer edge of the last bin (0 = half the shorter world side)
+    int interval;     ///< Steps between updates (1 = every step)
+
+    /**
+     * @brief Default constructor - off, 32 bins over the world, every step
+     */
+    ProfileConfig() : enabled(false), bins(32), maxRadius(0), interval(1) {}
+};
+
+/**
+ * @class RadialProfiler
+ * @brief Parallel binned reduction of radial profiles
+ */
+class RadialProfiler {
+public:
+    /// Largest supported bin count
+    static constexpr int kMaxBins = 1024;
+
+    /**
+     * @brief Default constructor - disabled, no profile yet
+     */
+    RadialProfiler();
+
+    /**
+     * @brief Set binning and cadence (clears the published profile)
+     * @param config New configuration (bins and interval are clamped)
+     */
+    void setConfig(const ProfileConfig& config);
+
+    /**
+     * @brief Get the active configuration
+     * @return Configuration
+     */
+    const ProfileConfig& getConfig() const { return config; }
+
+    /**
+     * @brief Forget the published profile and restart the cadence
+     */
+    void reset();
+
+    /**
+     * @brief Count a step and recompute the profile if one is due
+     * @param bodies Gravitating bodies (velocities at the end of the step)
+     * @param external External potential (nullptr for none)
+     * @param centre Potential centre
+     * @param defaultRadius Outer radius when config.maxRadius is 0
+     * @param G Gravitational constant (for the enclosed-mass circular speed)
+     * @param pool Worker pool for the reduction (nullptr = serial)
+     * @return True if the profile was recomputed
+     */
+    bool update(const std::vector<Body*>& bodies, const IExternalPotential* external, const Vec2& centre,
+                float defaultRadius, float G, WorkerPool* pool);
+
+    /**
+     * @brief Get the published profile
+     * @return Column-major array: column c starts at c * getBins() (nullptr before the first update)
+     */
+    const float* getData() const { return bins > 0 ? columns.data() : nullptr; }
+
+    /**
+     * @brief Get one column of the published profile
+     * @param column Column
+     * @return getBins() values (nullptr before the first update)
+     */
+    const float* getColumn(ProfileColumn column) const {
+        return bins > 0 ? columns.data() + static_cast<int>(column) * bins : nullptr;
+    }
+
+    /**
+     * @brief Get the bin count of the published profile
+     * @return Bins (0 before the first update)
+     */
+    int getBins() const { return bins; }
+
+    /**
+     * @brief Get the number of profiles computed since the last reset
+     * @return Updates
+     */
+    int getUpdates() const { return updates; }
+
+    /**
+     * @brief Append the profiler state (config, cadence, profile) to a checkpoint
+     * @param out Checkpoint writer
+     */
+    void saveState(CheckpointWriter& out) const;
+
+    /**
+     * @brief Restore state written by saveState
+     * @param in Checkpoint reader (failure is reported through in.good())
+     */
+    void loadState(CheckpointReader& in);
+
+private:
+    ProfileConfig config;          ///< Active configuration
+    int stepsUntilUpdate;          ///< Steps left before the next update
+    int updates;                   ///< Profiles computed since reset
+    int bins;                      ///< Bins of the published profile (0 = none yet)
+    std::vector<float> columns;    ///< Published profile, kProfileColumns * bins
+
+    // Structure-of-arrays scratch, one slot per body (each task fills its own range)
+    std::vector<int> binIndex;     ///< Bin of each body (-1 = outside)
+    std::vector<float> mass;       ///< Mass of each body
+    std::vector<float> radialVel;  ///< Velocity component away from the centre
+    std::vector<float> tangentVel; ///< Velocity component counter-clockwise about the centre
+    std::vector<uint8_t> tracer;   ///< 1 if the body counts towards density and kinematics
+    std::vector<double> partial;   ///< Per-task bin sums, numTasks * bins * kSums
+};
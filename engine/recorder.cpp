@@ -0,0 +1,158 @@
+/**
+ * @file recorder.cpp
+ * @brief Asynchronous trajectory recorder
+ */
+
+#include "recorder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+/**
+ * @brief Seconds elapsed since a start time
+ * @param start Start time point
+ * @return Elapsed wall-clock seconds
+ */
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+TrajectoryRecorder::TrajectoryRecorder()
+    : file(nullptr), full{false, false}, fillIndex(0), stopping(false), failed(false), keyframeInterval(1),
+      offset(0) {}
+
+TrajectoryRecorder::~TrajectoryRecorder() {
+    close();
+}
+
+bool TrajectoryRecorder::open(const std::string& path, int interval, int keyframeInterval) {
+    close();
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+
+    this->keyframeInterval = (uint32_t)std::max(1, keyframeInterval);
+    offset = 0;
+    index.clear();
+    TrajectoryFileHeader header = {};
+    std::memcpy(header.magic, kTrajectoryMagic, sizeof(header.magic));
+    header.version = kTrajectoryVersion;
+    header.interval = (uint32_t)interval;
+    header.keyframeInterval = this->keyframeInterval;
+    failed = !write(&header, sizeof(header));
+    full[0] = full[1] = false;
+    fillIndex = 0;
+    stopping = false;
+    stats = RecorderStats();
+    writer = std::thread(&TrajectoryRecorder::writerLoop, this);
+    return !failed;
+}
+
+TrajectoryFrame& TrajectoryRecorder::acquire() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (full[fillIndex]) {
+        auto start = std::chrono::steady_clock::now();
+        changed.wait(lock, [&] { return !full[fillIndex]; });
+        stats.stallSeconds += secondsSince(start);
+        stats.stalls++;
+    }
+    return buffers[fillIndex];
+}
+
+void TrajectoryRecorder::submit() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        full[fillIndex] = true;
+        fillIndex ^= 1;
+    }
+    changed.notify_all();
+}
+
+bool TrajectoryRecorder::close() {
+    if (!file) return !failed;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    writer.join();
+
+    // Frames end 8-byte aligned, so the index is too
+    TrajectoryFooter footer = {};
+    footer.indexOffset = offset;
+    footer.frameCount = index.size();
+    std::memcpy(footer.magic, kTrajectoryIndexMagic, sizeof(footer.magic));
+    bool ok = write(index.data(), index.size() * sizeof(TrajectoryIndexEntry)) && write(&footer, sizeof(footer));
+    failed = std::fclose(file) != 0 || !ok || failed;
+    file = nullptr;
+    return !failed;
+}
+
+RecorderStats TrajectoryRecorder::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+bool TrajectoryRecorder::write(const void* data, size_t size) {
+    offset += size;
+    return size == 0 || std::fwrite(data, 1, size, file) == size;
+}
+
+void TrajectoryRecorder::writerLoop() {
+    const TrajectoryFrame empty;
+    TrajectoryFrame keyframe;
+    uint32_t keyframeNumber = 0;
+    std::vector<uint8_t> payload;
+    int writeIndex = 0;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&] { return full[writeIndex] || stopping; });
+            if (!full[writeIndex]) return;  // stopping and drained
+        }
+
+        // The full buffer belongs to this thread until it is released below
+        TrajectoryFrame& frame = buffers[writeIndex];
+        uint32_t number = (uint32_t)index.size();
+        bool isKeyframe = number % keyframeInterval == 0;
+        if (isKeyframe) keyframeNumber = number;
+
+        auto encodeStart = std::chrono::steady_clock::now();
+        payload.clear();
+        encodeFrame(frame, isKeyframe ? empty : keyframe, payload);
+        double encodeTime = secondsSince(encodeStart);
+
+        auto writeStart = std::chrono::steady_clock::now();
+        TrajectoryFrameHeader header = {};
+        header.payloadBytes = (uint32_t)payload.size();
+        header.count = (uint32_t)frame.size();
+        header.step = frame.step;
+        header.time = frame.time;
+        header.keyframe = keyframeNumber;
+        header.sync = kTrajectoryFrameSync;
+        TrajectoryIndexEntry entry = {};
+        entry.step = frame.step;
+        entry.offset = offset;
+        entry.keyframe = keyframeNumber;
+        index.push_back(entry);
+        static const uint8_t zeros[8] = {};
+        bool ok = write(&header, sizeof(header)) && write(payload.data(), payload.size()) &&
+                  write(zeros, (8 - payload.size() % 8) % 8);
+        double writeTime = secondsSince(writeStart);
+
+        if (isKeyframe) keyframe = frame;  // reuses capacity after the first keyframe
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            full[writeIndex] = false;
+            failed = failed || !ok;
+            stats.frames++;
+            stats.keyframes += isKeyframe;
+            stats.rawBytes += (uint64_t)header.count * 5 * sizeof(uint32_t);
+            stats.compressedBytes += payload.size();
+            stats.encodeSeconds += encodeTime;
+            stats.writeSeconds += writeTime;
+        }
+        changed.notify_all();
+        writeIndex ^= 1;
+    }
+}
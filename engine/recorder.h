@@ -0,0 +1,127 @@
+/**
+ * @file recorder.h
+ * @brief Asynchronous trajectory recorder (native build)
+ *
+ * The simulation thread copies a frame into one of two staging buffers and
+ * returns immediately; a writer thread compresses the other buffer (see
+ * trajectory.h) and streams it to disk. The simulation only waits if the
+ * writer is still busy with the previous frame when the next one is ready
+ * (both buffers full); that wait is measured and reported as stall time.
+ *
+ * The container format (keyframes, delta frames and the footer index) is
+ * described in trajectory.h; the index and footer are written by close().
+ */
+
+#pragma once
+#include "trajectory.h"
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @struct RecorderStats
+ * @brief Recorder throughput counters
+ */
+struct RecorderStats {
+    uint64_t frames;           ///< Frames written
+    uint64_t keyframes;        ///< Of which keyframes
+    uint64_t rawBytes;         ///< Uncompressed column bytes
+    uint64_t compressedBytes;  ///< Payload bytes written
+    double encodeSeconds;      ///< Writer time spent compressing
+    double writeSeconds;       ///< Writer time spent in file I/O
+    double stallSeconds;       ///< Simulation time spent waiting for a free buffer
+    uint64_t stalls;           ///< Frames that had to wait
+
+    /**
+     * @brief Default constructor - zero counters
+     */
+    RecorderStats()
+        : frames(0), keyframes(0), rawBytes(0), compressedBytes(0), encodeSeconds(0), writeSeconds(0),
+          stallSeconds(0), stalls(0) {}
+};
+
+/**
+ * @class TrajectoryRecorder
+ * @brief Double-buffered, background-compressed trajectory writer
+ *
+ * Usage per recorded step: `TrajectoryFrame& f = recorder.acquire();`,
+ * fill f (e.g. GameEngine::captureTrajectory), then `recorder.submit();`.
+ */
+class TrajectoryRecorder {
+public:
+    /**
+     * @brief Construct a closed recorder
+     */
+    TrajectoryRecorder();
+
+    /**
+     * @brief Flush and close
+     */
+    ~TrajectoryRecorder();
+
+    TrajectoryRecorder(const TrajectoryRecorder&) = delete;
+    TrajectoryRecorder& operator=(const TrajectoryRecorder&) = delete;
+
+    /**
+     * @brief Create the output file and start the writer thread
+     * @param path Output path
+     * @param interval Recording interval in steps (stored in the header)
+     * @param keyframeInterval Frames per keyframe (1 = every frame self-contained)
+     * @return False if the file cannot be created
+     */
+    bool open(const std::string& path, int interval, int keyframeInterval = 30);
+
+    /**
+     * @brief Get a staging buffer for the next frame
+     * @return Frame to fill (blocks while both buffers are in use)
+     */
+    TrajectoryFrame& acquire();
+
+    /**
+     * @brief Hand the acquired frame to the writer
+     */
+    void submit();
+
+    /**
+     * @brief Write all pending frames and the index, stop the writer and close the file
+     * @return False if any write failed
+     */
+    bool close();
+
+    /**
+     * @brief Get throughput counters (call after close for final values)
+     * @return Statistics
+     */
+    RecorderStats getStats() const;
+
+private:
+    FILE* file;                        ///< Output file (null when closed)
+    std::thread writer;                ///< Background compression thread
+    mutable std::mutex mutex;          ///< Guards the buffer states and stats
+    std::condition_variable changed;   ///< Signalled on every state change
+    TrajectoryFrame buffers[2];        ///< Staging buffers
+    bool full[2];                      ///< Buffer holds a submitted frame
+    int fillIndex;                     ///< Buffer the simulation fills next
+    bool stopping;                     ///< Writer should exit once buffers drain
+    bool failed;                       ///< A write failed
+    uint32_t keyframeInterval;         ///< Frames per keyframe
+    uint64_t offset;                   ///< Bytes written so far (writer thread)
+    std::vector<TrajectoryIndexEntry> index;  ///< Footer index (writer thread)
+    RecorderStats stats;               ///< Counters
+
+    /**
+     * @brief Writer thread main loop
+     */
+    void writerLoop();
+
+    /**
+     * @brief Write bytes and advance the offset
+     * @param data Bytes
+     * @param size Byte count
+     * @return False on I/O error
+     */
+    bool write(const void* data, size_t size);
+};
@@ -0,0 +1,181 @@
+/**
+ * @file replay.cpp
+ * @brief Memory-mapped, seekable trajectory reader (native build)
+ */
+
+#include "replay.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Round up to the frame alignment
+ * @param offset Byte offset
+ * @return Next multiple of 8
+ */
+static uint64_t alignUp8(uint64_t offset) {
+    return (offset + 7) & ~(uint64_t)7;
+}
+
+TrajectoryFile::TrajectoryFile()
+    : data(nullptr), size(0), interval(0), keyframeInterval(0), entries(nullptr), frameCount(0),
+      keyframeNumber(-1) {}
+
+TrajectoryFile::~TrajectoryFile() {
+    close();
+}
+
+void TrajectoryFile::close() {
+    if (data) ::munmap(data, size);
+    data = nullptr;
+    size = 0;
+    entries = nullptr;
+    frameCount = 0;
+    scannedIndex.clear();
+    keyframeNumber = -1;
+}
+
+bool TrajectoryFile::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "cannot open " + path;
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(TrajectoryFileHeader)) {
+        ::close(fd);
+        error = path + ": too small for a trajectory header";
+        return false;
+    }
+    size = (size_t)st.st_size;
+    data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        data = nullptr;
+        size = 0;
+        error = "cannot map " + path;
+        return false;
+    }
+
+    const char* base = static_cast<const char*>(data);
+    const TrajectoryFileHeader* header = reinterpret_cast<const TrajectoryFileHeader*>(base);
+    if (std::memcmp(header->magic, kTrajectoryMagic, sizeof(header->magic)) != 0 ||
+        header->version != kTrajectoryVersion || header->keyframeInterval == 0) {
+        close();
+        error = path + ": not a valid version " + std::to_string(kTrajectoryVersion) + " trajectory";
+        return false;
+    }
+    interval = header->interval;
+    keyframeInterval = header->keyframeInterval;
+
+    // Closed file: the footer points at the index
+    if (size >= sizeof(TrajectoryFileHeader) + sizeof(TrajectoryFooter)) {
+        const TrajectoryFooter* footer =
+            reinterpret_cast<const TrajectoryFooter*>(base + size - sizeof(TrajectoryFooter));
+        uint64_t indexEnd = size - sizeof(TrajectoryFooter);
+        if (std::memcmp(footer->magic, kTrajectoryIndexMagic, sizeof(footer->magic)) == 0 &&
+            footer->indexOffset % 8 == 0 && footer->indexOffset <= indexEnd &&
+            footer->frameCount == (indexEnd - footer->indexOffset) / sizeof(TrajectoryIndexEntry)) {
+            entries = reinterpret_cast<const TrajectoryIndexEntry*>(base + footer->indexOffset);
+            frameCount = (size_t)footer->frameCount;
+
+            // Every frame header must lie between the file header and the index
+            bool valid = footer->indexOffset >= sizeof(TrajectoryFileHeader) + sizeof(TrajectoryFrameHeader);
+            uint64_t lastHeader = footer->indexOffset - sizeof(TrajectoryFrameHeader);
+            for (size_t i = 0; valid && i < frameCount; i++) {
+                valid = entries[i].offset % 8 == 0 && entries[i].offset >= sizeof(TrajectoryFileHeader) &&
+                        entries[i].offset <= lastHeader && entries[i].keyframe <= i;
+            }
+            if (!valid) {
+                close();
+                error = path + ": not a valid version " + std::to_string(kTrajectoryVersion) + " trajectory";
+                return false;
+            }
+            error.clear();
+            return true;
+        }
+    }
+
+    // Unclosed recording: walk the frame headers
+    uint64_t offset = sizeof(TrajectoryFileHeader);
+    while (offset + sizeof(TrajectoryFrameHeader) <= size) {
+        const TrajectoryFrameHeader* frame = reinterpret_cast<const TrajectoryFrameHeader*>(base + offset);
+        if (frame->payloadBytes > size - offset - sizeof(TrajectoryFrameHeader)) break;
+        uint64_t next = alignUp8(offset + sizeof(TrajectoryFrameHeader) + frame->payloadBytes);
+        if (next > size || frame->sync != kTrajectoryFrameSync || frame->keyframe > scannedIndex.size()) break;
+        TrajectoryIndexEntry entry = {};
+        entry.step = frame->step;
+        entry.offset = offset;
+        entry.keyframe = frame->keyframe;
+        scannedIndex.push_back(entry);
+        offset = next;
+    }
+    entries = scannedIndex.data();
+    frameCount = scannedIndex.size();
+    error.clear();
+    return true;
+}
+
+long TrajectoryFile::findFrame(uint64_t step) const {
+    if (frameCount == 0 || step < entries[0].step) return -1;
+
+    // Regular recordings: frame k holds step first + k * interval
+    if (interval > 0) {
+        uint64_t guess = (step - entries[0].step) / interval;
+        if (guess < frameCount && entries[guess].step <= step &&
+            (guess + 1 == frameCount || entries[guess + 1].step > step)) {
+            return (long)guess;
+        }
+    }
+    const TrajectoryIndexEntry* it =
+        std::upper_bound(entries, entries + frameCount, step,
+                         [](uint64_t s, const TrajectoryIndexEntry& e) { return s < e.step; });
+    return (long)(it - entries) - 1;
+}
+
+bool TrajectoryFile::decode(size_t frame, const TrajectoryFrame& reference, TrajectoryFrame& out) {
+    const char* base = static_cast<const char*>(data);
+    uint64_t offset = entries[frame].offset;
+    if (size < sizeof(TrajectoryFrameHeader) || offset > size - sizeof(TrajectoryFrameHeader)) {
+        error = "frame " + std::to_string(frame) + " is out of bounds";
+        return false;
+    }
+    const TrajectoryFrameHeader* header = reinterpret_cast<const TrajectoryFrameHeader*>(base + offset);
+    const uint8_t* payload = reinterpret_cast<const uint8_t*>(header + 1);
+    if (header->payloadBytes > size - offset - sizeof(TrajectoryFrameHeader) ||
+        !decodeFrame(payload, header->payloadBytes, header->count, reference, out)) {
+        error = "frame " + std::to_string(frame) + " is corrupt";
+        return false;
+    }
+    out.step = header->step;
+    out.time = header->time;
+    return true;
+}
+
+bool TrajectoryFile::readFrame(size_t frame, TrajectoryFrame& out) {
+    if (frame >= frameCount) {
+        error = "frame " + std::to_string(frame) + " is out of range";
+        return false;
+    }
+    size_t key = entries[frame].keyframe;
+    if (key > frame) {
+        error = "frame " + std::to_string(frame) + " has an invalid keyframe";
+        return false;
+    }
+    if (keyframeNumber != (long)key) {
+        static const TrajectoryFrame empty;
+        keyframeNumber = -1;
+        if (!decode(key, empty, keyframe)) return false;
+        keyframeNumber = (long)key;
+    }
+    if (frame == key) {
+        out = keyframe;
+        return true;
+    }
+    return decode(frame, keyframe, out);
+}
@@ -0,0 +1,119 @@
+/**
+ * @file replay.h
+ * @brief Memory-mapped, seekable trajectory reader (native build)
+ *
+ * Reads the container written by TrajectoryRecorder (see trajectory.h).
+ * Opening maps the file and locates the footer index; no frame is decoded
+ * until it is requested. Reading frame k decodes its keyframe (cached, so
+ * playing forward costs one payload per frame) and then frame k itself.
+ */
+
+#pragma once
+#include "trajectory.h"
+#include <string>
+#include <vector>
+
+/**
+ * @class TrajectoryFile
+ * @brief Random-access reader for recorded trajectories
+ */
+class TrajectoryFile {
+public:
+    /**
+     * @brief Construct an unopened reader
+     */
+    TrajectoryFile();
+
+    /**
+     * @brief Unmap the file
+     */
+    ~TrajectoryFile();
+
+    TrajectoryFile(const TrajectoryFile&) = delete;
+    TrajectoryFile& operator=(const TrajectoryFile&) = delete;
+
+    /**
+     * @brief Map a trajectory file and load its index
+     * @param path File path
+     * @return False if the file is missing or not a trajectory (see getError)
+     *
+     * Without a valid footer (recording not closed) the index is rebuilt by
+     * walking the frame headers; a truncated last frame is dropped.
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Unmap the current file
+     */
+    void close();
+
+    /**
+     * @brief Number of frames
+     * @return Frame count
+     */
+    size_t getFrameCount() const { return frameCount; }
+
+    /**
+     * @brief Simulation steps between recorded frames
+     * @return Recording interval
+     */
+    uint32_t getInterval() const { return interval; }
+
+    /**
+     * @brief Frames per keyframe
+     * @return Keyframe interval
+     */
+    uint32_t getKeyframeInterval() const { return keyframeInterval; }
+
+    /**
+     * @brief Index record of a frame
+     * @param frame Frame number (< getFrameCount())
+     * @return Step, offset and keyframe of the frame
+     */
+    const TrajectoryIndexEntry& getEntry(size_t frame) const { return entries[frame]; }
+
+    /**
+     * @brief Find the frame recorded at or before a step
+     * @param step Simulation step
+     * @return Frame number, or -1 if the step precedes the first frame
+     *
+     * Constant time for regularly spaced recordings; falls back to a binary
+     * search over the index otherwise.
+     */
+    long findFrame(uint64_t step) const;
+
+    /**
+     * @brief Decode a frame
+     * @param frame Frame number (< getFrameCount())
+     * @param out Output frame
+     * @return False if the frame data is corrupt (see getError)
+     */
+    bool readFrame(size_t frame, TrajectoryFrame& out);
+
+    /**
+     * @brief Reason the last open or read failed
+     * @return Error message
+     */
+    const std::string& getError() const { return error; }
+
+private:
+    void* data;                                ///< Mapping base (null if closed)
+    size_t size;                               ///< Mapping length
+    uint32_t interval;                         ///< Recording interval
+    uint32_t keyframeInterval;                 ///< Frames per keyframe
+    const TrajectoryIndexEntry* entries;       ///< Index (in the mapping or scannedIndex)
+    size_t frameCount;                         ///< Index length
+    std::vector<TrajectoryIndexEntry> scannedIndex;  ///< Index rebuilt from an unclosed file
+    TrajectoryFrame keyframe;                  ///< Last decoded keyframe
+    long keyframeNumber;                       ///< Frame number of keyframe (-1 = none)
+    std::string error;                         ///< Last error
+
+    /**
+     * @brief Decode one frame payload
+     * @param frame Frame number
+     * @param reference Reference frame (empty for keyframes)
+     * @param out Output frame
+     * @return False if the payload is out of bounds or malformed
+     */
+    bool decode(size_t frame, const TrajectoryFrame& reference, TrajectoryFrame& out);
+};
@@ -0,0 +1,1826 @@
+/**
+ * @file runner.cpp
+ * @brief Headless native runner and benchmarks for the game engine
+ *
+ * Builds with `make native` into `nbody-native`. Runs the same GameEngine
+ * used by the WebAssembly build without a browser, for profiling,
+ * scaling measurements and offline simulation runs.
+ *
+ * Modes:
+ * - default: step a game for --steps frames and report throughput and
+ *   time to first step
+ *   (with --diagnostics N, print energy/momentum totals every N steps;
+ *   with --scenario NAME, start from --bodies generated bodies instead;
+ *   --load-snapshot / --save-snapshot read and write snapshot files;
+ *   --record FILE writes every --record-every'th step to a trajectory file;
+ *   --checkpoint-every / --checkpoint-seconds write restartable checkpoints
+ *   and --restart resumes from the last one; --metrics-port N serves live
+ *   Prometheus metrics on 127.0.0.1:N while stepping; --memory-budget
+ *   TAG=MB sets a per-subsystem heap budget; --softening NAME picks the
+ *   softening kernel; --adaptive-dt chooses dt per step, treating --steps
+ *   and the output intervals as fixed-dt frames it lands on exactly;
+ *   --kepler drifts bodies bound to a black hole along exact orbits;
+ *   --compact-storage keeps explosion particles in 16-bit columns;
+ *   --profiles N bins radial profiles about the potential centre every
+ *   step and prints the last one)
+ * - --bench-snapshot: write, map and ingest a --bodies snapshot and time
+ *   each stage
+ * - --bench-recorder: compress --steps frames of --bodies moving bodies
+ *   through the trajectory recorder, report frames/s and compression
+ *   ratio, and verify the file decodes bit for bit
+ * - --bench-scenarios: step every scenario at 1k, 10k, ... --bodies bodies
+ *   with collisions off and report time and tree work per body
+ * - --bench-collisions: time CollisionDetector on a dense fragment field
+ *   for 1..--threads threads and verify every run matches the serial output
+ * - --bench-polygons: time the asteroid polygon narrowphase on pairs whose
+ *   circles overlap and report how many circle hits it rejects
+ * - --bench-balance: compare equal-count and cost-weighted force ranges on
+ *   a clustered field around a black hole (per-task imbalance)
+ * - --bench-softening: per softening kernel, the force law against
+ *   Newtonian gravity, the bias on a --scenario (default plummer) field and
+ *   the gravity cost and energy drift of stepping it
+ * - --bench-kepler: leapfrog against Kepler drift on eccentric orbits
+ *   about a black hole, at fixed and adaptive dt, against the exact orbit
+ * - --bench-storage: memory, update time and fidelity of --bodies
+ *   particles in the full and compact particle tiers, and the throughput
+ *   of the batch 16-bit conversions
+ * - --bench-profiles: time the radial profile reduction on a --bodies
+ *   rotating disc in --level for 1..--threads threads, check every run
+ *   matches the serial profile, and print the profile
+ * - --dims 3: pure N-body run of a 3D --scenario (uniform, plummer or
+ *   collapse) of --bodies bodies in a --width cube on the octree
+ *   (NBodySystem<3>), reporting throughput, tree work and energy drift
+ *   (every --diagnostics N steps if given)
+ * - --bench-dims: the same run in 2D and 3D at 1k, 4k and 16k bodies
+ *   (NBodySystem<2> and <3>), with GameEngine gravity time on the 2D
+ *   field for reference
+ * - --domains P: pure N-body run of --bodies bodies split over P processes
+ *   (DomainSimulation over socket transport)
+ * - --bench-domains: strong and weak scaling of the distributed run for
+ *   P = 1, 2, 4, ... up to --domains
+ */
+
+#include "checkpoint.h"
+#include "domain.h"
+#include "engine.h"
+#include "half.h"
+#include "metrics.h"
+#include "nbodysystem.h"
+#include "recorder.h"
+#include "replay.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
+/**
+ * @struct RunnerOptions
+ * @brief Command line options for the native runner
+ */
+struct RunnerOptions {
+    float width;          ///< World width
+    float height;         ///< World height
+    uint32_t seed;        ///< Random seed
+    int steps;            ///< Number of steps (or benchmark repetitions)
+    int threads;          ///< Maximum worker threads
+    int level;            ///< Potential level (0-4)
+    int asteroids;        ///< Fragment count for collision benchmark
+    int bullets;          ///< Bullet count for collision benchmark
+    int diagnosticsEvery; ///< Print conservation diagnostics every N steps (0 = off)
+    int monitorInterval;  ///< Force accuracy check interval (0 = off)
+    float targetError;    ///< Adaptive theta target (0 = fixed theta)
+    bool benchCollisions; ///< Run collision detection benchmark
+    bool benchPolygons;   ///< Run polygon narrowphase benchmark
+    int domains;          ///< Processes for the distributed run (0 = game mode)
+    int bodies;           ///< Bodies in the distributed run (per process for weak scaling)
+    bool benchDomains;    ///< Run distributed scaling benchmark
+    bool benchBalance;    ///< Run force load-balancing benchmark
+    const char* scenario; ///< Scenario to load into the game (null = normal waves)
+    bool collisions;      ///< Collision handling in game mode
+    bool benchScenarios;  ///< Run scenario scaling benchmark
+    const char* loadSnapshot;  ///< Snapshot to start from (null = none)
+    const char* saveSnapshot;  ///< Snapshot path, printf pattern with the step (null = none)
+    int snapshotEvery;    ///< Write a snapshot every N steps (0 = only at the end)
+    bool benchSnapshot;   ///< Run snapshot I/O benchmark
+    const char* record;   ///< Trajectory output path (null = none)
+    int recordEvery;      ///< Record every N steps
+    int keyframeEvery;    ///< Recorded frames per keyframe
+    bool benchRecorder;   ///< Run trajectory recorder benchmark
+    const char* checkpoint;    ///< Checkpoint path
+    int checkpointEvery;       ///< Checkpoint every N steps (0 = off)
+    double checkpointSeconds;  ///< Checkpoint every S wall-clock seconds (0 = off)
+    bool restart;              ///< Resume from the checkpoint before stepping
+    int metricsPort;           ///< Prometheus endpoint port (-1 = off, 0 = any free port)
+    int64_t memoryBudgets[kMemoryTagCount];  ///< Heap budget per tag in bytes (0 = unlimited)
+    SofteningKernel softening; ///< Gravitational softening kernel
+    bool benchSoftening;       ///< Run softening kernel benchmark
+    bool adaptiveDt;           ///< Adaptive global timestep (frames become output times)
+    float dtEta;               ///< Accuracy parameter of the adaptive timestep
+    float dtCourant;           ///< Courant factor of the adaptive timestep
+    bool kepler;               ///< Kepler-drift bodies bound to a black hole
+    float keplerDominance;     ///< Host pull / other acceleration needed for Kepler drift
+    bool benchKepler;          ///< Run Kepler drift benchmark
+    bool compactStorage;       ///< Compact 16-bit particle storage
+    bool benchStorage;         ///< Run particle storage tier benchmark
+    int profileBins;           ///< Radial profile bins (0 = off)
+    bool benchProfiles;        ///< Run radial profile benchmark
+    int dims;                  ///< Spatial dimensions (3 = octree N-body run instead of the game)
+    bool benchDims;            ///< Run 2D against 3D N-body benchmark
+
+    /**
+     * @brief Default options
+     */
+    RunnerOptions()
+        : width(1600.0f), height(1200.0f), seed(1), steps(1000), threads(hardwareThreads()),
+          level(0), asteroids(20000), bullets(2000), diagnosticsEvery(0), monitorInterval(30),
+          targetError(0), benchCollisions(false),
+          benchPolygons(false), domains(0), bodies(100000), benchDomains(false),
+          benchBalance(false), scenario(nullptr), collisions(true), benchScenarios(false),
+          loadSnapshot(nullptr), saveSnapshot(nullptr), snapshotEvery(0), benchSnapshot(false),
+          record(nullptr), recordEvery(1), keyframeEvery(30), benchRecorder(false),
+          checkpoint("nbody.ckpt"), checkpointEvery(0), checkpointSeconds(0), restart(false),
+          metricsPort(-1), memoryBudgets{}, softening(SofteningKernel::PLUMMER), benchSoftening(false),
+          adaptiveDt(false), dtEta(TimestepConfig().eta),
+          dtCourant(TimestepConfig().courant), kepler(false), keplerDominance(KeplerConfig().dominance),
+          benchKepler(false), compactStorage(false), benchStorage(false),
+          profileBins(0), benchProfiles(false), dims(2), benchDims(false) {}
+};
+
+/**
+ * @brief Seconds elapsed since a start time
+ * @param start Start time point
+ * @return Elapsed wall-clock seconds
+ */
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Print usage text
+ */
+static void printUsage() {
+    std::printf(
+        "Usage: nbody-native [options]\n"
+        "  --width W --height H   World size (default 1600x1200)\n"
+        "  --seed N               Random seed (default 1)\n"
+        "  --steps N              Steps to run / benchmark repetitions (default 1000)\n"
+        "  --threads N            Worker threads (default: hardware threads)\n"
+        "  --level N              Potential level 0-4 (default 0)\n"
+        "  --diagnostics N        Print energy, momentum and drift every N steps\n"
+        "  --force-monitor K      Check tree force error every K steps (default 30, 0 = off)\n"
+        "  --target-error E       Steer theta to hold RMS force error E\n"
+        "  --bench-collisions     Benchmark collision detection scaling\n"
+        "  --bench-polygons       Benchmark polygon narrowphase (--steps = pairs / 1000)\n"
+        "  --asteroids N          Fragments in collision benchmark (default 20000)\n"
+        "  --bullets N            Bullets in collision benchmark (default 2000)\n"
+        "  --scenario NAME        Start from generated bodies: uniform, plummer, king,\n"
+        "                         collapse, disc, bh-cluster (size from --bodies)\n"
+        "  --no-collisions        Pure gravity (skip collision handling)\n"
+        "  --load-snapshot FILE   Start from a snapshot file\n"
+        "  --save-snapshot PATH   Write a snapshot at the end (PATH may contain %%d for the step)\n"
+        "  --snapshot-every N     Also write a snapshot every N steps\n"
+        "  --bench-snapshot       Time snapshot write, map and ingest for --bodies bodies\n"
+        "  --record FILE          Record positions and velocities to a trajectory file\n"
+        "  --record-every N       Record every N steps (default 1)\n"
+        "  --keyframe-every N     Recorded frames per seekable keyframe (default 30)\n"
+        "  --bench-recorder       Time trajectory compression for --bodies bodies\n"
+        "  --checkpoint FILE      Checkpoint path (default nbody.ckpt)\n"
+        "  --checkpoint-every N   Write a full-state checkpoint every N steps\n"
+        "  --checkpoint-seconds S Write a full-state checkpoint every S seconds of wall time\n"
+        "  --restart              Resume bit-identically from the checkpoint (--steps is the total)\n"
+        "  --metrics-port N       Serve Prometheus metrics at http://127.0.0.1:N/metrics while running\n"
+        "  --memory-budget TAG=MB Heap budget for entities, particles, quadtree, collision or engine\n"
+        "                         (repeatable; over budget the engine degrades, see engine.h)\n"
+        "  --softening NAME       Softening kernel: plummer (default), spline, none\n"
+        "  --bench-softening      Compare softening kernels' force law, bias, cost and drift\n"
+        "  --adaptive-dt          Choose dt per step; --steps and output intervals count fixed-dt frames\n"
+        "  --dt-eta E             Adaptive dt accuracy parameter (default 0.025)\n"
+        "  --dt-courant C         Adaptive dt: fraction of softening length / collision radius crossed\n"
+        "                         per step (default 1)\n"
+        "  --kepler               Drift bodies bound to a dominant black hole along exact Kepler orbits\n"
+        "  --kepler-dominance D   Host pull / everything else needed for Kepler drift (default 10)\n"
+        "  --bench-kepler         Compare leapfrog and Kepler drift on eccentric black hole orbits\n"
+        "  --compact-storage      Store explosion particles in 16-bit columns (17 instead of 60 bytes)\n"
+        "  --bench-storage        Compare the full and compact particle tiers on --bodies particles\n"
+        "  --profiles N           Radial density, rotation and dispersion profile in N bins (printed at the end)\n"
+        "  --bench-profiles       Time the radial profile reduction on a --bodies disc for 1..--threads threads\n"
+        "  --dims N               3 = pure N-body run of --scenario in a --width cube (octree)\n"
+        "  --bench-dims           Compare 2D and 3D N-body runs at 1k, 4k and 16k bodies\n"
+        "  --bench-scenarios      Time every scenario at 1k, 10k, ... --bodies\n"
+        "  --bench-balance        Compare equal-count and cost-weighted force ranges\n"
+        "  --domains P            Distributed N-body run over P processes\n"
+        "  --bodies N             Bodies in distributed run (default 100000)\n"
+        "  --bench-domains        Strong/weak scaling for P = 1, 2, 4, ... --domains\n");
+}
+
+/**
+ * @brief Parse a --memory-budget TAG=MB argument
+ * @param text Argument value
+ * @param opts Options to update
+ * @return False if the tag is unknown or the value malformed
+ */
+static bool parseMemoryBudget(const char* text, RunnerOptions& opts) {
+    const char* equals = std::strchr(text, '=');
+    if (equals) {
+        std::string name(text, equals - text);
+        for (int i = 0; i < kMemoryTagCount; i++) {
+            if (name == memoryTagName(static_cast<MemoryTag>(i))) {
+                opts.memoryBudgets[i] = (int64_t)(std::atof(equals + 1) * 1e6);
+                return true;
+            }
+        }
+    }
+    std::fprintf(stderr, "bad --memory-budget %s (expected TAG=MB, e.g. particles=2)\n", text);
+    return false;
+}
+
+/**
+ * @brief Parse command line arguments
+ * @param argc Argument count
+ * @param argv Argument values
+ * @param opts Output options
+ * @return False if arguments were invalid or help was requested
+ */
+static bool parseArgs(int argc, char** argv, RunnerOptions& opts) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--width") == 0 && hasValue) opts.width = std::atof(argv[++i]);
+        else if (std::strcmp(arg, "--height") == 0 && hasValue) opts.height = std::atof(argv[++i]);
+        else if (std::strcmp(arg, "--seed") == 0 && hasValue) opts.seed = std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(arg, "--steps") == 0 && hasValue) opts.steps = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--threads") == 0 && hasValue) opts.threads = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--level") == 0 && hasValue) opts.level = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--asteroids") == 0 && hasValue) opts.asteroids = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--bullets") == 0 && hasValue) opts.bullets = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--diagnostics") == 0 && hasValue) opts.diagnosticsEvery = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--force-monitor") == 0 && hasValue) opts.monitorInterval = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--target-error") == 0 && hasValue) opts.targetError = std::atof(argv[++i]);
+        else if (std::strcmp(arg, "--bench-collisions") == 0) opts.benchCollisions = true;
+        else if (std::strcmp(arg, "--bench-polygons") == 0) opts.benchPolygons = true;
+        else if (std::strcmp(arg, "--domains") == 0 && hasValue) opts.domains = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--bodies") == 0 && hasValue) opts.bodies = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--bench-domains") == 0) opts.benchDomains = true;
+        else if (std::strcmp(arg, "--bench-balance") == 0) opts.benchBalance = true;
+        else if (std::strcmp(arg, "--scenario") == 0 && hasValue) opts.scenario = argv[++i];
+        else if (std::strcmp(arg, "--no-collisions") == 0) opts.collisions = false;
+        else if (std::strcmp(arg, "--bench-scenarios") == 0) opts.benchScenarios = true;
+        else if (std::strcmp(arg, "--load-snapshot") == 0 && hasValue) opts.loadSnapshot = argv[++i];
+        else if (std::strcmp(arg, "--save-snapshot") == 0 && hasValue) opts.saveSnapshot = argv[++i];
+        else if (std::strcmp(arg, "--snapshot-every") == 0 && hasValue) opts.snapshotEvery = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--bench-snapshot") == 0) opts.benchSnapshot = true;
+        else if (std::strcmp(arg, "--record") == 0 && hasValue) opts.record = argv[++i];
+        else if (std::strcmp(arg, "--record-every") == 0 && hasValue) opts.recordEvery = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(arg, "--keyframe-every") == 0 && hasValue) opts.keyframeEvery = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--bench-recorder") == 0) opts.benchRecorder = true;
+        else if (std::strcmp(arg, "--checkpoint") == 0 && hasValue) opts.checkpoint = argv[++i];
+        else if (std::strcmp(arg, "--checkpoint-every") == 0 && hasValue) opts.checkpointEvery = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--checkpoint-seconds") == 0 && hasValue) opts.checkpointSeconds = std::atof(argv[++i]);
+        else if (std::strcmp(arg, "--restart") == 0) opts.restart = true;
+        else if (std::strcmp(arg, "--metrics-port") == 0 && hasValue) opts.metricsPort = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--memory-budget") == 0 && hasValue) {
+            if (!parseMemoryBudget(argv[++i], opts)) return false;
+        }
+        else if (std::strcmp(arg, "--softening") == 0 && hasValue) {
+            if (!parseSofteningKernel(argv[++i], opts.softening)) {
+                std::fprintf(stderr, "unknown softening kernel '%s' (plummer, spline, none)\n", argv[i]);
+                return false;
+            }
+        }
+        else if (std::strcmp(arg, "--bench-softening") == 0) opts.benchSoftening = true;
+        else if (std::strcmp(arg, "--adaptive-dt") == 0) opts.adaptiveDt = true;
+        else if (std::strcmp(arg, "--dt-eta") == 0 && hasValue) opts.dtEta = std::atof(argv[++i]);
+        else if (std::strcmp(arg, "--dt-courant") == 0 && hasValue) opts.dtCourant = std::atof(argv[++i]);
+        else if (std::strcmp(arg, "--kepler") == 0) opts.kepler = true;
+        else if (std::strcmp(arg, "--kepler-dominance") == 0 && hasValue) opts.keplerDominance = std::atof(argv[++i]);
+        else if (std::strcmp(arg, "--bench-kepler") == 0) opts.benchKepler = true;
+        else if (std::strcmp(arg, "--compact-storage") == 0) opts.compactStorage = true;
+        else if (std::strcmp(arg, "--bench-storage") == 0) opts.benchStorage = true;
+        else if (std::strcmp(arg, "--profiles") == 0 && hasValue) opts.profileBins = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--bench-profiles") == 0) opts.benchProfiles = true;
+        else if (std::strcmp(arg, "--dims") == 0 && hasValue) {
+            opts.dims = std::atoi(argv[++i]);
+            if (opts.dims != 2 && opts.dims != 3) {
+                std::fprintf(stderr, "--dims must be 2 or 3\n");
+                return false;
+            }
+        }
+        else if (std::strcmp(arg, "--bench-dims") == 0) opts.benchDims = true;
+        else {
+            printUsage();
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Print heap usage per allocation tag
+ * @param engine Engine (for budgets and over-budget steps)
+ */
+static void printMemoryStats(const GameEngine& engine) {
+    if (!memoryTrackingEnabled()) return;
+    std::printf("%-10s %10s %10s %12s %12s %10s\n", "memory", "current MB", "peak MB", "allocations",
+                "frees", "budget MB");
+    for (int i = 0; i < kMemoryTagCount; i++) {
+        MemoryTag tag = static_cast<MemoryTag>(i);
+        MemoryTagStats stats = getMemoryStats(tag);
+        std::printf("%-10s %10.3f %10.3f %12llu %12llu", memoryTagName(tag), stats.currentBytes / 1e6,
+                    stats.peakBytes / 1e6, (unsigned long long)stats.allocations,
+                    (unsigned long long)stats.frees);
+        if (engine.getMemoryBudget(tag) > 0) {
+            std::printf(" %10.3f (over in %llu steps)", engine.getMemoryBudget(tag) / 1e6,
+                        (unsigned long long)engine.getOverBudgetSteps(tag));
+        }
+        std::printf("\n");
+    }
+}
+
+/**
+ * @brief Write the engine state to a snapshot file
+ * @param engine Engine to capture
+ * @param pattern Output path, optionally containing %d for the step number
+ * @return False on I/O error (reported on stderr)
+ */
+static bool saveSnapshot(const GameEngine& engine, const char* pattern) {
+    SnapshotData data;
+    engine.captureSnapshot(data);
+    char path[1024];
+    std::snprintf(path, sizeof(path), pattern, (int)data.step);
+    if (!writeSnapshot(path, data.view())) {
+        std::fprintf(stderr, "cannot write snapshot %s\n", path);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Print trajectory recorder counters
+ * @param stats Recorder statistics
+ * @param elapsed Wall-clock seconds of the recorded run
+ */
+static void printRecorderStats(const RecorderStats& stats, double elapsed) {
+    double ratio = stats.compressedBytes > 0 ? (double)stats.rawBytes / stats.compressedBytes : 0;
+    std::printf("recorder: frames=%llu raw=%.1f MB written=%.1f MB ratio=%.2f encode=%.2f ms/frame "
+                "write=%.2f ms/frame stalls=%llu (%.2f%% of run)\n",
+                (unsigned long long)stats.frames, stats.rawBytes / 1e6, stats.compressedBytes / 1e6, ratio,
+                stats.frames ? 1000.0 * stats.encodeSeconds / stats.frames : 0.0,
+                stats.frames ? 1000.0 * stats.writeSeconds / stats.frames : 0.0,
+                (unsigned long long)stats.stalls, elapsed > 0 ? 100.0 * stats.stallSeconds / elapsed : 0.0);
+}
+
+/**
+ * @brief Print adaptive timestep savings, dt range and limiters
+ * @param stats Engine timestep statistics
+ */
+static void printTimestepStats(const TimestepStats& stats) {
+    if (stats.steps == 0) return;
+    std::printf("timestep: steps=%lld fixed-dt steps=%.0f saved=%.1f%% dt min=%.3g mean=%.3g max=%.3g s\n",
+                (long long)stats.steps, stats.fixedSteps, 100.0 * stats.stepsSaved() / stats.fixedSteps,
+                stats.minDt, stats.simulatedTime / stats.steps, stats.maxDt);
+    std::printf("limited by:");
+    for (int i = 0; i < kTimestepLimiterCount; i++) {
+        if (stats.limitedBy[i] == 0) continue;
+        std::printf(" %s=%lld", timestepLimiterName(static_cast<TimestepLimiter>(i)), (long long)stats.limitedBy[i]);
+    }
+    std::printf("\n");
+}
+
+/**
+ * @brief Print Kepler drift counts
+ * @param stats Engine Kepler drift statistics
+ */
+static void printKeplerStats(const KeplerStats& stats) {
+    std::printf("kepler: bodies=%d drifts=%lld fallbacks=%lld iterations/drift=%.2f\n", stats.bodies,
+                (long long)stats.drifts, (long long)stats.fallbacks,
+                stats.drifts > 0 ? (double)stats.iterations / stats.drifts : 0.0);
+}
+
+/**
+ * @brief Print the latest radial profile, one row per bin
+ * @param profiler Radial profiler
+ */
+static void printProfile(const RadialProfiler& profiler) {
+    if (profiler.getBins() == 0) return;
+    const float* radius = profiler.getColumn(ProfileColumn::RADIUS);
+    const float* count = profiler.getColumn(ProfileColumn::COUNT);
+    const float* density = profiler.getColumn(ProfileColumn::DENSITY);
+    const float* rotation = profiler.getColumn(ProfileColumn::ROTATION);
+    const float* dispersion = profiler.getColumn(ProfileColumn::DISPERSION);
+    const float* circular = profiler.getColumn(ProfileColumn::CIRCULAR);
+    std::printf("%8s %8s %12s %10s %11s %10s\n", "radius", "bodies", "density", "rotation", "dispersion",
+                "circular");
+    for (int b = 0; b < profiler.getBins(); b++) {
+        std::printf("%8.1f %8.0f %12.4g %10.2f %11.2f %10.2f\n", radius[b], count[b], density[b], rotation[b],
+                    dispersion[b], circular[b]);
+    }
+}
+
+/**
+ * @brief Next fixed-dt frame the run writes anything at
+ * @param opts Runner options (output intervals)
+ * @param frame Current frame
+ * @return Next diagnostics, record, snapshot or checkpoint frame, or --steps
+ */
+static int nextOutputFrame(const RunnerOptions& opts, int frame) {
+    int next = opts.steps;
+    auto after = [&](int every) {
+        if (every > 0) next = std::min(next, (frame / every + 1) * every);
+    };
+    after(opts.diagnosticsEvery);
+    if (opts.record) after(opts.recordEvery);
+    if (opts.saveSnapshot) after(opts.snapshotEvery);
+    after(opts.checkpointEvery);
+    return next;
+}
+
+/**
+ * @brief Print step-latency percentiles and the outliers by dominant phase
+ * @param latency Engine latency tracker
+ */
+static void printLatency(const LatencyTracker& latency) {
+    LatencySummary total = latency.getSummary(LatencyScope::TOTAL);
+    if (total.steps == 0) return;
+    std::printf("step latency: p50=%.3f p90=%.3f p99=%.3f p99.9=%.3f max=%.3f ms (n=%llu)\n",
+                total.p50Ms, total.p90Ms, total.p99Ms, total.p999Ms, total.maxMs,
+                (unsigned long long)total.steps);
+    if (total.outliers == 0) return;
+    std::printf("outliers: %llu (>%.1fx median) by phase:", (unsigned long long)total.outliers,
+                latency.getConfig().outlierFactor);
+    for (int i = 0; i < kStepPhaseCount; i++) {
+        if (total.phaseOutliers[i] == 0) continue;
+        std::printf(" %s=%llu", stepPhaseName(static_cast<StepPhase>(i)),
+                    (unsigned long long)total.phaseOutliers[i]);
+    }
+    std::printf("\n");
+    for (int i = 0; i < std::min(3, latency.getOutlierCount()); i++) {
+        const LatencyOutlier& o = latency.getOutlier(i);
+        std::printf("  step %llu: %.3f ms (%s %.3f ms, median %.3f ms)\n", (unsigned long long)o.step,
+                    o.totalMs, stepPhaseName(o.phase), o.phaseMs, o.medianMs);
+    }
+}
+
+/**
+ * @brief Run a headless game and report throughput
+ * @param opts Runner options
+ * @return Process exit code
+ */
+static int runGame(const RunnerOptions& opts) {
+    auto setupStart = std::chrono::steady_clock::now();
+    GameEngine engine(opts.width, opts.height, opts.seed);
+    engine.setThreadCount(opts.threads);
+    engine.setLevel(opts.level);
+    engine.setCollisionsEnabled(opts.collisions);
+    engine.setSofteningKernel(opts.softening);
+    for (int i = 0; i < kMemoryTagCount; i++) {
+        engine.setMemoryBudget(static_cast<MemoryTag>(i), opts.memoryBudgets[i]);
+    }
+
+    if (opts.scenario) {
+        ScenarioParams params;
+        if (!parseScenarioKind(opts.scenario, params.kind)) {
+            std::fprintf(stderr, "unknown scenario '%s'\n", opts.scenario);
+            return 2;
+        }
+        params.count = opts.bodies;
+        params.seed = opts.seed;
+        params.level = opts.level;
+        Scenario scenario;
+        generateScenario(params, opts.width, opts.height, engine.getPhysicsConfig().G, scenario);
+        engine.setBlackHolesEnabled(false);
+        engine.loadScenario(scenario);
+    }
+    if (opts.loadSnapshot) {
+        SnapshotFile file;
+        if (!file.open(opts.loadSnapshot)) {
+            std::fprintf(stderr, "%s\n", file.getError().c_str());
+            return 2;
+        }
+        if (!engine.loadSnapshot(file.view())) {
+            std::fprintf(stderr, "%s: saved for a %gx%g world, not %gx%g\n", opts.loadSnapshot,
+                         file.view().worldWidth, file.view().worldHeight, opts.width, opts.height);
+            return 2;
+        }
+    }
+
+    ForceAccuracyConfig monitor;
+    monitor.enabled = opts.monitorInterval > 0;
+    monitor.interval = opts.monitorInterval;
+    monitor.adaptiveTheta = opts.targetError > 0;
+    monitor.targetError = opts.targetError;
+    engine.setForceAccuracyConfig(monitor);
+
+    TimestepConfig timestep;
+    timestep.enabled = opts.adaptiveDt;
+    timestep.eta = opts.dtEta;
+    timestep.courant = opts.dtCourant;
+    engine.setTimestepConfig(timestep);
+
+    KeplerConfig kepler;
+    kepler.enabled = opts.kepler;
+    kepler.dominance = opts.keplerDominance;
+    engine.setKeplerConfig(kepler);
+    engine.setCompactStorage(opts.compactStorage);
+
+    ProfileConfig profiles;
+    profiles.enabled = opts.profileBins > 0;
+    profiles.bins = opts.profileBins;
+    engine.setProfileConfig(profiles);
+
+    // Restarting replaces everything above except the thread count
+    int firstStep = 0;
+    if (opts.restart) {
+        uint64_t step = 0;
+        std::vector<uint8_t> state;
+        std::string error;
+        if (!readCheckpoint(opts.checkpoint, step, state, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 2;
+        }
+        if (!engine.loadState(state.data(), state.size())) {
+            std::fprintf(stderr, "%s: incompatible build or world size\n", opts.checkpoint);
+            return 2;
+        }
+        firstStep = (int)step;
+        std::printf("restarted from %s at step %d\n", opts.checkpoint, firstStep);
+    }
+    bool checkpointing = opts.checkpointEvery > 0 || opts.checkpointSeconds > 0;
+    std::unique_ptr<Checkpointer> checkpointer;
+    if (checkpointing) checkpointer = std::make_unique<Checkpointer>(opts.checkpoint);
+    std::vector<uint8_t> checkpointState;
+    double checkpointCaptureSeconds = 0;
+    auto lastCheckpoint = std::chrono::steady_clock::now();
+
+    if (opts.diagnosticsEvery > 0) {
+        std::printf("%8s %14s %14s %14s %12s %12s %14s %12s\n", "step", "kinetic", "potential",
+                    "external", "px", "py", "L", "drift");
+    }
+
+    TrajectoryRecorder recorder;
+    if (opts.record && !recorder.open(opts.record, opts.recordEvery, opts.keyframeEvery)) {
+        std::fprintf(stderr, "cannot write trajectory %s\n", opts.record);
+        return 1;
+    }
+
+    // Registry before server so the server never outlives what it serves
+    MetricsRegistry registry;
+    std::unique_ptr<EngineMetrics> metrics;
+    MetricsServer metricsServer;
+    if (opts.metricsPort >= 0) {
+        metrics = std::make_unique<EngineMetrics>(registry);
+        if (!metricsServer.start(opts.metricsPort, registry)) return 1;
+        std::printf("metrics: http://127.0.0.1:%d/metrics\n", metricsServer.getPort());
+        std::fflush(stdout);
+    }
+
+    StepProfile sum;
+    double imbalanceSum = 0, worstImbalance = 0;
+    auto start = std::chrono::steady_clock::now();
+    double setupSeconds = std::chrono::duration<double>(start - setupStart).count();
+    double firstStepSeconds = 0;
+    // Frames are fixed-dt steps. With --adaptive-dt the engine steps toward the
+    // next frame anything is written at and lands on it exactly, so outputs and
+    // checkpoints see the same synchronised state as in a fixed-dt run
+    const double frameDt = engine.getPhysicsConfig().dt;
+    int64_t stepsRun = 0;
+    int frameEnd = firstStep;
+    double frameTime = 0;
+    for (int i = firstStep; i < opts.steps;) {
+        bool reached = true;
+        if (opts.adaptiveDt) {
+            if (frameEnd == i) {
+                frameEnd = nextOutputFrame(opts, i);
+                frameTime = engine.getTime() + (frameEnd - i) * frameDt;
+            }
+            reached = engine.stepToward(frameTime);
+        } else {
+            engine.step();
+            frameEnd = i + 1;
+        }
+        if (stepsRun++ == 0) firstStepSeconds = secondsSince(start);
+        if (metrics) metrics->update(engine);
+        const StepProfile& p = engine.getStepProfile();
+        sum.entitySeconds += p.entitySeconds;
+        sum.gravitySeconds += p.gravitySeconds;
+        sum.analysisSeconds += p.analysisSeconds;
+        sum.collisionSeconds += p.collisionSeconds;
+        sum.cleanupSeconds += p.cleanupSeconds;
+        sum.totalSeconds += p.totalSeconds;
+        imbalanceSum += p.forceImbalance;
+        worstImbalance = std::max(worstImbalance, p.forceImbalance);
+        if (!reached) continue;
+
+        i = frameEnd;
+        if (checkpointing &&
+            ((opts.checkpointEvery > 0 && i % opts.checkpointEvery == 0) ||
+             (opts.checkpointSeconds > 0 && secondsSince(lastCheckpoint) >= opts.checkpointSeconds))) {
+            auto captureStart = std::chrono::steady_clock::now();
+            engine.saveState(checkpointState);
+            checkpointer->submit((uint64_t)i, checkpointState);
+            checkpointCaptureSeconds += secondsSince(captureStart);
+            lastCheckpoint = std::chrono::steady_clock::now();
+        }
+        if (opts.record && i % opts.recordEvery == 0) {
+            engine.captureTrajectory(recorder.acquire());
+            recorder.submit();
+        }
+        if (opts.saveSnapshot && opts.snapshotEvery > 0 && i % opts.snapshotEvery == 0) {
+            if (!saveSnapshot(engine, opts.saveSnapshot)) return 1;
+        }
+        if (opts.diagnosticsEvery > 0 && i % opts.diagnosticsEvery == 0) {
+            const EnergyDiagnostics& d = engine.getDiagnostics();
+            std::printf("%8d %14.6g %14.6g %14.6g %12.5g %12.5g %14.6g %12.3e\n", i,
+                        d.kinetic, d.potential, d.external, d.momentumX, d.momentumY,
+                        d.angularMomentum, d.drift);
+        }
+    }
+    if (opts.record && !recorder.close()) {
+        std::fprintf(stderr, "error writing trajectory %s\n", opts.record);
+        return 1;
+    }
+    double elapsed = secondsSince(start);
+
+    std::printf("steps=%lld time=%.2fs wave=%d asteroids=%zu elapsed=%.3fs steps/s=%.1f\n",
+                (long long)stepsRun, engine.getTime(), engine.getWave(), engine.getAsteroids().size(),
+                elapsed, stepsRun / elapsed);
+    if (stepsRun > 0) {
+        std::printf("startup: setup=%.3f ms first step=%.3f ms time to first step=%.3f ms\n",
+                    1000.0 * setupSeconds, 1000.0 * firstStepSeconds, 1000.0 * (setupSeconds + firstStepSeconds));
+    }
+    if (checkpointer) {
+        checkpointer->flush();
+        CheckpointStats cs = checkpointer->getStats();
+        std::printf("checkpoints: written=%d last step=%llu size=%.2f MB capture=%.2f ms write=%.2f ms "
+                    "(background) waited=%.2f ms\n",
+                    cs.written, (unsigned long long)cs.lastStep, cs.lastBytes / 1e6,
+                    cs.written ? 1000.0 * checkpointCaptureSeconds / cs.written : 0.0,
+                    cs.written ? 1000.0 * cs.writeSeconds / cs.written : 0.0, 1000.0 * cs.waitSeconds);
+        if (cs.failed) return 1;
+    }
+
+    if (stepsRun > 0 && sum.totalSeconds > 0) {
+        double ms = 1000.0 / stepsRun;
+        std::printf("ms/step: entities=%.3f gravity=%.3f analysis=%.3f collisions=%.3f cleanup=%.3f total=%.3f\n",
+                    sum.entitySeconds * ms, sum.gravitySeconds * ms, sum.analysisSeconds * ms,
+                    sum.collisionSeconds * ms, sum.cleanupSeconds * ms, sum.totalSeconds * ms);
+        std::printf("force imbalance: mean=%.3f worst=%.3f tasks=%d\n",
+                    imbalanceSum / stepsRun, worstImbalance,
+                    engine.getStepProfile().forceTasks);
+        printLatency(engine.getLatency());
+    }
+
+    if (opts.adaptiveDt) printTimestepStats(engine.getTimestepStats());
+    if (opts.kepler) printKeplerStats(engine.getKeplerStats());
+    if (opts.profileBins > 0) printProfile(engine.getProfiler());
+    if (opts.record) printRecorderStats(recorder.getStats(), elapsed);
+    printMemoryStats(engine);
+    if (opts.saveSnapshot && !saveSnapshot(engine, opts.saveSnapshot)) return 1;
+
+    const ForceAccuracyStats& acc = engine.getForceAccuracy();
+    if (acc.checks > 0) {
+        std::printf("force error: mean=%.2e rms=%.2e p95=%.2e max=%.2e theta=%.3f checks=%d cost=%.2f%%\n",
+                    acc.meanError, acc.rmsError, acc.p95Error, acc.maxError,
+                    engine.getPhysicsConfig().theta, acc.checks, 100.0 * acc.costSeconds / elapsed);
+    }
+    return 0;
+}
+
+/**
+ * @brief Benchmark collision detection on a dense fragment field
+ * @param opts Runner options
+ * @return Process exit code (1 if a threaded run differs from serial)
+ *
+ * Fills the world with small fragments (size classes 3-5) and bullets,
+ * then times detectCollisions for thread counts 1, 2, 4, ... up to
+ * opts.threads. Each threaded result is compared pair-by-pair with the
+ * serial result.
+ */
+static int benchCollisions(const RunnerOptions& opts) {
+    std::mt19937 rng(opts.seed);
+    std::uniform_real_distribution<float> ux(0, opts.width), uy(0, opts.height);
+
+    std::vector<Ship> ships;
+    std::vector<BlackHole> blackHoles;
+    std::vector<Asteroid> asteroids(opts.asteroids);
+    std::vector<Bullet> bullets(opts.bullets);
+    for (int i = 0; i < opts.asteroids; i++) {
+        asteroids[i].init(i, Vec2(ux(rng), uy(rng)), Vec2(0, 0), 3 + i % 3);
+    }
+    for (int i = 0; i < opts.bullets; i++) {
+        bullets[i].init(opts.asteroids + i, Vec2(ux(rng), uy(rng)), Vec2(0, 0), 0);
+    }
+
+    WorkerPool pool;
+    CollisionDetector detector(opts.width, opts.height);
+    detector.setWorkerPool(&pool);
+
+    std::vector<CollisionPair> serial, pairs;
+    pool.setThreadCount(1);
+    detector.detectCollisions(ships, asteroids, bullets, blackHoles, serial);
+
+    std::printf("asteroids=%d bullets=%d pairs=%zu reps=%d\n",
+                opts.asteroids, opts.bullets, serial.size(), opts.steps);
+    std::printf("%8s %12s %10s\n", "threads", "ms/detect", "speedup");
+
+    double serialTime = 0;
+    bool identical = true;
+    for (int threads = 1; threads <= opts.threads; threads *= 2) {
+        pool.setThreadCount(threads);
+        auto start = std::chrono::steady_clock::now();
+        for (int rep = 0; rep < opts.steps; rep++) {
+            detector.detectCollisions(ships, asteroids, bullets, blackHoles, pairs);
+        }
+        double perCall = secondsSince(start) / opts.steps;
+        if (threads == 1) serialTime = perCall;
+
+        bool same = pairs.size() == serial.size();
+        for (size_t i = 0; same && i < pairs.size(); i++) {
+            same = pairs[i].a == serial[i].a && pairs[i].b == serial[i].b &&
+                   pairs[i].kind == serial[i].kind;
+        }
+        identical = identical && same;
+
+        std::printf("%8d %12.3f %10.2f%s\n", threads, perCall * 1e3, serialTime / perCall,
+                    same ? "" : "  MISMATCH");
+    }
+    return identical ? 0 : 1;
+}
+
+/**
+ * @brief Benchmark the polygon narrowphase against circle-only collisions
+ * @param opts Runner options (steps * 1000 pairs are tested)
+ * @return Process exit code
+ *
+ * Builds random asteroid pairs whose bounding circles overlap (the only
+ * pairs that reach the narrowphase) and random bullet positions inside
+ * asteroid circles, then times polygonsOverlap and circlePolygonOverlap
+ * and reports the fraction of circle hits they reject as false positives.
+ */
+static int benchPolygons(const RunnerOptions& opts) {
+    const int numShapes = 1024;
+    int numPairs = std::max(opts.steps, 1) * 1000;
+    std::mt19937 rng(opts.seed);
+    std::uniform_real_distribution<float> unit(0, 1);
+
+    std::vector<Asteroid> shapes(numShapes);
+    for (int i = 0; i < numShapes; i++) {
+        shapes[i].init(i, Vec2(0, 0), Vec2(0, 0), i % 6);
+        shapes[i].rotation = unit(rng) * 6.28318531f;
+    }
+
+    struct Pair { int a, b; Vec2 offset; };
+    std::vector<Pair> pairs(numPairs);
+    for (auto& p : pairs) {
+        p.a = rng() % numShapes;
+        p.b = rng() % numShapes;
+        float reach = (shapes[p.a].radius + shapes[p.b].radius) * std::sqrt(unit(rng));
+        float angle = unit(rng) * 6.28318531f;
+        p.offset = Vec2(std::cos(angle) * reach, std::sin(angle) * reach);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    int polygonHits = 0;
+    for (const auto& p : pairs) {
+        const Asteroid& a = shapes[p.a];
+        const Asteroid& b = shapes[p.b];
+        polygonHits += polygonsOverlap(a.shape, a.rotation, a.radius,
+                                       b.shape, b.rotation, b.radius, p.offset);
+    }
+    double polygonTime = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    int circleHits = 0;
+    for (const auto& p : pairs) {
+        const Asteroid& a = shapes[p.a];
+        Vec2 bulletOffset = p.offset * (a.radius / (a.radius + shapes[p.b].radius));
+        circleHits += circlePolygonOverlap(a.shape, a.rotation, a.radius, bulletOffset, 2.0f);
+    }
+    double circleTime = secondsSince(start);
+
+    std::printf("pairs=%d (all with overlapping circles)\n", numPairs);
+    std::printf("polygon-polygon: %.1f ns/test, %.1f%% of circle hits rejected\n",
+                polygonTime / numPairs * 1e9, 100.0 * (numPairs - polygonHits) / numPairs);
+    std::printf("circle-polygon:  %.1f ns/test, %.1f%% of circle hits rejected\n",
+                circleTime / numPairs * 1e9, 100.0 * (numPairs - circleHits) / numPairs);
+    return 0;
+}
+
+/**
+ * @brief Compare two trajectory frames bit for bit
+ * @param a First frame
+ * @param b Second frame
+ * @return True if step, ids, positions and velocities are identical
+ */
+static bool sameFrame(const TrajectoryFrame& a, const TrajectoryFrame& b) {
+    size_t bytes = a.size() * 4;
+    return a.step == b.step && a.size() == b.size() && std::memcmp(a.id.data(), b.id.data(), bytes) == 0 &&
+           std::memcmp(a.px.data(), b.px.data(), bytes) == 0 && std::memcmp(a.py.data(), b.py.data(), bytes) == 0 &&
+           std::memcmp(a.vx.data(), b.vx.data(), bytes) == 0 && std::memcmp(a.vy.data(), b.vy.data(), bytes) == 0;
+}
+
+/**
+ * @brief Benchmark the trajectory recorder
+ * @param opts Runner options (--bodies bodies, --steps frames, at most 240)
+ * @return Process exit code
+ *
+ * Frames come from a uniform scenario advanced kinematically with a weak
+ * central pull (a full force step per frame would dominate the timing and
+ * the codec only sees how far bodies move between frames). Every frame is
+ * first precomputed, then fed to the recorder as fast as the simulation
+ * side can copy it, so the frame rate reported is the writer's sustained
+ * limit; the 120 Hz target counts as met if the writer alone keeps up.
+ * The file is then reopened through TrajectoryFile: every frame is played
+ * forward and compared bit for bit, and random seeks by step are timed.
+ */
+static int benchRecorder(const RunnerOptions& opts) {
+    const std::string path = "nbody-bench.traj";
+    GameEngine engine(opts.width, opts.height, opts.seed);
+    ScenarioParams params;
+    params.kind = ScenarioKind::UNIFORM;
+    params.count = opts.bodies;
+    params.seed = opts.seed;
+    Scenario scenario;
+    generateScenario(params, opts.width, opts.height, engine.getPhysicsConfig().G, scenario);
+    engine.loadScenario(scenario);
+
+    int frames = std::max(2, std::min(opts.steps, 240));
+    float dt = engine.getPhysicsConfig().dt;
+    Vec2 center(opts.width * 0.5f, opts.height * 0.5f);
+    std::vector<TrajectoryFrame> recorded(frames);
+    engine.captureTrajectory(recorded[0]);
+    for (int f = 1; f < frames; f++) {
+        TrajectoryFrame& frame = recorded[f];
+        frame = recorded[f - 1];
+        frame.step++;
+        frame.time += dt;
+        for (size_t i = 0; i < frame.size(); i++) {
+            frame.vx[i] -= (frame.px[i] - center.x) * 0.01f * dt;
+            frame.vy[i] -= (frame.py[i] - center.y) * 0.01f * dt;
+            frame.px[i] += frame.vx[i] * dt;
+            frame.py[i] += frame.vy[i] * dt;
+        }
+    }
+
+    TrajectoryRecorder recorder;
+    if (!recorder.open(path, 1, opts.keyframeEvery)) {
+        std::fprintf(stderr, "cannot write %s\n", path.c_str());
+        return 1;
+    }
+    double copySeconds = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; f++) {
+        TrajectoryFrame& slot = recorder.acquire();
+        auto copyStart = std::chrono::steady_clock::now();
+        slot = recorded[f];
+        copySeconds += secondsSince(copyStart);
+        recorder.submit();
+    }
+    bool closed = recorder.close();
+    double elapsed = secondsSince(start);
+    const RecorderStats stats = recorder.getStats();
+
+    TrajectoryFile file;
+    if (!closed || !file.open(path)) {
+        std::fprintf(stderr, "cannot read back %s: %s\n", path.c_str(), file.getError().c_str());
+        return 1;
+    }
+    TrajectoryFrame frame;
+    bool exact = file.getFrameCount() == recorded.size();
+    start = std::chrono::steady_clock::now();
+    for (size_t f = 0; exact && f < file.getFrameCount(); f++) {
+        exact = file.readFrame(f, frame) && sameFrame(frame, recorded[f]);
+    }
+    double playTime = secondsSince(start);
+
+    std::mt19937 rng(opts.seed);
+    const int seeks = 50;
+    start = std::chrono::steady_clock::now();
+    for (int k = 0; exact && k < seeks; k++) {
+        uint64_t step = recorded[0].step + rng() % frames;
+        long f = file.findFrame(step);
+        exact = f >= 0 && file.readFrame((size_t)f, frame) && sameFrame(frame, recorded[f]);
+    }
+    double seekTime = secondsSince(start);
+    file.close();
+
+    double writerSeconds = stats.encodeSeconds + stats.writeSeconds;
+    double writerFps = writerSeconds > 0 ? stats.frames / writerSeconds : 0;
+    std::printf("bodies=%zu frames=%d copy=%.2f ms/frame wall=%.1f frames/s\n", recorded[0].size(), frames,
+                1000.0 * copySeconds / frames, frames / elapsed);
+    printRecorderStats(stats, elapsed);
+    std::printf("writer throughput: %.1f frames/s (%s 120 Hz), roundtrip %s\n", writerFps,
+                writerFps >= 120 ? "meets" : "below", exact ? "exact" : "MISMATCH");
+    std::printf("replay: keyframe every %d frames, play=%.2f ms/frame, random seek=%.2f ms\n",
+                std::max(1, opts.keyframeEvery), 1000.0 * playTime / frames, 1000.0 * seekTime / seeks);
+    std::remove(path.c_str());
+    return exact ? 0 : 1;
+}
+
+/**
+ * @brief Benchmark snapshot write, map and ingest
+ * @param opts Runner options (--bodies bodies, uniform scenario)
+ * @return Process exit code
+ *
+ * Reports each stage separately: mapping is lazy, so "map" is the header
+ * validation cost, "scan" the first touch of every column, and the two
+ * ingest figures the copy into GameEngine entities (which also generates
+ * asteroid outlines) and into a plain Body array (the research path).
+ */
+static int benchSnapshot(const RunnerOptions& opts) {
+    const std::string path = "nbody-bench.snap";
+    GameEngine engine(opts.width, opts.height, opts.seed);
+    ScenarioParams params;
+    params.kind = ScenarioKind::UNIFORM;
+    params.count = opts.bodies;
+    params.seed = opts.seed;
+    Scenario scenario;
+    generateScenario(params, opts.width, opts.height, engine.getPhysicsConfig().G, scenario);
+    engine.loadScenario(scenario);
+
+    SnapshotData data;
+    engine.captureSnapshot(data);
+    auto start = std::chrono::steady_clock::now();
+    if (!writeSnapshot(path, data.view())) {
+        std::fprintf(stderr, "cannot write %s\n", path.c_str());
+        return 1;
+    }
+    double writeTime = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    SnapshotFile file;
+    if (!file.open(path)) {
+        std::fprintf(stderr, "%s\n", file.getError().c_str());
+        return 1;
+    }
+    double mapTime = secondsSince(start);
+    const SnapshotView& view = file.view();
+
+    start = std::chrono::steady_clock::now();
+    double massSum = 0;
+    for (size_t i = 0; i < view.count; i++) massSum += view.mass[i] + view.pos[i].x * 0 + view.vel[i].y * 0;
+    double scanTime = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    std::vector<Body> bodies(view.count);
+    for (size_t i = 0; i < view.count; i++) {
+        bodies[i].pos = view.pos[i];
+        bodies[i].vel = view.vel[i];
+        bodies[i].mass = view.mass[i];
+        bodies[i].type = static_cast<EntityType>(view.type[i]);
+        bodies[i].id = (int)i;
+    }
+    double bodyTime = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    GameEngine loaded(opts.width, opts.height, opts.seed);
+    loaded.setThreadCount(opts.threads);
+    loaded.loadSnapshot(view);
+    double engineTime = secondsSince(start);
+
+    std::printf("bodies=%zu file=%.1f MB mass=%.6g\n", view.count,
+                (double)(sizeof(SnapshotHeader) + view.count * 29) / 1e6, massSum);
+    std::printf("write=%.2f ms map=%.3f ms scan=%.2f ms ingest(Body[])=%.2f ms ingest(GameEngine)=%.2f ms\n",
+                1000 * writeTime, 1000 * mapTime, 1000 * scanTime, 1000 * bodyTime, 1000 * engineTime);
+    file.close();
+    std::remove(path.c_str());
+    return 0;
+}
+
+/**
+ * @brief Benchmark every scenario across body counts
+ * @param opts Runner options (--bodies is the largest N, --steps caps steps per run)
+ * @return Process exit code
+ *
+ * Collisions and black hole spawning are off, so the timings are the
+ * gravity step alone. Interactions per body is the mean tree walk length,
+ * the machine-independent measure of how hard the distribution is.
+ */
+static int benchScenarios(const RunnerOptions& opts) {
+    int steps = std::max(1, std::min(opts.steps, 5));
+    std::printf("%-12s %9s %10s %12s %14s\n", "scenario", "bodies", "ms/step", "gravity ms", "interact/body");
+
+    for (int k = 0; k < static_cast<int>(ScenarioKind::COUNT); k++) {
+        for (int n = 1000; n <= std::max(opts.bodies, 1000); n *= 10) {
+            GameEngine engine(opts.width, opts.height, opts.seed);
+            engine.setThreadCount(opts.threads);
+            engine.setCollisionsEnabled(false);
+            engine.setBlackHolesEnabled(false);
+            ForceAccuracyConfig monitor;
+            monitor.enabled = false;
+            engine.setForceAccuracyConfig(monitor);
+
+            ScenarioParams params;
+            params.kind = static_cast<ScenarioKind>(k);
+            params.count = n;
+            params.seed = opts.seed;
+            params.level = opts.level;
+            Scenario scenario;
+            generateScenario(params, opts.width, opts.height, engine.getPhysicsConfig().G, scenario);
+            engine.loadScenario(scenario);
+
+            double total = 0, gravity = 0;
+            for (int i = 0; i < steps; i++) {
+                engine.step();
+                total += engine.getStepProfile().totalSeconds;
+                gravity += engine.getStepProfile().gravitySeconds;
+            }
+
+            double interactions = 0;
+            for (const Asteroid& a : engine.getAsteroids()) interactions += a.cost;
+            std::printf("%-12s %9d %10.2f %12.2f %14.1f\n", scenario.name.c_str(), n,
+                        1000.0 * total / steps, 1000.0 * gravity / steps,
+                        interactions / std::max<size_t>(engine.getAsteroids().size(), 1));
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Direct-sum acceleration on one body (periodic minimum image)
+ * @tparam Kernel Softening policy
+ * @param target Index of the body to evaluate
+ * @param bodies Scenario bodies
+ * @param kernel Prepared kernel
+ * @param physics Physics parameters (G)
+ * @param opts Runner options (world size)
+ * @return Acceleration
+ */
+template <typename Kernel>
+static Vec2 directSum(size_t target, const std::vector<ScenarioBody>& bodies, const Kernel& kernel,
+                      const PhysicsConfig& physics, const RunnerOptions& opts) {
+    double ax = 0, ay = 0;
+    for (size_t j = 0; j < bodies.size(); j++) {
+        if (j == target) continue;
+        Vec2 dr = minimumImage(bodies[j].pos - bodies[target].pos, opts.width, opts.height);
+        float f, phi;
+        kernel.apply(dr.lengthSquared(), physics.G * bodies[j].mass, f, phi);
+        ax += dr.x * f;
+        ay += dr.y * f;
+    }
+    return Vec2((float)ax, (float)ay);
+}
+
+/**
+ * @brief Benchmark and characterise the softening kernels
+ * @param opts Runner options (--scenario field of --bodies bodies, --steps caps the drift run)
+ * @return Process exit code
+ *
+ * Three tables: the kernel's force as a fraction of Newtonian gravity at
+ * a few separations; the RMS and maximum relative deviation from
+ * unsoftened direct summation on 256 bodies of the field (the bias the
+ * kernel itself adds, before any tree error); and a collisionless run of
+ * the field with gravity time, tree interactions per body and relative
+ * energy drift at the end.
+ */
+static int benchSoftening(const RunnerOptions& opts) {
+    PhysicsConfig physics;
+    const int kernels = static_cast<int>(SofteningKernel::COUNT);
+
+    const float radii[] = {0.25f, 0.5f, 1.0f, 2.0f, 2.8f, 5.0f, 10.0f};
+    std::printf("force / Newtonian at r/eps (eps = %g)\n%-8s", physics.epsilon, "kernel");
+    for (float r : radii) std::printf(" %8.2f", r);
+    std::printf("\n");
+    for (int k = 0; k < kernels; k++) {
+        SofteningKernel kind = static_cast<SofteningKernel>(k);
+        std::printf("%-8s", softeningKernelName(kind));
+        withSoftening(kind, physics.epsilon, [&](const auto& kernel) {
+            for (float r : radii) {
+                float d = r * physics.epsilon;
+                float f, phi;
+                kernel.apply(d * d, 1.0f, f, phi);
+                std::printf(" %8.4f", f * d * d * d);
+            }
+        });
+        std::printf("\n");
+    }
+
+    ScenarioParams params;  // plummer unless --scenario says otherwise
+    if (opts.scenario && !parseScenarioKind(opts.scenario, params.kind)) {
+        std::fprintf(stderr, "unknown scenario '%s'\n", opts.scenario);
+        return 2;
+    }
+    params.count = opts.bodies;
+    params.seed = opts.seed;
+    params.level = opts.level;
+    Scenario scenario;
+    generateScenario(params, opts.width, opts.height, physics.G, scenario);
+    if (scenario.bodies.size() < 2) return 0;
+
+    int samples = std::min<int>(256, (int)scenario.bodies.size());
+    std::vector<Vec2> newtonian(samples);
+    size_t stride = scenario.bodies.size() / samples;
+    for (int s = 0; s < samples; s++) {
+        newtonian[s] = directSum(s * stride, scenario.bodies, NewtonianKernel(0), physics, opts);
+    }
+
+    int steps = std::max(1, std::min(opts.steps, 100));
+    std::printf("\n%s, %zu bodies, %d steps\n%-8s %12s %12s %12s %14s %12s\n", scenario.name.c_str(),
+                scenario.bodies.size(), steps, "kernel", "rms bias", "max bias", "gravity ms", "interact/body",
+                "drift");
+    for (int k = 0; k < kernels; k++) {
+        SofteningKernel kind = static_cast<SofteningKernel>(k);
+        double sumSq = 0, maxBias = 0;
+        withSoftening(kind, physics.epsilon, [&](const auto& kernel) {
+            for (int s = 0; s < samples; s++) {
+                float exact = newtonian[s].length();
+                if (exact <= 0) continue;
+                Vec2 acc = directSum(s * stride, scenario.bodies, kernel, physics, opts);
+                double bias = (acc - newtonian[s]).length() / exact;
+                sumSq += bias * bias;
+                maxBias = std::max(maxBias, bias);
+            }
+        });
+
+        GameEngine engine(opts.width, opts.height, opts.seed);
+        engine.setThreadCount(opts.threads);
+        engine.setCollisionsEnabled(false);
+        engine.setBlackHolesEnabled(false);
+        engine.setSofteningKernel(kind);
+        ForceAccuracyConfig monitor;
+        monitor.enabled = false;
+        engine.setForceAccuracyConfig(monitor);
+        engine.loadScenario(scenario);
+
+        double gravity = 0;
+        for (int i = 0; i < steps; i++) {
+            engine.step();
+            gravity += engine.getStepProfile().gravitySeconds;
+        }
+        double interactions = 0;
+        for (const Asteroid& a : engine.getAsteroids()) interactions += a.cost;
+        std::printf("%-8s %12.3e %12.3e %12.2f %14.1f %12.3e\n", softeningKernelName(kind),
+                    std::sqrt(sumSq / samples), maxBias, 1000.0 * gravity / steps,
+                    interactions / std::max<size_t>(engine.getAsteroids().size(), 1),
+                    engine.getDiagnostics().drift);
+    }
+    return 0;
+}
+
+/**
+ * @brief Compare leapfrog and Kepler drift on eccentric orbits about a black hole
+ * @param opts Runner options (--steps fixed-dt frames of simulated time per run)
+ * @return Process exit code
+ *
+ * A light body orbits a black hole (mass ratio 1:50000, semi-major axis
+ * 150) in a world large enough that the player ship stays out of reach.
+ * The more eccentric orbits pass inside the softening length. Each orbit
+ * is run with plain leapfrog and with Kepler drift, at the fixed dt and
+ * with the adaptive timestep, and compared with the exact two-body
+ * solution: steps taken, position error relative to the semi-major axis
+ * and relative error of the Newtonian orbital energy.
+ */
+static int benchKepler(const RunnerOptions& opts) {
+    PhysicsConfig physics;
+    const float worldSize = 4000.0f;
+    const float holeMass = 50000.0f, bodyMass = 1.0f, a = 150.0f;
+    const double mu = (double)physics.G * (holeMass + bodyMass);
+    const double duration = std::max(opts.steps, 1) * (double)physics.dt;
+    const float eccentricities[] = {0.5f, 0.9f, 0.97f, 0.99f};
+    const Vec2 centre(worldSize * 0.75f, worldSize * 0.5f);  // the ship starts at 0.3 width
+    const float share = bodyMass / (holeMass + bodyMass);
+
+    std::printf("GM=%.4g a=%g eps=%g, %.2f s (%d fixed steps)\n", mu, a, physics.epsilon, duration,
+                std::max(opts.steps, 1));
+    std::printf("%-6s %-8s %-8s %8s %12s %12s %10s\n", "e", "drift", "dt", "steps", "pos err/a",
+                "energy err", "fallbacks");
+    for (float e : eccentricities) {
+        // Start at apocentre with the centre of mass at rest
+        double apocentre = a * (1.0 + e);
+        double speed = std::sqrt(mu * (1.0 - e) / apocentre);
+        Vec2 rel0((float)apocentre, 0), relVel0(0, (float)speed);
+        Vec2 exactPos = rel0, exactVel = relVel0;
+        int iterations = 0;
+        keplerDrift(exactPos, exactVel, mu, duration, iterations);
+        double energy0 = 0.5 * speed * speed - mu / apocentre;
+
+        for (int mode = 0; mode < 4; mode++) {
+            bool useKepler = mode >= 2, adaptive = mode % 2 == 1;
+            Scenario scenario;
+            scenario.name = "kepler";
+            scenario.level = 0;
+            scenario.bodies.resize(2);
+            ScenarioBody& hole = scenario.bodies[0];
+            hole.pos = centre - rel0 * share;
+            hole.vel = relVel0 * -share;
+            hole.mass = holeMass;
+            hole.blackHole = true;
+            ScenarioBody& body = scenario.bodies[1];
+            body.pos = centre + rel0 * (1.0f - share);
+            body.vel = relVel0 * (1.0f - share);
+            body.mass = bodyMass;
+
+            GameEngine engine(worldSize, worldSize, opts.seed);
+            engine.setThreadCount(opts.threads);
+            engine.setCollisionsEnabled(false);
+            engine.setBlackHolesEnabled(false);
+            engine.setShipMass(0);
+            ForceAccuracyConfig monitor;
+            monitor.enabled = false;
+            engine.setForceAccuracyConfig(monitor);
+            TimestepConfig timestep;
+            timestep.enabled = adaptive;
+            engine.setTimestepConfig(timestep);
+            KeplerConfig kepler;
+            kepler.enabled = useKepler;
+            engine.setKeplerConfig(kepler);
+            engine.loadScenario(scenario);
+            int64_t steps = engine.advance(duration);
+
+            const Body& h = engine.getBlackHoles()[0];
+            const Body& b = engine.getAsteroids()[0];
+            Vec2 rel = minimumImage(b.pos - h.pos, worldSize, worldSize);
+            Vec2 relVel = b.vel - h.vel;
+            double energy = 0.5 * relVel.lengthSquared() - mu / rel.length();
+            std::printf("%-6.2f %-8s %-8s %8lld %12.3e %12.3e %10lld\n", e, useKepler ? "kepler" : "leapfrog",
+                        adaptive ? "adaptive" : "fixed", (long long)steps, (rel - exactPos).length() / a,
+                        std::fabs((energy - energy0) / energy0), (long long)engine.getKeplerStats().fallbacks);
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Compare the full and compact particle storage tiers
+ * @param opts Runner options (--bodies particles)
+ * @return Process exit code
+ *
+ * Fills one pool per tier with the same explosion-like particles (speeds
+ * 20-200, lifetimes 0.5-3 s), then steps both at the game dt until every
+ * particle has expired. Reports bytes per particle, pool capacity and the
+ * PARTICLES heap tag, time per update and per removal pass, the largest
+ * position, alpha and expiry-step differences of the compact tier, and
+ * the throughput of the batch conversions against per-value calls.
+ */
+static int benchStorage(const RunnerOptions& opts) {
+    PhysicsConfig physics;
+    const int count = std::max(opts.bodies, 1);
+    std::mt19937 rng(opts.seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    ParticlePool pools[2];
+    pools[1].setCompact(true);
+    double heapBytes[2] = {0, 0};
+    for (int tier = 0; tier < 2; tier++) {
+        int64_t before = getMemoryStats(MemoryTag::PARTICLES).currentBytes;
+        {
+            MemoryScope scope(MemoryTag::PARTICLES);
+            std::mt19937 tierRng(opts.seed);
+            std::uniform_real_distribution<float> tierUnit(0.0f, 1.0f);
+            for (int i = 0; i < count; i++) {
+                Particle p;
+                float angle = tierUnit(tierRng) * 6.2831853f;
+                float speed = 20.0f + 180.0f * tierUnit(tierRng);
+                p.init(Vec2(opts.width * tierUnit(tierRng), opts.height * tierUnit(tierRng)),
+                       Vec2(std::cos(angle) * speed, std::sin(angle) * speed), (int)(tierRng() % 3) - 1);
+                p.maxLifetime = 0.5f + 2.5f * tierUnit(tierRng);
+                p.lifetime = p.maxLifetime;
+                pools[tier].add(p);
+            }
+        }
+        heapBytes[tier] = (double)(getMemoryStats(MemoryTag::PARTICLES).currentBytes - before);
+    }
+
+    // Step both tiers to extinction, comparing every particle each step
+    std::vector<int> expiry[2] = {std::vector<int>(count, -1), std::vector<int>(count, -1)};
+    double updateSeconds[2] = {0, 0};
+    double maxPosError = 0, maxAlphaError = 0;
+    int steps = 0;
+    for (bool alive = true; alive; steps++) {
+        for (int tier = 0; tier < 2; tier++) {
+            auto start = std::chrono::steady_clock::now();
+            pools[tier].update(physics.dt);
+            updateSeconds[tier] += secondsSince(start);
+        }
+        alive = false;
+        for (int i = 0; i < count; i++) {
+            Particle a = pools[0].get(i), b = pools[1].get(i);
+            for (int tier = 0; tier < 2; tier++) {
+                bool active = tier == 0 ? a.active : b.active;
+                if (!active && expiry[tier][i] < 0) expiry[tier][i] = steps;
+            }
+            if (a.active && b.active) {
+                maxPosError = std::max(maxPosError, (double)(a.pos - b.pos).length());
+                maxAlphaError = std::max(maxAlphaError, (double)std::fabs(a.lifetime / a.maxLifetime -
+                                                                          b.lifetime / b.maxLifetime));
+            }
+            alive = alive || a.active || b.active;
+        }
+    }
+    int maxExpiryDiff = 0;
+    for (int i = 0; i < count; i++) maxExpiryDiff = std::max(maxExpiryDiff, std::abs(expiry[0][i] - expiry[1][i]));
+
+    std::printf("%d particles, %d steps of %.4f s\n", count, steps, physics.dt);
+    std::printf("%-8s %8s %12s %12s %12s %12s\n", "tier", "bytes", "capacity MB", "heap MB", "update ms",
+                "remove ms");
+    for (int tier = 0; tier < 2; tier++) {
+        // Removal on a half-expired copy of the initial pool
+        ParticlePool half;
+        half.setCompact(tier == 1);
+        for (int i = 0; i < count; i++) {
+            Particle p;
+            p.init(Vec2(0, 0), Vec2(1, 1), -1);
+            p.active = (i & 1) == 0;
+            half.add(p);
+        }
+        auto start = std::chrono::steady_clock::now();
+        half.removeInactive();
+        double removeMs = secondsSince(start) * 1e3;
+        char heap[32] = "-";
+        if (memoryTrackingEnabled()) std::snprintf(heap, sizeof(heap), "%.3f", heapBytes[tier] / 1e6);
+        std::printf("%-8s %8zu %12.3f %12s %12.4f %12.4f\n", tier ? "compact" : "full",
+                    pools[tier].bytesPerParticle(), count * (double)pools[tier].bytesPerParticle() / 1e6, heap,
+                    updateSeconds[tier] * 1e3 / steps, removeMs);
+    }
+    std::printf("compact vs full: max position diff %.4f px, max alpha diff %.2e, max expiry diff %d steps\n",
+                maxPosError, maxAlphaError, maxExpiryDiff);
+
+    // Conversion throughput over a 1M-value array, batch against one call per value
+    const size_t values = 1 << 20;
+    const int repeats = 20;
+    std::vector<float> floats(values), decoded(values);
+    std::vector<uint16_t> halves(values);
+    for (auto& f : floats) f = (unit(rng) - 0.5f) * 400.0f;
+    double seconds[4] = {0, 0, 0, 0};
+    for (int r = 0; r < repeats; r++) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < values; i++) halves[i] = floatToHalf(floats[i]);
+        seconds[0] += secondsSince(start);
+        start = std::chrono::steady_clock::now();
+        floatToHalf(floats.data(), halves.data(), values);
+        seconds[1] += secondsSince(start);
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < values; i++) decoded[i] = halfToFloat(halves[i]);
+        seconds[2] += secondsSince(start);
+        start = std::chrono::steady_clock::now();
+        halfToFloat(halves.data(), decoded.data(), values);
+        seconds[3] += secondsSince(start);
+    }
+    double maxRelError = 0;
+    for (size_t i = 0; i < values; i++) {
+        if (std::fabs(floats[i]) > 1e-3f) {
+            maxRelError = std::max(maxRelError, (double)std::fabs((decoded[i] - floats[i]) / floats[i]));
+        }
+    }
+    double total = (double)values * repeats / 1e6;
+    std::printf("float->half: scalar %.0f M/s, batch %.0f M/s; half->float: scalar %.0f M/s, batch %.0f M/s; "
+                "max rel error %.2e\n",
+                total / seconds[0], total / seconds[1], total / seconds[2], total / seconds[3], maxRelError);
+    return 0;
+}
+
+/**
+ * @brief Benchmark the radial profile reduction (--bench-profiles)
+ * @param opts Runner options
+ * @return Process exit code (1 if a threaded profile differs from serial)
+ *
+ * Generates a --bodies rotating disc in --level and times
+ * min(--steps, 100) profile updates (32 bins) for thread counts 1, 2, 4,
+ * ... up to --threads, then prints the serial profile: on the disc the
+ * measured rotation follows the model circular speed.
+ */
+static int benchProfiles(const RunnerOptions& opts) {
+    PhysicsConfig physics;
+    ScenarioParams params;
+    params.kind = ScenarioKind::ROTATING_DISC;
+    params.count = std::max(opts.bodies, 1);
+    params.seed = opts.seed;
+    params.level = opts.level;
+    Scenario scenario;
+    generateScenario(params, opts.width, opts.height, physics.G, scenario);
+
+    std::vector<Body> bodies(scenario.bodies.size());
+    std::vector<Body*> pointers;
+    for (size_t i = 0; i < bodies.size(); i++) {
+        bodies[i].pos = scenario.bodies[i].pos;
+        bodies[i].vel = scenario.bodies[i].vel;
+        bodies[i].mass = scenario.bodies[i].mass;
+        if (scenario.bodies[i].blackHole) bodies[i].type = EntityType::BLACK_HOLE;
+        pointers.push_back(&bodies[i]);
+    }
+    Vec2 centre(opts.width * 0.5f, opts.height * 0.5f);
+    auto potential = createPotential(opts.level, centre, opts.width);
+    float radius = 0.5f * std::min(opts.width, opts.height);
+
+    ProfileConfig config;
+    config.enabled = true;
+    int reps = std::max(1, std::min(opts.steps, 100));
+    std::printf("%zu bodies, %d bins, %d updates per thread count\n", bodies.size(), config.bins, reps);
+    std::printf("%8s %12s %10s\n", "threads", "ms/update", "speedup");
+
+    RadialProfiler serial;
+    double serialMs = 0;
+    bool identical = true;
+    for (int threads = 1; threads <= std::max(opts.threads, 1); threads *= 2) {
+        WorkerPool pool(threads);
+        RadialProfiler profiler;
+        profiler.setConfig(config);
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < reps; r++) {
+            profiler.update(pointers, potential.get(), centre, radius, physics.G, &pool);
+        }
+        double ms = 1000.0 * secondsSince(start) / reps;
+        if (threads == 1) {
+            serial = profiler;
+            serialMs = ms;
+        } else if (std::memcmp(profiler.getData(), serial.getData(),
+                               sizeof(float) * kProfileColumns * profiler.getBins()) != 0) {
+            identical = false;
+        }
+        std::printf("%8d %12.4f %10.2f\n", threads, ms, serialMs / ms);
+    }
+    printProfile(serial);
+    if (!identical) {
+        std::printf("threaded profiles differ from serial\n");
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Load generated bodies into an N-body system
+ * @tparam D Dimension
+ * @tparam ScenarioBodyT ScenarioBody or ScenarioBody3D
+ * @param system System to add to
+ * @param bodies Generated bodies
+ */
+template <int D, typename ScenarioBodyT>
+static void loadSystem(NBodySystem<D>& system, const std::vector<ScenarioBodyT>& bodies) {
+    for (const ScenarioBodyT& b : bodies) system.addBody(b.pos, b.vel, b.mass);
+}
+
+/**
+ * @brief Run a 3D N-body system (--dims 3)
+ * @param opts Runner options
+ * @return Process exit code
+ *
+ * Generates --scenario (default plummer) in a cube of side --width and
+ * steps it with the octree leapfrog. Prints energy drift every
+ * --diagnostics steps and a throughput summary at the end.
+ */
+static int runOctree(const RunnerOptions& opts) {
+    ScenarioParams params;
+    if (opts.scenario && !parseScenarioKind(opts.scenario, params.kind)) {
+        std::fprintf(stderr, "unknown scenario '%s'\n", opts.scenario);
+        return 2;
+    }
+    params.count = opts.bodies;
+    params.seed = opts.seed;
+    SystemParams physics;
+    physics.softening = opts.softening;
+    std::vector<ScenarioBody3D> generated;
+    if (!generateScenario3D(params, opts.width, physics.G, generated)) {
+        std::fprintf(stderr, "scenario '%s' has no 3D form (uniform, plummer, collapse)\n",
+                     scenarioKindName(params.kind));
+        return 2;
+    }
+
+    NBodySystem<3> system(splat<3>(opts.width), physics);
+    system.setThreadCount(opts.threads);
+    loadSystem(system, generated);
+    system.computeForces();
+    double initialEnergy = system.kineticEnergy() + system.potentialEnergy();
+    std::printf("%s: %zu bodies in a %.0f cube, %d threads, %s softening\n", scenarioKindName(params.kind),
+                generated.size(), opts.width, opts.threads, softeningKernelName(opts.softening));
+
+    double gravity = 0, interactions = 0, nodes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 1; i <= opts.steps; i++) {
+        system.step();
+        gravity += system.getStats().gravitySeconds;
+        interactions += system.getStats().interactions;
+        nodes += system.getStats().treeNodes;
+        if (opts.diagnosticsEvery > 0 && i % opts.diagnosticsEvery == 0) {
+            double energy = system.kineticEnergy() + system.potentialEnergy();
+            Vec3 p = system.momentum();
+            std::printf("step %6d  E %.6e  dE/E %+.3e  |p| %.3e\n", i, energy,
+                        (energy - initialEnergy) / std::fabs(initialEnergy), p.length());
+        }
+    }
+    double seconds = secondsSince(start);
+
+    int steps = std::max(opts.steps, 1);
+    double n = std::max<size_t>(generated.size(), 1);
+    double energy = system.kineticEnergy() + system.potentialEnergy();
+    std::printf("%d steps in %.3f s: %.2f ms/step (gravity %.2f ms), %.1f interactions/body, "
+                "%.2f nodes/body, energy drift %.2e\n",
+                opts.steps, seconds, 1000.0 * seconds / steps, 1000.0 * gravity / steps,
+                interactions / steps / n, nodes / steps / n,
+                (energy - initialEnergy) / std::fabs(initialEnergy));
+    return 0;
+}
+
+/**
+ * @brief Step an N-body system and print one benchmark row
+ * @tparam D Dimension
+ * @tparam ScenarioBodyT ScenarioBody or ScenarioBody3D
+ * @param bodies Generated bodies
+ * @param box Periodic domain size per axis
+ * @param steps Steps to time
+ * @param opts Runner options (threads)
+ */
+template <int D, typename ScenarioBodyT>
+static void benchSystem(const std::vector<ScenarioBodyT>& bodies, const VecN<D>& box, int steps,
+                        const RunnerOptions& opts) {
+    NBodySystem<D> system(box, SystemParams());
+    system.setThreadCount(opts.threads);
+    loadSystem(system, bodies);
+    system.computeForces();
+    double initialEnergy = system.kineticEnergy() + system.potentialEnergy();
+
+    double gravity = 0, interactions = 0, nodes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < steps; i++) {
+        system.step();
+        gravity += system.getStats().gravitySeconds;
+        interactions += system.getStats().interactions;
+        nodes += system.getStats().treeNodes;
+    }
+    double seconds = secondsSince(start);
+    double energy = system.kineticEnergy() + system.potentialEnergy();
+    double n = std::max<size_t>(bodies.size(), 1);
+    std::printf("%-6s %8zu %10.2f %12.2f %14.1f %11.2f %12.2e\n", D == 3 ? "3d" : "2d", bodies.size(),
+                1000.0 * seconds / steps, 1000.0 * gravity / steps, interactions / steps / n,
+                nodes / steps / n, (energy - initialEnergy) / std::fabs(initialEnergy));
+}
+
+/**
+ * @brief Compare 2D and 3D N-body runs (--bench-dims)
+ * @param opts Runner options
+ * @return Process exit code
+ *
+ * Plummer spheres of 1k, 4k and 16k bodies: the projected profile in the
+ * --width x --height plane on the quadtree and the true sphere in a
+ * --width cube on the octree, both stepped by NBodySystem for
+ * min(--steps, 20) steps. The game row times GameEngine's own gravity on
+ * the 2D field (collisions off): the same walk over full game bodies,
+ * plus the cost-ordered ranges and Kepler checks around it.
+ */
+static int benchDims(const RunnerOptions& opts) {
+    int steps = std::max(1, std::min(opts.steps, 20));
+    std::printf("%-6s %8s %10s %12s %14s %11s %12s\n", "dims", "bodies", "ms/step", "gravity ms",
+                "interact/body", "nodes/body", "energy drift");
+
+    SystemParams physics;
+    for (int n = 1000; n <= 16000; n *= 4) {
+        ScenarioParams params;
+        params.kind = ScenarioKind::PLUMMER;
+        params.count = n;
+        params.seed = opts.seed;
+
+        Scenario planar;
+        generateScenario(params, opts.width, opts.height, physics.G, planar);
+        benchSystem(planar.bodies, Vec2(opts.width, opts.height), steps, opts);
+        std::vector<ScenarioBody3D> spatial;
+        generateScenario3D(params, opts.width, physics.G, spatial);
+        benchSystem(spatial, splat<3>(opts.width), steps, opts);
+
+        GameEngine engine(opts.width, opts.height, opts.seed);
+        engine.setThreadCount(opts.threads);
+        engine.setCollisionsEnabled(false);
+        engine.setBlackHolesEnabled(false);
+        ForceAccuracyConfig monitor;
+        monitor.enabled = false;
+        engine.setForceAccuracyConfig(monitor);
+        engine.loadScenario(planar);
+        double total = 0, gravity = 0;
+        for (int i = 0; i < steps; i++) {
+            engine.step();
+            total += engine.getStepProfile().totalSeconds;
+            gravity += engine.getStepProfile().gravitySeconds;
+        }
+        std::printf("%-6s %8d %10.2f %12.2f\n", "game", n, 1000.0 * total / steps, 1000.0 * gravity / steps);
+    }
+    return 0;
+}
+
+/**
+ * @brief Time each force range of one partition serially
+ * @param balancer Partitioned balancer (timings are recorded into it)
+ * @param tree Tree built over bodies
+ * @param bodies Bodies in the order they were partitioned
+ * @param physics Physics parameters
+ */
+static void timeForceRanges(ForceBalancer& balancer, const QuadTree& tree,
+                            std::vector<Body*>& bodies, const PhysicsConfig& physics) {
+    const std::vector<int>& order = balancer.getOrder();
+    for (int task = 0; task < balancer.getTaskCount(); task++) {
+        auto start = std::chrono::steady_clock::now();
+        size_t begin, end;
+        balancer.taskRange(task, begin, end);
+        for (size_t k = begin; k < end; k++) {
+            Body* body = bodies[order[k]];
+            ForceResult force = tree.calculateForce(body->pos, body->mass, physics.theta,
+                                                    physics.epsilon, physics.G);
+            body->acc = force.acc;
+            body->cost = (float)force.interactions;
+        }
+        balancer.recordTaskTime(task, secondsSince(start));
+    }
+}
+
+/**
+ * @brief Benchmark cost-weighted force partitioning
+ * @param opts Runner options (--asteroids bodies, ranges for 2..--threads tasks)
+ * @return Process exit code
+ *
+ * Builds a field where most of the mass sits in a tight cluster around a
+ * black hole, so walk cost varies strongly along the Morton curve. Each
+ * range is timed on its own (serially), so the imbalance figure is the
+ * one a pool of that many threads would see, independent of core count.
+ */
+static int benchBalance(const RunnerOptions& opts) {
+    std::mt19937 rng(opts.seed);
+    std::uniform_real_distribution<float> ux(0, opts.width), uy(0, opts.height), unit(0, 1);
+    std::normal_distribution<float> cluster(0, 40);
+    PhysicsConfig physics;
+
+    int count = std::max(opts.asteroids, 16);
+    std::vector<Body> storage(count);
+    for (int i = 0; i < count; i++) {
+        bool clustered = unit(rng) < 0.5f;
+        Vec2 pos = clustered ? Vec2(opts.width * 0.3f + cluster(rng), opts.height * 0.6f + cluster(rng))
+                             : Vec2(ux(rng), uy(rng));
+        storage[i].pos = wrapPosition(pos, opts.width, opts.height);
+        storage[i].mass = 100.0f;
+        storage[i].id = i;
+    }
+    storage[0].pos = Vec2(opts.width * 0.3f, opts.height * 0.6f);
+    storage[0].mass = 50000.0f;
+    storage[0].type = EntityType::BLACK_HOLE;
+
+    std::vector<Body*> bodies;
+    for (Body& b : storage) bodies.push_back(&b);
+    QuadTree tree(Vec2(opts.width, opts.height));
+    tree.build(bodies);
+
+    std::printf("%8s %14s %14s\n", "tasks", "equal-count", "cost-weighted");
+    for (int tasks = 2; tasks <= std::max(opts.threads, 2); tasks *= 2) {
+        ForceBalancer balancer;
+
+        for (Body* b : bodies) b->cost = 0;  // no weights: equal-count ranges
+        balancer.partition(bodies, opts.width, opts.height, tasks);
+        timeForceRanges(balancer, tree, bodies, physics);
+        double equalImbalance = balancer.imbalance();
+
+        balancer.partition(bodies, opts.width, opts.height, tasks);  // weights from the pass above
+        timeForceRanges(balancer, tree, bodies, physics);
+        std::printf("%8d %14.3f %14.3f\n", tasks, equalImbalance, balancer.imbalance());
+    }
+    return 0;
+}
+
+/**
+ * @brief Uniform random initial conditions for distributed runs
+ * @param opts Runner options (world size and seed)
+ * @param count Number of bodies
+ * @return Bodies with unit mass and small random velocities
+ */
+static std::vector<Body> makeUniformBodies(const RunnerOptions& opts, int count) {
+    std::mt19937 rng(opts.seed);
+    std::uniform_real_distribution<float> ux(0, opts.width), uy(0, opts.height), uv(-5, 5);
+    std::vector<Body> bodies(count);
+    for (int i = 0; i < count; i++) {
+        bodies[i].pos = Vec2(ux(rng), uy(rng));
+        bodies[i].vel = Vec2(uv(rng), uv(rng));
+        bodies[i].mass = 1.0f;
+        bodies[i].id = i;
+    }
+    return bodies;
+}
+
+/**
+ * @struct DomainRunResult
+ * @brief Summary of a distributed run, as measured on rank 0
+ */
+struct DomainRunResult {
+    double secondsPerStep;  ///< Mean wall time per step
+    double imbalance;       ///< Max / mean force time over ranks, averaged over steps
+    double exchangeShare;   ///< Fraction of step time spent in communication
+    double importedPerRank; ///< Mean pseudo-bodies imported per rank per step
+};
+
+/**
+ * @brief Run the distributed simulation on P processes
+ * @param opts Runner options
+ * @param numDomains Process count
+ * @param numBodies Total bodies
+ * @param steps Steps to run
+ * @param verbose Print per-run totals from rank 0
+ * @param out Output summary (filled in the calling process, rank 0)
+ * @return Process exit code
+ */
+static int runDomains(const RunnerOptions& opts, int numDomains, int numBodies, int steps,
+                      bool verbose, DomainRunResult& out) {
+    std::vector<Body> initial = makeUniformBodies(opts, numBodies);
+    DomainParams params;
+    params.worldWidth = opts.width;
+    params.worldHeight = opts.height;
+
+    return SocketTransport::launch(numDomains, [&](ITransport& transport) {
+        DomainSimulation sim(transport, params);
+        sim.initialize(initial);
+
+        double kinetic0;
+        Vec2 momentum0;
+        sim.globalTotals(kinetic0, momentum0);
+
+        double total = 0, imbalance = 0, exchange = 0, imported = 0;
+        std::vector<DomainStepStats> perRank;
+        for (int i = 0; i < steps; i++) {
+            sim.step();
+            sim.gatherStats(perRank);
+
+            double maxForce = 0, sumForce = 0, maxStep = 0, maxExchange = 0;
+            for (const DomainStepStats& s : perRank) {
+                maxForce = std::max(maxForce, s.forceSeconds);
+                sumForce += s.forceSeconds;
+                maxStep = std::max(maxStep, s.stepSeconds);
+                maxExchange = std::max(maxExchange, s.exchangeSeconds);
+                imported += s.importedBodies;
+            }
+            total += maxStep;
+            exchange += maxExchange;
+            imbalance += sumForce > 0 ? maxForce * perRank.size() / sumForce : 1.0;
+        }
+
+        double kinetic;
+        Vec2 momentum;
+        sim.globalTotals(kinetic, momentum);
+
+        if (transport.rank() == 0) {
+            out.secondsPerStep = total / steps;
+            out.imbalance = imbalance / steps;
+            out.exchangeShare = total > 0 ? exchange / total : 0;
+            out.importedPerRank = imported / ((double)steps * numDomains);
+            if (verbose) {
+                std::printf("domains=%d bodies=%d steps=%d ms/step=%.2f imbalance=%.3f "
+                            "exchange=%.1f%% imported/rank=%.0f\n",
+                            numDomains, numBodies, steps, 1000.0 * out.secondsPerStep, out.imbalance,
+                            100.0 * out.exchangeShare, out.importedPerRank);
+                std::printf("kinetic %.6g -> %.6g  momentum (%.4g, %.4g) -> (%.4g, %.4g)\n",
+                            kinetic0, kinetic, momentum0.x, momentum0.y, momentum.x, momentum.y);
+            }
+        }
+        return 0;
+    });
+}
+
+/**
+ * @brief Strong and weak scaling of the distributed run
+ * @param opts Runner options (--domains is the largest P, --bodies the base size)
+ * @return Process exit code
+ *
+ * Strong scaling keeps --bodies fixed; weak scaling uses --bodies per
+ * process. Efficiency is relative to P = 1 (ideal 100%).
+ */
+static int benchDomains(const RunnerOptions& opts) {
+    int maxDomains = std::max(opts.domains, 1);
+    int steps = std::max(1, std::min(opts.steps, 20));
+    std::printf("%-6s %8s %10s %10s %10s %10s %10s\n", "mode", "P", "bodies", "ms/step",
+                "effic", "imbalance", "exchange");
+
+    for (int weak = 0; weak < 2; weak++) {
+        double base = 0;
+        for (int p = 1; p <= maxDomains; p *= 2) {
+            int bodies = weak ? opts.bodies * p : opts.bodies;
+            DomainRunResult result{};
+            int code = runDomains(opts, p, bodies, steps, false, result);
+            if (code != 0) return code;
+            if (p == 1) base = result.secondsPerStep;
+            double efficiency = weak ? base / result.secondsPerStep
+                                     : base / (result.secondsPerStep * p);
+            std::printf("%-6s %8d %10d %10.2f %9.1f%% %10.3f %9.1f%%\n", weak ? "weak" : "strong",
+                        p, bodies, 1000.0 * result.secondsPerStep, 100.0 * efficiency,
+                        result.imbalance, 100.0 * result.exchangeShare);
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    RunnerOptions opts;
+    if (!parseArgs(argc, argv, opts)) return 2;
+
+    if (opts.benchCollisions) return benchCollisions(opts);
+    if (opts.benchPolygons) return benchPolygons(opts);
+    if (opts.benchDomains) return benchDomains(opts);
+    if (opts.benchBalance) return benchBalance(opts);
+    if (opts.benchScenarios) return benchScenarios(opts);
+    if (opts.benchSoftening) return benchSoftening(opts);
+    if (opts.benchKepler) return benchKepler(opts);
+    if (opts.benchStorage) return benchStorage(opts);
+    if (opts.benchDims) return benchDims(opts);
+    if (opts.benchProfiles) return benchProfiles(opts);
+    if (opts.benchSnapshot) return benchSnapshot(opts);
+    if (opts.benchRecorder) return benchRecorder(opts);
+    if (opts.dims == 3) return runOctree(opts);
+    if (opts.domains > 0) {
+        DomainRunResult result{};
+        return runDomains(opts, opts.domains, opts.bodies, opts.steps, true, result);
+    }
+    return runGame(opts);
+}
@@ -0,0 +1,315 @@
+/**
+ * @file scenario.cpp
+ * @brief Initial-condition generators
+ */
+
+#include "scenario.h"
+#include "potential.h"
+#include "tree.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <random>
+
+/// Names indexed by ScenarioKind
+static const char* const kScenarioNames[static_cast<int>(ScenarioKind::COUNT)] = {
+    "uniform", "plummer", "king", "collapse", "disc", "bh-cluster",
+};
+
+bool parseScenarioKind(const char* name, ScenarioKind& outKind) {
+    for (int k = 0; k < static_cast<int>(ScenarioKind::COUNT); k++) {
+        if (std::strcmp(name, kScenarioNames[k]) == 0) {
+            outKind = static_cast<ScenarioKind>(k);
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* scenarioKindName(ScenarioKind kind) {
+    int k = static_cast<int>(kind);
+    return k >= 0 && k < static_cast<int>(ScenarioKind::COUNT) ? kScenarioNames[k] : "unknown";
+}
+
+/**
+ * @brief Random point at radius r around a centre
+ * @param centre Centre
+ * @param r Radius
+ * @param rng Random generator
+ * @return Position
+ */
+static Vec2 pointAtRadius(const Vec2& centre, float r, std::mt19937& rng) {
+    float angle = std::uniform_real_distribution<float>(0, 6.28318531f)(rng);
+    return centre + Vec2(std::cos(angle) * r, std::sin(angle) * r);
+}
+
+/**
+ * @brief Set circular velocities from enclosed mass and an external field
+ * @param bodies Bodies to modify (black holes are skipped but counted as mass)
+ * @param centre System centre
+ * @param G Gravitational constant
+ * @param potential External potential (may be null)
+ * @param dispersion Random velocity as a fraction of the local circular speed
+ * @param rng Random generator
+ *
+ * Uses the monopole of the bodies' own mass (sorted by radius) plus the
+ * inward component of the external acceleration. Orbits are counter-clockwise.
+ */
+static void setCircularVelocities(std::vector<ScenarioBody>& bodies, const Vec2& centre, float G,
+                                  const IExternalPotential* potential, float dispersion, std::mt19937& rng) {
+    std::vector<std::pair<float, int>> byRadius(bodies.size());
+    for (size_t i = 0; i < bodies.size(); i++) {
+        byRadius[i] = std::make_pair((bodies[i].pos - centre).length(), (int)i);
+    }
+    std::sort(byRadius.begin(), byRadius.end());
+
+    std::normal_distribution<float> gauss(0, 1);
+    double enclosed = 0;
+    for (const auto& entry : byRadius) {
+        ScenarioBody& b = bodies[entry.second];
+        float r = std::max(entry.first, 1.0f);
+        Vec2 radial = (b.pos - centre) / r;
+
+        float v2 = (float)(G * enclosed / r);
+        if (potential) {
+            v2 += std::max(0.0f, -potential->accelerationAt(b.pos).dot(radial) * r);
+        }
+        enclosed += b.mass;
+        if (b.blackHole && entry.first < 1.0f) continue;  // central black hole stays at rest
+
+        float v = std::sqrt(v2);
+        b.vel = Vec2(-radial.y, radial.x) * v + Vec2(gauss(rng), gauss(rng)) * (v * dispersion);
+    }
+}
+
+void generateScenario(const ScenarioParams& params, float worldWidth, float worldHeight, float G,
+                      Scenario& outScenario) {
+    std::mt19937 rng(params.seed);
+    std::uniform_real_distribution<float> unit(0, 1);
+    std::normal_distribution<float> gauss(0, 1);
+
+    Vec2 centre(worldWidth * 0.5f, worldHeight * 0.5f);
+    float a = params.scaleRadius > 0 ? params.scaleRadius : 0.15f * std::min(worldWidth, worldHeight);
+    float rMax = 0.48f * std::min(worldWidth, worldHeight);  // keep systems clear of their own images
+    int n = std::max(params.count, 0);
+    float m = n > 0 ? params.totalMass / n : 0;
+
+    outScenario.name = scenarioKindName(params.kind);
+    outScenario.level = params.level;
+    std::vector<ScenarioBody>& bodies = outScenario.bodies;
+    bodies.clear();
+
+    // Black holes first so loaders can create them before the bodies
+    if (params.kind == ScenarioKind::BLACK_HOLE_CLUSTER) {
+        for (int k = 0; k < std::max(params.blackHoles, 1); k++) {
+            ScenarioBody bh;
+            bh.pos = k == 0 ? centre : pointAtRadius(centre, a * (0.5f + unit(rng)), rng);
+            bh.mass = k == 0 ? params.blackHoleMass : params.blackHoleMass * 0.1f;
+            bh.blackHole = true;
+            bodies.push_back(bh);
+        }
+    }
+
+    std::unique_ptr<IExternalPotential> potential;
+    switch (params.kind) {
+        case ScenarioKind::UNIFORM:
+            for (int i = 0; i < n; i++) {
+                ScenarioBody b;
+                b.pos = Vec2(unit(rng) * worldWidth, unit(rng) * worldHeight);
+                b.vel = Vec2(gauss(rng), gauss(rng)) * 5.0f;
+                b.mass = m;
+                b.blackHole = false;
+                bodies.push_back(b);
+            }
+            break;
+
+        case ScenarioKind::PLUMMER:
+        case ScenarioKind::BLACK_HOLE_CLUSTER:
+            // Projected Plummer: M(<R) = R² / (R² + a²), inverted for R
+            for (int i = 0; i < n; i++) {
+                float r;
+                do {
+                    float u = unit(rng);
+                    r = a * std::sqrt(u / std::max(1.0f - u, 1e-6f));
+                } while (r > rMax);
+                ScenarioBody b;
+                b.pos = pointAtRadius(centre, r, rng);
+                b.mass = m;
+                b.blackHole = false;
+                bodies.push_back(b);
+            }
+            if (params.kind == ScenarioKind::PLUMMER) {
+                // Isotropic dispersion of the Plummer sphere in its midplane
+                for (ScenarioBody& b : bodies) {
+                    float r2 = (b.pos - centre).lengthSquared();
+                    float sigma = std::sqrt(G * params.totalMass / (6.0f * std::sqrt(r2 + a * a)));
+                    b.vel = Vec2(gauss(rng), gauss(rng)) * sigma;
+                }
+            } else {
+                setCircularVelocities(bodies, centre, G, nullptr, 0.05f, rng);
+            }
+            break;
+
+        case ScenarioKind::KING_DISC: {
+            // King surface density with tidal radius rt = min(8a, rMax),
+            // sampled by rejection on Σ(R)·R
+            float rc = a * 0.5f;
+            float rt = std::min(8.0f * rc, rMax);
+            float tail = 1.0f / std::sqrt(1.0f + (rt / rc) * (rt / rc));
+            auto weight = [&](float r) {
+                float x = r / rc;
+                float s = 1.0f / std::sqrt(1.0f + x * x) - tail;
+                return s * s * r;
+            };
+            float peak = 0;
+            for (int k = 1; k <= 256; k++) peak = std::max(peak, weight(rt * k / 256.0f));
+            peak *= 1.05f;
+            for (int i = 0; i < n; i++) {
+                float r;
+                do {
+                    r = unit(rng) * rt;
+                } while (unit(rng) * peak > weight(r));
+                ScenarioBody b;
+                b.pos = pointAtRadius(centre, r, rng);
+                b.mass = m;
+                b.blackHole = false;
+                bodies.push_back(b);
+            }
+            setCircularVelocities(bodies, centre, G, nullptr, 0.1f, rng);
+            break;
+        }
+
+        case ScenarioKind::COLD_COLLAPSE:
+            for (int i = 0; i < n; i++) {
+                ScenarioBody b;
+                b.pos = pointAtRadius(centre, std::min(2.0f * a, rMax) * std::sqrt(unit(rng)), rng);
+                b.vel = Vec2(0, 0);
+                b.mass = m;
+                b.blackHole = false;
+                bodies.push_back(b);
+            }
+            break;
+
+        case ScenarioKind::ROTATING_DISC: {
+            // Exponential disc (scale length a/2), circular in self-gravity plus the level potential
+            float rd = a * 0.5f;
+            for (int i = 0; i < n; i++) {
+                float r;
+                do {
+                    r = -rd * std::log(std::max(unit(rng) * unit(rng), 1e-12f));
+                } while (r > rMax);
+                ScenarioBody b;
+                b.pos = pointAtRadius(centre, r, rng);
+                b.mass = m;
+                b.blackHole = false;
+                bodies.push_back(b);
+            }
+            potential = createPotential(params.level, centre, worldWidth);
+            setCircularVelocities(bodies, centre, G, potential.get(), 0.05f, rng);
+            break;
+        }
+
+        case ScenarioKind::COUNT:
+            break;
+    }
+
+    // Remove net momentum so the system stays centred
+    double px = 0, py = 0, mass = 0;
+    for (const ScenarioBody& b : bodies) {
+        px += (double)b.mass * b.vel.x;
+        py += (double)b.mass * b.vel.y;
+        mass += b.mass;
+    }
+    if (mass > 0) {
+        Vec2 drift((float)(px / mass), (float)(py / mass));
+        for (ScenarioBody& b : bodies) b.vel -= drift;
+    }
+    for (ScenarioBody& b : bodies) b.pos = wrapPosition(b.pos, worldWidth, worldHeight);
+}
+
+/**
+ * @brief Random direction uniformly distributed on the unit sphere
+ * @param rng Random generator
+ * @return Unit vector
+ */
+static Vec3 randomDirection(std::mt19937& rng) {
+    std::uniform_real_distribution<float> unit(0, 1);
+    float z = 2.0f * unit(rng) - 1.0f;
+    float angle = unit(rng) * 6.28318531f;
+    float s = std::sqrt(std::max(0.0f, 1.0f - z * z));
+    return Vec3(s * std::cos(angle), s * std::sin(angle), z);
+}
+
+bool generateScenario3D(const ScenarioParams& params, float boxSize, float G,
+                        std::vector<ScenarioBody3D>& outBodies) {
+    std::mt19937 rng(params.seed);
+    std::uniform_real_distribution<float> unit(0, 1);
+    std::normal_distribution<float> gauss(0, 1);
+
+    Vec3 centre = splat<3>(boxSize * 0.5f);
+    float a = params.scaleRadius > 0 ? params.scaleRadius : 0.15f * boxSize;
+    float rMax = 0.48f * boxSize;  // keep systems clear of their own images
+    int n = std::max(params.count, 0);
+    float m = n > 0 ? params.totalMass / n : 0;
+
+    outBodies.clear();
+    switch (params.kind) {
+        case ScenarioKind::UNIFORM:
+            for (int i = 0; i < n; i++) {
+                ScenarioBody3D b;
+                b.pos = Vec3(unit(rng), unit(rng), unit(rng)) * boxSize;
+                b.vel = Vec3(gauss(rng), gauss(rng), gauss(rng)) * 5.0f;
+                b.mass = m;
+                outBodies.push_back(b);
+            }
+            break;
+
+        case ScenarioKind::PLUMMER:
+            for (int i = 0; i < n; i++) {
+                // M(<r) = r³ / (r² + a²)^(3/2), inverted for r
+                float r;
+                do {
+                    float u = std::max(unit(rng), 1e-6f);
+                    r = a / std::sqrt(std::max(std::pow(u, -2.0f / 3.0f) - 1.0f, 1e-12f));
+                } while (r > rMax);
+                // Speed as a fraction q of the local escape speed, g(q) = q²(1 - q²)^(7/2) <= 0.1
+                float q;
+                do {
+                    q = unit(rng);
+                } while (unit(rng) * 0.1f > q * q * std::pow(1.0f - q * q, 3.5f));
+                float escape = std::sqrt(2.0f * G * params.totalMass) / std::pow(r * r + a * a, 0.25f);
+                ScenarioBody3D b;
+                b.pos = centre + randomDirection(rng) * r;
+                b.vel = randomDirection(rng) * (q * escape);
+                b.mass = m;
+                outBodies.push_back(b);
+            }
+            break;
+
+        case ScenarioKind::COLD_COLLAPSE:
+            for (int i = 0; i < n; i++) {
+                ScenarioBody3D b;
+                b.pos = centre + randomDirection(rng) * (std::min(2.0f * a, rMax) * std::cbrt(unit(rng)));
+                b.mass = m;
+                outBodies.push_back(b);
+            }
+            break;
+
+        default:
+            return false;
+    }
+
+    // Remove net momentum so the system stays centred
+    double p[3] = {0, 0, 0}, mass = 0;
+    for (const ScenarioBody3D& b : outBodies) {
+        for (int d = 0; d < 3; d++) p[d] += (double)b.mass * b.vel[d];
+        mass += b.mass;
+    }
+    if (mass > 0) {
+        Vec3 drift((float)(p[0] / mass), (float)(p[1] / mass), (float)(p[2] / mass));
+        for (ScenarioBody3D& b : outBodies) b.vel -= drift;
+    }
+    for (ScenarioBody3D& b : outBodies) b.pos = wrapPosition(b.pos, splat<3>(boxSize));
+    return true;
+}
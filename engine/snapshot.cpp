@@ -0,0 +1,137 @@
+/**
+ * @file snapshot.cpp
+ * @brief Memory-mapped snapshot reader and writer (native build)
+ */
+
+#include "snapshot.h"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(sizeof(Vec2) == 2 * sizeof(float), "Vec2 must be two packed floats");
+
+/// Element size of each column
+static const uint64_t kColumnElementSize[SNAPSHOT_COLUMNS] = {
+    sizeof(Vec2), sizeof(Vec2), sizeof(float), sizeof(uint8_t), sizeof(float),
+};
+
+/**
+ * @brief Round up to the column alignment
+ * @param offset Byte offset
+ * @return Next multiple of kSnapshotAlignment
+ */
+static uint64_t alignUp(uint64_t offset) {
+    return (offset + kSnapshotAlignment - 1) & ~(kSnapshotAlignment - 1);
+}
+
+SnapshotFile::SnapshotFile() : data(nullptr), size(0) {}
+
+SnapshotFile::~SnapshotFile() {
+    close();
+}
+
+void SnapshotFile::close() {
+    if (data) ::munmap(data, size);
+    data = nullptr;
+    size = 0;
+    mapped = SnapshotView();
+}
+
+bool SnapshotFile::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "cannot open " + path;
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SnapshotHeader)) {
+        ::close(fd);
+        error = path + ": too small for a snapshot header";
+        return false;
+    }
+    size = (size_t)st.st_size;
+    data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        data = nullptr;
+        size = 0;
+        error = "cannot map " + path;
+        return false;
+    }
+
+    const SnapshotHeader* header = static_cast<const SnapshotHeader*>(data);
+    const char* base = static_cast<const char*>(data);
+    bool valid = std::memcmp(header->magic, kSnapshotMagic, sizeof(header->magic)) == 0 &&
+                 header->version == kSnapshotVersion &&
+                 header->headerSize == sizeof(SnapshotHeader) &&
+                 header->fileSize == size;
+    for (int c = 0; valid && c < SNAPSHOT_COLUMNS; c++) {
+        uint64_t offset = header->columnOffset[c];
+        // offset <= size first: the subtraction must not wrap
+        valid = offset % kSnapshotAlignment == 0 && offset >= sizeof(SnapshotHeader) && offset <= size &&
+                header->count <= (size - offset) / kColumnElementSize[c];
+    }
+    if (!valid) {
+        close();
+        error = path + ": not a valid version " + std::to_string(kSnapshotVersion) + " snapshot";
+        return false;
+    }
+
+    mapped.count = (size_t)header->count;
+    mapped.step = header->step;
+    mapped.time = header->time;
+    mapped.worldWidth = header->worldWidth;
+    mapped.worldHeight = header->worldHeight;
+    mapped.level = header->level;
+    mapped.pos = reinterpret_cast<const Vec2*>(base + header->columnOffset[SNAPSHOT_POS]);
+    mapped.vel = reinterpret_cast<const Vec2*>(base + header->columnOffset[SNAPSHOT_VEL]);
+    mapped.mass = reinterpret_cast<const float*>(base + header->columnOffset[SNAPSHOT_MASS]);
+    mapped.type = reinterpret_cast<const uint8_t*>(base + header->columnOffset[SNAPSHOT_TYPE]);
+    mapped.radius = reinterpret_cast<const float*>(base + header->columnOffset[SNAPSHOT_RADIUS]);
+    error.clear();
+    return true;
+}
+
+bool writeSnapshot(const std::string& path, const SnapshotView& view) {
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+    header.version = kSnapshotVersion;
+    header.headerSize = sizeof(SnapshotHeader);
+    header.count = view.count;
+    header.step = view.step;
+    header.time = view.time;
+    header.worldWidth = view.worldWidth;
+    header.worldHeight = view.worldHeight;
+    header.level = view.level;
+
+    uint64_t offset = sizeof(SnapshotHeader);
+    for (int c = 0; c < SNAPSHOT_COLUMNS; c++) {
+        offset = alignUp(offset);
+        header.columnOffset[c] = offset;
+        offset += view.count * kColumnElementSize[c];
+    }
+    header.fileSize = offset;
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+
+    const void* columns[SNAPSHOT_COLUMNS] = {view.pos, view.vel, view.mass, view.type, view.radius};
+    static const char zeros[kSnapshotAlignment] = {};
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    uint64_t written = sizeof(header);
+    for (int c = 0; ok && c < SNAPSHOT_COLUMNS; c++) {
+        uint64_t pad = header.columnOffset[c] - written;
+        ok = std::fwrite(zeros, 1, pad, file) == pad;
+        size_t bytes = view.count * kColumnElementSize[c];
+        ok = ok && (bytes == 0 || std::fwrite(columns[c], 1, bytes, file) == bytes);
+        written = header.columnOffset[c] + bytes;
+    }
+    ok = std::fclose(file) == 0 && ok;
+    return ok;
+}
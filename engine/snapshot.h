@@ -0,0 +1,230 @@
+/**
+ * @file snapshot.h
+ * @brief Columnar binary snapshot format for initial conditions and dumps
+ *
+ * File layout (little-endian, all offsets from the start of the file):
+ *
+ *     offset 0     SnapshotHeader (128 bytes)
+ *     pos          count x {float x, float y}     world position
+ *     vel          count x {float x, float y}     velocity
+ *     mass         count x float
+ *     type         count x uint8_t                EntityType value
+ *     radius       count x float                  collision radius (0 if none)
+ *
+ * Each column starts on a 64-byte boundary (zero padding between columns)
+ * and its offset is stored in the header, so readers never compute layout
+ * themselves and a mapped file can be used in place: the column pointers
+ * of a SnapshotView point straight into the mapping.
+ *
+ * Black holes keep their mass and use the radius column for the accretion
+ * radius. Ships are matched to the engine's ships in file order. Particles
+ * are not stored.
+ *
+ * The types here are plain data and compile in every build; the
+ * memory-mapped reader and the writer (snapshot.cpp) are native only.
+ */
+
+#pragma once
+#include "vecn.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// File magic (8 bytes including the terminator)
+constexpr char kSnapshotMagic[8] = "NBSNAP1";
+
+/// Current format version
+constexpr uint32_t kSnapshotVersion = 1;
+
+/// Alignment of every column
+constexpr uint64_t kSnapshotAlignment = 64;
+
+/**
+ * @enum SnapshotColumn
+ * @brief Column indices into SnapshotHeader::columnOffset
+ */
+enum SnapshotColumn {
+    SNAPSHOT_POS,
+    SNAPSHOT_VEL,
+    SNAPSHOT_MASS,
+    SNAPSHOT_TYPE,
+    SNAPSHOT_RADIUS,
+    SNAPSHOT_COLUMNS  ///< Number of columns
+};
+
+/**
+ * @struct SnapshotHeader
+ * @brief Fixed 128-byte file header
+ */
+struct SnapshotHeader {
+    char magic[8];                            ///< kSnapshotMagic
+    uint32_t version;                         ///< kSnapshotVersion
+    uint32_t headerSize;                      ///< sizeof(SnapshotHeader)
+    uint64_t count;                           ///< Number of bodies
+    uint64_t step;                            ///< Simulation step the snapshot was taken at
+    double time;                              ///< Simulation time (seconds)
+    float worldWidth;                         ///< Domain width
+    float worldHeight;                        ///< Domain height
+    int32_t level;                            ///< Potential level
+    uint32_t reserved;                        ///< Zero
+    uint64_t columnOffset[SNAPSHOT_COLUMNS];  ///< Byte offset of each column
+    uint64_t fileSize;                        ///< Total file size (truncation check)
+    uint8_t padding[24];                      ///< Zero
+};
+static_assert(sizeof(SnapshotHeader) == 128, "snapshot header must stay 128 bytes");
+
+/**
+ * @struct SnapshotView
+ * @brief Read-only view of snapshot columns (mapped file or in-memory data)
+ */
+struct SnapshotView {
+    size_t count;          ///< Number of bodies
+    uint64_t step;         ///< Simulation step
+    double time;           ///< Simulation time
+    float worldWidth;      ///< Domain width
+    float worldHeight;     ///< Domain height
+    int level;             ///< Potential level
+    const Vec2* pos;       ///< Positions
+    const Vec2* vel;       ///< Velocities
+    const float* mass;     ///< Masses
+    const uint8_t* type;   ///< EntityType values
+    const float* radius;   ///< Radii
+
+    /**
+     * @brief Default constructor - empty view
+     */
+    SnapshotView()
+        : count(0), step(0), time(0), worldWidth(0), worldHeight(0), level(0), pos(nullptr),
+          vel(nullptr), mass(nullptr), type(nullptr), radius(nullptr) {}
+};
+
+/**
+ * @struct SnapshotData
+ * @brief Owned snapshot columns (filled by GameEngine::captureSnapshot)
+ */
+struct SnapshotData {
+    std::vector<Vec2> pos;       ///< Positions
+    std::vector<Vec2> vel;       ///< Velocities
+    std::vector<float> mass;     ///< Masses
+    std::vector<uint8_t> type;   ///< EntityType values
+    std::vector<float> radius;   ///< Radii
+    uint64_t step;               ///< Simulation step
+    double time;                 ///< Simulation time
+    float worldWidth;            ///< Domain width
+    float worldHeight;           ///< Domain height
+    int level;                   ///< Potential level
+
+    /**
+     * @brief Default constructor - empty snapshot
+     */
+    SnapshotData() : step(0), time(0), worldWidth(0), worldHeight(0), level(0) {}
+
+    /**
+     * @brief Remove all bodies, keeping capacity
+     */
+    void clear() {
+        pos.clear();
+        vel.clear();
+        mass.clear();
+        type.clear();
+        radius.clear();
+    }
+
+    /**
+     * @brief Append one body
+     * @param p Position
+     * @param v Velocity
+     * @param m Mass
+     * @param t EntityType value
+     * @param r Radius
+     */
+    void add(const Vec2& p, const Vec2& v, float m, uint8_t t, float r) {
+        pos.push_back(p);
+        vel.push_back(v);
+        mass.push_back(m);
+        type.push_back(t);
+        radius.push_back(r);
+    }
+
+    /**
+     * @brief View of the owned columns
+     * @return View valid until the data is modified
+     */
+    SnapshotView view() const {
+        SnapshotView v;
+        v.count = pos.size();
+        v.step = step;
+        v.time = time;
+        v.worldWidth = worldWidth;
+        v.worldHeight = worldHeight;
+        v.level = level;
+        v.pos = pos.data();
+        v.vel = vel.data();
+        v.mass = mass.data();
+        v.type = type.data();
+        v.radius = radius.data();
+        return v;
+    }
+};
+
+/**
+ * @class SnapshotFile
+ * @brief Read-only memory mapping of a snapshot file (native build)
+ *
+ * Opening maps the file and validates the header and column bounds; no
+ * body data is read until the columns are accessed.
+ */
+class SnapshotFile {
+public:
+    /**
+     * @brief Construct an unopened file
+     */
+    SnapshotFile();
+
+    /**
+     * @brief Unmap the file
+     */
+    ~SnapshotFile();
+
+    SnapshotFile(const SnapshotFile&) = delete;
+    SnapshotFile& operator=(const SnapshotFile&) = delete;
+
+    /**
+     * @brief Map and validate a snapshot
+     * @param path File path
+     * @return False if the file is missing, truncated or not a snapshot (see getError)
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Unmap the current file
+     */
+    void close();
+
+    /**
+     * @brief Columns of the mapped file
+     * @return View into the mapping (valid until close)
+     */
+    const SnapshotView& view() const { return mapped; }
+
+    /**
+     * @brief Reason the last open failed
+     * @return Error message
+     */
+    const std::string& getError() const { return error; }
+
+private:
+    void* data;           ///< Mapping base (null if closed)
+    size_t size;          ///< Mapping length
+    SnapshotView mapped;  ///< Column pointers into the mapping
+    std::string error;    ///< Last open error
+};
+
+/**
+ * @brief Write a snapshot file
+ * @param path Output path
+ * @param view Columns to write
+ * @return False on I/O error
+ */
+bool writeSnapshot(const std::string& path, const SnapshotView& view);
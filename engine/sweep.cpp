@@ -0,0 +1,443 @@
+/**
+ * @file sweep.cpp
+ * @brief Native parameter sweep tool for batch game campaigns
+ *
+ * Builds with `make native` into `nbody-sweep`. Reads a sweep spec, then
+ * plays every (config, seed) game headlessly with bot inputs on a pool of
+ * threads and streams one summary line per game to CSV or JSON lines.
+ *
+ * Jobs are numbered 0..configs*seeds-1 and handed out through an atomic
+ * counter; a job's config is decoded from its number (grid: mixed radix
+ * over the value lists; random: sampled from a generator seeded by the
+ * config number), so nothing is precomputed and nothing is held in memory
+ * beyond the games in flight. Lines are written as games finish, so they
+ * are not in job order; the run column identifies them. Every game is
+ * deterministic in its config and seed regardless of thread count.
+ *
+ * Spec format (one `key = value` per line, `#` comments):
+ *
+ *     mode = grid                 # grid | random
+ *     samples = 50                # random mode: configs to draw
+ *     seeds = 1..8                # range or comma list
+ *     steps = 7200                # frame limit per game (stops early at game over)
+ *     bot = hunter                # idle | spin | hunter
+ *     level = 0                   # potential level (also sweepable)
+ *     param bhSpawnRate = 0.0005, 0.001, 0.002     # grid: value list
+ *     param shipMass = 1000:3000                   # random: uniform range
+ *
+ * Sweepable parameters: bhSpawnRate, bhMassMult, bhAccRadius, shipMass,
+ * bulletMass, asteroidBaseMass, asteroidCount, level.
+ */
+
+#include "bot.h"
+#include "engine.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @struct SweepParam
+ * @brief One swept parameter: a value list (grid) or a range (random)
+ */
+struct SweepParam {
+    std::string name;           ///< Parameter name
+    std::vector<double> values; ///< Grid values (or random choices)
+    double low;                 ///< Random range lower bound
+    double high;                ///< Random range upper bound
+    bool isRange;               ///< True for `low:high`
+
+    /**
+     * @brief Default constructor - empty list
+     */
+    SweepParam() : low(0), high(0), isRange(false) {}
+};
+
+/**
+ * @struct SweepSpec
+ * @brief Parsed sweep specification and tool options
+ */
+struct SweepSpec {
+    bool random;                    ///< Random sampling instead of a full grid
+    int samples;                    ///< Configs drawn in random mode
+    std::vector<uint32_t> seeds;    ///< Game seeds run for every config
+    int steps;                      ///< Frame limit per game
+    int level;                      ///< Default potential level
+    BotStrategy bot;                ///< Input strategy
+    std::vector<SweepParam> params; ///< Swept parameters
+    float width;                    ///< World width
+    float height;                   ///< World height
+    int threads;                    ///< Concurrent games
+    std::string outPath;            ///< Output file ("" or "-" = stdout)
+    bool json;                      ///< JSON lines instead of CSV
+
+    /**
+     * @brief Default spec
+     */
+    SweepSpec()
+        : random(false), samples(16), seeds(1, 1), steps(7200), level(0), bot(BotStrategy::HUNTER),
+          width(1600.0f), height(1200.0f), threads(hardwareThreads()), json(false) {}
+};
+
+/**
+ * @struct GameConfig
+ * @brief Everything that defines one game
+ */
+struct GameConfig {
+    DifficultyConfig difficulty;  ///< Difficulty parameters
+    int level;                    ///< Potential level
+};
+
+/**
+ * @brief Strip leading and trailing whitespace
+ * @param s Input string
+ * @return Trimmed copy
+ */
+static std::string trim(const std::string& s) {
+    size_t begin = s.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return "";
+    size_t end = s.find_last_not_of(" \t\r\n");
+    return s.substr(begin, end - begin + 1);
+}
+
+/**
+ * @brief Parse a comma-separated list of numbers
+ * @param text List text
+ * @param out Output values
+ * @return False if any entry is not a number
+ */
+static bool parseList(const std::string& text, std::vector<double>& out) {
+    std::stringstream ss(text);
+    std::string item;
+    out.clear();
+    while (std::getline(ss, item, ',')) {
+        item = trim(item);
+        char* end = nullptr;
+        double v = std::strtod(item.c_str(), &end);
+        if (item.empty() || *end != '\0') return false;
+        out.push_back(v);
+    }
+    return !out.empty();
+}
+
+/**
+ * @brief Apply one parameter value to a game config
+ * @param name Parameter name
+ * @param value Value
+ * @param config Config to modify
+ * @return False if the name is unknown
+ */
+static bool applyParam(const std::string& name, double value, GameConfig& config) {
+    DifficultyConfig& d = config.difficulty;
+    if (name == "bhSpawnRate") d.bhSpawnRate = (float)value;
+    else if (name == "bhMassMult") d.bhMassMult = (float)value;
+    else if (name == "bhAccRadius") d.bhAccRadius = (float)value;
+    else if (name == "shipMass") d.shipMass = (float)value;
+    else if (name == "bulletMass") d.bulletMass = (float)value;
+    else if (name == "asteroidBaseMass") d.asteroidBaseMass = (float)value;
+    else if (name == "asteroidCount") d.asteroidCount = (int)value;
+    else if (name == "level") config.level = (int)value;
+    else return false;
+    return true;
+}
+
+/**
+ * @brief Parse a sweep spec file
+ * @param path Spec path
+ * @param spec Output spec (options already set on the command line are kept)
+ * @return False on a read or syntax error (reported on stderr)
+ */
+static bool parseSpec(const char* path, SweepSpec& spec) {
+    std::ifstream in(path);
+    if (!in) {
+        std::fprintf(stderr, "cannot open spec %s\n", path);
+        return false;
+    }
+
+    std::string line;
+    int lineNo = 0;
+    GameConfig probe;
+    while (std::getline(in, line)) {
+        lineNo++;
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) continue;
+
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) {
+            std::fprintf(stderr, "%s:%d: expected key = value\n", path, lineNo);
+            return false;
+        }
+        std::string key = trim(line.substr(0, eq));
+        std::string value = trim(line.substr(eq + 1));
+        bool ok = true;
+
+        if (key == "mode") {
+            ok = value == "grid" || value == "random";
+            spec.random = value == "random";
+        } else if (key == "samples") {
+            spec.samples = std::atoi(value.c_str());
+        } else if (key == "steps") {
+            spec.steps = std::atoi(value.c_str());
+        } else if (key == "level") {
+            spec.level = std::atoi(value.c_str());
+        } else if (key == "bot") {
+            ok = parseBotStrategy(value.c_str(), spec.bot);
+        } else if (key == "seeds") {
+            spec.seeds.clear();
+            size_t dots = value.find("..");
+            if (dots != std::string::npos) {
+                uint32_t first = std::strtoul(value.substr(0, dots).c_str(), nullptr, 10);
+                uint32_t last = std::strtoul(value.substr(dots + 2).c_str(), nullptr, 10);
+                ok = first <= last;
+                for (uint64_t s = first; ok && s <= last; s++) spec.seeds.push_back((uint32_t)s);
+            } else {
+                std::vector<double> list;
+                ok = parseList(value, list);
+                for (double s : list) spec.seeds.push_back((uint32_t)s);
+            }
+            ok = ok && !spec.seeds.empty();
+        } else if (key.compare(0, 6, "param ") == 0) {
+            SweepParam param;
+            param.name = trim(key.substr(6));
+            size_t colon = value.find(':');
+            if (colon != std::string::npos) {
+                param.isRange = true;
+                param.low = std::atof(value.substr(0, colon).c_str());
+                param.high = std::atof(value.substr(colon + 1).c_str());
+                param.values = {param.low, param.high};
+            } else {
+                ok = parseList(value, param.values);
+            }
+            ok = ok && applyParam(param.name, 0, probe);
+            spec.params.push_back(param);
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            std::fprintf(stderr, "%s:%d: invalid line '%s'\n", path, lineNo, line.c_str());
+            return false;
+        }
+    }
+
+    if (!spec.random) {
+        for (const SweepParam& p : spec.params) {
+            if (p.isRange) {
+                std::fprintf(stderr, "%s: range '%s' needs mode = random\n", path, p.name.c_str());
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Number of configs described by a spec
+ * @param spec Sweep spec
+ * @return Grid size or random sample count
+ */
+static long long configCount(const SweepSpec& spec) {
+    if (spec.random) return spec.samples;
+    long long count = 1;
+    for (const SweepParam& p : spec.params) count *= (long long)p.values.size();
+    return count;
+}
+
+/**
+ * @brief Decode a config from its index
+ * @param spec Sweep spec
+ * @param index Config index in [0, configCount)
+ * @return Game config
+ */
+static GameConfig decodeConfig(const SweepSpec& spec, long long index) {
+    GameConfig config;
+    config.level = spec.level;
+
+    if (spec.random) {
+        std::mt19937 rng((uint32_t)(index * 2654435761ULL) ^ 0x85ebca6bU);
+        for (const SweepParam& p : spec.params) {
+            double value;
+            if (p.isRange) {
+                value = std::uniform_real_distribution<double>(p.low, p.high)(rng);
+            } else {
+                value = p.values[rng() % p.values.size()];
+            }
+            applyParam(p.name, value, config);
+        }
+    } else {
+        // Mixed radix: the last parameter varies fastest
+        for (int k = (int)spec.params.size() - 1; k >= 0; k--) {
+            const SweepParam& p = spec.params[k];
+            long long n = (long long)p.values.size();
+            applyParam(p.name, p.values[index % n], config);
+            index /= n;
+        }
+    }
+    return config;
+}
+
+/**
+ * @struct GameSummary
+ * @brief Outcome of one game
+ */
+struct GameSummary {
+    float survivalTime;  ///< Simulated seconds until game over (or the frame limit)
+    int waves;           ///< Wave reached
+    int score;           ///< Player 0 score
+    int steps;           ///< Frames simulated
+    bool gameOver;       ///< True if the ship ran out of lives
+    double stepsPerSec;  ///< Simulation throughput
+};
+
+/**
+ * @brief Play one game to game over or the frame limit
+ * @param spec Sweep spec
+ * @param config Game config
+ * @param seed Game seed
+ * @return Summary
+ */
+static GameSummary playGame(const SweepSpec& spec, const GameConfig& config, uint32_t seed) {
+    GameEngine engine(spec.width, spec.height, seed);
+    engine.setDifficulty(config.difficulty);
+    engine.setLevel(config.level);
+    ForceAccuracyConfig monitor;
+    monitor.enabled = false;
+    engine.setForceAccuracyConfig(monitor);
+    engine.reset();
+
+    Bot bot(spec.bot, 0);
+    auto start = std::chrono::steady_clock::now();
+    GameSummary summary = {};
+    while (summary.steps < spec.steps && !engine.isGameOver()) {
+        engine.setInput(0, bot.decide(engine));
+        engine.step();
+        summary.steps++;
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    summary.survivalTime = engine.getTime();
+    summary.waves = engine.getWave();
+    summary.score = engine.getShips().empty() ? 0 : engine.getShips()[0].score;
+    summary.gameOver = engine.isGameOver();
+    summary.stepsPerSec = elapsed > 0 ? summary.steps / elapsed : 0;
+    return summary;
+}
+
+/**
+ * @brief Format one result line
+ * @param spec Sweep spec (column set and format)
+ * @param run Job index
+ * @param config Game config
+ * @param seed Game seed
+ * @param summary Game outcome
+ * @return Line including the trailing newline
+ */
+static std::string formatLine(const SweepSpec& spec, long long run, const GameConfig& config,
+                              uint32_t seed, const GameSummary& summary) {
+    const DifficultyConfig& d = config.difficulty;
+    char buffer[512];
+    const char* format = spec.json
+        ? "{\"run\":%lld,\"seed\":%u,\"level\":%d,\"bot\":\"%s\",\"bhSpawnRate\":%g,\"bhMassMult\":%g,"
+          "\"bhAccRadius\":%g,\"shipMass\":%g,\"bulletMass\":%g,\"asteroidBaseMass\":%g,"
+          "\"asteroidCount\":%d,\"survivalTime\":%.3f,\"waves\":%d,\"score\":%d,\"steps\":%d,"
+          "\"gameOver\":%d,\"stepsPerSec\":%.1f}\n"
+        : "%lld,%u,%d,%s,%g,%g,%g,%g,%g,%g,%d,%.3f,%d,%d,%d,%d,%.1f\n";
+    std::snprintf(buffer, sizeof(buffer), format, run, seed, config.level, botStrategyName(spec.bot),
+                  d.bhSpawnRate, d.bhMassMult, d.bhAccRadius, d.shipMass, d.bulletMass,
+                  d.asteroidBaseMass, d.asteroidCount, summary.survivalTime, summary.waves,
+                  summary.score, summary.steps, summary.gameOver ? 1 : 0, summary.stepsPerSec);
+    return buffer;
+}
+
+/**
+ * @brief Print usage text
+ */
+static void printUsage() {
+    std::printf(
+        "Usage: nbody-sweep SPEC [options]\n"
+        "  --out FILE      Output file (default stdout)\n"
+        "  --json          JSON lines instead of CSV\n"
+        "  --threads N     Concurrent games (default: hardware threads)\n"
+        "  --width W --height H   World size (default 1600x1200)\n");
+}
+
+int main(int argc, char** argv) {
+    SweepSpec spec;
+    const char* specPath = nullptr;
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--out") == 0 && hasValue) spec.outPath = argv[++i];
+        else if (std::strcmp(arg, "--json") == 0) spec.json = true;
+        else if (std::strcmp(arg, "--threads") == 0 && hasValue) spec.threads = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--width") == 0 && hasValue) spec.width = std::atof(argv[++i]);
+        else if (std::strcmp(arg, "--height") == 0 && hasValue) spec.height = std::atof(argv[++i]);
+        else if (arg[0] != '-' && !specPath) specPath = arg;
+        else {
+            printUsage();
+            return 2;
+        }
+    }
+    if (!specPath) {
+        printUsage();
+        return 2;
+    }
+    if (!parseSpec(specPath, spec)) return 2;
+
+    FILE* out = stdout;
+    if (!spec.outPath.empty() && spec.outPath != "-") {
+        out = std::fopen(spec.outPath.c_str(), "w");
+        if (!out) {
+            std::perror(spec.outPath.c_str());
+            return 2;
+        }
+    }
+    if (!spec.json) {
+        std::fputs("run,seed,level,bot,bhSpawnRate,bhMassMult,bhAccRadius,shipMass,bulletMass,"
+                   "asteroidBaseMass,asteroidCount,survivalTime,waves,score,steps,gameOver,stepsPerSec\n", out);
+    }
+
+    long long numSeeds = (long long)spec.seeds.size();
+    long long totalJobs = configCount(spec) * numSeeds;
+    std::atomic<long long> nextJob(0);
+    std::mutex outMutex;
+    long long finished = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    auto worker = [&]() {
+        for (;;) {
+            long long job = nextJob.fetch_add(1);
+            if (job >= totalJobs) return;
+            GameConfig config = decodeConfig(spec, job / numSeeds);
+            uint32_t seed = spec.seeds[job % numSeeds];
+            GameSummary summary = playGame(spec, config, seed);
+            std::string line = formatLine(spec, job, config, seed, summary);
+
+            std::lock_guard<std::mutex> lock(outMutex);
+            std::fputs(line.c_str(), out);
+            std::fflush(out);
+            finished++;
+        }
+    };
+
+    int numThreads = (int)std::max(1LL, std::min<long long>(spec.threads, totalJobs));
+    std::vector<std::thread> threads;
+    for (int t = 1; t < numThreads; t++) threads.emplace_back(worker);
+    worker();
+    for (std::thread& t : threads) t.join();
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::fprintf(stderr, "%lld games on %d threads in %.2fs (%.2f games/s)\n", finished, numThreads,
+                 elapsed, elapsed > 0 ? finished / elapsed : 0);
+    if (out != stdout) std::fclose(out);
+    return 0;
+}
@@ -0,0 +1,113 @@
+/**
+ * @file timestep.cpp
+ * @brief Implementation of the adaptive global timestep controller
+ */
+
+#include "timestep.h"
+#include <cmath>
+
+const char* timestepLimiterName(TimestepLimiter limiter) {
+    switch (limiter) {
+        case TimestepLimiter::FIXED: return "fixed";
+        case TimestepLimiter::ACCELERATION: return "acceleration";
+        case TimestepLimiter::SOFTENING: return "softening";
+        case TimestepLimiter::COLLISION: return "collision";
+        case TimestepLimiter::MAX_DT: return "max-dt";
+        case TimestepLimiter::MIN_DT: return "min-dt";
+        case TimestepLimiter::SYNC: return "sync";
+        default: return "unknown";
+    }
+}
+
+TimestepController::TimestepController() : level(0), primed(false) {}
+
+void TimestepController::setConfig(const TimestepConfig& newConfig) {
+    config = newConfig;
+    config.minLevel = std::min(config.minLevel, 0);
+    config.maxLevel = std::max(config.maxLevel, 0);
+    level = 0;
+}
+
+void TimestepController::reset() {
+    stats = TimestepStats();
+    invalidate();
+}
+
+float TimestepController::select(const TimestepSample& sample, float baseDt, float eps, double limit,
+                                 bool& outSynced) {
+    float dt = baseDt;
+    TimestepLimiter limiter = TimestepLimiter::FIXED;
+
+    if (wantsSample()) {
+        const float inf = std::numeric_limits<float>::infinity();
+        float accel = std::sqrt(sample.maxAccel2);
+        float speed = std::sqrt(sample.maxSpeed2);
+        float dtAccel = accel > 0 ? std::sqrt(2.0f * config.eta * eps / accel) : inf;
+        float dtSoft = speed > 0 ? config.courant * eps / speed : inf;
+        float dtCollision = config.courant * std::sqrt(sample.minCrossing2);
+
+        float wanted = dtAccel;
+        limiter = TimestepLimiter::ACCELERATION;
+        if (dtSoft < wanted) {
+            wanted = dtSoft;
+            limiter = TimestepLimiter::SOFTENING;
+        }
+        if (dtCollision < wanted) {
+            wanted = dtCollision;
+            limiter = TimestepLimiter::COLLISION;
+        }
+
+        // Largest power-of-two multiple of the fixed step within the criteria
+        int target = config.maxLevel;
+        if (wanted < std::ldexp(baseDt, config.maxLevel)) {
+            target = wanted > 0 ? (int)std::floor(std::log2(wanted / baseDt)) : config.minLevel;
+        } else {
+            limiter = TimestepLimiter::MAX_DT;
+        }
+        if (target < config.minLevel) {
+            target = config.minLevel;
+            limiter = TimestepLimiter::MIN_DT;
+        }
+        // Grow one level per step, shrink at once
+        level = target > level ? level + 1 : target;
+        dt = std::ldexp(baseDt, level);
+    }
+
+    // Land exactly on the caller's output time rather than stepping past it;
+    // within two steps of it, split the rest evenly instead of leaving a sliver
+    outSynced = false;
+    if (limit <= (double)dt * 1.0001) {
+        dt = (float)limit;
+        limiter = TimestepLimiter::SYNC;
+        outSynced = true;
+    } else if (limit < 2.0 * dt) {
+        dt = (float)(limit * 0.5);
+        limiter = TimestepLimiter::SYNC;
+    }
+
+    stats.steps++;
+    stats.simulatedTime += dt;
+    stats.fixedSteps += (double)dt / baseDt;
+    stats.lastDt = dt;
+    stats.minDt = stats.steps == 1 ? dt : std::min(stats.minDt, dt);
+    stats.maxDt = std::max(stats.maxDt, dt);
+    stats.lastLimiter = limiter;
+    stats.limitedBy[static_cast<int>(limiter)]++;
+    primed = true;
+    return dt;
+}
+
+void TimestepController::saveState(CheckpointWriter& out) const {
+    out.put(config);
+    out.put(stats);
+    out.put(level);
+    out.put(primed);
+}
+
+void TimestepController::loadState(CheckpointReader& in) {
+    in.get(config);
+    in.get(stats);
+    in.get(level);
+    in.get(primed);
+    if (level < config.minLevel || level > config.maxLevel) in.fail();
+}
@@ -0,0 +1,213 @@
+/**
+ * @file timestep.h
+ * @brief Adaptive global timestep for headless runs
+ *
+ * With the controller enabled, GameEngine picks each step's dt from the
+ * state at the start of the step instead of using PhysicsConfig::dt:
+ *
+ * - acceleration: sqrt(2 η ε / |a|max), the standard softened-gravity
+ *   criterion (ε is the softening length);
+ * - softening crossing: C ε / |v|max, so no body drifts through the
+ *   force resolution scale in one step (bodies Kepler-drifted about a black
+ *   hole are exempt: their drift follows the host's pull exactly);
+ * - collisions (only while collision handling is on): C r / |v| per body,
+ *   the CFL-like limit that keeps bodies from tunnelling through each other.
+ *
+ * The accelerations are the ones of the closing half-kick of the previous
+ * step, so choosing dt costs one pass over the bodies and no force
+ * evaluation. dt is quantised to PhysicsConfig::dt * 2^k and grows by at
+ * most one power of two per step (it may shrink at once), which keeps
+ * it from jittering from step to step. Output times that are multiples of
+ * the fixed dt therefore stay commensurate with the step.
+ *
+ * Every step is a complete kick-drift-kick, so positions and velocities
+ * are synchronised after each one. GameEngine::stepToward() additionally
+ * shortens the step that would cross an output time so the run lands on it
+ * exactly. Output and checkpoints are taken there, never mid-step.
+ *
+ * The controller is off by default: the interactive game keeps its fixed
+ * 1/120 s step. Stats compare the steps taken with the fixed-dt steps the
+ * same simulated time would have needed.
+ */
+
+#pragma once
+#include "checkpoint.h"
+#include "entity.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+/**
+ * @enum TimestepLimiter
+ * @brief What set a step's dt
+ */
+enum class TimestepLimiter : int {
+    FIXED = 0,     ///< Controller off, or first step after new bodies (no accelerations yet)
+    ACCELERATION,  ///< sqrt(2 η ε / |a|)
+    SOFTENING,     ///< C ε / |v|
+    COLLISION,     ///< C r / |v|
+    MAX_DT,        ///< Clamped to the largest allowed step
+    MIN_DT,        ///< Clamped to the smallest allowed step (criteria want less)
+    SYNC,          ///< Shortened to land on an output time
+    COUNT          ///< Number of limiters (not a limiter)
+};
+
+/// Number of timestep limiters
+constexpr int kTimestepLimiterCount = static_cast<int>(TimestepLimiter::COUNT);
+
+/**
+ * @brief Get a limiter's name
+ * @param limiter Limiter
+ * @return Short lowercase name
+ */
+const char* timestepLimiterName(TimestepLimiter limiter);
+
+/**
+ * @struct TimestepConfig
+ * @brief Parameters of the adaptive timestep
+ */
+struct TimestepConfig {
+    bool enabled;   ///< Choose dt per step (false = PhysicsConfig::dt)
+    float eta;      ///< Accuracy parameter of the acceleration criterion
+    float courant;  ///< Fraction of ε or of a collision radius a body may cross per step
+    int minLevel;   ///< Smallest step is PhysicsConfig::dt * 2^minLevel
+    int maxLevel;   ///< Largest step is PhysicsConfig::dt * 2^maxLevel
+
+    /**
+     * @brief Default constructor - off; when enabled, dt between 1/16 and 16 times the fixed step
+     */
+    TimestepConfig() : enabled(false), eta(0.025f), courant(1.0f), minLevel(-4), maxLevel(4) {}
+};
+
+/**
+ * @struct TimestepStats
+ * @brief Step counts and dt range since the last reset
+ */
+struct TimestepStats {
+    int64_t steps;         ///< Steps taken
+    double simulatedTime;  ///< Simulated seconds they covered
+    double fixedSteps;     ///< Steps the fixed dt would have needed for the same time
+    float lastDt;          ///< dt of the latest step
+    float minDt;           ///< Smallest dt (0 before the first step)
+    float maxDt;           ///< Largest dt
+    TimestepLimiter lastLimiter;  ///< What set the latest dt
+    int64_t limitedBy[kTimestepLimiterCount];  ///< Steps per limiter
+
+    /**
+     * @brief Default constructor - no steps yet
+     */
+    TimestepStats()
+        : steps(0), simulatedTime(0), fixedSteps(0), lastDt(0), minDt(0), maxDt(0),
+          lastLimiter(TimestepLimiter::FIXED), limitedBy{} {}
+
+    /**
+     * @brief Fixed-dt steps avoided
+     * @return fixedSteps - steps (negative when the controller took more, smaller steps)
+     */
+    double stepsSaved() const { return fixedSteps - (double)steps; }
+};
+
+/**
+ * @struct TimestepSample
+ * @brief Extremes of the timestep criteria over the bodies of one step
+ */
+struct TimestepSample {
+    float maxAccel2;     ///< Largest |a|²
+    float maxSpeed2;     ///< Largest |v|²
+    float minCrossing2;  ///< Smallest (r / |v|)² over bodies with a collision radius
+
+    /**
+     * @brief Default constructor - no bodies
+     */
+    TimestepSample() : maxAccel2(0), maxSpeed2(0), minCrossing2(std::numeric_limits<float>::infinity()) {}
+
+    /**
+     * @brief Include one body
+     * @param body Body (acceleration from the last closing kick)
+     * @param radius Collision radius (0 = not limited by collisions)
+     */
+    void add(const Body& body, float radius) {
+        float v2 = body.vel.lengthSquared();
+        maxAccel2 = std::max(maxAccel2, body.acc.lengthSquared());
+        if (body.keplerHost < 0) maxSpeed2 = std::max(maxSpeed2, v2);
+        if (radius > 0 && v2 > 0) minCrossing2 = std::min(minCrossing2, radius * radius / v2);
+    }
+};
+
+/**
+ * @class TimestepController
+ * @brief Picks a global dt per step from a TimestepSample
+ */
+class TimestepController {
+public:
+    /**
+     * @brief Construct a disabled controller
+     */
+    TimestepController();
+
+    /**
+     * @brief Set parameters (the step level restarts at the fixed dt)
+     * @param config New configuration
+     */
+    void setConfig(const TimestepConfig& config);
+
+    /**
+     * @brief Get current configuration
+     * @return Active configuration
+     */
+    const TimestepConfig& getConfig() const { return config; }
+
+    /**
+     * @brief Clear statistics and forget the current accelerations
+     */
+    void reset();
+
+    /**
+     * @brief Forget the current accelerations (new bodies were loaded)
+     *
+     * The next step uses the fixed dt, since the bodies have no
+     * accelerations until it has computed them.
+     */
+    void invalidate() { primed = false; level = 0; }
+
+    /**
+     * @brief Check whether the next step needs a sample
+     * @return True if enabled and the bodies' accelerations are current
+     */
+    bool wantsSample() const { return config.enabled && primed; }
+
+    /**
+     * @brief Choose the next step and record it in the statistics
+     * @param sample Criteria extremes (ignored unless wantsSample())
+     * @param baseDt Fixed step (PhysicsConfig::dt)
+     * @param eps Softening length
+     * @param limit Longest step allowed, e.g. time to the next output (infinity = none)
+     * @param outSynced Set to true if the step was shortened to exactly limit
+     * @return dt of the step
+     */
+    float select(const TimestepSample& sample, float baseDt, float eps, double limit, bool& outSynced);
+
+    /**
+     * @brief Get statistics since the last reset
+     * @return Latest statistics
+     */
+    const TimestepStats& getStats() const { return stats; }
+
+    /**
+     * @brief Append the controller state to a checkpoint
+     * @param out Checkpoint writer
+     */
+    void saveState(CheckpointWriter& out) const;
+
+    /**
+     * @brief Restore state written by saveState
+     * @param in Checkpoint reader (failure is reported through in.good())
+     */
+    void loadState(CheckpointReader& in);
+
+private:
+    TimestepConfig config;  ///< Active configuration
+    TimestepStats stats;    ///< Counters since reset
+    int level;              ///< Current step is baseDt * 2^level
+    bool primed;            ///< Bodies carry accelerations from a completed step
+};
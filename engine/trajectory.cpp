@@ -0,0 +1,180 @@
+/**
+ * @file trajectory.cpp
+ * @brief Delta / zigzag / bitshuffle / plane-mask trajectory codec
+ */
+
+#include "trajectory.h"
+#include <cstring>
+
+/// Words per bitshuffle block
+static constexpr size_t kBlockWords = 32;
+
+/**
+ * @brief Transpose a 32x32 bit matrix in place (self-inverse)
+ * @param a Matrix rows
+ *
+ * Recursive block swap: exchange the off-diagonal 16x16 blocks, then the
+ * 8x8 blocks inside each, and so on down to single bits.
+ */
+static void transpose32(uint32_t a[kBlockWords]) {
+    uint32_t mask = 0x0000ffffU;
+    for (int j = 16; j != 0; j >>= 1, mask ^= (mask << j)) {
+        for (int k = 0; k < 32; k = ((k | j) + 1) & ~j) {
+            uint32_t t = (a[k] ^ (a[k | j] >> j)) & mask;
+            a[k] ^= t;
+            a[k | j] ^= (t << j);
+        }
+    }
+}
+
+/**
+ * @brief Write an unsigned LEB128 varint
+ * @param value Value
+ * @param out Output cursor (advanced; needs room for 5 bytes)
+ */
+static void putVarint(uint32_t value, uint8_t*& out) {
+    while (value >= 0x80) {
+        *out++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = (uint8_t)value;
+}
+
+/**
+ * @brief Read an unsigned LEB128 varint
+ * @param data Input cursor (advanced)
+ * @param end End of input
+ * @param value Output value
+ * @return False if the input ends mid-varint or the value overflows 32 bits
+ */
+static bool getVarint(const uint8_t*& data, const uint8_t* end, uint32_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (data == end) return false;
+        uint8_t byte = *data++;
+        value |= (uint32_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Encode one column of 32-bit words
+ * @param words Current values
+ * @param count Number of values
+ * @param reference Previous values
+ * @param referenceCount Number of previous values
+ * @param out Output cursor (advanced; needs room for columnBound(count) bytes)
+ */
+static void encodeColumn(const void* words, size_t count, const void* reference, size_t referenceCount,
+                         uint8_t*& out) {
+    const uint8_t* cur = static_cast<const uint8_t*>(words);
+    const uint8_t* prev = static_cast<const uint8_t*>(reference);
+    uint32_t block[kBlockWords];
+
+    for (size_t start = 0; start < count; start += kBlockWords) {
+        uint32_t value[kBlockWords] = {}, base[kBlockWords] = {};
+        if (start + kBlockWords <= count && start + kBlockWords <= referenceCount) {
+            // Common case: a whole block present in both frames
+            std::memcpy(value, cur + start * 4, sizeof(value));
+            std::memcpy(base, prev + start * 4, sizeof(base));
+        } else {
+            for (size_t i = 0; i < kBlockWords && start + i < count; i++) {
+                std::memcpy(&value[i], cur + (start + i) * 4, 4);
+                if (start + i < referenceCount) std::memcpy(&base[i], prev + (start + i) * 4, 4);
+            }
+        }
+        for (size_t i = 0; i < kBlockWords; i++) {
+            uint32_t delta = value[i] - base[i];
+            block[i] = (delta << 1) ^ (uint32_t)((int32_t)delta >> 31);
+        }
+        transpose32(block);
+
+        uint32_t planes = 0;
+        for (size_t b = 0; b < kBlockWords; b++) planes |= (block[b] != 0) << b;
+        putVarint(planes, out);
+        for (size_t b = 0; b < kBlockWords; b++) {
+            if (block[b]) {
+                std::memcpy(out, &block[b], 4);
+                out += 4;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Decode one column of 32-bit words
+ * @param data Input cursor (advanced)
+ * @param end End of input
+ * @param count Number of values
+ * @param reference Previous values
+ * @param referenceCount Number of previous values
+ * @param words Output values
+ * @return False on malformed input
+ */
+static bool decodeColumn(const uint8_t*& data, const uint8_t* end, size_t count, const void* reference,
+                         size_t referenceCount, void* words) {
+    const uint8_t* prev = static_cast<const uint8_t*>(reference);
+    uint8_t* cur = static_cast<uint8_t*>(words);
+    uint32_t block[kBlockWords];
+
+    for (size_t start = 0; start < count; start += kBlockWords) {
+        uint32_t planes;
+        if (!getVarint(data, end, planes)) return false;
+        for (size_t b = 0; b < kBlockWords; b++) {
+            block[b] = 0;
+            if (!(planes & (1U << b))) continue;
+            if (end - data < 4) return false;
+            std::memcpy(&block[b], data, 4);
+            data += 4;
+        }
+        transpose32(block);
+        for (size_t i = 0; i < kBlockWords && start + i < count; i++) {
+            size_t index = start + i;
+            uint32_t base = 0;
+            if (index < referenceCount) std::memcpy(&base, prev + index * 4, 4);
+            uint32_t delta = (block[i] >> 1) ^ (0U - (block[i] & 1));
+            uint32_t value = base + delta;
+            std::memcpy(cur + index * 4, &value, 4);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Worst-case encoded size of one column
+ * @param count Number of values
+ * @return Bytes (plane mask varint plus every plane, per block)
+ */
+static size_t columnBound(size_t count) {
+    return (count + kBlockWords - 1) / kBlockWords * (5 + kBlockWords * 4);
+}
+
+void encodeFrame(const TrajectoryFrame& frame, const TrajectoryFrame& reference, std::vector<uint8_t>& out) {
+    size_t n = frame.size(), r = reference.size();
+    size_t used = out.size();
+    out.resize(used + 5 * columnBound(n));
+    uint8_t* cursor = out.data() + used;
+    encodeColumn(frame.id.data(), n, reference.id.data(), r, cursor);
+    encodeColumn(frame.px.data(), n, reference.px.data(), r, cursor);
+    encodeColumn(frame.py.data(), n, reference.py.data(), r, cursor);
+    encodeColumn(frame.vx.data(), n, reference.vx.data(), r, cursor);
+    encodeColumn(frame.vy.data(), n, reference.vy.data(), r, cursor);
+    out.resize(cursor - out.data());
+}
+
+bool decodeFrame(const uint8_t* data, size_t size, size_t count, const TrajectoryFrame& reference,
+                 TrajectoryFrame& out) {
+    // Every block of every column takes at least its plane-mask byte, so a
+    // count the payload cannot hold is rejected before it is allocated
+    if (count / kBlockWords > size / 5) return false;
+    const uint8_t* end = data + size;
+    size_t r = reference.size();
+    out.resize(count);
+    return decodeColumn(data, end, count, reference.id.data(), r, out.id.data()) &&
+           decodeColumn(data, end, count, reference.px.data(), r, out.px.data()) &&
+           decodeColumn(data, end, count, reference.py.data(), r, out.py.data()) &&
+           decodeColumn(data, end, count, reference.vx.data(), r, out.vx.data()) &&
+           decodeColumn(data, end, count, reference.vy.data(), r, out.vy.data()) &&
+           data == end;
+}
@@ -0,0 +1,167 @@
+/**
+ * @file trajectory.h
+ * @brief Trajectory frames and their lossless compression codec
+ *
+ * A frame holds the id, position and velocity of every gravitating body at
+ * one step. Frames are stored relative to the previous frame, column by
+ * column, in four stages:
+ *
+ * 1. delta: each 32-bit word (float bits, or the id) minus the word at the
+ *    same index in the previous frame (0 past its end), wrapping mod 2^32.
+ *    Smoothly moving bodies keep their sign and exponent between frames,
+ *    so the difference of the bit patterns is small.
+ * 2. zigzag: map the signed difference to unsigned so small negative
+ *    deltas also have leading zeros.
+ * 3. bitshuffle: transpose each block of 32 words as a 32x32 bit matrix;
+ *    output word b holds bit b of all 32 inputs. The many zero high bits
+ *    become whole zero words (bit planes).
+ * 4. plane mask: per block, a LEB128 varint whose bit b says plane b is
+ *    nonzero, followed by the 4 raw little-endian bytes of each nonzero
+ *    plane in order. Planes of an unchanged column cost one byte per block.
+ *
+ * The codec is exact: decoding reproduces the input bit for bit.
+ *
+ * Container (.traj, little-endian), written by TrajectoryRecorder and read
+ * by TrajectoryFile (native, memory-mapped) and src/replay.ts (browser):
+ *
+ *     TrajectoryFileHeader                        24 bytes
+ *     per frame: TrajectoryFrameHeader, payload   32 bytes + payloadBytes
+ *     index:     frameCount x TrajectoryIndexEntry
+ *     TrajectoryFooter                            24 bytes, at the end
+ *
+ * Every keyframeInterval'th frame is a keyframe, encoded against an empty
+ * frame; the frames between are encoded against the preceding keyframe
+ * (not the previous frame), so any frame decodes from at most two
+ * payloads. The footer locates the index, which maps frame number to step,
+ * offset and keyframe, so seeking is a lookup plus one keyframe decode.
+ * Frames and the index start on 8-byte boundaries (zero padding after
+ * each payload) so a mapped file can be read in place.
+ * A file whose footer is missing (the recorder did not close) can still be
+ * read by walking the frame headers from the start.
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @struct TrajectoryFrame
+ * @brief Positions and velocities of all bodies at one step
+ */
+struct TrajectoryFrame {
+    uint64_t step;            ///< Simulation step
+    double time;              ///< Simulation time (seconds)
+    std::vector<int32_t> id;  ///< Entity ids
+    std::vector<float> px;    ///< Position x
+    std::vector<float> py;    ///< Position y
+    std::vector<float> vx;    ///< Velocity x
+    std::vector<float> vy;    ///< Velocity y
+
+    /**
+     * @brief Default constructor - empty frame
+     */
+    TrajectoryFrame() : step(0), time(0) {}
+
+    /**
+     * @brief Number of bodies
+     * @return Body count
+     */
+    size_t size() const { return id.size(); }
+
+    /**
+     * @brief Resize every column
+     * @param n Body count
+     */
+    void resize(size_t n) {
+        id.resize(n);
+        px.resize(n);
+        py.resize(n);
+        vx.resize(n);
+        vy.resize(n);
+    }
+};
+
+/// File magic (8 bytes including the terminator)
+constexpr char kTrajectoryMagic[8] = "NBTRAJ2";
+
+/// Footer magic (8 bytes including the terminator)
+constexpr char kTrajectoryIndexMagic[8] = "NBTRIDX";
+
+/// Marker at the end of every frame header (recovery scans check it)
+constexpr uint32_t kTrajectoryFrameSync = 0x4d415246;  // "FRAM"
+
+/// Current container version
+constexpr uint32_t kTrajectoryVersion = 2;
+
+/**
+ * @struct TrajectoryFileHeader
+ * @brief Fixed 24-byte file header
+ */
+struct TrajectoryFileHeader {
+    char magic[8];              ///< kTrajectoryMagic
+    uint32_t version;           ///< kTrajectoryVersion
+    uint32_t interval;          ///< Simulation steps between recorded frames
+    uint32_t keyframeInterval;  ///< Frames per keyframe
+    uint32_t reserved;          ///< Zero
+};
+static_assert(sizeof(TrajectoryFileHeader) == 24, "trajectory header must stay 24 bytes");
+
+/**
+ * @struct TrajectoryFrameHeader
+ * @brief Fixed 32-byte header in front of every frame payload
+ */
+struct TrajectoryFrameHeader {
+    uint32_t payloadBytes;  ///< Encoded payload size
+    uint32_t count;         ///< Bodies in the frame
+    uint64_t step;          ///< Simulation step
+    double time;            ///< Simulation time (seconds)
+    uint32_t keyframe;      ///< Frame number of the reference keyframe (own number for keyframes)
+    uint32_t sync;          ///< kTrajectoryFrameSync
+};
+static_assert(sizeof(TrajectoryFrameHeader) == 32, "trajectory frame header must stay 32 bytes");
+
+/**
+ * @struct TrajectoryIndexEntry
+ * @brief Footer index record for one frame
+ */
+struct TrajectoryIndexEntry {
+    uint64_t step;      ///< Simulation step
+    uint64_t offset;    ///< File offset of the frame header
+    uint32_t keyframe;  ///< Frame number of the reference keyframe
+    uint32_t reserved;  ///< Zero
+};
+static_assert(sizeof(TrajectoryIndexEntry) == 24, "trajectory index entry must stay 24 bytes");
+
+/**
+ * @struct TrajectoryFooter
+ * @brief Last 24 bytes of a closed file
+ */
+struct TrajectoryFooter {
+    uint64_t indexOffset;  ///< File offset of the first TrajectoryIndexEntry
+    uint64_t frameCount;   ///< Number of index entries
+    char magic[8];         ///< kTrajectoryIndexMagic
+};
+static_assert(sizeof(TrajectoryFooter) == 24, "trajectory footer must stay 24 bytes");
+
+/**
+ * @brief Compress a frame relative to a reference frame
+ * @param frame Frame to encode
+ * @param reference Previous frame (empty for a self-contained frame)
+ * @param out Output bytes (appended)
+ *
+ * The step, time and body count are not included; the container stores them.
+ */
+void encodeFrame(const TrajectoryFrame& frame, const TrajectoryFrame& reference, std::vector<uint8_t>& out);
+
+/**
+ * @brief Decompress a frame
+ * @param data Encoded bytes
+ * @param size Byte count
+ * @param count Body count of the frame
+ * @param reference The reference frame used when encoding
+ * @param out Output frame (columns resized to count)
+ * @return False if the data is truncated or malformed
+ */
+bool decodeFrame(const uint8_t* data, size_t size, size_t count, const TrajectoryFrame& reference,
+                 TrajectoryFrame& out);
@@ -0,0 +1,169 @@
+/**
+ * @file transport.cpp
+ * @brief Collectives and the Unix socketpair transport
+ */
+
+#include "transport.h"
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// ============================================================================
+// ITransport collectives
+// ============================================================================
+
+void ITransport::exchange(const std::vector<MessageBuffer>& outgoing, std::vector<MessageBuffer>& incoming) {
+    int me = rank();
+    incoming.resize(size());
+    incoming[me] = outgoing[me];
+
+    // Ascending peer order with lower rank sending first: every pair is
+    // serviced in the same global order on all ranks, so no cycle of
+    // blocked senders can form
+    for (int peer = 0; peer < size(); peer++) {
+        if (peer == me) continue;
+        if (me < peer) {
+            send(peer, outgoing[peer]);
+            recv(peer, incoming[peer]);
+        } else {
+            recv(peer, incoming[peer]);
+            send(peer, outgoing[peer]);
+        }
+    }
+}
+
+void ITransport::allGather(const MessageBuffer& mine, std::vector<MessageBuffer>& all) {
+    std::vector<MessageBuffer> outgoing(size(), mine);
+    exchange(outgoing, all);
+}
+
+// ============================================================================
+// SocketTransport
+// ============================================================================
+
+/**
+ * @brief Write exactly n bytes, retrying on partial writes
+ * @param fd Socket
+ * @param data Bytes to write
+ * @param n Byte count
+ */
+static void writeAll(int fd, const char* data, size_t n) {
+    while (n > 0) {
+        ssize_t written = ::write(fd, data, n);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            std::perror("transport write");
+            std::exit(3);
+        }
+        data += written;
+        n -= (size_t)written;
+    }
+}
+
+/**
+ * @brief Read exactly n bytes, retrying on partial reads
+ * @param fd Socket
+ * @param data Destination
+ * @param n Byte count
+ */
+static void readAll(int fd, char* data, size_t n) {
+    while (n > 0) {
+        ssize_t got = ::read(fd, data, n);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) {
+            std::perror("transport read");
+            std::exit(3);
+        }
+        data += got;
+        n -= (size_t)got;
+    }
+}
+
+SocketTransport::SocketTransport(int rank, std::vector<int> peerSockets)
+    : myRank(rank), peers(std::move(peerSockets)) {}
+
+SocketTransport::~SocketTransport() {
+    for (int fd : peers) {
+        if (fd >= 0) ::close(fd);
+    }
+}
+
+void SocketTransport::send(int dest, const MessageBuffer& data) {
+    uint64_t length = data.size();
+    writeAll(peers[dest], reinterpret_cast<const char*>(&length), sizeof(length));
+    writeAll(peers[dest], data.data(), data.size());
+}
+
+void SocketTransport::recv(int src, MessageBuffer& out) {
+    uint64_t length = 0;
+    readAll(peers[src], reinterpret_cast<char*>(&length), sizeof(length));
+    out.resize(length);
+    readAll(peers[src], out.data(), length);
+}
+
+int SocketTransport::launch(int size, const std::function<int(ITransport&)>& fn) {
+    // sockets[i][j] is rank i's end of the (i, j) pair
+    std::vector<std::vector<int>> sockets(size, std::vector<int>(size, -1));
+    for (int i = 0; i < size; i++) {
+        for (int j = i + 1; j < size; j++) {
+            int pair[2];
+            if (::socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0) {
+                std::perror("socketpair");
+                return 3;
+            }
+            sockets[i][j] = pair[0];
+            sockets[j][i] = pair[1];
+        }
+    }
+
+    // Keep only this rank's ends; close everything else
+    auto keepRank = [&](int r) {
+        for (int i = 0; i < size; i++) {
+            for (int j = 0; j < size; j++) {
+                if (i != r && sockets[i][j] >= 0) ::close(sockets[i][j]);
+            }
+        }
+        return sockets[r];
+    };
+
+    // Children inherit unflushed stdio buffers; flush so output is not duplicated
+    std::fflush(stdout);
+    std::fflush(stderr);
+
+    std::vector<pid_t> children;
+    for (int r = 1; r < size; r++) {
+        pid_t pid = ::fork();
+        if (pid < 0) {
+            std::perror("fork");
+            return 3;
+        }
+        if (pid == 0) {
+            int code;
+            {
+                SocketTransport transport(r, keepRank(r));
+                code = fn(transport);
+            }
+            std::fflush(stdout);
+            ::_exit(code);
+        }
+        children.push_back(pid);
+    }
+
+    int result;
+    {
+        SocketTransport transport(0, keepRank(0));
+        result = fn(transport);
+    }
+
+    for (pid_t pid : children) {
+        int status = 0;
+        ::waitpid(pid, &status, 0);
+        int code = WIFEXITED(status) ? WEXITSTATUS(status) : 3;
+        if (result == 0) result = code;
+    }
+    return result;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file transport.h
+ * @brief Pluggable message transport between simulation processes
+ *
+ * The distributed runner (domain.h) exchanges ghost data between processes
+ * on one machine. It only needs point-to-point messages and a few
+ * collective patterns built on them, so the transport is a small interface
+ * rather than an MPI dependency. SocketTransport connects every pair of
+ * ranks with a Unix domain socketpair created before forking.
+ *
+ * Native build only (POSIX fork and sockets).
+ */
+
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+/// Byte buffer used for messages
+using MessageBuffer = std::vector<char>;
+
+/**
+ * @class ITransport
+ * @brief Point-to-point message passing between a fixed set of ranks
+ *
+ * Messages are length-prefixed byte blobs. Collectives are implemented on
+ * top of send/recv with a fixed pairwise schedule: each rank talks to its
+ * peers in ascending rank order, the lower rank of a pair sending first.
+ * All ranks therefore walk the pairs in the same global order, which keeps
+ * blocking sends deadlock-free.
+ */
+class ITransport {
+public:
+    virtual ~ITransport() = default;
+
+    /**
+     * @brief Get this process's rank
+     * @return Rank in [0, size())
+     */
+    virtual int rank() const = 0;
+
+    /**
+     * @brief Get number of ranks
+     * @return Total rank count
+     */
+    virtual int size() const = 0;
+
+    /**
+     * @brief Send one message (blocks until handed to the transport)
+     * @param dest Destination rank
+     * @param data Message bytes
+     */
+    virtual void send(int dest, const MessageBuffer& data) = 0;
+
+    /**
+     * @brief Receive one message (blocks until it arrives)
+     * @param src Source rank
+     * @param out Output buffer, resized to the message length
+     */
+    virtual void recv(int src, MessageBuffer& out) = 0;
+
+    /**
+     * @brief All-to-all personalized exchange
+     * @param outgoing One message per rank (own entry is copied locally)
+     * @param incoming Output: one message from each rank
+     */
+    void exchange(const std::vector<MessageBuffer>& outgoing, std::vector<MessageBuffer>& incoming);
+
+    /**
+     * @brief Gather the same message from every rank on every rank
+     * @param mine This rank's contribution
+     * @param all Output: contributions indexed by rank
+     */
+    void allGather(const MessageBuffer& mine, std::vector<MessageBuffer>& all);
+};
+
+/**
+ * @class SocketTransport
+ * @brief ITransport over a full mesh of Unix domain socketpairs
+ */
+class SocketTransport : public ITransport {
+public:
+    /**
+     * @brief Run a function on `size` ranks in separate processes
+     * @param size Number of ranks (processes)
+     * @param fn Function executed by every rank with its transport; returns an exit code
+     * @return 0 if every rank returned 0, otherwise the first non-zero code
+     *
+     * The calling process becomes rank 0; ranks 1..size-1 are forked
+     * children that exit when fn returns.
+     */
+    static int launch(int size, const std::function<int(ITransport&)>& fn);
+
+    int rank() const override { return myRank; }
+    int size() const override { return (int)peers.size(); }
+    void send(int dest, const MessageBuffer& data) override;
+    void recv(int src, MessageBuffer& out) override;
+
+    /**
+     * @brief Close all peer sockets
+     */
+    ~SocketTransport() override;
+
+private:
+    int myRank;              ///< This process's rank
+    std::vector<int> peers;  ///< Socket per peer rank (-1 for self)
+
+    /**
+     * @brief Construct from an already-connected socket mesh
+     * @param rank This process's rank
+     * @param peerSockets Socket per peer rank (-1 for self)
+     */
+    SocketTransport(int rank, std::vector<int> peerSockets);
+};
@@ -0,0 +1,314 @@
+/**
+ * @file tree.cpp
+ * @brief Implementation of the Barnes-Hut tree for N-body gravity
+ *
+ * Implements the Barnes-Hut algorithm to accelerate N-body gravitational
+ * calculations from O(N²) to O(N log N). The tree recursively subdivides
+ * space into 2^D cells, storing aggregate mass properties at each node.
+ * Distant node clusters are approximated as single masses, controlled by
+ * the opening angle criterion (theta).
+ *
+ * Key algorithm details:
+ * - Leaf nodes contain at most one body
+ * - Internal nodes store center of mass and total mass of subtree
+ * - Opening criterion: s/d < theta (s=node size, d=distance, theta~0.5)
+ * - Supports periodic boundary conditions via minimum image convention
+ *
+ * Loops over axes and children have compile-time bounds, so the D = 2
+ * instantiation performs the same operations in the same order as a
+ * hand-written quadtree.
+ */
+
+#include "tree.h"
+#include "entity.h"
+#include "nbodysystem.h"
+#include <algorithm>
+
+/**
+ * @brief Construct a tree node
+ * @param center Geometric center of node's spatial region
+ * @param halfSize Half of the side of the cubic region
+ *
+ * Initializes empty node as a leaf with no mass. Children are created
+ * lazily when subdivision is needed.
+ */
+template <int D, typename BodyT>
+TreeNode<D, BodyT>::TreeNode(VecN<D> center, float halfSize)
+    : center(center), halfSize(halfSize), totalMass(0), body(nullptr), isLeaf(true) {
+}
+
+/**
+ * @brief Determine which child cell contains a position
+ * @param pos Position to classify
+ * @return Child index
+ *
+ * Uses bitwise encoding: bit d set if pos[d] >= center[d]
+ * (2D: bit 0 = East, bit 1 = South)
+ */
+template <int D, typename BodyT>
+int TreeNode<D, BodyT>::getChildIndex(const VecN<D>& pos) const {
+    int index = 0;
+    for (int d = 0; d < D; d++) {
+        if (pos[d] >= center[d]) index |= 1 << d;
+    }
+    return index;
+}
+
+/**
+ * @brief Subdivide this node into 2^D children
+ *
+ * Each child has half the linear size of the parent and is offset from
+ * the center by that half size along every axis (in 2D the quadrants
+ * NW, NE, SW, SE). Called when a leaf node needs to store a second body.
+ */
+template <int D, typename BodyT>
+void TreeNode<D, BodyT>::subdivide() {
+    float newHalfSize = halfSize * 0.5f;
+    for (int i = 0; i < kChildren; i++) {
+        VecN<D> childCenter;
+        for (int d = 0; d < D; d++) {
+            childCenter[d] = (i >> d) & 1 ? center[d] + newHalfSize : center[d] - newHalfSize;
+        }
+        children[i] = std::make_unique<TreeNode>(childCenter, newHalfSize);
+    }
+    isLeaf = false;
+}
+
+/**
+ * @brief Insert a body into the tree
+ * @param b Pointer to body to insert
+ *
+ * Recursively inserts body and updates center of mass along the path.
+ * If inserting into a leaf that already contains a body, subdivides the
+ * leaf and redistributes both bodies. Center of mass is computed using
+ * mass-weighted averaging: COM = (m1*r1 + m2*r2) / (m1 + m2)
+ */
+template <int D, typename BodyT>
+void TreeNode<D, BodyT>::insert(BodyT* b) {
+    if (isLeaf) {
+        if (body == nullptr) {
+            // Empty leaf - just store the body
+            body = b;
+            centerOfMass = b->pos;
+            totalMass = b->mass;
+        } else {
+            // Leaf already has a body - subdivide
+            BodyT* existingBody = body;
+            body = nullptr;
+            subdivide();
+
+            // Reinsert existing body
+            children[getChildIndex(existingBody->pos)]->insert(existingBody);
+
+            // Insert new body
+            children[getChildIndex(b->pos)]->insert(b);
+
+            // Update center of mass
+            float m1 = existingBody->mass;
+            float m2 = b->mass;
+            totalMass = m1 + m2;
+            centerOfMass = (existingBody->pos * m1 + b->pos * m2) / totalMass;
+        }
+    } else {
+        // Internal node - insert into appropriate child
+        children[getChildIndex(b->pos)]->insert(b);
+
+        // Update center of mass
+        float oldMass = totalMass;
+        VecN<D> oldCOM = centerOfMass;
+        totalMass += b->mass;
+        if (totalMass > 0) {
+            centerOfMass = (oldCOM * oldMass + b->pos * b->mass) / totalMass;
+        }
+    }
+}
+
+/**
+ * @brief Calculate gravitational acceleration using Barnes-Hut algorithm
+ * @param pos Position at which to calculate acceleration
+ * @param mass Mass of the body (for self-interaction exclusion)
+ * @param theta Opening angle criterion (typically 0.5)
+ * @param eps Softening length to prevent singularities
+ * @param G Gravitational constant
+ * @param box Periodic domain size per axis
+ * @return Gravitational acceleration vector
+ *
+ * Implementation of Barnes-Hut approximation:
+ * - For leaf nodes: compute direct force (excluding self-interaction)
+ * - For internal nodes: check opening criterion s/d < theta
+ *   - If satisfied: treat node as single mass at center of mass
+ *   - Otherwise: recurse into children for higher accuracy
+ * Uses softened gravity: a = G*M*r / (r² + ε²)^(3/2) to prevent singularities
+ * (other kernels: the template accumulateForce and softening.h)
+ * Periodic boundaries handled via minimum image convention
+ */
+template <int D, typename BodyT>
+VecN<D> TreeNode<D, BodyT>::calculateAcceleration(const VecN<D>& pos, float mass, float theta,
+                                                  float eps, float G, const VecN<D>& box) const {
+    ForceResultN<D> result;
+    accumulateForce(pos, mass, theta, eps, G, box, result);
+    return result.acc;
+}
+
+template <int D, typename BodyT>
+void TreeNode<D, BodyT>::accumulateForce(const VecN<D>& pos, float mass, float theta, float eps, float G,
+                                         const VecN<D>& box, ForceResultN<D>& out) const {
+    accumulateForce(pos, mass, theta, PlummerSoftening(eps), G, box, out);
+}
+
+/**
+ * @brief Check whether two positions are identical on every axis
+ * @param a First position
+ * @param b Second position
+ * @return True if all components compare equal
+ */
+template <int D>
+static bool samePosition(const VecN<D>& a, const VecN<D>& b) {
+    for (int d = 0; d < D; d++) {
+        if (a[d] != b[d]) return false;
+    }
+    return true;
+}
+
+template <int D, typename BodyT>
+template <typename Kernel>
+void TreeNode<D, BodyT>::accumulateForce(const VecN<D>& pos, float mass, float theta, const Kernel& kernel,
+                                         float G, const VecN<D>& box, ForceResultN<D>& out) const {
+    if (totalMass == 0) return;
+
+    // Calculate distance using minimum image convention
+    VecN<D> dr = minimumImage(centerOfMass - pos, box);
+    float r2 = dr.lengthSquared();
+
+    if (isLeaf) {
+        // Leaf node - calculate direct force
+        if (body && samePosition(body->pos, pos) && body->mass == mass) {
+            // Same body - no self-interaction
+            return;
+        }
+    } else {
+        // Internal node - check opening criterion
+        float r = std::sqrt(r2);
+        float s = halfSize * 2.0f;  // Node size
+
+        if (!(s / r < theta)) {
+            // Node is too close - recurse into children
+            for (int i = 0; i < kChildren; i++) {
+                if (children[i]) {
+                    children[i]->accumulateForce(pos, mass, theta, kernel, G, box, out);
+                }
+            }
+            return;
+        }
+    }
+
+    // Leaf or far enough node - treat as single mass at center of mass
+    float accScale, phi;
+    kernel.apply(r2, G * totalMass, accScale, phi);
+    out.acc += dr * accScale;
+    out.potential -= phi;
+    out.interactions++;
+}
+
+// ============================================================================
+// SpatialTree wrapper class implementation
+// ============================================================================
+
+/**
+ * @brief Largest axis of a box
+ * @param box Box size per axis
+ * @return max over d of box[d]
+ */
+template <int D>
+static float largestAxis(const VecN<D>& box) {
+    float size = box[0];
+    for (int d = 1; d < D; d++) size = std::max(size, box[d]);
+    return size;
+}
+
+/**
+ * @brief Construct a tree for the simulation domain
+ * @param box Size of the periodic domain per axis
+ *
+ * Creates root node centered in the box with a side large enough to
+ * contain the entire domain. Uses the largest axis to handle non-cubic
+ * domains.
+ */
+template <int D, typename BodyT>
+SpatialTree<D, BodyT>::SpatialTree(const VecN<D>& box)
+    : box(box), nodeCount(1) {
+    root = std::make_unique<TreeNode<D, BodyT>>(box * 0.5f, largestAxis(box) * 0.5f);
+}
+
+/**
+ * @brief Count the nodes of a subtree
+ * @param node Subtree root
+ * @return Nodes including node itself
+ */
+template <int D, typename BodyT>
+static int countNodes(const TreeNode<D, BodyT>* node) {
+    int count = 1;
+    if (!node->isLeaf) {
+        for (const auto& child : node->children) count += countNodes(child.get());
+    }
+    return count;
+}
+
+/**
+ * @brief Build the tree from a collection of bodies
+ * @param bodies Vector of body pointers to insert
+ *
+ * Reconstructs the tree from scratch. Should be called after all bodies
+ * have moved (typically after the drift step in leapfrog integration).
+ * Creates a new root node and inserts all bodies, building the spatial
+ * hierarchy bottom-up.
+ */
+template <int D, typename BodyT>
+void SpatialTree<D, BodyT>::build(std::vector<BodyT*>& bodies) {
+    root = std::make_unique<TreeNode<D, BodyT>>(box * 0.5f, largestAxis(box) * 0.5f);
+
+    for (BodyT* body : bodies) {
+        root->insert(body);
+    }
+    nodeCount = countNodes(root.get());
+}
+
+template <int D, typename BodyT>
+VecN<D> SpatialTree<D, BodyT>::calculateAcceleration(const VecN<D>& pos, float mass,
+                                                     float theta, float eps, float G) const {
+    return root->calculateAcceleration(pos, mass, theta, eps, G, box);
+}
+
+template <int D, typename BodyT>
+ForceResultN<D> SpatialTree<D, BodyT>::calculateForce(const VecN<D>& pos, float mass,
+                                                      float theta, float eps, float G) const {
+    ForceResultN<D> result;
+    root->accumulateForce(pos, mass, theta, eps, G, box, result);
+    return result;
+}
+
+// ============================================================================
+// Instantiations: the game quadtree, and the NBodySystem trees in 2D and 3D
+// ============================================================================
+
+/**
+ * @brief Instantiate one tree with its three kernel walks
+ */
+#define INSTANTIATE_TREE(D, BODY)                                                                             \
+    template class TreeNode<D, BODY>;                                                                         \
+    template class SpatialTree<D, BODY>;                                                                      \
+    template void TreeNode<D, BODY>::accumulateForce<PlummerSoftening>(const VecN<D>&, float, float,          \
+                                                                       const PlummerSoftening&, float,        \
+                                                                       const VecN<D>&, ForceResultN<D>&) const; \
+    template void TreeNode<D, BODY>::accumulateForce<SplineSoftening>(const VecN<D>&, float, float,           \
+                                                                      const SplineSoftening&, float,          \
+                                                                      const VecN<D>&, ForceResultN<D>&) const; \
+    template void TreeNode<D, BODY>::accumulateForce<NewtonianKernel>(const VecN<D>&, float, float,           \
+                                                                      const NewtonianKernel&, float,          \
+                                                                      const VecN<D>&, ForceResultN<D>&) const;
+
+INSTANTIATE_TREE(2, Body)
+INSTANTIATE_TREE(2, PointBody<2>)
+INSTANTIATE_TREE(3, PointBody<3>)
+
+#undef INSTANTIATE_TREE
@@ -0,0 +1,326 @@
+/**
+ * @file tree.h
+ * @brief Barnes-Hut 2^D-ary tree (quadtree and octree) for N-body gravity
+ *
+ * Implements the Barnes-Hut algorithm to reduce O(N²) pairwise force
+ * calculations to O(N log N) using spatial hierarchical grouping.
+ * Also provides periodic boundary condition utilities.
+ *
+ * The tree is a template over the dimension D and the body type, which
+ * needs only `VecN<D> pos` and `float mass`. The game uses QuadTree (D = 2
+ * over Body); 3D research runs use Octree (D = 3 over PointBody<3>, see
+ * nbodysystem.h). Member templates are defined in tree.cpp and explicitly
+ * instantiated there for these combinations and the softening kernels.
+ */
+
+#pragma once
+#include "softening.h"
+#include "vecn.h"
+#include <vector>
+#include <memory>
+
+// Forward declarations
+struct Body;
+
+/**
+ * @struct ForceResultN
+ * @brief Accumulated result of a tree walk for one body
+ * @tparam D Dimension
+ *
+ * The walk adds into these fields, so callers zero-initialize once and
+ * can combine several contributions.
+ */
+template <int D>
+struct ForceResultN {
+    VecN<D> acc;       ///< Gravitational acceleration
+    float potential;   ///< Gravitational potential per unit mass (phi, <= 0)
+    int interactions;  ///< Number of body/node interactions evaluated (work estimate)
+
+    /**
+     * @brief Default constructor - zero force and potential
+     */
+    ForceResultN() : potential(0), interactions(0) {}
+};
+
+/// Planar tree walk result
+using ForceResult = ForceResultN<2>;
+
+/**
+ * @class TreeNode
+ * @brief A node in the Barnes-Hut tree
+ * @tparam D Dimension (2: quadtree, 3: octree)
+ * @tparam BodyT Body type (pos and mass members)
+ *
+ * Recursively subdivides space into 2^D equal cells. Leaf nodes contain
+ * individual bodies, while internal nodes store aggregate mass properties
+ * (center of mass and total mass) for efficient far-field approximations.
+ *
+ * Child i covers the cell on the positive side of axis d where bit d of i
+ * is set; in 2D the four children are the quadrants NW, NE, SW, SE.
+ */
+template <int D, typename BodyT>
+class TreeNode {
+public:
+    /// Children per internal node
+    static constexpr int kChildren = 1 << D;
+
+    VecN<D> center;   ///< Geometric center of this node's region
+    float halfSize;   ///< Half of the side of the cubic region
+
+    // Aggregate mass properties for Barnes-Hut approximation
+    VecN<D> centerOfMass;  ///< Mass-weighted position of all bodies in subtree
+    float totalMass;       ///< Sum of masses of all bodies in subtree
+
+    /// Child nodes, indexed by the sides of the center they lie on (see class comment)
+    std::unique_ptr<TreeNode> children[kChildren];
+
+    BodyT* body;  ///< Pointer to body (only valid for leaf nodes)
+    bool isLeaf;  ///< True if this is a leaf node containing a single body
+
+    /**
+     * @brief Construct a tree node
+     * @param center Geometric center of this node's spatial region
+     * @param halfSize Half of the side of the cubic region
+     */
+    TreeNode(VecN<D> center, float halfSize);
+
+    /**
+     * @brief Insert a body into the tree
+     * @param b Pointer to the body to insert
+     *
+     * Recursively subdivides if necessary. When a leaf node receives a second
+     * body, it subdivides into 2^D children and redistributes both bodies.
+     */
+    void insert(BodyT* b);
+
+    /**
+     * @brief Calculate gravitational acceleration using Barnes-Hut algorithm
+     * @param pos Position at which to calculate acceleration
+     * @param mass Mass of the body being accelerated (for self-gravity exclusion)
+     * @param theta Opening angle criterion (typically ~0.5)
+     * @param eps Softening length to prevent singularities
+     * @param G Gravitational constant
+     * @param box Periodic domain size per axis
+     * @return Gravitational acceleration vector
+     *
+     * Uses opening angle criterion: s/d < theta, where s is node size and d is distance.
+     * If criterion met, treats entire node as a single mass at center of mass.
+     * Otherwise, recursively evaluates children.
+     */
+    VecN<D> calculateAcceleration(const VecN<D>& pos, float mass, float theta,
+                                  float eps, float G, const VecN<D>& box) const;
+
+    /**
+     * @brief Accumulate acceleration and potential using Barnes-Hut algorithm
+     * @param pos Position at which to evaluate
+     * @param mass Mass of the body being evaluated (for self-gravity exclusion)
+     * @param theta Opening angle criterion
+     * @param eps Softening length
+     * @param G Gravitational constant
+     * @param box Periodic domain size per axis
+     * @param out Result to add into
+     *
+     * Same walk as calculateAcceleration; the softened potential
+     * phi = -G*M / sqrt(r² + ε²) shares the inverse square root with the
+     * force, so it costs one extra multiply-add per interaction.
+     */
+    void accumulateForce(const VecN<D>& pos, float mass, float theta, float eps, float G,
+                         const VecN<D>& box, ForceResultN<D>& out) const;
+
+    /**
+     * @brief Accumulate acceleration and potential with a softening policy
+     * @tparam Kernel PlummerSoftening, SplineSoftening or NewtonianKernel (softening.h)
+     * @param pos Position at which to evaluate
+     * @param mass Mass of the body being evaluated (for self-gravity exclusion)
+     * @param theta Opening angle criterion
+     * @param kernel Prepared kernel
+     * @param G Gravitational constant
+     * @param box Periodic domain size per axis
+     * @param out Result to add into
+     *
+     * Instantiated in tree.cpp for the three kernels; the eps overload
+     * above is the Plummer instantiation.
+     */
+    template <typename Kernel>
+    void accumulateForce(const VecN<D>& pos, float mass, float theta, const Kernel& kernel, float G,
+                         const VecN<D>& box, ForceResultN<D>& out) const;
+
+private:
+    /**
+     * @brief Determine which child cell contains a position
+     * @param pos Position to check
+     * @return Child index: bit d set if pos[d] >= center[d] (2D: 0=NW, 1=NE, 2=SW, 3=SE)
+     */
+    int getChildIndex(const VecN<D>& pos) const;
+
+    /**
+     * @brief Subdivide this node into 2^D children
+     *
+     * Called when a leaf node needs to accept a second body.
+     */
+    void subdivide();
+};
+
+/**
+ * @class SpatialTree
+ * @brief Container for the Barnes-Hut tree
+ * @tparam D Dimension (2: quadtree, 3: octree)
+ * @tparam BodyT Body type (pos and mass members)
+ *
+ * Manages the root node and provides the interface for building
+ * the tree and querying accelerations.
+ */
+template <int D, typename BodyT>
+class SpatialTree {
+public:
+    /**
+     * @brief Construct a tree for the simulation domain
+     * @param box Size of the periodic domain per axis (width, height[, depth])
+     */
+    explicit SpatialTree(const VecN<D>& box);
+
+    /**
+     * @brief Build the tree from a collection of bodies
+     * @param bodies Vector of body pointers to insert into the tree
+     *
+     * Reconstructs the tree from scratch each time. Should be called
+     * after all bodies have moved (after the drift step in leapfrog).
+     */
+    void build(std::vector<BodyT*>& bodies);
+
+    /**
+     * @brief Calculate gravitational acceleration at a position
+     * @param pos Position at which to calculate acceleration
+     * @param mass Mass of the body (for self-exclusion)
+     * @param theta Opening angle criterion
+     * @param eps Softening length
+     * @param G Gravitational constant
+     * @return Gravitational acceleration vector from all bodies
+     */
+    VecN<D> calculateAcceleration(const VecN<D>& pos, float mass, float theta,
+                                  float eps, float G) const;
+
+    /**
+     * @brief Calculate acceleration and potential at a position
+     * @param pos Position at which to evaluate
+     * @param mass Mass of the body (for self-exclusion)
+     * @param theta Opening angle criterion
+     * @param eps Softening length
+     * @param G Gravitational constant
+     * @return Acceleration and potential per unit mass from all bodies
+     */
+    ForceResultN<D> calculateForce(const VecN<D>& pos, float mass, float theta,
+                                   float eps, float G) const;
+
+    /**
+     * @brief Calculate acceleration and potential with a softening policy
+     * @tparam Kernel Softening policy (softening.h)
+     * @param pos Position at which to evaluate
+     * @param mass Mass of the body (for self-exclusion)
+     * @param theta Opening angle criterion
+     * @param kernel Prepared kernel
+     * @param G Gravitational constant
+     * @return Acceleration and potential per unit mass from all bodies
+     */
+    template <typename Kernel>
+    ForceResultN<D> calculateForce(const VecN<D>& pos, float mass, float theta, const Kernel& kernel,
+                                   float G) const {
+        ForceResultN<D> result;
+        root->accumulateForce(pos, mass, theta, kernel, G, box, result);
+        return result;
+    }
+
+    /**
+     * @brief Get the root node (read-only, for tree export)
+     * @return Root node of the most recent build
+     */
+    const TreeNode<D, BodyT>* getRoot() const { return root.get(); }
+
+    /**
+     * @brief Get the size of the most recent build
+     * @return Nodes (each a separate heap allocation), including the root
+     */
+    int getNodeCount() const { return nodeCount; }
+
+private:
+    VecN<D> box;                               ///< Size of the periodic domain per axis
+    std::unique_ptr<TreeNode<D, BodyT>> root;  ///< Root node of the tree
+    int nodeCount;                             ///< Nodes in the most recent build
+};
+
+/// Node of the game's quadtree
+using QuadTreeNode = TreeNode<2, Body>;
+
+/// Barnes-Hut quadtree over game bodies
+using QuadTree = SpatialTree<2, Body>;
+
+/**
+ * @brief Calculate minimum image displacement for periodic boundaries
+ * @param dr Displacement vector (destination - source)
+ * @param worldWidth Width of the periodic domain
+ * @param worldHeight Height of the periodic domain
+ * @return Adjusted displacement vector using nearest-image convention
+ *
+ * Implements torus topology: if displacement exceeds half the box size,
+ * uses the shorter path across the periodic boundary. Essential for
+ * correctly calculating forces and distances in periodic systems.
+ *
+ * @note Used for force calculations and collision detection
+ */
+inline Vec2 minimumImage(Vec2 dr, float worldWidth, float worldHeight) {
+    if (dr.x > worldWidth * 0.5f) dr.x -= worldWidth;
+    if (dr.x < -worldWidth * 0.5f) dr.x += worldWidth;
+    if (dr.y > worldHeight * 0.5f) dr.y -= worldHeight;
+    if (dr.y < -worldHeight * 0.5f) dr.y += worldHeight;
+    return dr;
+}
+
+/**
+ * @brief Calculate minimum image displacement in any dimension
+ * @param dr Displacement vector (destination - source)
+ * @param box Size of the periodic domain per axis
+ * @return Adjusted displacement vector using nearest-image convention
+ *
+ * Same per-axis arithmetic as the planar overload.
+ */
+template <int D>
+inline VecN<D> minimumImage(VecN<D> dr, const VecN<D>& box) {
+    for (int d = 0; d < D; d++) {
+        if (dr[d] > box[d] * 0.5f) dr[d] -= box[d];
+        if (dr[d] < -box[d] * 0.5f) dr[d] += box[d];
+    }
+    return dr;
+}
+
+/**
+ * @brief Wrap position to stay within periodic boundaries
+ * @param pos Position to wrap
+ * @param worldWidth Width of the periodic domain
+ * @param worldHeight Height of the periodic domain
+ * @return Wrapped position inside [0, worldWidth) × [0, worldHeight)
+ *
+ * Ensures positions remain in the primary simulation cell by
+ * wrapping around periodic boundaries.
+ */
+inline Vec2 wrapPosition(Vec2 pos, float worldWidth, float worldHeight) {
+    while (pos.x < 0) pos.x += worldWidth;
+    while (pos.x >= worldWidth) pos.x -= worldWidth;
+    while (pos.y < 0) pos.y += worldHeight;
+    while (pos.y >= worldHeight) pos.y -= worldHeight;
+    return pos;
+}
+
+/**
+ * @brief Wrap position into the primary cell in any dimension
+ * @param pos Position to wrap
+ * @param box Size of the periodic domain per axis
+ * @return Wrapped position inside [0, box[d]) on every axis
+ */
+template <int D>
+inline VecN<D> wrapPosition(VecN<D> pos, const VecN<D>& box) {
+    for (int d = 0; d < D; d++) {
+        while (pos[d] < 0) pos[d] += box[d];
+        while (pos[d] >= box[d]) pos[d] -= box[d];
+    }
+    return pos;
+}
@@ -0,0 +1,301 @@
+/**
+ * @file vecn.h
+ * @brief Fixed-dimension vector mathematics for N-body physics simulation
+ *
+ * VecN<D> is a D-component float vector. The game and everything around it
+ * are planar and use Vec2 = VecN<2>; the research core (tree, potentials
+ * and NBodySystem) is written once over D and also instantiated for
+ * Vec3 = VecN<3>. Each dimension is a specialisation with named members
+ * (x, y[, z]), so Vec2 code is unchanged and as cheap as before; code
+ * generic over D uses operator[] with a constant index inside loops over
+ * d < D, which the compiler unrolls and resolves to the named member.
+ */
+
+#pragma once
+#include <cmath>
+
+/**
+ * @struct VecN
+ * @brief A D-dimensional vector with floating-point components
+ * @tparam D Dimension (2 or 3)
+ */
+template <int D>
+struct VecN;
+
+/**
+ * @struct VecN<2>
+ * @brief A 2D vector with floating-point components
+ *
+ * Represents positions, velocities, accelerations, and forces
+ * in the 2D simulation space. Provides operator overloading for
+ * convenient vector arithmetic.
+ */
+template <>
+struct VecN<2> {
+    float x; ///< X component
+    float y; ///< Y component
+
+    /**
+     * @brief Default constructor - initializes to zero vector
+     */
+    VecN() : x(0), y(0) {}
+
+    /**
+     * @brief Construct from components
+     * @param x X component
+     * @param y Y component
+     */
+    VecN(float x, float y) : x(x), y(y) {}
+
+    /**
+     * @brief Component access
+     * @param i Component index (0 = x, 1 = y)
+     * @return Component
+     */
+    float& operator[](int i) { return i == 0 ? x : y; }
+
+    /**
+     * @brief Component access
+     * @param i Component index (0 = x, 1 = y)
+     * @return Component value
+     */
+    float operator[](int i) const { return i == 0 ? x : y; }
+
+    /**
+     * @brief Vector addition
+     * @param other Vector to add
+     * @return Sum of vectors
+     */
+    VecN operator+(const VecN& other) const { return VecN(x + other.x, y + other.y); }
+
+    /**
+     * @brief Vector subtraction
+     * @param other Vector to subtract
+     * @return Difference of vectors
+     */
+    VecN operator-(const VecN& other) const { return VecN(x - other.x, y - other.y); }
+
+    /**
+     * @brief Scalar multiplication
+     * @param s Scalar value
+     * @return Scaled vector
+     */
+    VecN operator*(float s) const { return VecN(x * s, y * s); }
+
+    /**
+     * @brief Scalar division
+     * @param s Scalar divisor
+     * @return Scaled vector
+     */
+    VecN operator/(float s) const { return VecN(x / s, y / s); }
+
+    /**
+     * @brief In-place vector addition
+     * @param other Vector to add
+     * @return Reference to this vector
+     */
+    VecN& operator+=(const VecN& other) { x += other.x; y += other.y; return *this; }
+
+    /**
+     * @brief In-place vector subtraction
+     * @param other Vector to subtract
+     * @return Reference to this vector
+     */
+    VecN& operator-=(const VecN& other) { x -= other.x; y -= other.y; return *this; }
+
+    /**
+     * @brief In-place scalar multiplication
+     * @param s Scalar value
+     * @return Reference to this vector
+     */
+    VecN& operator*=(float s) { x *= s; y *= s; return *this; }
+
+    /**
+     * @brief Calculate squared magnitude (avoids sqrt)
+     * @return |v|² = x² + y²
+     * @note Faster than length() for distance comparisons
+     */
+    float lengthSquared() const { return x * x + y * y; }
+
+    /**
+     * @brief Calculate vector magnitude
+     * @return |v| = √(x² + y²)
+     */
+    float length() const { return std::sqrt(lengthSquared()); }
+
+    /**
+     * @brief Return unit vector in same direction
+     * @return Normalized vector (length = 1) or zero if length = 0
+     */
+    VecN normalized() const { float len = length(); return len > 0 ? *this / len : VecN(0, 0); }
+
+    /**
+     * @brief Calculate dot product with another vector
+     * @param other The other vector
+     * @return v · other = x*other.x + y*other.y
+     * @note Useful for projections and angle calculations
+     */
+    float dot(const VecN& other) const { return x * other.x + y * other.y; }
+
+    /**
+     * @brief Rotate vector by angle
+     * @param angle Rotation angle in radians (positive = counter-clockwise)
+     * @return Rotated vector
+     * @note Uses standard 2D rotation matrix: [cos -sin; sin cos]
+     */
+    VecN rotated(float angle) const {
+        float c = std::cos(angle);
+        float s = std::sin(angle);
+        return VecN(x * c - y * s, x * s + y * c);
+    }
+};
+
+/**
+ * @struct VecN<3>
+ * @brief A 3D vector with floating-point components (research runs)
+ */
+template <>
+struct VecN<3> {
+    float x; ///< X component
+    float y; ///< Y component
+    float z; ///< Z component
+
+    /**
+     * @brief Default constructor - initializes to zero vector
+     */
+    VecN() : x(0), y(0), z(0) {}
+
+    /**
+     * @brief Construct from components
+     * @param x X component
+     * @param y Y component
+     * @param z Z component
+     */
+    VecN(float x, float y, float z) : x(x), y(y), z(z) {}
+
+    /**
+     * @brief Component access
+     * @param i Component index (0 = x, 1 = y, 2 = z)
+     * @return Component
+     */
+    float& operator[](int i) { return i == 0 ? x : (i == 1 ? y : z); }
+
+    /**
+     * @brief Component access
+     * @param i Component index (0 = x, 1 = y, 2 = z)
+     * @return Component value
+     */
+    float operator[](int i) const { return i == 0 ? x : (i == 1 ? y : z); }
+
+    /**
+     * @brief Vector addition
+     * @param other Vector to add
+     * @return Sum of vectors
+     */
+    VecN operator+(const VecN& other) const { return VecN(x + other.x, y + other.y, z + other.z); }
+
+    /**
+     * @brief Vector subtraction
+     * @param other Vector to subtract
+     * @return Difference of vectors
+     */
+    VecN operator-(const VecN& other) const { return VecN(x - other.x, y - other.y, z - other.z); }
+
+    /**
+     * @brief Scalar multiplication
+     * @param s Scalar value
+     * @return Scaled vector
+     */
+    VecN operator*(float s) const { return VecN(x * s, y * s, z * s); }
+
+    /**
+     * @brief Scalar division
+     * @param s Scalar divisor
+     * @return Scaled vector
+     */
+    VecN operator/(float s) const { return VecN(x / s, y / s, z / s); }
+
+    /**
+     * @brief In-place vector addition
+     * @param other Vector to add
+     * @return Reference to this vector
+     */
+    VecN& operator+=(const VecN& other) { x += other.x; y += other.y; z += other.z; return *this; }
+
+    /**
+     * @brief In-place vector subtraction
+     * @param other Vector to subtract
+     * @return Reference to this vector
+     */
+    VecN& operator-=(const VecN& other) { x -= other.x; y -= other.y; z -= other.z; return *this; }
+
+    /**
+     * @brief In-place scalar multiplication
+     * @param s Scalar value
+     * @return Reference to this vector
+     */
+    VecN& operator*=(float s) { x *= s; y *= s; z *= s; return *this; }
+
+    /**
+     * @brief Calculate squared magnitude (avoids sqrt)
+     * @return |v|² = x² + y² + z²
+     */
+    float lengthSquared() const { return x * x + y * y + z * z; }
+
+    /**
+     * @brief Calculate vector magnitude
+     * @return |v|
+     */
+    float length() const { return std::sqrt(lengthSquared()); }
+
+    /**
+     * @brief Return unit vector in same direction
+     * @return Normalized vector (length = 1) or zero if length = 0
+     */
+    VecN normalized() const { float len = length(); return len > 0 ? *this / len : VecN(0, 0, 0); }
+
+    /**
+     * @brief Calculate dot product with another vector
+     * @param other The other vector
+     * @return v · other
+     */
+    float dot(const VecN& other) const { return x * other.x + y * other.y + z * other.z; }
+
+    /**
+     * @brief Calculate cross product with another vector
+     * @param other The other vector
+     * @return v × other
+     */
+    VecN cross(const VecN& other) const {
+        return VecN(y * other.z - z * other.y, z * other.x - x * other.z, x * other.y - y * other.x);
+    }
+};
+
+/// Planar vector used by the game
+using Vec2 = VecN<2>;
+
+/// Spatial vector used by 3D research runs
+using Vec3 = VecN<3>;
+
+/**
+ * @brief Scalar multiplication (commutative)
+ * @param s Scalar value
+ * @param v Vector
+ * @return s * v
+ * @note Allows writing scalar * vector in addition to vector * scalar
+ */
+template <int D>
+inline VecN<D> operator*(float s, const VecN<D>& v) { return v * s; }
+
+/**
+ * @brief Vector with every component equal
+ * @tparam D Dimension
+ * @param value Component value
+ * @return (value, ..., value)
+ */
+template <int D>
+inline VecN<D> splat(float value) {
+    VecN<D> v;
+    for (int d = 0; d < D; d++) v[d] = value;
+    return v;
+}
@@ -4,7 +4,7 @@ import { InputManager } from './input';
 import { AudioManager } from './audio';
 import { UIManager } from './ui';
 import { GameState, GameMode } from './types';
-import type { GameConfig } from './types';
+import type { GameConfig, PhysicsInitOptions } from './types';
 
 export class Game {
   private physics: PhysicsEngine;
@@ -19,6 +19,8 @@ export class Game {
   private accumulator: number = 0;
   private readonly fixedDt: number = 1 / 120;
 
+  private prebakedWorld: boolean = false;  // World restored from initialState, not yet started
+
   private prevBulletCount: number = 0;
   private prevAsteroidCount: number = 0;
   private prevBlackHoleCount: number = 0;
@@ -73,11 +75,12 @@ export class Game {
     });
   }
 
-  async initialize(): Promise<void> {
+  async initialize(options: PhysicsInitOptions = {}): Promise<void> {
     this.ui.setLoading(true);
 
     try {
-      await this.physics.initialize(this.canvas.width, this.canvas.height);
+      await this.physics.initialize(this.canvas.width, this.canvas.height, undefined, options);
+      this.prebakedWorld = this.physics.getStartupTiming()?.prebakedState ?? false;
       this.ui.setLoading(false);
     } catch (error) {
       console.error('Failed to initialize physics engine:', error);
@@ -89,10 +92,16 @@ export class Game {
   private startGame(): void {
     const config = this.ui.getConfig();
 
-    this.physics.setMode(config.mode);
-    this.physics.setLevel(config.level);
-    this.physics.setDifficulty(config.difficulty);
-    this.physics.reset();
+    if (this.prebakedWorld) {
+      // The first start plays the pre-baked world as restored (it carries its
+      // own mode, level and difficulty); setMode() would regenerate it
+      this.prebakedWorld = false;
+    } else {
+      // setMode() resets the world, so it goes last: one world generation per start
+      this.physics.setLevel(config.level);
+      this.physics.setDifficulty(config.difficulty);
+      this.physics.setMode(config.mode);
+    }
 
     this.ui.setState(GameState.PLAYING);
     this.running = true;
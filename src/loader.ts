@@ -0,0 +1,182 @@
+/**
+ * @fileoverview WebAssembly module loading for fast cold starts
+ *
+ * Compiles physics.wasm with WebAssembly.compileStreaming, so compilation
+ * overlaps the download, while the Emscripten glue script is still
+ * loading. The result is kept in IndexedDB under the wasm URL together
+ * with the content hash the build writes to physics.wasm.version
+ * (engine/Makefile); a warm start whose hash matches skips the download.
+ * IndexedDB is read first, while the version file is in flight: with no
+ * cached entry the download starts at once, so a cold start pays no extra
+ * round trip; only a stale entry (a new build) waits for the version.
+ *
+ * Browsers that can structured-clone a WebAssembly.Module store the
+ * compiled module itself and skip compilation too. Most current browsers
+ * reject that with a DataCloneError; the wasm bytes are stored instead,
+ * so a warm start still compiles (baseline tier, fast) but never waits on
+ * the network. Without a version file or without IndexedDB (private
+ * browsing, file://) loading falls back to plain streaming compilation,
+ * and if even that fails the glue script fetches the module itself.
+ *
+ * Usage:
+ * ```typescript
+ * const compiled = loadWasmModule('/physics.wasm', '/physics.wasm.version');
+ * // ... load the glue script meanwhile ...
+ * const { module, source } = await compiled;
+ * ```
+ */
+
+import type { ModuleSource } from './types';
+
+const DB_NAME = 'nbody-wasm-cache';
+const DB_VERSION = 1;
+const STORE = 'modules';
+
+/**
+ * Cache record, one per wasm URL (a new build overwrites the old one)
+ */
+interface CacheEntry {
+  version: string;                  // Content hash from the version file
+  module?: WebAssembly.Module;      // Compiled module, where the browser can store it
+  bytes?: ArrayBuffer;              // Raw wasm otherwise
+}
+
+/**
+ * Compiled module and how it was obtained
+ */
+export interface LoadedWasm {
+  module: WebAssembly.Module | null;  // Null when loading is left to the glue script
+  source: ModuleSource;
+}
+
+/**
+ * Wrap an IndexedDB request in a promise
+ * @param request Pending request
+ * @returns Request result
+ */
+function requestResult<T>(request: IDBRequest<T>): Promise<T> {
+  return new Promise((resolve, reject) => {
+    request.onsuccess = () => resolve(request.result);
+    request.onerror = () => reject(request.error);
+  });
+}
+
+/**
+ * Open the module cache
+ * @returns Database, or null where IndexedDB is unavailable
+ */
+async function openCache(): Promise<IDBDatabase | null> {
+  if (typeof indexedDB === 'undefined') return null;
+  try {
+    const request = indexedDB.open(DB_NAME, DB_VERSION);
+    request.onupgradeneeded = () => request.result.createObjectStore(STORE);
+    return await requestResult(request);
+  } catch {
+    return null;
+  }
+}
+
+/**
+ * Read the build's content hash
+ * @param versionUrl URL of the version file
+ * @returns Hash, or null if the file is missing (caching is then skipped)
+ */
+async function fetchVersion(versionUrl: string): Promise<string | null> {
+  try {
+    // Always revalidate: this tiny file is what detects a new build
+    const response = await fetch(versionUrl, { cache: 'no-cache' });
+    if (!response.ok) return null;
+    const version = (await response.text()).trim();
+    return version.length > 0 ? version : null;
+  } catch {
+    return null;
+  }
+}
+
+/**
+ * Compile from the network, streaming where the server sends application/wasm
+ * @param wasmUrl Module URL
+ * @param request The module fetch, already in flight
+ * @returns Module, an unconsumed copy of the response (for the cache) and how it was compiled
+ */
+async function compileFromNetwork(wasmUrl: string, request: Promise<Response>): Promise<{ module: WebAssembly.Module; response: Response; source: ModuleSource }> {
+  const response = await request;
+  if (!response.ok) throw new Error(`${wasmUrl}: HTTP ${response.status}`);
+  const copy = response.clone();
+  try {
+    return { module: await WebAssembly.compileStreaming(response), response: copy, source: 'streaming' };
+  } catch {
+    // Wrong MIME type (e.g. a plain static server): compile from a buffer
+    const bytes = await copy.clone().arrayBuffer();
+    return { module: await WebAssembly.compile(bytes), response: copy, source: 'buffered' };
+  }
+}
+
+/**
+ * Store a freshly compiled module, falling back to its bytes
+ * @param db Cache database
+ * @param key Wasm URL
+ * @param version Content hash
+ * @param module Compiled module
+ * @param response Unconsumed copy of the wasm response
+ */
+async function storeModule(db: IDBDatabase, key: string, version: string,
+                           module: WebAssembly.Module, response: Response): Promise<void> {
+  try {
+    const entry: CacheEntry = { version, module };
+    await requestResult(db.transaction(STORE, 'readwrite').objectStore(STORE).put(entry, key));
+    return;
+  } catch {
+    // DataCloneError: this browser cannot persist compiled modules
+  }
+  try {
+    const entry: CacheEntry = { version, bytes: await response.arrayBuffer() };
+    await requestResult(db.transaction(STORE, 'readwrite').objectStore(STORE).put(entry, key));
+  } catch (error) {
+    console.warn('Could not cache physics module:', error);
+  }
+}
+
+/**
+ * Load and compile the physics module, from the cache when it is current
+ * @param wasmUrl Module URL
+ * @param versionUrl Version file URL, or null to skip the cache
+ * @returns Compiled module (null if the glue script must load it) and its source
+ */
+export async function loadWasmModule(wasmUrl: string, versionUrl: string | null): Promise<LoadedWasm> {
+  // The version round trip runs while the local cache is read
+  const versionRequest = versionUrl ? fetchVersion(versionUrl) : Promise.resolve(null);
+  const db = versionUrl ? await openCache() : null;
+  let entry: CacheEntry | undefined;
+  if (db) {
+    try {
+      entry = await requestResult<CacheEntry | undefined>(
+        db.transaction(STORE, 'readonly').objectStore(STORE).get(wasmUrl));
+    } catch (error) {
+      console.warn('Physics module cache unreadable:', error);
+    }
+  }
+
+  // Nothing cached: the download need not wait for the version file
+  const request: Promise<Response> | null = entry ? null : fetch(wasmUrl);
+  void request?.catch(() => {});  // reported by compileFromNetwork
+  const version = await versionRequest;
+
+  if (entry && version && entry.version === version) {
+    if (entry.module) return { module: entry.module, source: 'module-cache' };
+    if (entry.bytes) return { module: await WebAssembly.compile(entry.bytes), source: 'bytes-cache' };
+  }
+
+  try {
+    // A stale entry (new build) is refetched only now, after the version check
+    const { module, response, source } = await compileFromNetwork(wasmUrl, request ?? fetch(wasmUrl));
+    if (db && version) {
+      // Off the start-up path: the first step does not wait for the write
+      void storeModule(db, wasmUrl, version, module, response);
+    }
+    return { module, source };
+  } catch (error) {
+    console.warn('Streaming compilation failed, leaving it to the glue script:', error);
+    return { module: null, source: 'glue' };
+  }
+}
@@ -19,10 +19,33 @@ import type {
   BulletData,
   BlackHoleData,
   ParticleData,
+  DiagnosticsData,
+  ForceAccuracyData,
+  RadialProfileData,
+  StepProfileData,
+  LatencyData,
+  LatencyOutlierData,
+  StepPhaseName,
+  MemoryStatsData,
+  MemoryTagData,
+  MemoryTagName,
+  SofteningKernelName,
+  PhysicsInitOptions,
+  StartupTiming,
   InputState,
   DifficultyConfig,
   GameMode
 } from './types';
+import { loadWasmModule } from './loader';
+
+/** Step phases in StepPhase order (engine/latency.h) */
+const STEP_PHASES: StepPhaseName[] = ['entities', 'gravity', 'analysis', 'collisions', 'cleanup'];
+
+/** Softening kernels in SofteningKernel order (engine/softening.h) */
+const SOFTENING_KERNELS: SofteningKernelName[] = ['plummer', 'spline', 'none'];
+
+/** Allocation tags in MemoryTag order (engine/allocation.h) */
+const MEMORY_TAGS: MemoryTagName[] = ['untagged', 'entities', 'particles', 'quadtree', 'collision', 'engine'];
 
 /**
  * Emscripten module interface with physics engine functions
@@ -30,7 +53,11 @@ import type {
  */
 interface PhysicsModule extends EmscriptenModule {
   _engine_create: (width: number, height: number, seed: number) => number;
+  _engine_create_deferred: (width: number, height: number, seed: number) => number;
   _engine_destroy: (handle: number) => void;
+  _engine_save_state: (handle: number) => number;
+  _engine_get_saved_state: () => number;
+  _engine_load_state: (handle: number, data: number, size: number) => number;
   _engine_set_mode: (handle: number, mode: number) => void;
   _engine_set_level: (handle: number, levelId: number) => void;
   _engine_set_difficulty: (handle: number, bhSpawnRate: number, bhMassMult: number, bhAccRadius: number) => void;
@@ -44,12 +71,29 @@ interface PhysicsModule extends EmscriptenModule {
   _engine_get_ship_data: (handle: number, index: number, outData: number) => void;
   _engine_get_asteroid_count: (handle: number) => number;
   _engine_get_asteroid_data: (handle: number, index: number, outData: number) => void;
+  _engine_get_asteroid_shape: (handle: number, index: number, outData: number) => void;
   _engine_get_bullet_count: (handle: number) => number;
   _engine_get_bullet_data: (handle: number, index: number, outData: number) => void;
   _engine_get_blackhole_count: (handle: number) => number;
   _engine_get_blackhole_data: (handle: number, index: number, outData: number) => void;
   _engine_get_particle_count: (handle: number) => number;
   _engine_get_particle_data: (handle: number, index: number, outData: number) => void;
+  _engine_get_particles: (handle: number, outData: number, maxCount: number) => number;
+  _engine_set_compact_storage: (handle: number, enabled: number) => void;
+  _engine_get_diagnostics: (handle: number, outData: number) => void;
+  _engine_reset_diagnostics_baseline: (handle: number) => void;
+  _engine_set_force_monitor: (handle: number, interval: number, samples: number, adaptiveTheta: number, targetError: number) => void;
+  _engine_get_force_accuracy: (handle: number, outData: number) => void;
+  _engine_set_profiles: (handle: number, bins: number, maxRadius: number, interval: number) => void;
+  _engine_get_profile_bins: (handle: number) => number;
+  _engine_get_profile: (handle: number) => number;
+  _engine_get_step_profile: (handle: number, outData: number) => void;
+  _engine_set_latency_config: (handle: number, window: number, outlierFactor: number, minOutlierMs: number) => void;
+  _engine_get_latency: (handle: number, scope: number, outData: number) => void;
+  _engine_get_latency_outliers: (handle: number, outData: number, maxCount: number) => number;
+  _engine_get_memory_stats: (handle: number, outData: number) => void;
+  _engine_set_memory_budget: (handle: number, tag: number, bytes: number) => void;
+  _engine_reset_memory_peaks: (handle: number) => void;
   _engine_get_potential_name: (handle: number) => number;
   _engine_get_potential_description: (handle: number) => number;
 }
@@ -76,13 +120,17 @@ export class PhysicsEngine {
   private handle: number = 0;           // Opaque pointer to C++ GameEngine
   private tempBuffer: Float32Array;     // Reusable buffer for data transfer
   private tempPtr: number = 0;          // WASM memory address of tempBuffer
+  private particlePtr: number = 0;      // WASM buffer for batch particle reads (grown on demand)
+  private particleCapacity: number = 0; // Capacity of particlePtr in particles
+  private startup: StartupTiming | null = null;  // Cold-start timeline (first step filled in by step())
+  private startTime: number = 0;        // performance.now() when initialize() was called
 
   /**
    * Create physics engine wrapper
    * Initializes temporary buffer for efficient data transfer
    */
   constructor() {
-    this.tempBuffer = new Float32Array(16);
+    this.tempBuffer = new Float32Array(32);
   }
 
   /**
@@ -90,14 +138,41 @@ export class PhysicsEngine {
    * @param width World width in pixels
    * @param height World height in pixels
    * @param seed Random seed for reproducible simulations (default: Date.now())
+   * @param options Loading options (module cache, deferred world, pre-baked state)
    *
-   * Asynchronously loads the physics.js script which contains the WASM module,
-   * creates the C++ engine instance, and allocates shared memory for data transfer.
+   * The wasm module is compiled (streaming, or from the IndexedDB cache, see
+   * loader.ts) and the optional initial state downloaded while the glue
+   * script loads, and the runtime is instantiated from that module. By
+   * default the engine's world is populated by the first setMode()/reset()/
+   * step() rather than at creation, since callers configure a game first.
+   * A pre-baked state (bytes from saveState() with the same world size and
+   * build) replaces world generation entirely; if it does not match, the
+   * engine generates the world as usual. getStartupTiming() reports the
+   * timeline up to the first step.
    */
-  async initialize(width: number, height: number, seed: number = Date.now()): Promise<void> {
+  async initialize(width: number, height: number, seed: number = Date.now(),
+                   options: PhysicsInitOptions = {}): Promise<void> {
+    const start = performance.now();
+    const elapsed = () => performance.now() - start;
+    const scriptUrl = options.scriptUrl ?? '/physics.js';
+    const wasmUrl = options.wasmUrl ?? '/physics.wasm';
+
+    // Start compiling and downloading before the glue script arrives
+    let compileMs = 0;
+    const compiled = loadWasmModule(wasmUrl, options.cacheModule === false ? null : wasmUrl + '.version')
+      .then((loaded) => {
+        compileMs = elapsed();
+        return loaded;
+      });
+    const initialState = typeof options.initialState === 'string'
+      ? fetch(options.initialState)
+        .then((response) => (response.ok ? response.arrayBuffer() : null))
+        .catch(() => null)
+      : Promise.resolve(options.initialState ?? null);
+
     // Load the WASM module dynamically at runtime
     const script = document.createElement('script');
-    script.src = '/physics.js';
+    script.src = scriptUrl;
     document.head.appendChild(script);
 
     // Wait for the script to load
@@ -105,21 +180,87 @@ export class PhysicsEngine {
       script.onload = resolve;
       script.onerror = reject;
     });
+    const scriptMs = elapsed();
 
     // @ts-ignore - createPhysicsModule is loaded from the script
     const createPhysicsModule = (window as any).createPhysicsModule;
     if (!createPhysicsModule) {
       throw new Error('Physics module not loaded');
     }
-    this.module = await createPhysicsModule();
+    const { module: wasmModule, source } = await compiled;
+    const moduleArgs = wasmModule
+      ? {
+          // Instantiate from our compiled module instead of letting the glue fetch it again
+          instantiateWasm: (imports: WebAssembly.Imports,
+                            receive: (instance: WebAssembly.Instance, module: WebAssembly.Module) => void) => {
+            WebAssembly.instantiate(wasmModule, imports).then((instance) => receive(instance, wasmModule));
+            return {};
+          }
+        }
+      : {};
+    this.module = await createPhysicsModule(moduleArgs);
+    const instantiateMs = elapsed();
 
     // Allocate temp buffer
     this.tempPtr = this.module._malloc(this.tempBuffer.length * 4);
-    this.handle = this.module._engine_create(width, height, seed);
+    this.handle = options.deferWorld === false
+      ? this.module._engine_create(width, height, seed)
+      : this.module._engine_create_deferred(width, height, seed);
 
     if (this.handle === 0) {
       throw new Error('Failed to create physics engine (handle is 0)');
     }
+
+    const state = await initialState;
+    const prebakedState = state !== null && this.loadState(state);
+
+    this.startTime = start;
+    this.startup = {
+      moduleSource: source,
+      prebakedState,
+      scriptMs,
+      compileMs,
+      instantiateMs,
+      createMs: elapsed(),
+      firstStepMs: null
+    };
+  }
+
+  /**
+   * Get the cold-start timeline
+   * @returns Timings, or null before initialize() completes
+   */
+  getStartupTiming(): StartupTiming | null {
+    return this.startup ? { ...this.startup } : null;
+  }
+
+  /**
+   * Serialise the full engine state (restorable with loadState(), or as
+   * a pre-baked initialState for a later initialize())
+   * @returns State bytes (only valid for the same build and world size)
+   */
+  saveState(): Uint8Array | null {
+    if (!this.module || !this.handle) return null;
+
+    const size = this.module._engine_save_state(this.handle);
+    const ptr = this.module._engine_get_saved_state();
+    return new Uint8Array(this.module.HEAP8.buffer, ptr, size).slice();
+  }
+
+  /**
+   * Restore a state produced by saveState()
+   * @param state State bytes
+   * @returns False if the state is from another build or world size
+   */
+  loadState(state: ArrayBuffer | Uint8Array): boolean {
+    if (!this.module || !this.handle) return false;
+
+    const bytes = state instanceof Uint8Array ? state : new Uint8Array(state);
+    const ptr = this.module._malloc(Math.max(bytes.length, 1));
+    new Uint8Array(this.module.HEAP8.buffer, ptr, bytes.length).set(bytes);
+    const ok = this.module._engine_load_state(this.handle, ptr, bytes.length) !== 0;
+    this.module._free(ptr);
+    return ok;
   }
 
   destroy(): void {
@@ -128,6 +269,9 @@ export class PhysicsEngine {
       if (this.tempPtr) {
         this.module._free(this.tempPtr);
       }
+      if (this.particlePtr) {
+        this.module._free(this.particlePtr);
+      }
     }
   }
 
@@ -165,6 +309,16 @@ export class PhysicsEngine {
     }
   }
 
+  /**
+   * Select the gravitational softening kernel (kept across resets and saved states)
+   * @param kernel 'plummer' (default), 'spline' (exactly Newtonian beyond 2.8 softening lengths) or 'none'
+   */
+  setSoftening(kernel: SofteningKernelName): void {
+    if (this.module && this.handle) {
+      this.module._engine_set_softening(this.handle, SOFTENING_KERNELS.indexOf(kernel));
+    }
+  }
+
   setShipMass(mass: number): void {
     if (this.module && this.handle) {
       this.module._engine_set_ship_mass(this.handle, mass);
@@ -200,6 +354,9 @@ export class PhysicsEngine {
   step(): void {
     if (this.module && this.handle) {
       this.module._engine_step(this.handle);
+      if (this.startup && this.startup.firstStepMs === null) {
+        this.startup.firstStepMs = performance.now() - this.startTime;
+      }
     }
   }
 
@@ -276,14 +433,25 @@ export class PhysicsEngine {
         this.tempBuffer[j] = heap[j];
       }
 
-      asteroids.push({
+      const asteroid: AsteroidData = {
         x: this.tempBuffer[0],
         y: this.tempBuffer[1],
         radius: this.tempBuffer[2],
         rotation: this.tempBuffer[3],
         size: this.tempBuffer[4],
-        active: this.tempBuffer[5] !== 0
-      });
+        active: this.tempBuffer[5] !== 0,
+        shape: []
+      };
+
+      // Outline owned by the engine (same polygon used for collisions)
+      this.module._engine_get_asteroid_shape(this.handle, i, this.tempPtr);
+      const shapeHeap = new Float32Array(this.module.HEAP8.buffer, this.tempPtr, 25);
+      const vertexCount = shapeHeap[0];
+      for (let j = 0; j < vertexCount * 2; j++) {
+        asteroid.shape.push(shapeHeap[1 + j]);
+      }
+
+      asteroids.push(asteroid);
     }
 
     return asteroids;
@@ -342,28 +510,254 @@ export class PhysicsEngine {
   getParticles(): ParticleData[] {
     if (!this.module || !this.handle) return [];
 
-    const count = this.module._engine_get_particle_count(this.handle);
-    const particles: ParticleData[] = [];
+    // One call for the whole pool instead of one per particle
+    const available = this.module._engine_get_particle_count(this.handle);
+    if (available > this.particleCapacity) {
+      if (this.particlePtr) this.module._free(this.particlePtr);
+      this.particleCapacity = Math.max(available, this.particleCapacity * 2, 64);
+      this.particlePtr = this.module._malloc(this.particleCapacity * 16);
+    }
+    if (!this.particlePtr) return [];
+    const count = this.module._engine_get_particles(this.handle, this.particlePtr, this.particleCapacity);
+    const heap = new Float32Array(this.module.HEAP8.buffer, this.particlePtr, count * 4);
 
+    const particles: ParticleData[] = [];
     for (let i = 0; i < count; i++) {
-      this.module._engine_get_particle_data(this.handle, i, this.tempPtr);
-
-      const heap = new Float32Array(this.module.HEAP8.buffer, this.tempPtr, 4);
-      for (let j = 0; j < 4; j++) {
-        this.tempBuffer[j] = heap[j];
-      }
-
       particles.push({
-        x: this.tempBuffer[0],
-        y: this.tempBuffer[1],
-        alpha: this.tempBuffer[2],
-        playerId: Math.round(this.tempBuffer[3])
+        x: heap[i * 4],
+        y: heap[i * 4 + 1],
+        alpha: heap[i * 4 + 2],
+        playerId: Math.round(heap[i * 4 + 3])
       });
     }
 
     return particles;
   }
 
+  /**
+   * Store explosion particles in the compact 16-bit tier (17 instead of 60 bytes each)
+   * @param enabled True for compact storage, false for full records
+   */
+  setCompactStorage(enabled: boolean): void {
+    if (this.module && this.handle) {
+      this.module._engine_set_compact_storage(this.handle, enabled ? 1 : 0);
+    }
+  }
+
+  getDiagnostics(): DiagnosticsData | null {
+    if (!this.module || !this.handle) return null;
+
+    this.module._engine_get_diagnostics(this.handle, this.tempPtr);
+    const heap = new Float32Array(this.module.HEAP8.buffer, this.tempPtr, 9);
+
+    return {
+      kinetic: heap[0],
+      potential: heap[1],
+      external: heap[2],
+      total: heap[3],
+      momentumX: heap[4],
+      momentumY: heap[5],
+      angularMomentum: heap[6],
+      drift: heap[7],
+      bodyCount: heap[8]
+    };
+  }
+
+  resetDiagnosticsBaseline(): void {
+    if (this.module && this.handle) {
+      this.module._engine_reset_diagnostics_baseline(this.handle);
+    }
+  }
+
+  /**
+   * Configure the tree force accuracy monitor
+   * @param interval Steps between checks (0 disables)
+   * @param samples Bodies sampled per check
+   * @param adaptiveTheta Steer theta to hold targetError
+   * @param targetError Target RMS relative force error
+   */
+  setForceMonitor(interval: number, samples: number, adaptiveTheta: boolean, targetError: number): void {
+    if (this.module && this.handle) {
+      this.module._engine_set_force_monitor(this.handle, interval, samples, adaptiveTheta ? 1 : 0, targetError);
+    }
+  }
+
+  getForceAccuracy(): ForceAccuracyData | null {
+    if (!this.module || !this.handle) return null;
+
+    this.module._engine_get_force_accuracy(this.handle, this.tempPtr);
+    const heap = new Float32Array(this.module.HEAP8.buffer, this.tempPtr, 6);
+
+    return {
+      meanError: heap[0],
+      rmsError: heap[1],
+      p95Error: heap[2],
+      maxError: heap[3],
+      theta: heap[4],
+      checks: heap[5]
+    };
+  }
+
+  /**
+   * Compute radial profiles about the potential centre during each step
+   * @param bins Radial bins (0 disables)
+   * @param maxRadius Outer edge of the last bin (0 = half the shorter world side)
+   * @param interval Steps between updates (1 = every step)
+   */
+  setProfiles(bins: number, maxRadius: number = 0, interval: number = 1): void {
+    if (this.module && this.handle) {
+      this.module._engine_set_profiles(this.handle, bins, maxRadius, interval);
+    }
+  }
+
+  /**
+   * Get the latest radial profiles as views into WASM memory (no copy)
+   * Returns null until a profiled step has run
+   */
+  getRadialProfile(): RadialProfileData | null {
+    if (!this.module || !this.handle) return null;
+
+    const bins = this.module._engine_get_profile_bins(this.handle);
+    const ptr = this.module._engine_get_profile(this.handle);
+    if (bins <= 0 || !ptr) return null;
+
+    // Column-major in ProfileColumn order (engine/profiles.h)
+    const column = (i: number) => new Float32Array(this.module.HEAP8.buffer, ptr + i * bins * 4, bins);
+    return {
+      bins,
+      radius: column(0),
+      count: column(1),
+      density: column(2),
+      rotation: column(3),
+      dispersion: column(4),
+      circular: column(5)
+    };
+  }
+
+  getStepProfile(): StepProfileData | null {
+    if (!this.module || !this.handle) return null;
+
+    this.module._engine_get_step_profile(this.handle, this.tempPtr);
+    const heap = new Float32Array(this.module.HEAP8.buffer, this.tempPtr, 8);
+
+    return {
+      entityMs: heap[0],
+      gravityMs: heap[1],
+      analysisMs: heap[2],
+      collisionMs: heap[3],
+      cleanupMs: heap[4],
+      totalMs: heap[5],
+      forceImbalance: heap[6],
+      forceTasks: heap[7]
+    };
+  }
+
+  /**
+   * Configure step-latency windows and outlier detection (clears the histograms)
+   * @param window Steps per snapshot window (600 = 5 s at 120 Hz)
+   * @param outlierFactor Outlier threshold as a multiple of the median step time
+   * @param minOutlierMs Steps faster than this are never outliers
+   */
+  setLatencyConfig(window: number, outlierFactor: number = 2, minOutlierMs: number = 1): void {
+    if (this.module && this.handle) {
+      this.module._engine_set_latency_config(this.handle, window, outlierFactor, minOutlierMs);
+    }
+  }
+
+  /**
+   * Get step-latency percentiles
+   * @param scope 'current' window being filled, last completed 'window', or 'total' since reset
+   */
+  getLatency(scope: 'current' | 'window' | 'total' = 'window'): LatencyData | null {
+    if (!this.module || !this.handle) return null;
+
+    const scopeIndex = scope === 'current' ? 0 : scope === 'window' ? 1 : 2;
+    this.module._engine_get_latency(this.handle, scopeIndex, this.tempPtr);
+    const heap = new Float32Array(this.module.HEAP8.buffer, this.tempPtr, 13);
+
+    const phaseOutliers = {} as Record<StepPhaseName, number>;
+    STEP_PHASES.forEach((phase, i) => { phaseOutliers[phase] = heap[8 + i]; });
+    return {
+      steps: heap[0],
+      meanMs: heap[1],
+      p50Ms: heap[2],
+      p90Ms: heap[3],
+      p99Ms: heap[4],
+      p999Ms: heap[5],
+      maxMs: heap[6],
+      outliers: heap[7],
+      phaseOutliers
+    };
+  }
+
+  /**
+   * Get the most recent outlier steps, newest first (at most 6)
+   */
+  getLatencyOutliers(): LatencyOutlierData[] {
+    if (!this.module || !this.handle) return [];
+
+    const maxCount = Math.floor(this.tempBuffer.length / 5);
+    const count = this.module._engine_get_latency_outliers(this.handle, this.tempPtr, maxCount);
+    const heap = new Float32Array(this.module.HEAP8.buffer, this.tempPtr, count * 5);
+
+    const outliers: LatencyOutlierData[] = [];
+    for (let i = 0; i < count; i++) {
+      outliers.push({
+        step: heap[i * 5],
+        totalMs: heap[i * 5 + 1],
+        phase: STEP_PHASES[heap[i * 5 + 2]] ?? 'entities',
+        phaseMs: heap[i * 5 + 3],
+        medianMs: heap[i * 5 + 4]
+      });
+    }
+    return outliers;
+  }
+
+  /**
+   * Get heap usage per subsystem (process-wide counters)
+   */
+  getMemoryStats(): MemoryStatsData | null {
+    if (!this.module || !this.handle) return null;
+
+    this.module._engine_get_memory_stats(this.handle, this.tempPtr);
+    const heap = new Float32Array(this.module.HEAP8.buffer, this.tempPtr, 32);
+
+    const tags = {} as Record<MemoryTagName, MemoryTagData>;
+    const overBudget: MemoryTagName[] = [];
+    MEMORY_TAGS.forEach((tag, i) => {
+      tags[tag] = {
+        currentBytes: heap[i * 5],
+        peakBytes: heap[i * 5 + 1],
+        allocations: heap[i * 5 + 2],
+        frees: heap[i * 5 + 3],
+        overBudgetSteps: heap[i * 5 + 4]
+      };
+      if (heap[30] & (1 << i)) overBudget.push(tag);
+    });
+    return { enabled: heap[31] !== 0, overBudget, tags };
+  }
+
+  /**
+   * Set a hard heap budget for one subsystem; over budget the engine degrades
+   * (particles stop emitting, black holes stop spawning, collision scratch is freed)
+   * @param tag Subsystem
+   * @param bytes Budget in bytes (0 = unlimited)
+   */
+  setMemoryBudget(tag: MemoryTagName, bytes: number): void {
+    if (this.module && this.handle) {
+      this.module._engine_set_memory_budget(this.handle, MEMORY_TAGS.indexOf(tag), bytes);
+    }
+  }
+
+  /**
+   * Restart peak tracking from current usage
+   */
+  resetMemoryPeaks(): void {
+    if (this.module && this.handle) {
+      this.module._engine_reset_memory_peaks(this.handle);
+    }
+  }
+
   getPotentialName(): string {
     if (!this.module || !this.handle) return '';
     const ptr = this.module._engine_get_potential_name(this.handle);
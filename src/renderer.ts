@@ -96,7 +96,7 @@ export class Renderer {
   }
 
   drawAsteroid(asteroid: AsteroidData): void {
-    if (!asteroid.active) return;
+    if (!asteroid.active || asteroid.shape.length === 0) return;
 
     this.ctx.save();
     this.ctx.translate(asteroid.x, asteroid.y);
@@ -105,15 +105,13 @@ export class Renderer {
     this.ctx.strokeStyle = '#fff';
     this.ctx.lineWidth = 2;
 
-    // Draw irregular polygon
-    const vertices = 8;
+    // Draw the engine's collision outline
+    const vertices = asteroid.shape.length / 2;
     this.ctx.beginPath();
     for (let i = 0; i <= vertices; i++) {
-      const angle = (i / vertices) * Math.PI * 2;
-      const variation = 0.7 + (Math.sin(i * 2.5) * 0.3);
-      const r = asteroid.radius * variation;
-      const x = Math.cos(angle) * r;
-      const y = Math.sin(angle) * r;
+      const k = (i % vertices) * 2;
+      const x = asteroid.shape[k] * asteroid.radius;
+      const y = asteroid.shape[k + 1] * asteroid.radius;
 
       if (i === 0) {
         this.ctx.moveTo(x, y);
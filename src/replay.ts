@@ -0,0 +1,310 @@
+/**
+ * @fileoverview Seekable trajectory replay reader
+ *
+ * Decodes the .traj container written by the native runner's --record
+ * option (engine/trajectory.h documents the layout and codec). The whole
+ * file is held in one ArrayBuffer, the browser's equivalent of the native
+ * memory mapping: opening only parses the header and footer index, and a
+ * frame is decoded when it is requested.
+ *
+ * Every frame is encoded against its keyframe, so seeking to any step is
+ * an index lookup plus at most two payload decodes; the last keyframe is
+ * cached, so playing forward decodes one payload per frame.
+ *
+ * Usage:
+ * ```typescript
+ * const replay = await TrajectoryReplay.load('/runs/plummer.traj');
+ * const frame = replay.readFrame(replay.findFrame(1200));
+ * ```
+ */
+
+import type { TrajectoryFrameData } from './types';
+
+const FILE_MAGIC = 'NBTRAJ2';
+const INDEX_MAGIC = 'NBTRIDX';
+const VERSION = 2;
+const FILE_HEADER_BYTES = 24;
+const FRAME_HEADER_BYTES = 32;
+const INDEX_ENTRY_BYTES = 24;
+const FOOTER_BYTES = 24;
+const FRAME_SYNC = 0x4d415246;
+const BLOCK_WORDS = 32;
+
+/**
+ * Index record for one frame
+ */
+interface IndexEntry {
+  step: number;      // Simulation step
+  offset: number;    // Byte offset of the frame header
+  keyframe: number;  // Frame number of the reference keyframe
+}
+
+/**
+ * Frame columns as raw 32-bit words (the codec works on bit patterns)
+ */
+interface FrameWords {
+  count: number;
+  columns: Uint32Array[];  // id, px, py, vx, vy
+}
+
+/**
+ * Read a NUL-terminated 8-byte magic string
+ */
+function readMagic(bytes: Uint8Array, offset: number): string {
+  let text = '';
+  for (let i = 0; i < 7; i++) text += String.fromCharCode(bytes[offset + i]);
+  return text;
+}
+
+/**
+ * Transpose a 32x32 bit matrix in place (self-inverse)
+ */
+function transpose32(a: Uint32Array): void {
+  let mask = 0x0000ffff;
+  for (let j = 16; j !== 0; j >>= 1, mask = (mask ^ (mask << j)) >>> 0) {
+    for (let k = 0; k < 32; k = ((k | j) + 1) & ~j) {
+      const t = (a[k] ^ (a[k | j] >>> j)) & mask;
+      a[k] ^= t;
+      a[k | j] ^= t << j;
+    }
+  }
+}
+
+/**
+ * Seekable reader for recorded trajectories
+ */
+export class TrajectoryReplay {
+  private bytes: Uint8Array;
+  private view: DataView;
+  private entries: IndexEntry[] = [];
+  private block = new Uint32Array(BLOCK_WORDS);
+  private cachedKeyframe: FrameWords | null = null;
+  private cachedKeyframeNumber = -1;
+
+  /** Simulation steps between recorded frames */
+  readonly interval: number;
+  /** Frames per keyframe */
+  readonly keyframeInterval: number;
+
+  /**
+   * Fetch and open a trajectory file
+   * @param url File URL
+   */
+  static async load(url: string): Promise<TrajectoryReplay> {
+    const response = await fetch(url);
+    if (!response.ok) {
+      throw new Error(`Failed to fetch trajectory ${url}: ${response.status}`);
+    }
+    return new TrajectoryReplay(await response.arrayBuffer());
+  }
+
+  /**
+   * Open a trajectory held in memory
+   * @param buffer Whole file contents
+   */
+  constructor(buffer: ArrayBuffer) {
+    this.bytes = new Uint8Array(buffer);
+    this.view = new DataView(buffer);
+    if (buffer.byteLength < FILE_HEADER_BYTES || readMagic(this.bytes, 0) !== FILE_MAGIC ||
+        this.view.getUint32(8, true) !== VERSION || this.view.getUint32(16, true) === 0) {
+      throw new Error(`Not a version ${VERSION} trajectory file`);
+    }
+    this.interval = this.view.getUint32(12, true);
+    this.keyframeInterval = this.view.getUint32(16, true);
+    if (!this.readIndex()) this.scanIndex();
+  }
+
+  /** Number of frames */
+  get frameCount(): number {
+    return this.entries.length;
+  }
+
+  /**
+   * Simulation step of a frame
+   * @param frame Frame number
+   */
+  getStep(frame: number): number {
+    return this.entries[frame].step;
+  }
+
+  /**
+   * Find the frame recorded at or before a step
+   * @param step Simulation step
+   * @returns Frame number, or -1 if the step precedes the first frame
+   */
+  findFrame(step: number): number {
+    const entries = this.entries;
+    if (entries.length === 0 || step < entries[0].step) return -1;
+
+    // Regular recordings: frame k holds step first + k * interval
+    if (this.interval > 0) {
+      const guess = Math.floor((step - entries[0].step) / this.interval);
+      if (guess < entries.length && entries[guess].step <= step &&
+          (guess + 1 === entries.length || entries[guess + 1].step > step)) {
+        return guess;
+      }
+    }
+    let lo = 0;
+    let hi = entries.length;
+    while (lo < hi) {
+      const mid = (lo + hi) >> 1;
+      if (entries[mid].step <= step) lo = mid + 1;
+      else hi = mid;
+    }
+    return lo - 1;
+  }
+
+  /**
+   * Decode a frame
+   * @param frame Frame number (0 <= frame < frameCount)
+   */
+  readFrame(frame: number): TrajectoryFrameData {
+    const entry = this.entries[frame];
+    if (!entry || entry.keyframe > frame) {
+      throw new Error(`Invalid trajectory frame ${frame}`);
+    }
+    if (this.cachedKeyframeNumber !== entry.keyframe) {
+      this.cachedKeyframeNumber = -1;
+      this.cachedKeyframe = this.decode(entry.keyframe, null);
+      this.cachedKeyframeNumber = entry.keyframe;
+    }
+    const words = frame === entry.keyframe
+      ? this.copyWords(this.cachedKeyframe!)
+      : this.decode(frame, this.cachedKeyframe);
+    const [id, px, py, vx, vy] = words.columns;
+    return {
+      step: entry.step,
+      time: this.view.getFloat64(entry.offset + 16, true),
+      id: new Int32Array(id.buffer),
+      px: new Float32Array(px.buffer),
+      py: new Float32Array(py.buffer),
+      vx: new Float32Array(vx.buffer),
+      vy: new Float32Array(vy.buffer)
+    };
+  }
+
+  /**
+   * Load the footer index of a closed recording
+   * @returns False if the footer is missing or inconsistent
+   */
+  private readIndex(): boolean {
+    const size = this.bytes.length;
+    if (size < FILE_HEADER_BYTES + FOOTER_BYTES) return false;
+    const footer = size - FOOTER_BYTES;
+    const indexOffset = Number(this.view.getBigUint64(footer, true));
+    const frameCount = Number(this.view.getBigUint64(footer + 8, true));
+    if (readMagic(this.bytes, footer + 16) !== INDEX_MAGIC || indexOffset % 8 !== 0 ||
+        indexOffset > footer || frameCount !== Math.floor((footer - indexOffset) / INDEX_ENTRY_BYTES)) {
+      return false;
+    }
+    for (let i = 0; i < frameCount; i++) {
+      const at = indexOffset + i * INDEX_ENTRY_BYTES;
+      this.entries.push({
+        step: Number(this.view.getBigUint64(at, true)),
+        offset: Number(this.view.getBigUint64(at + 8, true)),
+        keyframe: this.view.getUint32(at + 16, true)
+      });
+    }
+    return true;
+  }
+
+  /**
+   * Rebuild the index of an unclosed recording from the frame headers
+   */
+  private scanIndex(): void {
+    const size = this.bytes.length;
+    let offset = FILE_HEADER_BYTES;
+    while (offset + FRAME_HEADER_BYTES <= size) {
+      const payloadBytes = this.view.getUint32(offset, true);
+      const keyframe = this.view.getUint32(offset + 24, true);
+      const next = Math.ceil((offset + FRAME_HEADER_BYTES + payloadBytes) / 8) * 8;
+      if (next > size || this.view.getUint32(offset + 28, true) !== FRAME_SYNC ||
+          keyframe > this.entries.length) break;
+      this.entries.push({ step: Number(this.view.getBigUint64(offset + 8, true)), offset, keyframe });
+      offset = next;
+    }
+  }
+
+  /**
+   * Copy frame words so callers never alias the cached keyframe
+   */
+  private copyWords(words: FrameWords): FrameWords {
+    return { count: words.count, columns: words.columns.map(column => column.slice()) };
+  }
+
+  /**
+   * Decode one frame payload into raw words
+   * @param frame Frame number
+   * @param reference Reference keyframe (null for keyframes)
+   */
+  private decode(frame: number, reference: FrameWords | null): FrameWords {
+    const offset = this.entries[frame].offset;
+    const payloadBytes = this.view.getUint32(offset, true);
+    const count = this.view.getUint32(offset + 4, true);
+    const start = offset + FRAME_HEADER_BYTES;
+    const end = start + payloadBytes;
+    if (end > this.bytes.length) {
+      throw new Error(`Trajectory frame ${frame} is out of bounds`);
+    }
+
+    const columns: Uint32Array[] = [];
+    let pos = start;
+    for (let c = 0; c < 5; c++) {
+      const out = new Uint32Array(count);
+      pos = this.decodeColumn(pos, end, out, reference ? reference.columns[c] : null);
+      if (pos < 0) {
+        throw new Error(`Trajectory frame ${frame} is corrupt`);
+      }
+      columns.push(out);
+    }
+    if (pos !== end) {
+      throw new Error(`Trajectory frame ${frame} is corrupt`);
+    }
+    return { count, columns };
+  }
+
+  /**
+   * Decode one column (plane-mask varint, nonzero planes, bitshuffle,
+   * zigzag, delta against the reference)
+   * @returns Position after the column, or -1 on malformed input
+   */
+  private decodeColumn(pos: number, end: number, out: Uint32Array, reference: Uint32Array | null): number {
+    const bytes = this.bytes;
+    const view = this.view;
+    const block = this.block;
+    const count = out.length;
+    const referenceCount = reference ? reference.length : 0;
+
+    for (let start = 0; start < count; start += BLOCK_WORDS) {
+      let planes = 0;
+      let shift = 0;
+      for (;;) {
+        if (pos >= end || shift >= 35) return -1;
+        const byte = bytes[pos++];
+        planes += (byte & 0x7f) * 2 ** shift;
+        shift += 7;
+        if (!(byte & 0x80)) break;
+      }
+      if (planes > 0xffffffff) return -1;
+      for (let b = 0; b < BLOCK_WORDS; b++) {
+        if (planes % 2 === 1) {
+          if (end - pos < 4) return -1;
+          block[b] = view.getUint32(pos, true);
+          pos += 4;
+        } else {
+          block[b] = 0;
+        }
+        planes = Math.floor(planes / 2);
+      }
+      transpose32(block);
+      const n = Math.min(BLOCK_WORDS, count - start);
+      for (let i = 0; i < n; i++) {
+        const index = start + i;
+        const base = index < referenceCount ? reference![index] : 0;
+        const word = block[i];
+        out[index] = base + ((word >>> 1) ^ -(word & 1));
+      }
+    }
+    return pos;
+  }
+}
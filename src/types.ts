@@ -38,6 +38,7 @@ export interface AsteroidData {
   rotation: number;   // Current rotation angle for visual variety
   size: number;       // Size class (0=large, 1=medium, 2=small)
   active: boolean;    // Whether asteroid is alive
+  shape: number[];    // Outline as x0, y0, x1, y1, ... (unit radius, local frame)
 }
 
 /**
@@ -73,6 +74,173 @@ export interface ParticleData {
   playerId: number; // Color code: -1=white (asteroids), 0=green (player 1), 1=cyan (player 2)
 }
 
+/**
+ * Conservation diagnostics from the last physics step
+ * Used to validate physics changes without watching the screen
+ */
+export interface DiagnosticsData {
+  kinetic: number;          // Kinetic energy
+  potential: number;        // Mutual gravitational potential energy
+  external: number;         // Potential energy in the external potential
+  total: number;            // Total energy
+  momentumX: number;        // Linear momentum X
+  momentumY: number;        // Linear momentum Y
+  angularMomentum: number;  // Angular momentum about the potential centre
+  drift: number;            // Relative energy drift since the baseline
+  bodyCount: number;        // Bodies included
+}
+
+/**
+ * Radial profiles about the potential centre (engine/profiles.h)
+ * Each array is a zero-copy view of one column in WASM memory, one value
+ * per bin: valid until the next step or memory growth, so plot it (or
+ * copy it) right away
+ */
+export interface RadialProfileData {
+  bins: number;              // Number of radial bins
+  radius: Float32Array;      // Bin centre radius
+  count: Float32Array;       // Bodies per annulus (black holes excluded)
+  density: Float32Array;     // Surface density (mass / annulus area)
+  rotation: Float32Array;    // Measured rotation curve (mean tangential velocity)
+  dispersion: Float32Array;  // One-dimensional velocity dispersion
+  circular: Float32Array;    // Model circular speed (potential plus enclosed mass)
+}
+
+/**
+ * Barnes-Hut force error statistics from the engine's sampling monitor
+ * Errors are relative to exact direct summation over a rolling window
+ */
+export interface ForceAccuracyData {
+  meanError: number;  // Mean relative error
+  rmsError: number;   // RMS relative error
+  p95Error: number;   // 95th percentile relative error
+  maxError: number;   // Largest relative error in the window
+  theta: number;      // Current opening angle
+  checks: number;     // Checks performed since reset
+}
+
+/**
+ * Wall-clock phase timings of the last engine step
+ * Force imbalance is slowest / mean task time of the parallel force loop
+ */
+export interface StepProfileData {
+  entityMs: number;        // Entity timers and input handling
+  gravityMs: number;       // Tree builds, half-kicks and drift
+  analysisMs: number;      // Diagnostics and force accuracy sampling
+  collisionMs: number;     // Collision detection and response
+  cleanupMs: number;       // Spawning, cleanup and wave progression
+  totalMs: number;         // Whole step
+  forceImbalance: number;  // 1.0 = perfectly balanced
+  forceTasks: number;      // Ranges the force loop was split into
+}
+
+/**
+ * Step-latency percentiles from the engine's HDR-style histogram
+ * Values are within 3.1% of the true step time; outliers are steps slower
+ * than a multiple of the previous window's median
+ */
+export interface LatencyData {
+  steps: number;    // Steps in the histogram
+  meanMs: number;   // Mean step time
+  p50Ms: number;    // Median
+  p90Ms: number;    // 90th percentile
+  p99Ms: number;    // 99th percentile
+  p999Ms: number;   // 99.9th percentile
+  maxMs: number;    // Slowest step
+  outliers: number; // Outlier steps
+  phaseOutliers: Record<StepPhaseName, number>;  // Outliers by dominant phase
+}
+
+/** Step phases in engine order (StepPhase in engine/latency.h) */
+export type StepPhaseName = 'entities' | 'gravity' | 'analysis' | 'collisions' | 'cleanup';
+
+/**
+ * One slow step and the phase that took longest in it
+ */
+export interface LatencyOutlierData {
+  step: number;            // Step number since reset
+  totalMs: number;         // Whole step time
+  phase: StepPhaseName;    // Dominant phase
+  phaseMs: number;         // Time of the dominant phase
+  medianMs: number;        // Median the step was compared against
+}
+
+/** Gravitational softening kernels in engine order (SofteningKernel in engine/softening.h) */
+export type SofteningKernelName = 'plummer' | 'spline' | 'none';
+
+/** Heap allocation tags in engine order (MemoryTag in engine/allocation.h) */
+export type MemoryTagName = 'untagged' | 'entities' | 'particles' | 'quadtree' | 'collision' | 'engine';
+
+/**
+ * Heap counters of one allocation tag
+ */
+export interface MemoryTagData {
+  currentBytes: number;     // Live bytes
+  peakBytes: number;        // Highest live bytes since start or resetMemoryPeaks()
+  allocations: number;      // Blocks allocated
+  frees: number;            // Blocks freed
+  overBudgetSteps: number;  // Steps that ended over this tag's budget
+}
+
+/**
+ * Tagged heap accounting from the engine's allocation hooks
+ * Counters are process-wide (shared by every engine in the module)
+ */
+export interface MemoryStatsData {
+  enabled: boolean;                              // Hooks compiled in
+  overBudget: MemoryTagName[];                   // Tags over budget after the last step
+  tags: Record<MemoryTagName, MemoryTagData>;
+}
+
+/**
+ * How PhysicsEngine.initialize() obtained the compiled WebAssembly module
+ * - module-cache: compiled module from IndexedDB (no download, no compile)
+ * - bytes-cache: wasm bytes from IndexedDB, compiled locally
+ * - streaming: compiled while downloading
+ * - buffered: downloaded, then compiled (server lacks application/wasm)
+ * - glue: left to the Emscripten glue script
+ */
+export type ModuleSource = 'module-cache' | 'bytes-cache' | 'streaming' | 'buffered' | 'glue';
+
+/**
+ * Options for PhysicsEngine.initialize()
+ */
+export interface PhysicsInitOptions {
+  scriptUrl?: string;                 // Emscripten glue script (default /physics.js)
+  wasmUrl?: string;                   // Wasm binary (default /physics.wasm)
+  cacheModule?: boolean;              // Cache the compiled module in IndexedDB (default true)
+  deferWorld?: boolean;               // Populate the world on first reset/step, not at creation (default true)
+  initialState?: string | ArrayBuffer | Uint8Array;  // Pre-baked state (URL or bytes from saveState())
+}
+
+/**
+ * Cold-start timeline of PhysicsEngine.initialize()
+ * Stamps are milliseconds since initialize() was called
+ */
+export interface StartupTiming {
+  moduleSource: ModuleSource;   // Where the compiled module came from
+  prebakedState: boolean;       // World restored from initialState instead of generated
+  scriptMs: number;             // Glue script loaded
+  compileMs: number;            // Module compiled (overlaps scriptMs)
+  instantiateMs: number;        // Runtime ready
+  createMs: number;             // Engine created (and state restored)
+  firstStepMs: number | null;   // First step finished (time to first step); null until then
+}
+
+/**
+ * One decoded trajectory frame (see src/replay.ts)
+ * Columns are parallel arrays indexed by body
+ */
+export interface TrajectoryFrameData {
+  step: number;        // Simulation step
+  time: number;        // Simulation time (seconds)
+  id: Int32Array;      // Entity ids
+  px: Float32Array;    // Position X
+  py: Float32Array;    // Position Y
+  vx: Float32Array;    // Velocity X
+  vy: Float32Array;    // Velocity Y
+}
+
 /**
  * Player input state for one frame
  * Captured from keyboard/gamepad and sent to physics engine